@@ -0,0 +1,130 @@
+// CPU-only benchmark of the SoA bounce kernels: body updates per second for
+// populations from 1k to 10M, per kernel, single-threaded and on the pool.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/simulation/body_store.h"
+#include "../include/threading/thread_pool.h"
+
+namespace {
+
+constexpr float STEP_SECONDS { 1.0f / 120.0f };
+constexpr double MIN_SECONDS_PER_CASE { 0.25 };
+
+const simulation::Bounds WINDOW_BOUNDS { -1.0f, 1.0f, -1.0f, 1.0f };
+
+simulation::BodyStore make_bodies(std::size_t count)
+{
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> position(-0.8f, 0.8f);
+  std::uniform_real_distribution<float> velocity(-0.9f, 0.9f);
+  std::uniform_real_distribution<float> extent(0.01f, 0.1f);
+
+  simulation::BodyStore bodies;
+  bodies.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    bodies.add({ position(rng), position(rng), velocity(rng), velocity(rng) },
+        { extent(rng), extent(rng) });
+  }
+
+  return bodies;
+}
+
+bool kernels_agree()
+{
+  auto reference = make_bodies(1003);
+  for (int step = 0; step < 500; step++) {
+    simulation::integrate_bodies(reference, 0, reference.size(), WINDOW_BOUNDS,
+        STEP_SECONDS, simulation::BodyKernel::SCALAR);
+  }
+
+  for (auto kernel :
+      { simulation::BodyKernel::SSE41, simulation::BodyKernel::AVX2 }) {
+    if (!simulation::body_kernel_supported(kernel))
+      continue;
+
+    auto bodies = make_bodies(1003);
+    for (int step = 0; step < 500; step++) {
+      simulation::integrate_bodies(bodies, 0, bodies.size(), WINDOW_BOUNDS,
+          STEP_SECONDS, kernel);
+    }
+
+    if (bodies.x != reference.x || bodies.y != reference.y
+        || bodies.vx != reference.vx || bodies.vy != reference.vy) {
+      std::cout << simulation::body_kernel_name(kernel)
+                << " disagrees with the scalar kernel" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename Step>
+double updates_per_second(std::size_t count, const Step& step)
+{
+  using clock = std::chrono::steady_clock;
+
+  step();
+
+  std::uint64_t steps = 0;
+  auto start = clock::now();
+  double elapsed = 0.0;
+  while (elapsed < MIN_SECONDS_PER_CASE) {
+    step();
+    steps++;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  }
+
+  return static_cast<double>(count) * steps / elapsed;
+}
+
+} // namespace
+
+int main()
+{
+  if (!kernels_agree())
+    return EXIT_FAILURE;
+
+  threading::ThreadPool pool;
+
+  std::cout << "threads: " << pool.size() << "\n"
+            << std::setw(10) << "bodies" << std::setw(10) << "kernel"
+            << std::setw(18) << "1 thread (M/s)" << std::setw(18)
+            << "pool (M/s)" << "\n";
+
+  const std::vector<std::size_t> populations { 1'000, 10'000, 100'000,
+    1'000'000, 10'000'000 };
+
+  for (auto count : populations) {
+    auto bodies = make_bodies(count);
+
+    for (auto kernel : { simulation::BodyKernel::SCALAR,
+             simulation::BodyKernel::SSE41, simulation::BodyKernel::AVX2 }) {
+      if (!simulation::body_kernel_supported(kernel))
+        continue;
+
+      double single = updates_per_second(count, [&] {
+        simulation::integrate_bodies(
+            bodies, 0, bodies.size(), WINDOW_BOUNDS, STEP_SECONDS, kernel);
+      });
+      double pooled = updates_per_second(count, [&] {
+        simulation::integrate_bodies(
+            bodies, WINDOW_BOUNDS, STEP_SECONDS, pool, kernel);
+      });
+
+      std::cout << std::setw(10) << count << std::setw(10)
+                << simulation::body_kernel_name(kernel) << std::setw(18)
+                << std::fixed << std::setprecision(1) << single / 1e6
+                << std::setw(18) << pooled / 1e6 << "\n";
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
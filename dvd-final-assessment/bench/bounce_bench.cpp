@@ -0,0 +1,149 @@
+// CPU-only benchmark of the event-driven mode main runs with --event-driven:
+// fast-forwarding the wall-hit schedule of many logos by minutes of simulated
+// time, and evaluating positions in closed form.
+//
+// Before timing, every event the scheduler reports is checked against
+// position_at (the logo must be on the wall it hit) and the first corner
+// against next_corner_hit.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "../include/simulation/bounce_events.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t LOGOS { 10'000 };
+constexpr std::int64_t FAST_FORWARD_SECONDS { 600 };
+constexpr std::size_t POSITION_SAMPLES { 1'000'000 };
+// Positions come back as doubles; walls are integers up to a few thousand.
+constexpr double WALL_TOLERANCE { 1e-6 };
+
+std::vector<simulation::LatticeLogo> make_logos(std::size_t count)
+{
+  std::mt19937 rng(2024);
+  std::uniform_int_distribution<std::int64_t> span(100, 2000);
+  std::uniform_int_distribution<std::int64_t> speed(-3000, 3000);
+
+  std::vector<simulation::LatticeLogo> logos;
+  for (std::size_t i = 0; i < count; i++) {
+    simulation::LatticeLogo logo { span(rng), span(rng), 0, 0, speed(rng),
+      speed(rng) };
+    logo.x0 = std::uniform_int_distribution<std::int64_t>(0, logo.span_x)(rng);
+    logo.y0 = std::uniform_int_distribution<std::int64_t>(0, logo.span_y)(rng);
+    logos.push_back(logo);
+  }
+
+  // Speeds beyond the span, which once scheduled hits before t = 0.
+  logos.push_back({ 720, 540, 0, 100, 1000, -135 });
+  // A logo that starts in a corner.
+  logos.push_back({ 600, 400, 0, 0, 300, 200 });
+  return logos;
+}
+
+bool on_wall(double position, std::int64_t span)
+{
+  return std::fabs(position) < WALL_TOLERANCE
+      || std::fabs(position - static_cast<double>(span)) < WALL_TOLERANCE;
+}
+
+bool schedule_agrees(const std::vector<simulation::LatticeLogo>& logos)
+{
+  simulation::BounceScheduler scheduler;
+  for (const auto& logo : logos)
+    scheduler.add(logo);
+
+  std::vector<std::optional<simulation::ExactTime>> first_corner(
+      logos.size());
+  bool ok = true;
+  simulation::ExactTime last { 0, 1 };
+  scheduler.advance_to(simulation::exact_seconds(60),
+      [&](const simulation::BounceEvent& event) {
+        const auto& logo = logos[event.logo];
+        const auto position = simulation::position_at(logo, event.time.seconds());
+        const bool x_wall = on_wall(position.x, logo.span_x);
+        const bool y_wall = on_wall(position.y, logo.span_y);
+
+        bool hit = false;
+        switch (event.axis) {
+        case simulation::BounceAxis::X:
+          hit = x_wall;
+          break;
+        case simulation::BounceAxis::Y:
+          hit = y_wall;
+          break;
+        case simulation::BounceAxis::CORNER:
+          hit = x_wall && y_wall;
+          if (!first_corner[event.logo])
+            first_corner[event.logo] = event.time;
+          break;
+        }
+
+        if (!hit || event.time < simulation::exact_seconds(0)
+            || event.time < last) {
+          ok = false;
+        }
+        last = event.time;
+      });
+
+  for (std::size_t i = 0; ok && i < logos.size(); i++) {
+    const auto corner = simulation::next_corner_hit(
+        logos[i], simulation::exact_seconds(0), true);
+    const bool in_window
+        = corner && !(simulation::exact_seconds(60) < corner->time);
+    ok = in_window ? first_corner[i] && *first_corner[i] == corner->time
+                   : !first_corner[i];
+  }
+
+  if (!ok)
+    std::cout << "scheduled events disagree with position_at" << std::endl;
+  return ok;
+}
+
+} // namespace
+
+int main()
+{
+  const auto logos = make_logos(LOGOS);
+  if (!schedule_agrees(logos))
+    return EXIT_FAILURE;
+
+  simulation::BounceScheduler scheduler;
+  for (const auto& logo : logos)
+    scheduler.add(logo);
+
+  auto start = clock_type::now();
+  const std::size_t events = scheduler.advance_to(
+      simulation::exact_seconds(FAST_FORWARD_SECONDS));
+  std::chrono::duration<double> elapsed = clock_type::now() - start;
+
+  std::cout << logos.size() << " logos fast-forwarded "
+            << FAST_FORWARD_SECONDS << " s: " << events << " events in "
+            << std::fixed << std::setprecision(1) << elapsed.count() * 1e3
+            << " ms (" << events / elapsed.count() / 1e6 << " M events/s)\n";
+
+  double sink = 0.0;
+  start = clock_type::now();
+  for (std::size_t i = 0; i < POSITION_SAMPLES; i++) {
+    const auto position = simulation::position_at(
+        logos[i % logos.size()], static_cast<double>(i) * 0.37);
+    sink += position.x + position.y;
+  }
+  elapsed = clock_type::now() - start;
+
+  std::cout << "position_at: " << std::setprecision(1)
+            << POSITION_SAMPLES / elapsed.count() / 1e6
+            << " M evaluations/s (checksum " << std::setprecision(0) << sink
+            << ")\n";
+
+  return EXIT_SUCCESS;
+}
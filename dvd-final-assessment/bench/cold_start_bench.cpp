@@ -0,0 +1,172 @@
+// Start-up benchmark for the app's own assets: the files compiled in by the
+// embed step against the same files read live from disk, as with
+// DVD_ASSET_DIR set.
+//
+//   cold-start-bench [source-dir]
+//
+// Each run builds a fresh Vfs, mounts the assets and brings every file to
+// the point the app needs it: shader text in memory, and images, should any
+// be embedded, decoded to RGBA. "mount + read" is the I/O part alone. Disk runs are measured with
+// the files evicted from the page cache (posix_fadvise(DONTNEED); tmpfs
+// ignores it) and with them cached.
+//
+// The embedded bytes are part of the executable, already mapped and warm
+// by the time main runs; on a truly cold start they are read with the rest
+// of the binary, in the same sequential pass.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../include/asset/vfs.h"
+#include "../include/texture/pixel_ingest.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int RUNS_PER_CASE { 50 };
+
+enum class Mode { EMBEDDED, DISK_COLD, DISK_WARM };
+
+const char* mode_name(Mode mode)
+{
+  switch (mode) {
+  case Mode::EMBEDDED:
+    return "embedded";
+  case Mode::DISK_COLD:
+    return "disk cold";
+  case Mode::DISK_WARM:
+    return "disk warm";
+  default:
+    return "unknown";
+  }
+}
+
+struct CaseResult {
+  double read_us;
+  double ready_us;
+};
+
+void evict(const std::filesystem::path& root)
+{
+  for (std::size_t i = 0; i < asset::embedded_asset_count; i++) {
+    const auto path = (root / asset::embedded_assets[i].name).string();
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+      continue;
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(descriptor);
+  }
+}
+
+bool is_image(const std::string& name)
+{
+  const auto extension = std::filesystem::path(name).extension();
+  return extension == ".png" || extension == ".jpg" || extension == ".tga";
+}
+
+double median(std::vector<double>& values)
+{
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+CaseResult run_case(Mode mode, const std::filesystem::path& root)
+{
+  std::vector<double> read_us;
+  std::vector<double> ready_us;
+  volatile std::size_t sink = 0;
+
+  for (int run = 0; run < RUNS_PER_CASE + 1; run++) {
+    if (mode == Mode::DISK_COLD)
+      evict(root);
+
+    const auto start = clock_type::now();
+
+    asset::Vfs vfs(asset::ReadPath::BUFFERED);
+    if (mode == Mode::EMBEDDED) {
+      vfs.mount_embedded(asset::embedded_assets, asset::embedded_asset_count);
+    } else {
+      // The source mounts main uses.
+      vfs.mount_directory((root / "texture").string(), "texture");
+      vfs.mount_directory(root.string(), "", false);
+    }
+
+    std::vector<asset::VfsFile> files(asset::embedded_asset_count);
+    for (std::size_t i = 0; i < files.size(); i++)
+      vfs.read(asset::embedded_assets[i].name, files[i]);
+    const auto read = clock_type::now();
+
+    for (const auto& file : files) {
+      if (!is_image(file.path)) {
+        sink = sink + file.size();
+        continue;
+      }
+      texture::IngestedImage image;
+      texture::decode_image(file.data(), file.size(), image);
+      sink = sink + image.pixels.size();
+    }
+    const auto ready = clock_type::now();
+
+    // The first run faults in code and allocator state for both modes.
+    if (run == 0)
+      continue;
+    read_us.push_back(
+        std::chrono::duration<double, std::micro>(read - start).count());
+    ready_us.push_back(
+        std::chrono::duration<double, std::micro>(ready - start).count());
+  }
+
+  return { median(read_us), median(ready_us) };
+}
+
+// The source tree is the parent of the build directory the bench runs from.
+std::filesystem::path default_source_directory()
+{
+  std::error_code error;
+  const auto executable = std::filesystem::read_symlink("/proc/self/exe", error);
+  return (error ? std::filesystem::current_path() : executable.parent_path())
+      .parent_path();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const std::filesystem::path root
+      = argc > 1 ? std::filesystem::path(argv[1]) : default_source_directory();
+
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < asset::embedded_asset_count; i++) {
+    const auto& asset = asset::embedded_assets[i];
+    if (!std::filesystem::exists(root / asset.name)) {
+      std::cout << "missing " << (root / asset.name).string()
+                << "; pass the source directory\n";
+      return EXIT_FAILURE;
+    }
+    bytes += asset.size;
+  }
+
+  std::cout << asset::embedded_asset_count << " assets, " << bytes
+            << " bytes, median of " << RUNS_PER_CASE << " runs\n\n";
+  std::cout << std::setw(12) << "mode" << std::setw(20) << "mount + read us"
+            << std::setw(16) << "ready us" << "\n";
+
+  for (Mode mode : { Mode::EMBEDDED, Mode::DISK_COLD, Mode::DISK_WARM }) {
+    const CaseResult result = run_case(mode, root);
+    std::cout << std::setw(12) << mode_name(mode) << std::fixed
+              << std::setprecision(1) << std::setw(20) << result.read_us
+              << std::setw(16) << result.ready_us << "\n";
+  }
+
+  return EXIT_SUCCESS;
+}
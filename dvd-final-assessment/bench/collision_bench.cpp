@@ -0,0 +1,118 @@
+// CPU-only benchmark of the logo-logo broad phase: pairs tested against pairs
+// colliding, and time per tick, for populations from 10k to 1M.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/simulation/body_store.h"
+#include "../include/simulation/spatial_grid.h"
+#include "../include/threading/thread_pool.h"
+
+namespace {
+
+constexpr float HALF_EXTENT_MIN { 0.25f };
+constexpr float HALF_EXTENT_MAX { 0.5f };
+constexpr float STEP_SECONDS { 1.0f / 120.0f };
+constexpr int TICKS_PER_CASE { 10 };
+
+// The world grows with the population so the density of logos, and with it
+// the expected number of contacts per logo, stays the same for every case.
+simulation::Bounds world_for(std::size_t count)
+{
+  float half = 0.75f * std::sqrt(static_cast<float>(count));
+  return { -half, half, -half, half };
+}
+
+simulation::BodyStore make_bodies(
+    std::size_t count, const simulation::Bounds& world)
+{
+  std::mt19937 rng(4321);
+  std::uniform_real_distribution<float> x(world.left, world.right);
+  std::uniform_real_distribution<float> y(world.bottom, world.top);
+  std::uniform_real_distribution<float> velocity(-4.0f, 4.0f);
+  std::uniform_real_distribution<float> extent(
+      HALF_EXTENT_MIN, HALF_EXTENT_MAX);
+
+  simulation::BodyStore bodies;
+  bodies.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    bodies.add({ x(rng), y(rng), velocity(rng), velocity(rng) },
+        { extent(rng), extent(rng) });
+  }
+
+  return bodies;
+}
+
+std::uint64_t brute_force_contacts(const simulation::BodyStore& bodies)
+{
+  std::uint64_t colliding = 0;
+  for (std::size_t i = 0; i < bodies.size(); i++) {
+    for (std::size_t j = i + 1; j < bodies.size(); j++) {
+      if (std::fabs(bodies.x[i] - bodies.x[j])
+              < bodies.half_width[i] + bodies.half_width[j]
+          && std::fabs(bodies.y[i] - bodies.y[j])
+              < bodies.half_height[i] + bodies.half_height[j])
+        colliding++;
+    }
+  }
+
+  return colliding;
+}
+
+} // namespace
+
+int main()
+{
+  threading::ThreadPool pool;
+  simulation::SpatialGrid grid;
+  std::vector<simulation::BodyContact> contacts;
+
+  {
+    auto world = world_for(2000);
+    auto bodies = make_bodies(2000, world);
+    grid.rebuild(bodies, world, pool);
+    auto stats = grid.find_contacts(contacts, pool);
+    if (stats.pairs_colliding != brute_force_contacts(bodies)) {
+      std::cout << "broad phase missed pairs found by brute force"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "threads: " << pool.size() << "\n"
+            << std::setw(10) << "bodies" << std::setw(16) << "all pairs"
+            << std::setw(14) << "tested" << std::setw(12) << "colliding"
+            << std::setw(14) << "ms / tick" << "\n";
+
+  for (std::size_t count : { 10'000, 100'000, 1'000'000 }) {
+    auto world = world_for(count);
+    auto bodies = make_bodies(count, world);
+
+    simulation::CollisionStats total {};
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < TICKS_PER_CASE; tick++) {
+      simulation::integrate_bodies(bodies, world, STEP_SECONDS, pool);
+      auto stats
+          = simulation::collide_bodies(bodies, world, grid, contacts, pool);
+      total.pairs_tested += stats.pairs_tested;
+      total.pairs_colliding += stats.pairs_colliding;
+    }
+    std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    double all_pairs = 0.5 * static_cast<double>(count) * (count - 1);
+    std::cout << std::setw(10) << count << std::setw(16) << std::scientific
+              << std::setprecision(2) << all_pairs << std::setw(14)
+              << total.pairs_tested / TICKS_PER_CASE << std::setw(12)
+              << total.pairs_colliding / TICKS_PER_CASE << std::setw(14)
+              << std::fixed << elapsed.count() / TICKS_PER_CASE << "\n";
+  }
+
+  return EXIT_SUCCESS;
+}
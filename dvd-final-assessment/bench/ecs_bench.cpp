@@ -0,0 +1,214 @@
+// CPU-only benchmark of the ECS: structural changes (create, add and remove
+// a component, destroy) and the logo systems (simulate, cull, extract) at
+// millions of entities, in millions of entities per second.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/ecs/logo_systems.h"
+#include "../include/ecs/query.h"
+#include "../include/ecs/world.h"
+#include "../include/threading/thread_pool.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t STRUCTURAL_ENTITIES { 2'000'000 };
+constexpr float STEP_SECONDS { 1.0f / 120.0f };
+constexpr double MIN_SECONDS_PER_CASE { 0.25 };
+
+const simulation::Bounds WINDOW_BOUNDS { -1.0f, 1.0f, -1.0f, 1.0f };
+// The right half of the window, so about half the logos are culled.
+const simulation::Bounds VIEW_BOUNDS { 0.0f, 1.0f, -1.0f, 1.0f };
+
+// A component added to and removed from logos, moving them between
+// archetypes.
+struct Selected {
+  std::uint32_t group;
+};
+
+struct Logo {
+  simulation::DvdState state;
+  simulation::DvdLogo logo;
+};
+
+std::vector<Logo> make_logos(std::size_t count)
+{
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> position(-0.8f, 0.8f);
+  std::uniform_real_distribution<float> velocity(-0.9f, 0.9f);
+  std::uniform_real_distribution<float> extent(0.01f, 0.1f);
+
+  std::vector<Logo> logos;
+  logos.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    logos.push_back(
+        { { position(rng), position(rng), velocity(rng), velocity(rng) },
+            { extent(rng), extent(rng) } });
+  }
+  return logos;
+}
+
+void populate(ecs::World& world, const std::vector<Logo>& logos,
+    std::vector<ecs::Entity>* entities = nullptr)
+{
+  for (const auto& logo : logos) {
+    auto entity = ecs::LogoSystems::create_logo(world, logo.state, logo.logo);
+    if (entities)
+      entities->push_back(entity);
+  }
+}
+
+// The systems must give what stepping and culling each logo by hand gives.
+bool systems_agree(threading::ThreadPool& pool)
+{
+  auto logos = make_logos(10'007);
+  ecs::World world;
+  populate(world, logos);
+
+  ecs::LogoSystems systems;
+  for (int step = 0; step < 100; step++)
+    systems.simulate(world, WINDOW_BOUNDS, STEP_SECONDS, pool);
+  systems.cull(world, VIEW_BOUNDS, pool);
+  std::vector<ecs::LogoInstance> instances;
+  systems.extract(world, instances, pool);
+
+  std::vector<ecs::LogoInstance> expected;
+  for (auto& logo : logos) {
+    for (int step = 0; step < 100; step++) {
+      logo.state = simulation::step_dvd(
+          logo.state, logo.logo, WINDOW_BOUNDS, STEP_SECONDS);
+    }
+    if (logo.state.x + logo.logo.half_width >= VIEW_BOUNDS.left
+        && logo.state.x - logo.logo.half_width <= VIEW_BOUNDS.right) {
+      expected.push_back({ logo.state.x, logo.state.y, logo.logo.half_width,
+          logo.logo.half_height });
+    }
+  }
+
+  // Nothing was destroyed, so chunk order is creation order.
+  bool same = instances.size() == expected.size();
+  for (std::size_t i = 0; same && i < instances.size(); i++) {
+    same = instances[i].x == expected[i].x && instances[i].y == expected[i].y
+        && instances[i].half_width == expected[i].half_width;
+  }
+  if (!same)
+    std::cout << "logo systems disagree with stepping each logo" << std::endl;
+  return same;
+}
+
+double millions_per_second(std::size_t count, clock_type::time_point start)
+{
+  std::chrono::duration<double> elapsed = clock_type::now() - start;
+  return count / elapsed.count() / 1e6;
+}
+
+template <typename Run>
+double repeated_millions_per_second(std::size_t count, const Run& run)
+{
+  run();
+
+  std::uint64_t runs = 0;
+  auto start = clock_type::now();
+  double elapsed = 0.0;
+  while (elapsed < MIN_SECONDS_PER_CASE) {
+    run();
+    runs++;
+    elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+  }
+
+  return static_cast<double>(count) * runs / elapsed / 1e6;
+}
+
+void report(const char* name, double rate)
+{
+  std::cout << std::setw(24) << name << std::setw(12) << std::fixed
+            << std::setprecision(1) << rate << "\n";
+}
+
+void structural_changes()
+{
+  const auto logos = make_logos(STRUCTURAL_ENTITIES);
+  std::vector<ecs::Entity> entities;
+  entities.reserve(logos.size());
+
+  std::cout << "structural changes, " << logos.size()
+            << " entities (M/s)\n";
+
+  ecs::World world;
+  auto start = clock_type::now();
+  populate(world, logos, &entities);
+  report("create", millions_per_second(logos.size(), start));
+
+  start = clock_type::now();
+  for (std::size_t i = 0; i < entities.size(); i += 2)
+    world.add(entities[i], Selected { static_cast<std::uint32_t>(i) });
+  report("add component", millions_per_second(entities.size() / 2, start));
+
+  start = clock_type::now();
+  for (std::size_t i = 0; i < entities.size(); i += 2)
+    world.remove<Selected>(entities[i]);
+  report("remove component", millions_per_second(entities.size() / 2, start));
+
+  std::shuffle(entities.begin(), entities.end(), std::mt19937(99));
+  start = clock_type::now();
+  for (auto entity : entities)
+    world.destroy(entity);
+  report("destroy (random order)", millions_per_second(entities.size(), start));
+
+  start = clock_type::now();
+  populate(world, logos);
+  report("create (reused slots)", millions_per_second(logos.size(), start));
+}
+
+void iteration(std::size_t count, threading::ThreadPool& pool)
+{
+  ecs::World world;
+  populate(world, make_logos(count));
+
+  ecs::LogoSystems systems;
+  ecs::Query<simulation::DvdState, const simulation::DvdLogo> moving;
+  std::vector<ecs::LogoInstance> instances;
+
+  std::cout << "\nsystems, " << count << " entities (M/s)\n";
+  report("simulate, per entity", repeated_millions_per_second(count, [&] {
+    moving.each(world,
+        [](simulation::DvdState& state, const simulation::DvdLogo& logo) {
+          state = simulation::step_dvd(
+              state, logo, WINDOW_BOUNDS, STEP_SECONDS);
+        });
+  }));
+  report("simulate, pool", repeated_millions_per_second(count, [&] {
+    systems.simulate(world, WINDOW_BOUNDS, STEP_SECONDS, pool);
+  }));
+  report("cull, pool", repeated_millions_per_second(count, [&] {
+    systems.cull(world, VIEW_BOUNDS, pool);
+  }));
+  report("extract, pool", repeated_millions_per_second(count, [&] {
+    systems.extract(world, instances, pool);
+  }));
+  std::cout << "visible: " << instances.size() << "\n";
+}
+
+} // namespace
+
+int main()
+{
+  threading::ThreadPool pool;
+  if (!systems_agree(pool))
+    return EXIT_FAILURE;
+
+  std::cout << "threads: " << pool.size() << "\n\n";
+  structural_changes();
+  for (std::size_t count : { 1'000'000, 4'000'000 })
+    iteration(count, pool);
+
+  return EXIT_SUCCESS;
+}
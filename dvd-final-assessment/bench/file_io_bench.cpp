@@ -0,0 +1,220 @@
+// File read benchmark: the istream + stringstream readers used around the
+// tree against the asset::FileReader paths (buffered, mmap, io_uring), for
+// a batch of shader-sized files and a batch of texture-sized files, with a
+// cold and a warm page cache.
+//
+// Latency is the time from the start of the batch until a file's bytes are
+// in memory, which is what a loader that requests everything at start-up
+// waits for. Every page of every file is touched so mmap is not free.
+//
+// Cold runs evict the files with posix_fadvise(DONTNEED). That drops clean
+// pages on most file systems but not on every one (tmpfs keeps them), so
+// compare the cold rows against the warm ones before trusting them.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../include/asset/file_io.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int RUNS_PER_CASE { 5 };
+constexpr std::size_t PAGE_BYTES { 4096 };
+
+struct FileSet {
+  const char* name;
+  std::size_t count;
+  std::size_t bytes;
+};
+
+constexpr FileSet FILE_SETS[] { { "shader", 512, 2 << 10 },
+  { "texture", 16, 8 << 20 } };
+
+struct CaseResult {
+  double total_ms;
+  double megabytes_per_second;
+  double p50_ms;
+  double p99_ms;
+};
+
+std::vector<std::string> write_files(
+    const std::filesystem::path& directory, const FileSet& set)
+{
+  std::filesystem::create_directories(directory);
+
+  std::vector<char> contents(set.bytes);
+  for (std::size_t i = 0; i < contents.size(); i++)
+    contents[i] = static_cast<char>('a' + i % 26);
+
+  std::vector<std::string> paths;
+  for (std::size_t i = 0; i < set.count; i++) {
+    auto path = (directory / (std::string(set.name) + "-" + std::to_string(i)))
+                    .string();
+    {
+      std::ofstream file(path, std::ios::binary);
+      file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    // Dirty pages cannot be dropped, so flush them before any cold run.
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    fsync(descriptor);
+    ::close(descriptor);
+    paths.push_back(path);
+  }
+
+  return paths;
+}
+
+void evict(const std::vector<std::string>& paths)
+{
+  for (const auto& path : paths) {
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(descriptor);
+  }
+}
+
+unsigned touch_pages(const unsigned char* data, std::size_t size)
+{
+  unsigned sum = 0;
+  for (std::size_t offset = 0; offset < size; offset += PAGE_BYTES)
+    sum += data[offset];
+  return sum;
+}
+
+// The pattern of read_from_file/main.cpp and render-base's
+// get_file_contents.
+bool read_with_stringstream(const std::string& path, std::string& contents)
+{
+  std::ifstream file(path);
+  if (!file.is_open())
+    return false;
+
+  std::stringstream ss;
+  ss << file.rdbuf();
+  contents = ss.str();
+  return true;
+}
+
+double percentile(std::vector<double>& values, double fraction)
+{
+  std::sort(values.begin(), values.end());
+  return values[static_cast<std::size_t>(fraction * (values.size() - 1))];
+}
+
+// `path` is null for the stringstream baseline.
+CaseResult run_case(const std::vector<std::string>& paths,
+    std::size_t file_bytes, bool cold, const asset::ReadPath* path)
+{
+  std::vector<double> latencies;
+  double total_ms = 0.0;
+  volatile unsigned sink = 0;
+
+  for (int run = 0; run < RUNS_PER_CASE + (cold ? 0 : 1); run++) {
+    if (cold)
+      evict(paths);
+
+    // Warm runs discard the first pass, which fills the cache.
+    const bool measured = cold || run > 0;
+    auto start = clock_type::now();
+    auto record = [&] {
+      if (measured) {
+        latencies.push_back(std::chrono::duration<double, std::milli>(
+            clock_type::now() - start)
+                                .count());
+      }
+    };
+
+    if (path) {
+      asset::FileReader reader(*path);
+      std::vector<asset::FileRead> reads(paths.size());
+      for (std::size_t i = 0; i < paths.size(); i++)
+        reads[i].path = paths[i];
+
+      start = clock_type::now();
+      reader.read(reads, [&](std::size_t index) {
+        sink = sink + touch_pages(reads[index].data(), reads[index].size());
+        record();
+      });
+    } else {
+      std::string contents;
+      for (const auto& file : paths) {
+        read_with_stringstream(file, contents);
+        sink = sink + touch_pages(
+            reinterpret_cast<const unsigned char*>(contents.data()),
+            contents.size());
+        record();
+      }
+    }
+
+    if (measured) {
+      total_ms += std::chrono::duration<double, std::milli>(
+          clock_type::now() - start)
+                      .count();
+    }
+  }
+
+  total_ms /= RUNS_PER_CASE;
+  const double megabytes
+      = static_cast<double>(paths.size() * file_bytes) / (1 << 20);
+  return { total_ms, megabytes / (total_ms / 1000.0),
+    percentile(latencies, 0.5), percentile(latencies, 0.99) };
+}
+
+} // namespace
+
+int main()
+{
+  const auto directory
+      = std::filesystem::temp_directory_path() / "dvd-file-io-bench";
+
+  const asset::ReadPath paths[] { asset::ReadPath::BUFFERED,
+    asset::ReadPath::MAPPED, asset::ReadPath::IO_URING };
+
+  if (!asset::read_path_supported(asset::ReadPath::IO_URING))
+    std::cout << "io_uring is not available here; skipping it\n";
+
+  std::cout << std::setw(8) << "files" << std::setw(14) << "path"
+            << std::setw(7) << "cache" << std::setw(12) << "batch ms"
+            << std::setw(12) << "MB/s" << std::setw(12) << "p50 ms"
+            << std::setw(12) << "p99 ms" << "\n";
+
+  for (const auto& set : FILE_SETS) {
+    auto files = write_files(directory, set);
+
+    for (bool cold : { true, false }) {
+      auto print = [&](const char* name, const CaseResult& result) {
+        std::cout << std::setw(8) << set.name << std::setw(14) << name
+                  << std::setw(7) << (cold ? "cold" : "warm") << std::fixed
+                  << std::setprecision(2) << std::setw(12) << result.total_ms
+                  << std::setw(12) << std::setprecision(0)
+                  << result.megabytes_per_second << std::setprecision(3)
+                  << std::setw(12) << result.p50_ms << std::setw(12)
+                  << result.p99_ms << "\n";
+      };
+
+      print("stringstream", run_case(files, set.bytes, cold, nullptr));
+      for (const auto& path : paths) {
+        if (asset::read_path_supported(path))
+          print(asset::read_path_name(path),
+              run_case(files, set.bytes, cold, &path));
+      }
+    }
+  }
+
+  std::filesystem::remove_all(directory);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,278 @@
+// Loads a binary glTF through mesh::load_glb and prints its load report,
+// once on the calling thread's decoder and once with the thread pool.
+//
+//   gltf-bench [file.glb]
+//
+// Without a file it writes one to the temp directory: a tessellated grid
+// stored interleaved (uploaded as stored), a quad with 8-bit indices
+// (re-packed), a node tree instancing both, and the DVD logo from the source
+// tree as the grid's base colour texture. Needs a hidden window for the GL
+// context.
+
+#include "../lib/include/glad/glad.h"
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/asset/file_io.h"
+#include "../include/mesh/gltf.h"
+#include "../include/threading/thread_pool.h"
+
+namespace {
+
+constexpr int RUNS { 5 };
+constexpr int GRID_SIZE { 256 };
+constexpr int NODE_ROWS { 16 };
+
+constexpr std::uint32_t GLB_MAGIC { 0x46546c67 };
+constexpr std::uint32_t CHUNK_JSON { 0x4e4f534a };
+constexpr std::uint32_t CHUNK_BIN { 0x004e4942 };
+
+const char* const LOGO_NAME { "texture/dvd-logo.png" };
+
+template <typename T> void append(std::vector<unsigned char>& bytes, T value)
+{
+  const auto* raw = reinterpret_cast<const unsigned char*>(&value);
+  bytes.insert(bytes.end(), raw, raw + sizeof(T));
+}
+
+void pad(std::vector<unsigned char>& bytes, unsigned char fill)
+{
+  while (bytes.size() % 4 != 0)
+    bytes.push_back(fill);
+}
+
+// bufferView JSON for bytes [start, end) of the BIN chunk.
+std::string view_json(std::size_t start, std::size_t end, int stride = 0)
+{
+  std::string json = "{\"buffer\":0,\"byteOffset\":" + std::to_string(start)
+      + ",\"byteLength\":" + std::to_string(end - start);
+  if (stride)
+    json += ",\"byteStride\":" + std::to_string(stride);
+  return json + "}";
+}
+
+// The source tree is the parent of the build directory the bench runs
+// from. Empty when the logo is not there; the grid is then untextured.
+std::vector<unsigned char> read_logo()
+{
+  std::error_code error;
+  const auto executable
+      = std::filesystem::read_symlink("/proc/self/exe", error);
+  const auto source
+      = (error ? std::filesystem::current_path() : executable.parent_path())
+            .parent_path();
+
+  std::vector<unsigned char> logo;
+  if (!asset::read_file((source / LOGO_NAME).string(), logo))
+    logo.clear();
+  return logo;
+}
+
+bool write_generated_glb(const std::string& path)
+{
+  std::vector<unsigned char> bin;
+  std::vector<std::string> views;
+
+  // Grid: position, normal and uv interleaved in one view, 32-bit indices.
+  std::size_t start = bin.size();
+  for (int y = 0; y < GRID_SIZE; y++) {
+    for (int x = 0; x < GRID_SIZE; x++) {
+      const float u = static_cast<float>(x) / (GRID_SIZE - 1);
+      const float v = static_cast<float>(y) / (GRID_SIZE - 1);
+      for (float value : { u - 0.5f, 0.0f, v - 0.5f, 0.0f, 1.0f, 0.0f, u, v })
+        append(bin, value);
+    }
+  }
+  views.push_back(view_json(start, bin.size(), 32));
+
+  start = bin.size();
+  for (std::uint32_t y = 0; y + 1 < GRID_SIZE; y++) {
+    for (std::uint32_t x = 0; x + 1 < GRID_SIZE; x++) {
+      const std::uint32_t corner = y * GRID_SIZE + x;
+      for (std::uint32_t index : { corner, corner + GRID_SIZE, corner + 1,
+               corner + 1, corner + GRID_SIZE, corner + GRID_SIZE + 1 })
+        append(bin, index);
+    }
+  }
+  views.push_back(view_json(start, bin.size()));
+  const int grid_indices = (GRID_SIZE - 1) * (GRID_SIZE - 1) * 6;
+
+  // Quad: planar positions and 8-bit indices, which GL has to get widened.
+  start = bin.size();
+  for (float value :
+      { -0.5f, -0.5f, 0.0f, 0.5f, -0.5f, 0.0f, 0.5f, 0.5f, 0.0f, -0.5f, 0.5f,
+          0.0f })
+    append(bin, value);
+  views.push_back(view_json(start, bin.size()));
+
+  start = bin.size();
+  for (std::uint8_t index : { 0, 1, 2, 0, 2, 3 })
+    append(bin, index);
+  views.push_back(view_json(start, bin.size()));
+  pad(bin, 0);
+
+  std::string images;
+  std::string textures;
+  std::string material = "{\"name\":\"grid\"}";
+  if (const auto logo = read_logo(); !logo.empty()) {
+    start = bin.size();
+    bin.insert(bin.end(), logo.begin(), logo.end());
+    views.push_back(view_json(start, bin.size()));
+    pad(bin, 0);
+
+    images = ",\"images\":[{\"bufferView\":"
+        + std::to_string(views.size() - 1)
+        + ",\"mimeType\":\"image/png\"}]";
+    textures = ",\"textures\":[{\"source\":0}]";
+    material = "{\"name\":\"grid\",\"pbrMetallicRoughness\":"
+               "{\"baseColorTexture\":{\"index\":0}}}";
+  }
+
+  // A root, a row of groups under it, and a row of grid and quad instances
+  // under each group.
+  std::string nodes = "{\"name\":\"root\",\"children\":[";
+  for (int row = 0; row < NODE_ROWS; row++)
+    nodes += (row ? "," : "") + std::to_string(1 + row * (NODE_ROWS + 1));
+  nodes += "]}";
+  for (int row = 0; row < NODE_ROWS; row++) {
+    const int group = 1 + row * (NODE_ROWS + 1);
+    nodes += ",{\"translation\":[0," + std::to_string(row)
+        + ",0],\"children\":[";
+    for (int column = 0; column < NODE_ROWS; column++)
+      nodes += (column ? "," : "") + std::to_string(group + 1 + column);
+    nodes += "]}";
+    for (int column = 0; column < NODE_ROWS; column++) {
+      nodes += ",{\"mesh\":" + std::to_string(column % 2)
+          + ",\"translation\":[" + std::to_string(column) + ",0,0]}";
+    }
+  }
+
+  std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,"
+                     "\"scenes\":[{\"nodes\":[0]}],\"nodes\":["
+      + nodes + "],\"meshes\":[{\"name\":\"grid\",\"primitives\":[{"
+      + "\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},"
+      + "\"indices\":3,\"material\":0}]},{\"name\":\"quad\",\"primitives\":"
+      + "[{\"attributes\":{\"POSITION\":4},\"indices\":5}]}],"
+      + "\"materials\":[" + material + "]" + images + textures
+      + ",\"accessors\":["
+      + "{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"count\":"
+      + std::to_string(GRID_SIZE * GRID_SIZE) + ",\"type\":\"VEC3\"},"
+      + "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":"
+      + std::to_string(GRID_SIZE * GRID_SIZE) + ",\"type\":\"VEC3\"},"
+      + "{\"bufferView\":0,\"byteOffset\":24,\"componentType\":5126,\"count\":"
+      + std::to_string(GRID_SIZE * GRID_SIZE) + ",\"type\":\"VEC2\"},"
+      + "{\"bufferView\":1,\"componentType\":5125,\"count\":"
+      + std::to_string(grid_indices) + ",\"type\":\"SCALAR\"},"
+      + "{\"bufferView\":2,\"componentType\":5126,\"count\":4,"
+      + "\"type\":\"VEC3\"},"
+      + "{\"bufferView\":3,\"componentType\":5121,\"count\":6,"
+      + "\"type\":\"SCALAR\"}],"
+      + "\"bufferViews\":[";
+  for (std::size_t i = 0; i < views.size(); i++)
+    json += (i ? "," : "") + views[i];
+  json += "],\"buffers\":[{\"byteLength\":" + std::to_string(bin.size())
+      + "}]}";
+
+  std::vector<unsigned char> json_chunk(json.begin(), json.end());
+  pad(json_chunk, ' ');
+
+  std::vector<unsigned char> glb;
+  append(glb, GLB_MAGIC);
+  append(glb, std::uint32_t { 2 });
+  append(glb, static_cast<std::uint32_t>(
+                  12 + 8 + json_chunk.size() + 8 + bin.size()));
+  append(glb, static_cast<std::uint32_t>(json_chunk.size()));
+  append(glb, CHUNK_JSON);
+  glb.insert(glb.end(), json_chunk.begin(), json_chunk.end());
+  append(glb, static_cast<std::uint32_t>(bin.size()));
+  append(glb, CHUNK_BIN);
+  glb.insert(glb.end(), bin.begin(), bin.end());
+
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(glb.data()),
+      static_cast<std::streamsize>(glb.size()));
+  return static_cast<bool>(file);
+}
+
+// Loads RUNS times and reports the run with the median total.
+bool bench_load(const std::string& path, threading::ThreadPool* pool)
+{
+  std::vector<mesh::GltfLoadStats> runs;
+  mesh::GltfScene scene;
+  for (int run = 0; run < RUNS; run++) {
+    if (!mesh::load_glb(path, scene, pool))
+      return false;
+    glFinish();
+    runs.push_back(scene.stats);
+    if (run + 1 < RUNS)
+      mesh::delete_scene(scene);
+  }
+
+  std::sort(runs.begin(), runs.end(),
+      [](const auto& a, const auto& b) { return a.total_ms < b.total_ms; });
+  std::cout << (pool ? "pool, " : "1 decode thread, ") << scene.meshes.size()
+            << " mesh(es), " << scene.nodes.size() << " node(s), median of "
+            << RUNS << ":\n";
+  mesh::print_load_report(runs[runs.size() / 2]);
+
+  mesh::delete_scene(scene);
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string path;
+  bool generated = false;
+  if (argc > 1) {
+    path = argv[1];
+  } else {
+    path = (std::filesystem::temp_directory_path() / "gltf-bench.glb")
+               .string();
+    if (!write_generated_glb(path)) {
+      std::cout << "failed to write " << path << std::endl;
+      return EXIT_FAILURE;
+    }
+    generated = true;
+  }
+
+  if (!glfwInit()) {
+    std::cout << "no display, cannot create a GL context" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  GLFWwindow* window
+      = glfwCreateWindow(64, 64, "gltf-bench", nullptr, nullptr);
+  if (!window) {
+    std::cout << "no GL context" << std::endl;
+    glfwTerminate();
+    return EXIT_FAILURE;
+  }
+
+  glfwMakeContextCurrent(window);
+  gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+
+  threading::ThreadPool pool;
+  const bool ok = bench_load(path, nullptr) && bench_load(path, &pool);
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+  if (generated)
+    std::filesystem::remove(path);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
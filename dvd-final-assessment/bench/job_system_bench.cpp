@@ -0,0 +1,89 @@
+// CPU-only benchmark of the job system: scheduling overhead per empty job and
+// parallel_for scaling on a CPU-bound kernel from 1 to N threads.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../include/threading/job_system.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int EMPTY_JOBS { 1'000'000 };
+constexpr int JOBS_PER_BATCH { 4000 };
+constexpr std::size_t KERNEL_ELEMENTS { 1 << 22 };
+constexpr int KERNEL_ITERATIONS { 16 };
+constexpr int KERNEL_REPEATS { 5 };
+
+double nanoseconds_per_job(threading::JobSystem& jobs)
+{
+  auto start = clock_type::now();
+
+  for (int done = 0; done < EMPTY_JOBS; done += JOBS_PER_BATCH) {
+    threading::Job* root = jobs.create_job([] {});
+    for (int i = 0; i < JOBS_PER_BATCH; i++)
+      jobs.run(jobs.create_job([] {}, root));
+    jobs.run(root);
+    jobs.wait(root);
+  }
+
+  std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+  return elapsed.count() / EMPTY_JOBS;
+}
+
+double kernel_milliseconds(threading::JobSystem& jobs, std::vector<float>& data)
+{
+  auto kernel = [&data](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++) {
+      float value = data[i];
+      for (int k = 0; k < KERNEL_ITERATIONS; k++)
+        value = std::sqrt(value * value + 1.0f) * 0.5f;
+      data[i] = value;
+    }
+  };
+
+  jobs.parallel_for(data.size(), kernel, 256);
+
+  auto start = clock_type::now();
+  for (int repeat = 0; repeat < KERNEL_REPEATS; repeat++)
+    jobs.parallel_for(data.size(), kernel, 256);
+
+  std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+  return elapsed.count() / KERNEL_REPEATS;
+}
+
+} // namespace
+
+int main()
+{
+  const unsigned int max_threads
+      = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<float> data(KERNEL_ELEMENTS, 1.0f);
+
+  std::cout << std::setw(8) << "threads" << std::setw(16) << "ns / job"
+            << std::setw(16) << "kernel (ms)" << std::setw(12) << "speedup"
+            << "\n";
+
+  double single_thread_ms = 0.0;
+  for (unsigned int threads = 1; threads <= max_threads; threads++) {
+    threading::JobSystem jobs(threads, true);
+
+    double overhead = nanoseconds_per_job(jobs);
+    double kernel = kernel_milliseconds(jobs, data);
+    if (threads == 1)
+      single_thread_ms = kernel;
+
+    std::cout << std::setw(8) << threads << std::setw(16) << std::fixed
+              << std::setprecision(1) << overhead << std::setw(16) << kernel
+              << std::setw(11) << std::setprecision(2)
+              << single_thread_ms / kernel << "x\n";
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+// Mip chain generation: the CPU filters (single thread and thread pool),
+// reading the chain back from the on-disk cache, and, when a window can be
+// opened, glGenerateMipmap on the same image for comparison.
+//
+//   mipmap-bench [size]
+
+#include "../lib/include/glad/glad.h"
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/texture/mipmap.h"
+#include "../include/threading/thread_pool.h"
+
+namespace {
+
+constexpr int DEFAULT_SIZE { 2048 };
+constexpr int RUNS { 5 };
+
+using clock_type = std::chrono::steady_clock;
+
+template <typename F> double median_ms(F&& body)
+{
+  std::vector<double> times;
+  for (int run = 0; run < RUNS; run++) {
+    auto start = clock_type::now();
+    body();
+    std::chrono::duration<double, std::milli> elapsed
+        = clock_type::now() - start;
+    times.push_back(elapsed.count());
+  }
+
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2];
+}
+
+// Smooth gradients with noise and a hard edged alpha shape, which is what
+// makes the filters differ.
+std::vector<unsigned char> make_image(int size)
+{
+  std::mt19937 rng(99);
+  std::uniform_int_distribution<int> noise(-12, 12);
+  std::vector<unsigned char> rgba(static_cast<std::size_t>(size) * size * 4);
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      unsigned char* texel = rgba.data() + (static_cast<std::size_t>(y) * size + x) * 4;
+      texel[0] = static_cast<unsigned char>(
+          std::clamp(x * 255 / size + noise(rng), 0, 255));
+      texel[1] = static_cast<unsigned char>(
+          std::clamp(y * 255 / size + noise(rng), 0, 255));
+      texel[2] = static_cast<unsigned char>((x ^ y) & 0xff);
+      bool inside = (x - size / 2) * (x - size / 2)
+              + (y - size / 2) * (y - size / 2)
+          < size * size / 9;
+      texel[3] = inside ? 255 : 0;
+    }
+  }
+
+  return rgba;
+}
+
+void print_row(const std::string& name, double ms, int size)
+{
+  double megatexels = static_cast<double>(size) * size / 1e6;
+  std::cout << std::left << std::setw(34) << name << std::right
+            << std::setw(10) << std::fixed << std::setprecision(2) << ms
+            << " ms" << std::setw(10) << megatexels / (ms / 1000.0)
+            << " Mtexel/s\n";
+}
+
+void bench_gl(const std::vector<unsigned char>& rgba, int size,
+    const texture::Ktx2Image& chain)
+{
+  if (!glfwInit()) {
+    std::cout << "\nno display, skipping glGenerateMipmap\n";
+    return;
+  }
+
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  GLFWwindow* window = glfwCreateWindow(64, 64, "mipmap-bench", nullptr, nullptr);
+  if (!window) {
+    std::cout << "\nno GL context, skipping glGenerateMipmap\n";
+    glfwTerminate();
+    return;
+  }
+
+  glfwMakeContextCurrent(window);
+  gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+
+  // Uploads are included in both rows so the comparison is what a load
+  // costs: base level plus driver mips, against the whole cached chain.
+  double driver_ms = median_ms([&] {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA,
+        GL_UNSIGNED_BYTE, rgba.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glFinish();
+  });
+
+  double chain_ms = median_ms([&] {
+    for (std::size_t level = 0; level < chain.levels.size(); level++) {
+      int level_size = std::max(1, size >> level);
+      glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8,
+          level_size, level_size, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+          chain.levels[level].data());
+    }
+    glFinish();
+  });
+
+  std::cout << "\nGL: " << glGetString(GL_RENDERER) << "\n";
+  print_row("upload + glGenerateMipmap", driver_ms, size);
+  print_row("upload precomputed chain", chain_ms, size);
+
+  glDeleteTextures(1, &texture);
+  glfwDestroyWindow(window);
+  glfwTerminate();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const int size = argc > 1 ? std::atoi(argv[1]) : DEFAULT_SIZE;
+  if (size < 1) {
+    std::cout << "usage: " << argv[0] << " [size]\n";
+    return EXIT_FAILURE;
+  }
+
+  const auto rgba = make_image(size);
+  threading::ThreadPool pool;
+
+  std::cout << size << "x" << size << " RGBA8, " << pool.size()
+            << " thread(s), median of " << RUNS << " runs\n\n";
+
+  texture::Ktx2Image chain;
+  for (auto filter : { texture::MipFilter::BOX, texture::MipFilter::KAISER,
+           texture::MipFilter::LANCZOS }) {
+    const std::string name = texture::mip_filter_name(filter);
+    const texture::MipOptions options { filter, true };
+
+    print_row(name + " sRGB, 1 thread", median_ms([&] {
+      chain = texture::generate_mipmaps(rgba.data(), size, size, options);
+    }),
+        size);
+    print_row(name + " sRGB, pool", median_ms([&] {
+      chain = texture::generate_mipmaps(
+          rgba.data(), size, size, options, &pool);
+    }),
+        size);
+  }
+
+  const auto cache_path
+      = (std::filesystem::temp_directory_path() / "mipmap-bench.mips.ktx2")
+            .string();
+  texture::write_ktx2(cache_path, chain);
+  texture::Ktx2Image cached;
+  print_row("read chain from mip cache", median_ms([&] {
+    texture::read_ktx2(cache_path, cached);
+  }),
+      size);
+  std::filesystem::remove(cache_path);
+
+  bench_gl(rgba, size, chain);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+// CPU-only benchmark of mesh::load_obj against a naive istream parser
+// (getline, istringstream and a std::map for de-duplication) on a generated
+// model of over a million triangles. Both must produce the same mesh.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../include/mesh/obj_loader.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// A quad grid wrapped onto a torus: (GRID + 1)^2 corners per attribute and
+// 2 * GRID^2 triangles.
+constexpr int GRID { 750 };
+constexpr int RUNS { 3 };
+
+std::size_t write_model(const std::string& path)
+{
+  std::ofstream file(path);
+  file << std::fixed << std::setprecision(6) << "# generated torus\no torus\n";
+
+  const float two_pi = 6.2831853f;
+  for (int j = 0; j <= GRID; j++) {
+    for (int i = 0; i <= GRID; i++) {
+      float u = two_pi * i / GRID;
+      float v = two_pi * j / GRID;
+      float ring = 1.0f + 0.3f * std::cos(v);
+      file << "v " << ring * std::cos(u) << " " << ring * std::sin(u) << " "
+           << 0.3f * std::sin(v) << "\n";
+      file << "vt " << static_cast<float>(i) / GRID << " "
+           << static_cast<float>(j) / GRID << "\n";
+      file << "vn " << std::cos(v) * std::cos(u) << " "
+           << std::cos(v) * std::sin(u) << " " << std::sin(v) << "\n";
+    }
+  }
+
+  file << "s 1\n";
+  for (int j = 0; j < GRID; j++) {
+    for (int i = 0; i < GRID; i++) {
+      int a = j * (GRID + 1) + i + 1;
+      int corners[] { a, a + 1, a + GRID + 2, a + GRID + 1 };
+      file << "f";
+      for (int c : corners)
+        file << " " << c << "/" << c << "/" << c;
+      file << "\n";
+    }
+  }
+
+  return static_cast<std::size_t>(file.tellp());
+}
+
+// The obvious approach: one istringstream per line and a tree map keyed by
+// the corner's indices.
+bool load_obj_naive(const std::string& path, mesh::MeshData& mesh)
+{
+  std::ifstream file(path);
+  if (!file)
+    return false;
+
+  std::vector<float> positions, texcoords, normals;
+  std::map<std::tuple<int, int, int>, GLuint> seen;
+  mesh.vertices.clear();
+  mesh.indices.clear();
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream in(line);
+    std::string keyword;
+    in >> keyword;
+
+    if (keyword == "v" || keyword == "vn") {
+      float x, y, z;
+      in >> x >> y >> z;
+      auto& target = keyword == "v" ? positions : normals;
+      target.insert(target.end(), { x, y, z });
+    } else if (keyword == "vt") {
+      float u, v = 0.0f;
+      in >> u >> v;
+      texcoords.insert(texcoords.end(), { u, v });
+    } else if (keyword == "f") {
+      std::vector<GLuint> polygon;
+      std::string token;
+      while (in >> token) {
+        int indices[3] { 0, 0, 0 };
+        std::istringstream corner(token);
+        std::string part;
+        for (int k = 0; k < 3 && std::getline(corner, part, '/'); k++)
+          indices[k] = part.empty() ? 0 : std::stoi(part);
+
+        auto key = std::make_tuple(indices[0], indices[1], indices[2]);
+        auto found = seen.find(key);
+        if (found == seen.end()) {
+          mesh::MeshVertex vertex {};
+          for (int k = 0; k < 3; k++)
+            vertex.position[k] = positions[(indices[0] - 1) * 3 + k];
+          if (indices[1])
+            for (int k = 0; k < 2; k++)
+              vertex.uv[k] = texcoords[(indices[1] - 1) * 2 + k];
+          if (indices[2])
+            for (int k = 0; k < 3; k++)
+              vertex.normal[k] = normals[(indices[2] - 1) * 3 + k];
+
+          found = seen.emplace(key, static_cast<GLuint>(mesh.vertices.size()))
+                      .first;
+          mesh.vertices.push_back(vertex);
+        }
+        polygon.push_back(found->second);
+      }
+
+      for (std::size_t k = 2; k < polygon.size(); k++)
+        mesh.indices.insert(
+            mesh.indices.end(), { polygon[0], polygon[k - 1], polygon[k] });
+    }
+  }
+
+  return true;
+}
+
+bool same_mesh(const mesh::MeshData& a, const mesh::MeshData& b)
+{
+  if (a.indices != b.indices || a.vertices.size() != b.vertices.size())
+    return false;
+
+  for (std::size_t i = 0; i < a.vertices.size(); i++) {
+    const auto& x = a.vertices[i];
+    const auto& y = b.vertices[i];
+    for (int k = 0; k < 3; k++) {
+      if (x.position[k] != y.position[k] || x.normal[k] != y.normal[k])
+        return false;
+    }
+    if (x.uv[0] != y.uv[0] || x.uv[1] != y.uv[1])
+      return false;
+  }
+
+  return true;
+}
+
+template <typename Load> double best_milliseconds(const Load& load)
+{
+  double best = 0.0;
+  for (int run = 0; run < RUNS; run++) {
+    auto start = clock_type::now();
+    if (!load())
+      return -1.0;
+    std::chrono::duration<double, std::milli> elapsed
+        = clock_type::now() - start;
+    best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main()
+{
+  const auto path
+      = (std::filesystem::temp_directory_path() / "dvd-obj-bench.obj").string();
+  const std::size_t file_bytes = write_model(path);
+
+  threading::ThreadPool pool;
+  mesh::MeshData naive, single, pooled;
+
+  double naive_ms
+      = best_milliseconds([&] { return load_obj_naive(path, naive); });
+  double single_ms
+      = best_milliseconds([&] { return mesh::load_obj(path, single); });
+  double pooled_ms
+      = best_milliseconds([&] { return mesh::load_obj(path, pooled, &pool); });
+
+  std::filesystem::remove(path);
+
+  if (naive_ms < 0 || single_ms < 0 || pooled_ms < 0)
+    return EXIT_FAILURE;
+
+  if (!same_mesh(naive, single) || !same_mesh(naive, pooled)) {
+    std::cout << "load_obj disagrees with the naive parser" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const double megabytes = static_cast<double>(file_bytes) / (1 << 20);
+  const double triangles = static_cast<double>(naive.indices.size() / 3);
+
+  std::cout << "model: " << std::fixed << std::setprecision(1) << megabytes
+            << " MB, " << naive.indices.size() / 3 << " triangles, "
+            << naive.vertices.size() << " vertices\n"
+            << "threads: " << pool.size() << "\n"
+            << std::setw(22) << "parser" << std::setw(12) << "ms"
+            << std::setw(12) << "MB/s" << std::setw(14) << "Mtris/s"
+            << std::setw(10) << "speedup" << "\n";
+
+  auto print = [&](const char* name, double ms) {
+    std::cout << std::setw(22) << name << std::setw(12) << std::setprecision(1)
+              << ms << std::setw(12) << megabytes / (ms / 1000.0)
+              << std::setw(14) << std::setprecision(2)
+              << triangles / 1e6 / (ms / 1000.0) << std::setw(9)
+              << std::setprecision(1) << naive_ms / ms << "x\n";
+  };
+
+  print("istream + std::map", naive_ms);
+  print("load_obj (1 thread)", single_ms);
+  print("load_obj (pool)", pooled_ms);
+
+  return EXIT_SUCCESS;
+}
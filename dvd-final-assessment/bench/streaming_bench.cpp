@@ -0,0 +1,245 @@
+// Streaming loader benchmark over a synthetic scene: a grid of objects, each
+// with a 2048x2048 BC7 texture (about 5.3 MiB with mips, 21 GiB in all),
+// streamed within a 128 MiB budget while the camera first waits and then
+// flies over the grid.
+//
+//   streaming-bench
+//
+// Loads sleep for a fixed latency plus their size at a fixed bandwidth, as
+// a disk would; uploads are free. The first phase reports when every
+// object in view has its coarse level (the scene is drawable) and when
+// everything has settled; the flight phase reports how many requests were
+// cancelled and levels evicted as the view changed, and how much of what
+// the view wanted was resident on average.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../include/resource/streaming.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int GRID { 64 };
+constexpr float SPACING { 10.0f };
+constexpr float RADIUS { 4.0f };
+constexpr int TEXTURE_SIZE { 2048 };
+constexpr int TAIL_SIZE { 64 };
+constexpr std::size_t BUDGET_BYTES { std::size_t(128) << 20 };
+constexpr unsigned int WORKERS { 4 };
+constexpr double LATENCY_US { 200.0 };
+constexpr double BYTES_PER_US { 200.0 };
+constexpr auto FRAME_TIME = std::chrono::milliseconds(2);
+constexpr int FLIGHT_FRAMES { 600 };
+constexpr float FLIGHT_SPEED { 2.0f };
+// Half of a 60 degree field of view, and 1080 pixels across it.
+constexpr float HALF_FOV { 0.5236f };
+constexpr float PIXELS_PER_RADIAN { 1080.0f / (2.0f * HALF_FOV) };
+
+std::size_t bc7_bytes(int size)
+{
+  const std::size_t blocks = static_cast<std::size_t>((size + 3) / 4);
+  return blocks * blocks * 16;
+}
+
+// Laid out like StreamedTexture: the mip tail, then one mip per level.
+class SyntheticTexture : public resource::StreamSource {
+public:
+  SyntheticTexture()
+  {
+    std::size_t tail_bytes = 0;
+    int size = TEXTURE_SIZE;
+    for (; size > TAIL_SIZE; size /= 2)
+      sizes.push_back(size);
+    for (; size >= 1; size /= 2)
+      tail_bytes += bc7_bytes(size);
+    std::reverse(sizes.begin(), sizes.end());
+    bytes.push_back(tail_bytes);
+    for (int mip : sizes)
+      bytes.push_back(bc7_bytes(mip));
+  }
+
+  std::size_t level_count() const override { return bytes.size(); }
+  std::size_t level_bytes(std::size_t level) const override
+  {
+    return bytes[level];
+  }
+  float level_pixels(std::size_t level) const override
+  {
+    return level == 0 ? 0.0f : 0.5f * static_cast<float>(sizes[level - 1]);
+  }
+
+  bool load(std::size_t level, std::any&) override
+  {
+    std::this_thread::sleep_for(std::chrono::duration<double, std::micro>(
+        LATENCY_US + static_cast<double>(bytes[level]) / BYTES_PER_US));
+    loaded_bytes += bytes[level];
+    return true;
+  }
+  bool upload(std::size_t, std::any&) override { return true; }
+  void evict(std::size_t) override { }
+  void release() override { }
+
+  static inline std::atomic<std::size_t> loaded_bytes {};
+
+private:
+  std::vector<int> sizes;
+  std::vector<std::size_t> bytes;
+};
+
+struct Camera {
+  float position[3];
+  float forward[3];
+};
+
+bool in_view(const Camera& camera, const resource::StreamBounds& bounds)
+{
+  float to[3];
+  float distance = 0.0f;
+  for (int axis = 0; axis < 3; axis++) {
+    to[axis] = bounds.center[axis] - camera.position[axis];
+    distance += to[axis] * to[axis];
+  }
+  distance = std::sqrt(distance);
+  if (distance <= bounds.radius)
+    return true;
+
+  float along = 0.0f;
+  for (int axis = 0; axis < 3; axis++)
+    along += to[axis] * camera.forward[axis];
+  return along / distance >= std::cos(HALF_FOV + std::asin(bounds.radius / distance));
+}
+
+struct Frame {
+  std::size_t visible {};
+  std::size_t drawable {};
+  std::size_t wanted_levels {};
+  std::size_t resident_levels {};
+};
+
+Frame step(resource::StreamingLoader& loader, const Camera& camera,
+    const std::vector<resource::StreamId>& ids,
+    const std::vector<resource::StreamBounds>& bounds)
+{
+  for (std::size_t i = 0; i < ids.size(); i++)
+    loader.set_visible(ids[i], in_view(camera, bounds[i]));
+
+  resource::StreamView view;
+  std::copy(camera.position, camera.position + 3, view.position);
+  view.pixels_per_radian = PIXELS_PER_RADIAN;
+  loader.update(view);
+
+  Frame frame;
+  for (std::size_t i = 0; i < ids.size(); i++) {
+    if (!in_view(camera, bounds[i]))
+      continue;
+    const std::size_t resident = loader.resident_levels(ids[i]);
+    const std::size_t wanted = loader.wanted_levels(ids[i]);
+    frame.visible++;
+    frame.drawable += resident > 0;
+    frame.wanted_levels += wanted;
+    frame.resident_levels += std::min(resident, wanted);
+  }
+
+  std::this_thread::sleep_for(FRAME_TIME);
+  return frame;
+}
+
+double ms_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(clock_type::now() - start)
+      .count();
+}
+
+} // namespace
+
+int main()
+{
+  resource::StreamingLoader loader(BUDGET_BYTES, WORKERS);
+
+  std::vector<resource::StreamId> ids;
+  std::vector<resource::StreamBounds> bounds;
+  std::size_t scene_bytes = 0;
+  for (int z = 0; z < GRID; z++) {
+    for (int x = 0; x < GRID; x++) {
+      resource::StreamBounds object;
+      object.center[0] = x * SPACING;
+      object.center[2] = z * SPACING;
+      object.radius = RADIUS;
+
+      auto texture = std::make_shared<SyntheticTexture>();
+      for (std::size_t level = 0; level < texture->level_count(); level++)
+        scene_bytes += texture->level_bytes(level);
+      ids.push_back(loader.add(texture, object));
+      bounds.push_back(object);
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << ids.size() << " objects, " << scene_bytes / double(1 << 30)
+            << " GiB of textures, " << BUDGET_BYTES / double(1 << 20)
+            << " MiB budget" << std::endl;
+  std::cout << "loading everything up front would take "
+            << (ids.size() * LATENCY_US / WORKERS
+                   + static_cast<double>(scene_bytes) / BYTES_PER_US)
+          / 1000.0
+            << " ms (and not fit)" << std::endl;
+
+  // Looking along the grid's diagonal from one corner.
+  Camera camera { { -20.0f, 5.0f, -20.0f }, { 0.7071f, 0.0f, 0.7071f } };
+
+  const auto start = clock_type::now();
+  double drawable_ms = -1.0;
+  double settled_ms = -1.0;
+  std::size_t frames = 0;
+  while (ms_since(start) < 10000.0) {
+    const Frame frame = step(loader, camera, ids, bounds);
+    frames++;
+    if (drawable_ms < 0.0 && frame.drawable == frame.visible)
+      drawable_ms = ms_since(start);
+    if (loader.stats().pending == 0) {
+      settled_ms = ms_since(start);
+      break;
+    }
+  }
+
+  std::cout << "static view: every visible object drawable after "
+            << drawable_ms << " ms, settled after " << settled_ms << " ms ("
+            << frames << " frames)" << std::endl;
+  loader.print_stats();
+
+  const auto before = loader.stats();
+  double coverage = 0.0;
+  std::size_t peak_bytes = 0;
+  for (int i = 0; i < FLIGHT_FRAMES; i++) {
+    for (int axis = 0; axis < 3; axis++)
+      camera.position[axis] += camera.forward[axis] * FLIGHT_SPEED;
+    const Frame frame = step(loader, camera, ids, bounds);
+    coverage += frame.wanted_levels == 0
+        ? 1.0
+        : double(frame.resident_levels) / double(frame.wanted_levels);
+    peak_bytes = std::max(peak_bytes, loader.stats().resident_bytes);
+  }
+
+  const auto& after = loader.stats();
+  std::cout << "flight: " << FLIGHT_FRAMES << " frames, "
+            << after.cancelled - before.cancelled << " requests cancelled, "
+            << after.evicted - before.evicted << " levels evicted, "
+            << 100.0 * coverage / FLIGHT_FRAMES
+            << "% of wanted levels resident on average, peak "
+            << peak_bytes / double(1 << 20) << " MiB" << std::endl;
+  std::cout << "read " << SyntheticTexture::loaded_bytes / double(1 << 20)
+            << " MiB in all" << std::endl;
+  loader.print_stats();
+
+  loader.clear();
+  return 0;
+}
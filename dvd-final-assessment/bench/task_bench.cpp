@@ -0,0 +1,121 @@
+// CPU-only benchmark of the coroutine task API: what one co_await costs
+// for each kind of resume point, against a plain function call.
+//
+//   call             a function that cannot be inlined
+//   ready task       awaiting a Task<int> that finishes without suspending
+//                    (allocates and frees a coroutine frame)
+//   resume queue     suspending onto a ResumeQueue drained by the same
+//                    thread, as a GL-thread resume point is
+//   job hop          switch_to() from one job system worker onto the next
+//   round trip       worker to a ResumeQueue drained by another thread and
+//                    back onto the job system, as a decode-then-upload does
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "../include/threading/task.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int CALLS { 10'000'000 };
+constexpr int READY_TASKS { 2'000'000 };
+constexpr int QUEUE_RESUMES { 2'000'000 };
+constexpr int JOB_HOPS { 1'000'000 };
+constexpr int ROUND_TRIPS { 100'000 };
+constexpr unsigned int JOB_THREADS { 4 };
+
+[[gnu::noinline]] int add_one(int value) { return value + 1; }
+
+threading::Task<int> ready_value(int value) { co_return value + 1; }
+
+threading::Task<int> await_ready_tasks(int count)
+{
+  int total = 0;
+  for (int i = 0; i < count; i++)
+    total = co_await ready_value(total);
+  co_return total;
+}
+
+threading::Task<void> yield_to_queue(threading::ResumeQueue& queue, int count)
+{
+  for (int i = 0; i < count; i++)
+    co_await queue.schedule();
+}
+
+threading::Task<void> hop_jobs(threading::JobSystem& jobs, int count)
+{
+  for (int i = 0; i < count; i++)
+    co_await threading::switch_to(jobs);
+}
+
+threading::Task<void> round_trips(threading::JobSystem& jobs,
+    threading::ResumeQueue& queue, std::atomic<bool>& done, int count)
+{
+  co_await threading::switch_to(jobs);
+  for (int i = 0; i < count; i++) {
+    co_await queue.schedule();
+    co_await threading::switch_to(jobs);
+  }
+  done.store(true);
+}
+
+double nanoseconds_since(clock_type::time_point start, int count)
+{
+  std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+  return elapsed.count() / count;
+}
+
+void report(const char* name, double nanoseconds)
+{
+  std::cout << std::setw(14) << name << std::setw(14) << std::fixed
+            << std::setprecision(1) << nanoseconds << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+  std::cout << std::setw(14) << "" << std::setw(14) << "ns / await"
+            << std::endl;
+
+  auto start = clock_type::now();
+  int value = 0;
+  for (int i = 0; i < CALLS; i++)
+    value = add_one(value);
+  report("call", nanoseconds_since(start, CALLS));
+
+  start = clock_type::now();
+  const int total = threading::sync_wait(await_ready_tasks(READY_TASKS));
+  report("ready task", nanoseconds_since(start, READY_TASKS));
+
+  threading::ResumeQueue queue;
+  start = clock_type::now();
+  threading::spawn(yield_to_queue(queue, QUEUE_RESUMES));
+  while (queue.drain() > 0) { }
+  report("resume queue", nanoseconds_since(start, QUEUE_RESUMES));
+
+  threading::JobSystem jobs(JOB_THREADS);
+  start = clock_type::now();
+  threading::sync_wait(hop_jobs(jobs, JOB_HOPS));
+  report("job hop", nanoseconds_since(start, JOB_HOPS));
+
+  // This thread plays the GL thread, draining as fast as it can; yielding
+  // when there is nothing to drain lets the workers have the core on small
+  // machines.
+  std::atomic<bool> done { false };
+  start = clock_type::now();
+  threading::spawn(round_trips(jobs, queue, done, ROUND_TRIPS));
+  while (!done.load()) {
+    if (queue.drain() == 0)
+      std::this_thread::yield();
+  }
+  report("round trip", nanoseconds_since(start, ROUND_TRIPS));
+
+  // Keeps the loops from being optimized away.
+  return value + total == 0 ? 1 : 0;
+}
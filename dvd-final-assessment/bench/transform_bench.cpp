@@ -0,0 +1,250 @@
+// CPU-only benchmark of the batched transform kernels against computing the
+// same matrices one object at a time with glm: model (T * R * S), MVP and
+// normal matrix for 1M objects.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../include/math/transform_batch.h"
+#include "../include/math/transform_batch_glm.h"
+#include "../include/threading/thread_pool.h"
+
+namespace {
+
+constexpr std::size_t TRANSFORMS { 1'000'000 };
+constexpr double MIN_SECONDS_PER_CASE { 0.5 };
+// glm composes and inverts differently, so it agrees to rounding only.
+constexpr float GLM_TOLERANCE { 1e-4f };
+
+struct Objects {
+  std::vector<glm::vec3> translations;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+};
+
+Objects make_objects(std::size_t count)
+{
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> axis(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+  std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+
+  Objects objects;
+  objects.translations.reserve(count);
+  objects.rotations.reserve(count);
+  objects.scales.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    objects.translations.emplace_back(
+        position(rng), position(rng), position(rng));
+    glm::vec3 direction(axis(rng), axis(rng), axis(rng) + 2.0f);
+    objects.rotations.push_back(
+        glm::angleAxis(angle(rng), glm::normalize(direction)));
+    objects.scales.emplace_back(scale(rng), scale(rng), scale(rng));
+  }
+
+  return objects;
+}
+
+math::TransformBatch make_batch(const Objects& objects)
+{
+  math::TransformBatch batch;
+  batch.reserve(objects.translations.size());
+  for (std::size_t i = 0; i < objects.translations.size(); i++) {
+    math::add_transform(batch, objects.translations[i], objects.rotations[i],
+        objects.scales[i]);
+  }
+  return batch;
+}
+
+glm::mat4 make_view_projection()
+{
+  glm::mat4 projection
+      = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+  glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 50.0f, 250.0f),
+      glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  return projection * view;
+}
+
+// What the frame loop does today, one object at a time.
+void glm_transforms(const Objects& objects, const glm::mat4& view_projection,
+    std::vector<glm::mat4>& models, std::vector<glm::mat4>& mvps,
+    std::vector<glm::mat3>& normals)
+{
+  for (std::size_t i = 0; i < objects.translations.size(); i++) {
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), objects.translations[i])
+        * glm::mat4_cast(objects.rotations[i])
+        * glm::scale(glm::mat4(1.0f), objects.scales[i]);
+    models[i] = model;
+    mvps[i] = view_projection * model;
+    normals[i] = glm::inverseTranspose(glm::mat3(model));
+  }
+}
+
+template <typename Matrix>
+bool close(const Matrix& expected, const Matrix& actual)
+{
+  for (int column = 0; column < Matrix::length(); column++) {
+    for (int row = 0; row < Matrix::length(); row++) {
+      const float scale = std::max(1.0f, std::fabs(expected[column][row]));
+      if (std::fabs(expected[column][row] - actual[column][row])
+          > GLM_TOLERANCE * scale)
+        return false;
+    }
+  }
+  return true;
+}
+
+bool kernels_agree(const Objects& objects, const glm::mat4& view_projection)
+{
+  const std::size_t count = 1003;
+  Objects sample { { objects.translations.begin(),
+                       objects.translations.begin() + count },
+    { objects.rotations.begin(), objects.rotations.begin() + count },
+    { objects.scales.begin(), objects.scales.begin() + count } };
+  const auto batch = make_batch(sample);
+
+  auto run = [&](math::TransformKernel kernel, math::MatrixBatch& models,
+                 math::MatrixBatch& mvps, math::Matrix3Batch& normals) {
+    models.resize(count);
+    mvps.resize(count);
+    normals.resize(count);
+    math::compose_models(batch, 0, count, models, kernel);
+    math::multiply_matrices(
+        glm::value_ptr(view_projection), models, 0, count, mvps, kernel);
+    math::normal_matrices(models, 0, count, normals, kernel);
+  };
+
+  math::MatrixBatch models, mvps;
+  math::Matrix3Batch normals;
+  run(math::TransformKernel::SCALAR, models, mvps, normals);
+
+  std::vector<glm::mat4> glm_models(count), glm_mvps(count);
+  std::vector<glm::mat3> glm_normals(count);
+  glm_transforms(sample, view_projection, glm_models, glm_mvps, glm_normals);
+  for (std::size_t i = 0; i < count; i++) {
+    if (!close(glm_models[i], math::matrix_at(models, i))
+        || !close(glm_mvps[i], math::matrix_at(mvps, i))
+        || !close(glm_normals[i], math::matrix_at(normals, i))) {
+      std::cout << "scalar kernel disagrees with glm at " << i << std::endl;
+      return false;
+    }
+  }
+
+  for (auto kernel :
+      { math::TransformKernel::SSE41, math::TransformKernel::AVX2 }) {
+    if (!math::transform_kernel_supported(kernel))
+      continue;
+
+    math::MatrixBatch kernel_models, kernel_mvps;
+    math::Matrix3Batch kernel_normals;
+    run(kernel, kernel_models, kernel_mvps, kernel_normals);
+    if (kernel_models.m != models.m || kernel_mvps.m != mvps.m
+        || kernel_normals.m != normals.m) {
+      std::cout << math::transform_kernel_name(kernel)
+                << " disagrees with the scalar kernel" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename Compute> double transforms_per_second(const Compute& compute)
+{
+  using clock = std::chrono::steady_clock;
+
+  compute();
+
+  std::uint64_t runs = 0;
+  auto start = clock::now();
+  double elapsed = 0.0;
+  while (elapsed < MIN_SECONDS_PER_CASE) {
+    compute();
+    runs++;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  }
+
+  return static_cast<double>(TRANSFORMS) * runs / elapsed;
+}
+
+void report(const char* name, double single, double pooled)
+{
+  std::cout << std::setw(10) << name << std::setw(18) << std::fixed
+            << std::setprecision(1) << single / 1e6;
+  if (pooled > 0.0)
+    std::cout << std::setw(18) << pooled / 1e6;
+  std::cout << "\n";
+}
+
+} // namespace
+
+int main()
+{
+  const auto objects = make_objects(TRANSFORMS);
+  const glm::mat4 view_projection = make_view_projection();
+
+  if (!kernels_agree(objects, view_projection))
+    return EXIT_FAILURE;
+
+  threading::ThreadPool pool;
+
+  std::cout << "transforms: " << TRANSFORMS << ", threads: " << pool.size()
+            << "\n"
+            << std::setw(10) << "kernel" << std::setw(18) << "1 thread (M/s)"
+            << std::setw(18) << "pool (M/s)" << "\n";
+
+  std::vector<glm::mat4> glm_models(TRANSFORMS), glm_mvps(TRANSFORMS);
+  std::vector<glm::mat3> glm_normals(TRANSFORMS);
+  double glm_rate = transforms_per_second([&] {
+    glm_transforms(objects, view_projection, glm_models, glm_mvps, glm_normals);
+  });
+  report("glm", glm_rate, 0.0);
+
+  const auto batch = make_batch(objects);
+  math::MatrixBatch models, mvps;
+  math::Matrix3Batch normals;
+  models.resize(TRANSFORMS);
+  mvps.resize(TRANSFORMS);
+  normals.resize(TRANSFORMS);
+
+  for (auto kernel : { math::TransformKernel::SCALAR,
+           math::TransformKernel::SSE41, math::TransformKernel::AVX2 }) {
+    if (!math::transform_kernel_supported(kernel))
+      continue;
+
+    double single = transforms_per_second([&] {
+      math::compose_models(batch, 0, TRANSFORMS, models, kernel);
+      math::multiply_matrices(glm::value_ptr(view_projection), models, 0,
+          TRANSFORMS, mvps, kernel);
+      math::normal_matrices(models, 0, TRANSFORMS, normals, kernel);
+    });
+    double pooled = transforms_per_second([&] {
+      math::compute_transforms(batch, glm::value_ptr(view_projection), models,
+          mvps, normals, pool, kernel);
+    });
+    report(math::transform_kernel_name(kernel), single, pooled);
+  }
+
+  // Interleaving the MVPs for a per-instance attribute upload.
+  std::vector<float> upload(TRANSFORMS * 16);
+  double store_rate = transforms_per_second(
+      [&] { mvps.store_interleaved(0, TRANSFORMS, upload.data()); });
+  std::cout << "interleave for upload: " << std::fixed << std::setprecision(1)
+            << store_rate / 1e6 << " M/s\n";
+
+  return EXIT_SUCCESS;
+}
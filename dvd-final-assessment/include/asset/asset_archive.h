@@ -0,0 +1,85 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+#include "mapped_file.h"
+
+namespace asset {
+
+enum class AssetKind : std::uint32_t { RAW, SHADER, TEXTURE, MESH };
+
+const char* asset_kind_name(AssetKind kind);
+
+// One entry, pointing into the mapped archive. Textures are stored baked:
+// every mip level of `format` texels back to back, bottom row first, so
+// the bytes go to glTexImage2D as they are. Shaders are source text (not
+// NUL terminated) and raw/mesh data goes to glBufferData.
+struct AssetEntry {
+  std::string_view name;
+  AssetKind kind;
+  const unsigned char* data;
+  std::size_t size;
+  std::uint64_t content_hash;
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint32_t level_count;
+  GLenum format;
+};
+
+// Read-only packed archive. The file is
+//
+//   header (64 bytes)
+//   table of contents, 64 bytes per entry, sorted by name hash
+//   name strings
+//   entry data, each starting on a 64-byte boundary
+//
+// and is memory mapped, so opening it costs one mmap and a TOC scan, and
+// entry data is never copied before it reaches GL.
+class AssetArchive {
+public:
+  bool open(const std::string& path);
+  void close();
+
+  bool is_open() const { return file.is_open(); }
+  const std::vector<AssetEntry>& entries() const { return archive_entries; }
+
+  // Names are archive relative with '/' separators, e.g. "texture/logo.png".
+  const AssetEntry* find(std::string_view name) const;
+
+  // Starts reading an entry's pages in the background.
+  void prefetch(const AssetEntry& entry) const;
+
+private:
+  MappedFile file;
+  std::vector<AssetEntry> archive_entries;
+  std::vector<std::uint64_t> name_hashes;
+};
+
+struct ArchiveInput {
+  std::string name;
+  AssetKind kind { AssetKind::RAW };
+  std::vector<unsigned char> data;
+  std::uint64_t content_hash {};
+  std::uint32_t width {};
+  std::uint32_t height {};
+  std::uint32_t level_count {};
+  GLenum format {};
+};
+
+bool write_archive(const std::string& path, std::vector<ArchiveInput> inputs);
+
+// GL thread. Each hands the mapped bytes straight to GL.
+GLuint upload_texture(const AssetEntry& entry);
+void upload_buffer(GLenum target, const AssetEntry& entry, GLenum usage);
+// Returns 0 and prints the log if compilation fails.
+GLuint compile_shader(const AssetEntry& entry, GLenum stage);
+
+} // namespace asset
+
+#endif
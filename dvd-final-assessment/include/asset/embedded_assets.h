@@ -0,0 +1,23 @@
+#ifndef EMBEDDED_ASSETS_H
+#define EMBEDDED_ASSETS_H
+
+#include <cstddef>
+
+namespace asset {
+
+// A file compiled into the executable. `data` must outlive the Vfs.
+struct EmbeddedAsset {
+  const char* name;
+  const unsigned char* data;
+  std::size_t size;
+};
+
+// Filled in by the `embed` build step (tools/embed.cpp), which turns the
+// files listed in CMakeLists.txt into byte arrays in the embedded_assets
+// library. Mount them with Vfs::mount_embedded.
+extern const EmbeddedAsset embedded_assets[];
+extern const std::size_t embedded_asset_count;
+
+} // namespace asset
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace asset {
+
+// How FileReader gets file contents into memory.
+//
+//   BUFFERED  ifstream into a vector, one file at a time. Portable.
+//   MAPPED    mmap, one file at a time. No copy; pages fault in on touch.
+//   IO_URING  Linux only. Opens a window of files and submits all their
+//             reads in one io_uring_enter, so a batch of small files costs
+//             a handful of syscalls instead of several per file.
+enum class ReadPath { BUFFERED, MAPPED, IO_URING };
+
+bool read_path_supported(ReadPath path);
+ReadPath best_read_path();
+const char* read_path_name(ReadPath path);
+
+struct FileRead {
+  std::string path;
+  bool ok {};
+  // MAPPED fills `mapping`, the other paths fill `bytes`.
+  std::vector<unsigned char> bytes;
+  MappedFile mapping;
+
+  const unsigned char* data() const;
+  std::size_t size() const;
+};
+
+// Whole-file read with the BUFFERED path, for one-off loads.
+bool read_file(const std::string& path, std::vector<unsigned char>& bytes);
+
+struct IoRing;
+
+// Reads batches of whole files. An unsupported path falls back to BUFFERED.
+// Not thread safe; give each thread its own reader.
+class FileReader {
+public:
+  explicit FileReader(ReadPath path = best_read_path(),
+      unsigned int queue_depth = 64);
+  ~FileReader();
+
+  FileReader(const FileReader&) = delete;
+  FileReader& operator=(const FileReader&) = delete;
+
+  ReadPath path() const { return read_path; }
+
+  // Fills every entry of `reads`, calling `on_complete(index)` as each file
+  // finishes (in completion order, which for IO_URING is not index order).
+  // Returns false if any file failed; those have ok == false.
+  bool read(std::vector<FileRead>& reads,
+      const std::function<void(std::size_t)>& on_complete = {});
+
+private:
+  ReadPath read_path;
+  unsigned int queue_depth;
+  std::unique_ptr<IoRing> ring;
+
+  bool read_uring(std::vector<FileRead>& reads,
+      const std::function<void(std::size_t)>& on_complete);
+};
+
+} // namespace asset
+
+#endif
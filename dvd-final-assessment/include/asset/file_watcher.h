@@ -0,0 +1,66 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace asset {
+
+// Reports files that changed on disk. Linux only (inotify); elsewhere
+// watch() fails and poll() never reports anything.
+//
+// Editors save in bursts (truncate + write, or write a temporary and
+// rename it over the original), so a path is reported once it has been
+// quiet for `debounce`, however many events it produced. There is no
+// thread: poll() drains the inotify queue without blocking and is meant to
+// be called once a frame.
+class FileWatcher {
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit FileWatcher(
+      std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  bool supported() const { return descriptor >= 0; }
+
+  // Watches the directory holding `path`, which is enough to see the file
+  // replaced as well as written. Watching a directory twice is a no-op.
+  bool watch_file(const std::string& path);
+  bool watch_directory(const std::string& directory);
+
+  struct Change {
+    // Absolute, as the directory was watched plus the file name.
+    std::string path;
+    // When the first event of the burst arrived.
+    clock::time_point first_event;
+  };
+
+  // Paths whose last event is at least `debounce` old.
+  std::vector<Change> poll();
+
+private:
+  struct Pending {
+    clock::time_point first_event;
+    clock::time_point last_event;
+  };
+
+  void drain();
+
+  int descriptor { -1 };
+  std::chrono::milliseconds debounce;
+  // inotify watch descriptor to directory.
+  std::unordered_map<int, std::string> directories;
+  std::unordered_set<std::string> watched;
+  std::unordered_map<std::string, Pending> pending;
+};
+
+} // namespace asset
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace asset {
+
+// Read-only view of a whole file. On POSIX systems the file is mapped, so
+// pages are read on first touch straight from the page cache; elsewhere it
+// falls back to reading the file into memory.
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool open(const std::string& path);
+  void close();
+
+  bool is_open() const { return bytes != nullptr; }
+  const unsigned char* data() const { return bytes; }
+  std::size_t size() const { return length; }
+
+  // Hints that [offset, offset + size) will be read soon.
+  void prefetch(std::size_t offset, std::size_t size) const;
+
+private:
+  const unsigned char* bytes {};
+  std::size_t length {};
+  bool mapped {};
+  std::vector<unsigned char> fallback;
+};
+
+} // namespace asset
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef VFS_H
+#define VFS_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_archive.h"
+#include "embedded_assets.h"
+#include "file_io.h"
+
+namespace asset {
+
+enum class MountKind { DIRECTORY, ARCHIVE, EMBEDDED };
+
+const char* mount_kind_name(MountKind kind);
+
+// What the index knows about a path, without touching the disk.
+struct VfsStat {
+  MountKind kind;
+  std::size_t mount;
+  std::size_t size;
+  // Directory files only; archive and embedded files never change.
+  std::filesystem::file_time_type modified;
+  // Archive files carry the packer's content hash; zero otherwise.
+  std::uint64_t content_hash;
+  // Set for archive files, so baked textures can go straight to GL.
+  const AssetEntry* archive_entry;
+};
+
+// Contents of one file. Archive and embedded files point into memory owned
+// by the mount (valid for the life of the Vfs); directory files are read
+// into `bytes`.
+struct VfsFile {
+  std::string path;
+  bool ok {};
+  std::vector<unsigned char> bytes;
+
+  const unsigned char* data() const { return view ? view : bytes.data(); }
+  std::size_t size() const { return view ? view_size : bytes.size(); }
+
+  const unsigned char* view {};
+  std::size_t view_size {};
+};
+
+class Vfs;
+
+// Awaitable form of Vfs::read_async, for coroutines (threading::Task).
+struct VfsRead {
+  Vfs& vfs;
+  std::string path;
+  VfsFile file;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle);
+  VfsFile await_resume() { return std::move(file); }
+};
+
+// Virtual filesystem over an ordered mount table. Paths are relative,
+// '/' separated and case sensitive ("texture/dvd-logo.png"); each mount may
+// place its files under a prefix.
+//
+// Every mount is indexed when it is added: directories are walked once,
+// archives and embedded tables are listed. A path resolves to the first
+// mount that has it, so mount overrides (a development directory, baked
+// output) before the fallbacks. After mounting, exists(), stat() and the
+// lookup half of read() are a hash-map probe with no syscalls; call
+// refresh() for a path that changed on disk, or rescan() after files were
+// added or removed.
+//
+// Mounting, lookups and update() belong to one thread. Async directory
+// reads run on an I/O thread that batches them through FileReader.
+class Vfs {
+public:
+  using ReadCallback = std::function<void(VfsFile&)>;
+
+  explicit Vfs(ReadPath read_path = best_read_path());
+  ~Vfs();
+
+  Vfs(const Vfs&) = delete;
+  Vfs& operator=(const Vfs&) = delete;
+
+  // Each returns false (and mounts nothing) when the source can't be read.
+  // A non-recursive directory mount sees only the files directly in `root`.
+  bool mount_directory(const std::string& root, const std::string& prefix = "",
+      bool recursive = true);
+  bool mount_archive(const std::string& path, const std::string& prefix = "");
+  void mount_embedded(const EmbeddedAsset* assets, std::size_t count,
+      const std::string& prefix = "");
+
+  std::size_t mount_count() const { return mounts.size(); }
+  std::size_t file_count() const { return index.size(); }
+
+  bool exists(std::string_view path) const { return stat(path) != nullptr; }
+  // Null when no mount has the path.
+  const VfsStat* stat(std::string_view path) const;
+
+  // Disk path of a directory file, for loaders that need one (and their
+  // on-disk caches); empty for archive and embedded files.
+  std::string native_path(std::string_view path) const;
+
+  bool read(std::string_view path, VfsFile& file) const;
+
+  // Archive and embedded reads complete at once; directory reads are queued
+  // to the I/O thread. Callbacks run on the mounting thread, from update()
+  // or wait_all(), and may issue further reads.
+  void read_async(std::string_view path, ReadCallback on_complete);
+  // `co_await vfs.read_async(path)`: the coroutine resumes with the file
+  // where the callback would have run.
+  VfsRead read_async(std::string_view path);
+
+  // Delivers finished async reads. Returns how many were delivered.
+  std::size_t update();
+  void wait_all();
+  std::size_t pending() const { return outstanding; }
+
+  // Looks one path up again in every mount, picking up edits, new files
+  // and deletions on disk.
+  void refresh(std::string_view path);
+  void rescan();
+
+  // '\\' to '/', "." and ".." resolved, leading "/" and "./" removed.
+  static std::string normalize(std::string_view path);
+
+private:
+  struct Mount {
+    MountKind kind;
+    std::string prefix;
+    std::filesystem::path root;
+    bool recursive {};
+    std::unique_ptr<AssetArchive> archive;
+    const EmbeddedAsset* embedded {};
+    std::size_t embedded_count {};
+  };
+
+  struct IndexEntry {
+    VfsStat stat;
+    // Archive and embedded data.
+    const unsigned char* data {};
+  };
+
+  struct PendingRead {
+    VfsFile file;
+    std::string native;
+    ReadCallback on_complete;
+  };
+
+  void index_mount(std::size_t mount);
+  // Looks `path` up in one mount directly, bypassing the index.
+  bool lookup(
+      std::size_t mount, const std::string& path, IndexEntry& entry) const;
+  const IndexEntry* find(std::string_view path) const;
+  void io_loop();
+
+  std::vector<Mount> mounts;
+  std::unordered_map<std::string, IndexEntry> index;
+
+  // Completed on the calling thread, waiting for update().
+  std::vector<PendingRead> ready;
+  std::size_t outstanding {};
+
+  ReadPath read_path;
+  std::mutex mutex;
+  std::condition_variable work_available;
+  std::condition_variable work_done;
+  std::deque<PendingRead> queued;
+  std::vector<PendingRead> finished;
+  bool stopping {};
+  std::thread io_thread;
+};
+
+} // namespace asset
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef LOGO_SYSTEMS_H
+#define LOGO_SYSTEMS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../simulation/dvd_simulation.h"
+#include "query.h"
+#include "world.h"
+
+namespace threading {
+class ThreadPool;
+}
+
+namespace ecs {
+
+// Written by LogoSystems::cull: whether the logo overlaps the view.
+struct Visibility {
+  std::uint8_t visible;
+};
+
+// What the renderer needs per logo, in NDC, ready for an instance buffer.
+struct LogoInstance {
+  float x;
+  float y;
+  float half_width;
+  float half_height;
+};
+
+// The bouncing logos as ECS systems. A logo is an entity with a DvdState, a
+// DvdLogo and a Visibility; each system is one pass over the chunks of the
+// components it reads, spread over the pool.
+class LogoSystems {
+public:
+  static Entity create_logo(World& world, const simulation::DvdState& state,
+      const simulation::DvdLogo& logo);
+
+  // One fixed step of every logo.
+  void simulate(World& world, const simulation::Bounds& bounds, float dt,
+      threading::ThreadPool& pool);
+  void cull(World& world, const simulation::Bounds& view,
+      threading::ThreadPool& pool);
+  // Replaces `instances` with the logos visible at the last cull(), in
+  // chunk order. Chunks count their visible logos, then each writes its
+  // own slice of the output.
+  void extract(World& world, std::vector<LogoInstance>& instances,
+      threading::ThreadPool& pool);
+
+private:
+  Query<simulation::DvdState, const simulation::DvdLogo> moving;
+  Query<const simulation::DvdState, const simulation::DvdLogo, Visibility>
+      culled;
+  Query<const simulation::DvdState, const simulation::DvdLogo,
+      const Visibility>
+      drawn;
+  std::vector<std::size_t> offsets;
+};
+
+} // namespace ecs
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../threading/thread_pool.h"
+#include "world.h"
+
+namespace ecs {
+
+// One chunk of an archetype matched by a query.
+struct ChunkRef {
+  const Archetype* archetype;
+  std::uint32_t chunk;
+
+  std::size_t size() const { return archetype->chunk_size(chunk); }
+  const Entity* entities() const { return archetype->entities(chunk); }
+  template <typename T> T* column() const
+  {
+    return archetype->column<T>(chunk);
+  }
+};
+
+// Entities that have every component in Ts (and none excluded with
+// without()). Declare read-only components const.
+//
+// The matching archetypes are cached: each call only looks at archetypes
+// created since the last, so a query kept across frames costs nothing to
+// match. Iteration goes chunk by chunk, column by column; each_chunk hands
+// the columns to the callback as arrays, for loops the compiler can
+// vectorize. The pool overloads spread the chunks over the pool's threads;
+// the callback must then touch only the entities it is given.
+template <typename... Ts> class Query {
+public:
+  Query()
+      : required(component_mask<Ts...>())
+  {
+  }
+
+  template <typename... Us> Query& without()
+  {
+    excluded |= component_mask<Us...>();
+    seen_archetypes = 0;
+    matches.clear();
+    return *this;
+  }
+
+  // Chunks of every matching archetype that hold entities.
+  const std::vector<ChunkRef>& chunks(const World& world)
+  {
+    refresh(world);
+    chunk_refs.clear();
+    for (auto index : matches) {
+      const Archetype& archetype = world.archetype(index);
+      for (std::size_t c = 0; c < archetype.chunk_count(); c++)
+        chunk_refs.push_back({ &archetype, static_cast<std::uint32_t>(c) });
+    }
+    return chunk_refs;
+  }
+
+  std::size_t count(const World& world)
+  {
+    refresh(world);
+    std::size_t total = 0;
+    for (auto index : matches)
+      total += world.archetype(index).size();
+    return total;
+  }
+
+  // body(count, Ts* columns...) for every chunk.
+  template <typename Body> void each_chunk(const World& world, Body&& body)
+  {
+    for (const auto& chunk : chunks(world))
+      body(chunk.size(), chunk.template column<Ts>()...);
+  }
+
+  template <typename Body>
+  void each_chunk(const World& world, threading::ThreadPool& pool, Body&& body)
+  {
+    const auto& refs = chunks(world);
+    const std::size_t grain = std::max<std::size_t>(
+        1, refs.size() / (pool.size() * CHUNKS_PER_THREAD));
+    pool.parallel_for(
+        refs.size(), grain, [&](std::size_t begin, std::size_t end) {
+          for (std::size_t c = begin; c < end; c++)
+            body(refs[c].size(), refs[c].template column<Ts>()...);
+        });
+  }
+
+  // body(Ts&... components) for every entity.
+  template <typename Body> void each(const World& world, Body&& body)
+  {
+    each_chunk(world, [&](std::size_t count, Ts*... columns) {
+      for (std::size_t i = 0; i < count; i++)
+        body(columns[i]...);
+    });
+  }
+
+  template <typename Body>
+  void each(const World& world, threading::ThreadPool& pool, Body&& body)
+  {
+    each_chunk(world, pool, [&](std::size_t count, Ts*... columns) {
+      for (std::size_t i = 0; i < count; i++)
+        body(columns[i]...);
+    });
+  }
+
+private:
+  // A few chunks per thread, so archetypes of different sizes still
+  // balance.
+  static constexpr std::size_t CHUNKS_PER_THREAD { 8 };
+
+  void refresh(const World& world)
+  {
+    if (cached_world != &world) {
+      cached_world = &world;
+      seen_archetypes = 0;
+      matches.clear();
+    }
+
+    for (; seen_archetypes < world.archetype_count(); seen_archetypes++) {
+      const ComponentMask& mask = world.archetype(seen_archetypes).mask();
+      if ((mask & required) == required && (mask & excluded).none())
+        matches.push_back(static_cast<std::uint32_t>(seen_archetypes));
+    }
+  }
+
+  ComponentMask required;
+  ComponentMask excluded;
+
+  const World* cached_world {};
+  std::size_t seen_archetypes {};
+  std::vector<std::uint32_t> matches;
+  std::vector<ChunkRef> chunk_refs;
+};
+
+} // namespace ecs
+
+#endif
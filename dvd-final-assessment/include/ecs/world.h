@@ -0,0 +1,250 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ecs {
+
+constexpr std::size_t MAX_COMPONENTS { 64 };
+// Entities of one archetype are packed into chunks of this size, each
+// component in its own column, so a system streams through exactly the
+// columns it reads.
+constexpr std::size_t CHUNK_BYTES { 16 * 1024 };
+// Columns start on a cache line, so they can be loaded with full vectors.
+constexpr std::size_t COLUMN_ALIGNMENT { 64 };
+
+using ComponentId = std::uint32_t;
+using ComponentMask = std::bitset<MAX_COMPONENTS>;
+
+// Generational handle: destroying an entity bumps its slot's generation, so
+// stale handles are detected rather than aliasing the slot's next entity.
+struct Entity {
+  std::uint32_t index { 0xffffffffu };
+  std::uint32_t generation {};
+
+  bool operator==(const Entity& other) const = default;
+};
+
+struct ComponentInfo {
+  std::size_t size;
+  std::size_t alignment;
+};
+
+namespace detail {
+
+  ComponentId register_component(std::size_t size, std::size_t alignment);
+
+} // namespace detail
+
+const ComponentInfo& component_info(ComponentId id);
+
+// Components are plain data: they are moved between chunks with memcpy and
+// never constructed or destroyed in place. Ids are handed out on first use.
+template <typename T> ComponentId component_id()
+{
+  // const T, as read-only queries name it, is the same component.
+  if constexpr (std::is_const_v<T>) {
+    return component_id<std::remove_const_t<T>>();
+  } else {
+    static_assert(std::is_trivially_copyable_v<T>,
+        "components are moved between chunks with memcpy");
+    static_assert(alignof(T) <= COLUMN_ALIGNMENT);
+    static_assert(sizeof(T) <= CHUNK_BYTES / 16);
+
+    static const ComponentId id
+        = detail::register_component(sizeof(T), alignof(T));
+    return id;
+  }
+}
+
+template <typename... Ts> ComponentMask component_mask()
+{
+  ComponentMask mask;
+  (mask.set(component_id<Ts>()), ...);
+  return mask;
+}
+
+// All entities with exactly one set of components.
+class Archetype {
+public:
+  explicit Archetype(const ComponentMask& components);
+  ~Archetype();
+
+  Archetype(const Archetype&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+
+  const ComponentMask& mask() const { return components; }
+  std::size_t size() const { return count; }
+  std::size_t chunk_capacity() const { return capacity; }
+  std::size_t chunk_count() const
+  {
+    return (count + capacity - 1) / capacity;
+  }
+  // Chunks are kept full except for the last.
+  std::size_t chunk_size(std::size_t chunk) const
+  {
+    return chunk + 1 < chunk_count() ? capacity : count - chunk * capacity;
+  }
+
+  const Entity* entities(std::size_t chunk) const
+  {
+    return reinterpret_cast<const Entity*>(chunks[chunk]);
+  }
+
+  // nullptr when the archetype lacks the component.
+  void* column(std::size_t chunk, ComponentId id) const
+  {
+    return offsets[id] == NO_COLUMN ? nullptr : chunks[chunk] + offsets[id];
+  }
+  template <typename T> T* column(std::size_t chunk) const
+  {
+    return static_cast<T*>(column(chunk, component_id<T>()));
+  }
+
+private:
+  friend class World;
+
+  static constexpr std::uint32_t NO_COLUMN { 0xffffffffu };
+  static constexpr std::uint32_t NO_EDGE { 0xffffffffu };
+
+  // Appends a row for `entity`, allocating a chunk when the last is full,
+  // and returns its position.
+  std::size_t push(Entity entity);
+  // Moves the last row into `row` and drops the last; returns the entity
+  // that moved, or a default Entity when `row` was the last.
+  Entity swap_remove(std::size_t row);
+
+  std::byte* row_address(std::size_t row, ComponentId id) const
+  {
+    return chunks[row / capacity] + offsets[id]
+        + (row % capacity) * component_info(id).size;
+  }
+
+  ComponentMask components;
+  std::vector<ComponentId> ids;
+  std::array<std::uint32_t, MAX_COMPONENTS> offsets;
+  std::size_t capacity {};
+  std::size_t count {};
+  std::vector<std::byte*> chunks;
+
+  // Archetype reached by adding or removing one component, filled in as
+  // entities take those transitions.
+  std::array<std::uint32_t, MAX_COMPONENTS> add_edges;
+  std::array<std::uint32_t, MAX_COMPONENTS> remove_edges;
+};
+
+// Entities and their components, stored per archetype in chunked SoA form.
+//
+// Structural changes (create, destroy, adding or removing a component) move
+// the entity's row and swap the archetype's last row into the hole, so
+// chunks stay dense. They must not happen while a query iterates the world;
+// component values may be changed freely. Single-threaded apart from
+// parallel query iteration.
+class World {
+public:
+  World();
+  ~World();
+
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+
+  template <typename... Ts> Entity create(const Ts&... components)
+  {
+    const Entity entity = create(component_mask<Ts...>());
+    (write(entity, components), ...);
+    return entity;
+  }
+  void destroy(Entity entity);
+  bool alive(Entity entity) const;
+
+  // Stale handles are checked: add() and remove() do nothing, has() is
+  // false and get() nullptr for an entity that is no longer alive.
+
+  // Adds the component, or overwrites it if the entity already has it.
+  template <typename T> void add(Entity entity, const T& component)
+  {
+    if (!alive(entity))
+      return;
+    const ComponentId id = component_id<T>();
+    if (!records[entity.index].archetype_has(*this, id))
+      move(entity, id, true);
+    write(entity, component);
+  }
+  template <typename T> void remove(Entity entity)
+  {
+    if (!alive(entity))
+      return;
+    const ComponentId id = component_id<T>();
+    if (records[entity.index].archetype_has(*this, id))
+      move(entity, id, false);
+  }
+  template <typename T> bool has(Entity entity) const
+  {
+    return alive(entity)
+        && records[entity.index].archetype_has(*this, component_id<T>());
+  }
+  // nullptr when the entity lacks the component. Invalidated by any
+  // structural change.
+  template <typename T> T* get(Entity entity) const
+  {
+    if (!alive(entity))
+      return nullptr;
+    const Record& record = records[entity.index];
+    const Archetype& archetype = *archetypes[record.archetype];
+    const ComponentId id = component_id<T>();
+    if (!archetype.components.test(id))
+      return nullptr;
+    return reinterpret_cast<T*>(archetype.row_address(record.row, id));
+  }
+
+  std::size_t size() const { return live; }
+  std::size_t archetype_count() const { return archetypes.size(); }
+  Archetype& archetype(std::size_t index) const { return *archetypes[index]; }
+
+  // Destroys every entity; archetypes and their chunks are kept.
+  void clear();
+
+private:
+  struct Record {
+    std::uint32_t archetype;
+    std::uint32_t row;
+    std::uint32_t generation;
+
+    bool archetype_has(const World& world, ComponentId id) const
+    {
+      return world.archetypes[archetype]->components.test(id);
+    }
+  };
+
+  Entity create(const ComponentMask& mask);
+  std::uint32_t find_archetype(const ComponentMask& mask);
+  // Moves the entity to the archetype with `id` added or removed.
+  void move(Entity entity, ComponentId id, bool adding);
+  void remove_row(std::uint32_t archetype, std::size_t row);
+
+  template <typename T> void write(Entity entity, const T& component)
+  {
+    std::memcpy(get<T>(entity), &component, sizeof(T));
+  }
+
+  std::vector<std::unique_ptr<Archetype>> archetypes;
+  std::unordered_map<ComponentMask, std::uint32_t> archetype_index;
+  static constexpr std::uint32_t NO_ARCHETYPE { 0xffffffffu };
+  std::uint32_t last_found { NO_ARCHETYPE };
+
+  std::vector<Record> records;
+  std::vector<std::uint32_t> free_indices;
+  std::size_t live {};
+};
+
+} // namespace ecs
+
+#endif
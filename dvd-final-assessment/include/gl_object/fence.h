@@ -0,0 +1,70 @@
+#ifndef FENCE_H
+#define FENCE_H
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+#include "../threading/task.h"
+
+namespace gl_object {
+
+// Coroutines waiting for the GPU to get past a point in the command stream.
+// A fence is inserted after the commands issued so far; poll(), called on
+// the GL thread once a frame, resumes the coroutines whose fences have
+// signaled without ever blocking on the driver. Fences signal in the order
+// they were inserted, so poll() stops at the first one still pending.
+//
+// GL thread only (a coroutine must be on the GL thread to insert a fence,
+// and it is resumed there). Coroutines still waiting when the queue is
+// destroyed are never resumed.
+class FenceQueue {
+public:
+  struct Awaiter {
+    FenceQueue& queue;
+    GLsync fence;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      queue.waiting.push_back({ fence, handle });
+    }
+    void await_resume() const noexcept { }
+  };
+
+  FenceQueue() = default;
+  ~FenceQueue();
+
+  FenceQueue(const FenceQueue&) = delete;
+  FenceQueue& operator=(const FenceQueue&) = delete;
+
+  // `co_await fences.signaled()`: resumes once the GPU has executed every
+  // command issued before the call.
+  Awaiter signaled();
+
+  // Returns how many coroutines were resumed.
+  std::size_t poll();
+  std::size_t pending() const { return waiting.size(); }
+
+private:
+  struct Waiting {
+    GLsync fence;
+    std::coroutine_handle<> handle;
+  };
+
+  std::deque<Waiting> waiting;
+};
+
+// Reads a rectangle of the bound read framebuffer back as tightly packed
+// RGBA8 rows, bottom row first. glReadPixels goes into a pixel pack buffer
+// and returns at once; the buffer is mapped only after its fence signals,
+// so neither the frame loop nor the coroutine waits on the GPU. Empty on
+// failure.
+threading::Task<std::vector<unsigned char>> read_pixels(
+    FenceQueue& fences, GLint x, GLint y, GLsizei width, GLsizei height);
+
+} // namespace gl_object
+
+#endif
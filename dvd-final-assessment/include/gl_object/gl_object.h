@@ -0,0 +1,58 @@
+#ifndef GL_OBJECT_H
+#define GL_OBJECT_H
+
+#include <cstddef>
+
+#include "../../lib/include/glad/glad.h"
+
+// Thin wrappers over vertex arrays and buffers, ported from render-base.
+// They hold only the GL name, so copies refer to the same object; call the
+// delete_* functions explicitly while the context is current.
+namespace gl_object {
+
+class VBO {
+public:
+  GLuint ID;
+
+  VBO(const GLfloat* vertices, GLsizeiptr size);
+
+  void bind_vbo();
+  void unbind_vbo();
+  void delete_vbo();
+};
+
+class EBO {
+public:
+  GLuint ID;
+
+  // Bind the VAO first; the element binding is part of its state.
+  EBO(const GLuint* indices, GLsizeiptr size);
+
+  void bind_ebo();
+  void unbind_ebo();
+  void delete_ebo();
+};
+
+class VAO {
+public:
+  GLuint ID;
+
+  VAO();
+
+  // Tightly packed vec3 at `layout`.
+  void link_vbo(VBO& VBO, GLuint layout);
+  // `components` values of `type` at `offset` bytes into each
+  // `stride`-byte vertex; normalized integers read as floats in [-1, 1] or
+  // [0, 1].
+  void link_attribute(VBO& VBO, GLuint layout, GLint components,
+      GLsizei stride, std::size_t offset, GLenum type = GL_FLOAT,
+      GLboolean normalized = GL_FALSE);
+
+  void bind_vao();
+  void unbind_vao();
+  void delete_vao();
+};
+
+} // namespace gl_object
+
+#endif
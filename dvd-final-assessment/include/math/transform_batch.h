@@ -0,0 +1,112 @@
+#ifndef TRANSFORM_BATCH_H
+#define TRANSFORM_BATCH_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace threading {
+class ThreadPool;
+}
+
+namespace math {
+
+// Translation, rotation and scale of many objects, one array per component
+// so the kernels load eight objects' worth of a component at once.
+// Rotations are unit quaternions.
+class TransformBatch {
+public:
+  std::vector<float> tx;
+  std::vector<float> ty;
+  std::vector<float> tz;
+  std::vector<float> qx;
+  std::vector<float> qy;
+  std::vector<float> qz;
+  std::vector<float> qw;
+  std::vector<float> sx;
+  std::vector<float> sy;
+  std::vector<float> sz;
+
+  std::size_t size() const { return tx.size(); }
+
+  void reserve(std::size_t count);
+  void clear();
+  // `rotation` is x, y, z, w.
+  void add(const float* translation, const float* rotation, const float* scale);
+};
+
+// 4x4 matrices of many objects, one array per element. Elements are in
+// column-major order (m[column * 4 + row]), as GL and glm store a mat4.
+struct MatrixBatch {
+  std::array<std::vector<float>, 16> m;
+
+  std::size_t size() const { return m[0].size(); }
+  void resize(std::size_t count);
+
+  // Writes objects [begin, end) as 16 consecutive floats each, the layout
+  // of glm::mat4 and of a per-instance matrix attribute, ready to upload.
+  void store_interleaved(std::size_t begin, std::size_t end, float* out) const;
+};
+
+// 3x3 matrices, m[column * 3 + row], as glm::mat3.
+struct Matrix3Batch {
+  std::array<std::vector<float>, 9> m;
+
+  std::size_t size() const { return m[0].size(); }
+  void resize(std::size_t count);
+
+  void store_interleaved(std::size_t begin, std::size_t end, float* out) const;
+};
+
+enum class TransformKernel { SCALAR, SSE41, AVX2 };
+
+// Widest kernel the running CPU supports.
+TransformKernel best_transform_kernel();
+bool transform_kernel_supported(TransformKernel kernel);
+const char* transform_kernel_name(TransformKernel kernel);
+
+// One object at a time, for code that walks objects in an order the batch
+// kernels cannot vectorize (a hierarchy, where each matrix needs its
+// parent's). Same operations as the kernels, so the results are identical.
+// Matrices are 16 floats, column-major; `rotation` is x, y, z, w.
+void compose_matrix(const float* translation, const float* rotation,
+    const float* scale, float* out);
+// out = left * right; `out` may not alias either.
+void multiply_matrix(const float* left, const float* right, float* out);
+
+// The functions below work on objects [begin, end); outputs must already
+// hold at least `end` objects. Every kernel performs the same float
+// operations in the same order (no FMA contraction), so they agree bit for
+// bit.
+
+// models = translate(t) * rotate(q) * scale(s), as glm composes them.
+void compose_models(const TransformBatch& transforms, std::size_t begin,
+    std::size_t end, MatrixBatch& models, TransformKernel kernel);
+
+// out = left * right, with one matrix on the left for every object (a
+// view-projection, column-major as glm::value_ptr gives it).
+void multiply_matrices(const float* left, const MatrixBatch& right,
+    std::size_t begin, std::size_t end, MatrixBatch& out,
+    TransformKernel kernel);
+// out = left * right per object, e.g. parent * local. `out` may alias
+// neither input.
+void multiply_matrices(const MatrixBatch& left, const MatrixBatch& right,
+    std::size_t begin, std::size_t end, MatrixBatch& out,
+    TransformKernel kernel);
+
+// Inverse-transpose of each model's upper 3x3, for transforming normals
+// under non-uniform scale.
+void normal_matrices(const MatrixBatch& models, std::size_t begin,
+    std::size_t end, Matrix3Batch& normals, TransformKernel kernel);
+
+// Model, model-view-projection and normal matrices for the whole batch,
+// resized to fit. Chunks are split across the pool and each chunk runs all
+// three steps before the next, while its models are still in cache.
+void compute_transforms(const TransformBatch& transforms,
+    const float* view_projection, MatrixBatch& models, MatrixBatch& mvps,
+    Matrix3Batch& normals, threading::ThreadPool& pool,
+    TransformKernel kernel = best_transform_kernel());
+
+} // namespace math
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TRANSFORM_BATCH_GLM_H
+#define TRANSFORM_BATCH_GLM_H
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "transform_batch.h"
+
+// glm at the edges of the batch: objects go in as glm vectors and
+// quaternions and single matrices come back out as glm matrices. Header
+// only, so the math library itself does not depend on glm. A view-
+// projection is passed to the kernels as glm::value_ptr(view_projection).
+namespace math {
+
+inline void add_transform(TransformBatch& batch, const glm::vec3& translation,
+    const glm::quat& rotation, const glm::vec3& scale)
+{
+  const float xyzw[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+  batch.add(&translation.x, xyzw, &scale.x);
+}
+
+inline glm::mat4 matrix_at(const MatrixBatch& batch, std::size_t index)
+{
+  glm::mat4 matrix;
+  for (int column = 0; column < 4; column++) {
+    for (int row = 0; row < 4; row++)
+      matrix[column][row] = batch.m[column * 4 + row][index];
+  }
+  return matrix;
+}
+
+inline glm::mat3 matrix_at(const Matrix3Batch& batch, std::size_t index)
+{
+  glm::mat3 matrix;
+  for (int column = 0; column < 3; column++) {
+    for (int row = 0; row < 3; row++)
+      matrix[column][row] = batch.m[column * 3 + row][index];
+  }
+  return matrix;
+}
+
+} // namespace math
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef BAKED_MESH_H
+#define BAKED_MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../asset/mapped_file.h"
+#include "obj_loader.h"
+
+namespace mesh {
+
+// 16 bytes per vertex, in the locations of MeshVertex:
+//   position  4 x GL_SHORT, normalized to the mesh bounds (w unused)
+//   normal    GL_INT_2_10_10_10_REV, normalized
+//   uv        2 x GL_HALF_FLOAT
+// Positions dequantize as offset + scale * q, which dequantize_matrix
+// folds into the model matrix so vertex.vs needs no change.
+constexpr std::size_t BAKED_VERTEX_BYTES { 16 };
+
+struct BakedMesh {
+  float position_offset[3] {};
+  float position_scale[3] { 1.0f, 1.0f, 1.0f };
+  std::uint32_t vertex_count {};
+  std::uint32_t index_count {};
+  // GL_UNSIGNED_SHORT when every index fits, else GL_UNSIGNED_INT.
+  GLenum index_type { GL_UNSIGNED_INT };
+  // Into `file` after read_baked_mesh, or into `storage` after
+  // quantize_mesh.
+  const unsigned char* vertices {};
+  const unsigned char* indices {};
+
+  asset::MappedFile file;
+  std::vector<unsigned char> storage;
+};
+
+// Reorders triangles for the post-transform vertex cache (Tipsify, Sander
+// et al. 2007), then renumbers vertices in order of first use so fetches
+// walk the vertex buffer forwards.
+void optimize_mesh(MeshData& mesh, unsigned int cache_size = 16);
+
+// Average cache misses per triangle for a FIFO cache; 3.0 is the worst,
+// about 0.5 to 0.7 is typical for optimized closed meshes.
+double average_cache_miss_ratio(const std::vector<GLuint>& indices,
+    std::size_t vertex_count, unsigned int cache_size = 16);
+
+void quantize_mesh(const MeshData& mesh, BakedMesh& baked);
+
+// The .mesh file is a 64-byte header followed by the vertex and index
+// arrays, each 16-byte aligned, so reading it is a mapping and a header
+// check.
+bool write_baked_mesh(const std::string& path, const BakedMesh& baked);
+bool read_baked_mesh(const std::string& path, BakedMesh& baked);
+
+// Column-major scale-then-translate taking the normalized positions back
+// to model space.
+void dequantize_matrix(const BakedMesh& baked, float* matrix);
+
+// GL thread. The arrays go to the VBO and EBO straight from the mapping.
+GpuMesh upload_baked_mesh(const BakedMesh& baked);
+
+} // namespace mesh
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef GLTF_H
+#define GLTF_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+#include "../threading/thread_pool.h"
+
+namespace mesh {
+
+// Attribute locations the loader binds; the first three match MeshVertex
+// and vertex.vs.
+enum GltfAttribute : GLuint {
+  GLTF_POSITION = 0,
+  GLTF_NORMAL = 1,
+  GLTF_TEXCOORD_0 = 2,
+  GLTF_TANGENT = 3,
+  GLTF_COLOR_0 = 4,
+  GLTF_JOINTS_0 = 5,
+  GLTF_WEIGHTS_0 = 6,
+};
+
+enum class AlphaMode { OPAQUE, MASK, BLEND };
+
+// Texture fields index GltfScene::textures, or are -1.
+struct GltfMaterial {
+  std::string name;
+  float base_color[4] { 1.0f, 1.0f, 1.0f, 1.0f };
+  int base_color_texture { -1 };
+  float metallic { 1.0f };
+  float roughness { 1.0f };
+  int metallic_roughness_texture { -1 };
+  int normal_texture { -1 };
+  int occlusion_texture { -1 };
+  float emissive[3] {};
+  int emissive_texture { -1 };
+  AlphaMode alpha_mode { AlphaMode::OPAQUE };
+  float alpha_cutoff { 0.5f };
+  bool double_sided {};
+};
+
+// Ready to draw: bind the vertex array, then glDrawElements(mode, count,
+// index_type, (void*)index_offset), or glDrawArrays(mode, 0, count) when
+// index_type is GL_NONE.
+struct GltfPrimitive {
+  GLuint vertex_array {};
+  GLenum mode { GL_TRIANGLES };
+  GLsizei count {};
+  GLenum index_type { GL_NONE };
+  std::size_t index_offset {};
+  int material { -1 };
+};
+
+struct GltfMesh {
+  std::string name;
+  std::vector<GltfPrimitive> primitives;
+};
+
+// Matrices are column major, as glm and glUniformMatrix4fv expect.
+struct GltfNode {
+  std::string name;
+  int parent { -1 };
+  std::vector<int> children;
+  int mesh { -1 };
+  float local[16];
+  float world[16];
+};
+
+// Milliseconds per stage, and how much vertex and index data went to GL
+// as stored versus re-packed.
+struct GltfLoadStats {
+  double map_ms {};
+  double json_ms {};
+  double buffer_upload_ms {};
+  double image_decode_ms {};
+  double texture_upload_ms {};
+  double total_ms {};
+  std::size_t direct_bytes {};
+  std::size_t repacked_bytes {};
+  std::size_t image_count {};
+};
+
+struct GltfScene {
+  std::vector<GLuint> buffers;
+  std::vector<GLuint> vertex_arrays;
+  std::vector<GLuint> textures;
+  std::vector<GltfMaterial> materials;
+  std::vector<GltfMesh> meshes;
+  std::vector<GltfNode> nodes;
+  // Nodes of the default scene (or every parentless node without one).
+  std::vector<int> roots;
+  GltfLoadStats stats;
+};
+
+// GL thread. Loads a binary glTF 2.0 (.glb) whose buffer is the embedded
+// BIN chunk.
+//
+// The file is mapped, and every bufferView used by a vertex attribute or
+// index accessor goes to GL once, straight from the mapping: accessors
+// keep their byteOffset and byteStride, so interleaved and planar layouts
+// alike need no re-packing. Only sparse accessors, accessors without a
+// bufferView and 8-bit indices (widened to 16 bits) are re-packed.
+//
+// Embedded PNG/JPEG images are decoded and mipmapped on `pool` (or one
+// worker thread) while the buffers upload.
+bool load_glb(const std::string& path, GltfScene& scene,
+    threading::ThreadPool* pool = nullptr);
+
+void print_load_report(const GltfLoadStats& stats);
+
+// GL thread. Deletes every GL object the scene owns.
+void delete_scene(GltfScene& scene);
+
+} // namespace mesh
+
+#endif
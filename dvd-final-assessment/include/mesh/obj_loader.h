@@ -0,0 +1,57 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+#include "../gl_object/gl_object.h"
+#include "../threading/thread_pool.h"
+
+namespace mesh {
+
+// Interleaved vertex, laid out for vertex.vs: position at location 0,
+// normal at 1 and texture coordinate at 2. Missing attributes are zero.
+struct MeshVertex {
+  float position[3];
+  float normal[3];
+  float uv[2];
+};
+
+struct MeshData {
+  std::vector<MeshVertex> vertices;
+  std::vector<GLuint> indices;
+};
+
+// Parses Wavefront OBJ text: v, vt, vn and f (polygons are fan
+// triangulated, negative indices are relative); other statements are
+// skipped. Each distinct v/vt/vn corner becomes one vertex, in order of
+// first use.
+//
+// With a pool, the text is split into line-aligned chunks. A first pass
+// counts the v/vt/vn lines of every chunk so each chunk knows where its
+// attributes land, then the chunks are parsed in parallel straight into
+// the shared arrays. Only the final de-duplication runs on one thread.
+bool parse_obj(const char* text, std::size_t size, MeshData& mesh,
+    threading::ThreadPool* pool = nullptr);
+
+// Maps the file and parses it in place.
+bool load_obj(const std::string& path, MeshData& mesh,
+    threading::ThreadPool* pool = nullptr);
+
+struct GpuMesh {
+  gl_object::VAO vao;
+  gl_object::VBO vbo;
+  gl_object::EBO ebo;
+  GLsizei index_count;
+  GLenum index_type { GL_UNSIGNED_INT };
+};
+
+// GL thread. The arrays go to the VBO and EBO without another copy.
+GpuMesh upload_mesh(const MeshData& mesh);
+void delete_mesh(GpuMesh& mesh);
+
+} // namespace mesh
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef DEPENDENCY_GRAPH_H
+#define DEPENDENCY_GRAPH_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace resource {
+
+// Which assets are built from which: a shader from its includes, a material
+// from its shaders and textures, a mesh from its materials. Nodes are
+// asset paths; a file nothing else reads, or that reads nothing, is a node
+// with no edges.
+class DependencyGraph {
+public:
+  // Replaces what `asset` depends on, e.g. after a reload finds different
+  // includes.
+  void set_dependencies(
+      const std::string& asset, const std::vector<std::string>& dependencies);
+  // Drops the asset and its outgoing edges; assets depending on it keep
+  // their edges to it.
+  void remove(const std::string& asset);
+
+  const std::vector<std::string>& dependencies(const std::string& asset) const;
+  const std::vector<std::string>& dependents(const std::string& asset) const;
+
+  // Everything that must be rebuilt when `changed` change: the changed
+  // assets and all their transitive dependents, ordered so every asset
+  // comes after the assets it depends on. Members of a cycle come last, in
+  // no particular order.
+  std::vector<std::string> affected(const std::vector<std::string>& changed) const;
+
+private:
+  // Asset to what it reads, and the reverse.
+  std::unordered_map<std::string, std::vector<std::string>> forward;
+  std::unordered_map<std::string, std::vector<std::string>> reverse;
+};
+
+} // namespace resource
+
+#endif
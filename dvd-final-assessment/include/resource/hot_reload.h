@@ -0,0 +1,124 @@
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+#include <any>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../asset/file_watcher.h"
+#include "dependency_graph.h"
+
+namespace asset {
+class Vfs;
+}
+
+namespace resource {
+
+// Result of the worker-thread half of a reload.
+struct ReloadPayload {
+  std::any data;
+  // Files the asset was built from this time (e.g. a shader's includes),
+  // replacing its edges in the graph. Left empty, the edges stay as they
+  // are.
+  std::vector<std::string> dependencies;
+};
+
+// How to rebuild one asset. `prepare` runs on a worker thread and does the
+// CPU work: reading through the Vfs, preprocessing, decoding. It may read
+// the Vfs but nothing else shared with the GL thread. `apply` runs on the
+// GL thread and swaps the result in. Either returning false keeps the old
+// version, and so does every asset in the batch that depends on it.
+struct ReloadRecipe {
+  std::function<bool(const std::string& path, ReloadPayload& payload)> prepare;
+  std::function<bool(const std::string& path, ReloadPayload& payload)> apply;
+};
+
+// Rebuilds assets when the files they come from change on disk.
+//
+// Each registered asset is a node in a DependencyGraph. A changed file
+// marks itself and all its dependents; those with a recipe are prepared on
+// worker threads and, once the whole batch is ready, applied in dependency
+// order from one update() call, so a frame never sees half a change.
+// Changes that arrive meanwhile wait for the next batch. Assets with no
+// recipe (an include, say) only carry edges. Files without a path on disk
+// (archived or embedded) never change and are not watched.
+//
+// Each reload is logged with its latency, measured from the first file
+// event of the change, so it includes the watcher's debounce.
+//
+// GL thread only, apart from the recipes' prepare.
+class HotReloader {
+public:
+  HotReloader(asset::Vfs& vfs, unsigned int worker_threads = 1,
+      std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+  ~HotReloader();
+
+  HotReloader(const HotReloader&) = delete;
+  HotReloader& operator=(const HotReloader&) = delete;
+
+  bool supported() const { return watcher.supported(); }
+
+  // `path` may be a Vfs path or a name of your own (a program, a material)
+  // that only exists through its dependencies.
+  void add(const std::string& path, ReloadRecipe recipe,
+      const std::vector<std::string>& dependencies = {});
+  void add_dependencies(
+      const std::string& path, const std::vector<std::string>& dependencies);
+
+  // Call at a frame boundary. Applies a finished batch or starts the next
+  // one. Returns how many assets were applied.
+  std::size_t update();
+
+  bool busy() const { return !batch.empty(); }
+  const DependencyGraph& graph() const { return dependency_graph; }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct Job {
+    std::string path;
+    ReloadRecipe recipe;
+    ReloadPayload payload;
+    bool prepared {};
+    clock::time_point changed_at;
+    double prepare_ms {};
+  };
+
+  void watch(const std::string& path);
+  void start_batch(const std::vector<asset::FileWatcher::Change>& changes);
+  std::size_t apply_batch();
+  void worker_loop();
+
+  asset::Vfs& vfs;
+  asset::FileWatcher watcher;
+  DependencyGraph dependency_graph;
+  std::unordered_map<std::string, ReloadRecipe> recipes;
+  // Native directory to Vfs directory, to name what the watcher reports,
+  // including files that did not exist when the directory was watched.
+  std::unordered_map<std::string, std::string> watched_directories;
+  std::unordered_set<std::string> watched_files;
+
+  // The batch being prepared, in apply order.
+  std::deque<Job> batch;
+  std::size_t unfinished {};
+
+  std::mutex mutex;
+  std::condition_variable work_available;
+  std::deque<Job*> queue;
+  std::size_t finished {};
+  bool stopping {};
+  std::vector<std::thread> workers;
+};
+
+} // namespace resource
+
+#endif
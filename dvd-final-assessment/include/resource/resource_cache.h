@@ -0,0 +1,200 @@
+#ifndef RESOURCE_CACHE_H
+#define RESOURCE_CACHE_H
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+
+namespace asset {
+class Vfs;
+}
+
+namespace resource {
+
+enum class ResourceType { TEXTURE, SHADER, MESH };
+
+constexpr std::size_t RESOURCE_TYPE_COUNT { 3 };
+
+const char* resource_type_name(ResourceType type);
+
+// GL objects owned by the cache. Handles only keep them resident; the cache
+// deletes them on eviction or clear(), on the GL thread.
+struct Resource {
+  virtual ~Resource() = default;
+  // Counted against the cache budget.
+  std::size_t bytes {};
+};
+
+struct TextureResource : Resource {
+  GLuint texture {};
+  int width {};
+  int height {};
+};
+
+struct ShaderResource : Resource {
+  GLuint shader {};
+  GLenum stage {};
+};
+
+struct MeshResource : Resource {
+  GLuint vertex_array {};
+  GLuint vertex_buffer {};
+  GLuint element_buffer {};
+  GLsizei index_count {};
+};
+
+// Refcounted: a resource with live handles is never evicted.
+template <typename T> using Handle = std::shared_ptr<const T>;
+
+struct ResourceStats {
+  std::uint64_t hits {};
+  std::uint64_t misses {};
+  std::uint64_t evictions {};
+  std::size_t resident_bytes {};
+  std::size_t resident_count {};
+};
+
+// 64-bit content hash for change detection and de-duplication; not
+// cryptographic.
+std::uint64_t hash_bytes(const void* data, std::size_t size);
+bool hash_file(const std::string& path, std::uint64_t& hash);
+
+GLenum shader_stage_for(const std::string& path);
+
+// Reads a shader, replacing each `#include "file"` line with that file,
+// resolved relative to the including one (through `vfs` when given), and
+// appends every included path to `includes`.
+bool load_shader_source(const asset::Vfs* vfs, const std::string& path,
+    std::string& source, std::vector<std::string>* includes = nullptr);
+
+// GL thread. Returns 0 and prints the log if compilation fails.
+GLuint compile_shader(
+    const std::string& source, GLenum stage, const std::string& name);
+
+// Loads each resource once. Requests are keyed by canonical path, and a
+// path resolves to the content hash of the file, re-hashed only when its
+// size or modification time changes. Entries are keyed by type and content
+// hash, so identical files under different paths share one GL object and an
+// edited file loads as a new entry. What a loader takes from the path is
+// part of the key too: a shader's stage and the directory its includes
+// resolve from, a mesh's format. Shaders are keyed by their own file
+// alone; an edited include does not make a new entry.
+//
+// Unreferenced entries stay resident until the budget is exceeded and are
+// then evicted least recently used first. Referenced entries may push the
+// cache over budget.
+//
+// With a Vfs, paths are VFS paths: lookups and change detection use its
+// index, and the default loaders read through it, uploading baked archive
+// textures as stored. The Vfs must outlive the cache.
+//
+// GL thread only.
+class ResourceCache {
+public:
+  using Loader = std::function<std::shared_ptr<Resource>(const std::string&)>;
+  using Releaser = std::function<void(Resource&)>;
+
+  explicit ResourceCache(std::size_t budget_bytes = 256 << 20,
+      const asset::Vfs* vfs = nullptr);
+  ~ResourceCache() = default;
+
+  ResourceCache(const ResourceCache&) = delete;
+  ResourceCache& operator=(const ResourceCache&) = delete;
+
+  // Every type has a default loader (meshes read .obj); this replaces it.
+  void set_loader(ResourceType type, Loader loader, Releaser releaser);
+
+  Handle<TextureResource> texture(const std::string& path)
+  {
+    return acquire<TextureResource>(ResourceType::TEXTURE, path);
+  }
+  Handle<ShaderResource> shader(const std::string& path)
+  {
+    return acquire<ShaderResource>(ResourceType::SHADER, path);
+  }
+  Handle<MeshResource> mesh(const std::string& path)
+  {
+    return acquire<MeshResource>(ResourceType::MESH, path);
+  }
+
+  // Returns null when the file is missing or fails to load.
+  template <typename T>
+  Handle<T> acquire(ResourceType type, const std::string& path)
+  {
+    return std::static_pointer_cast<const T>(acquire(type, path));
+  }
+  std::shared_ptr<const Resource> acquire(
+      ResourceType type, const std::string& path);
+
+  void set_budget(std::size_t budget_bytes);
+  std::size_t budget() const { return budget_bytes; }
+
+  // Evicts unreferenced entries until the cache fits its budget.
+  void trim();
+
+  const ResourceStats& stats(ResourceType type) const;
+  void print_stats() const;
+
+  // Must run while the GL context is still current. Releases every entry,
+  // so outstanding handles must not be used afterwards.
+  void clear();
+
+private:
+  struct EntryKey {
+    ResourceType type;
+    std::uint64_t content_hash;
+    // Hash of the loader inputs that come from the path.
+    std::uint64_t path_inputs;
+
+    auto operator<=>(const EntryKey&) const = default;
+  };
+
+  struct PathRecord {
+    std::uintmax_t size;
+    std::filesystem::file_time_type modified;
+    std::uint64_t content_hash;
+  };
+
+  struct Entry {
+    std::shared_ptr<Resource> resource;
+    std::list<EntryKey>::iterator recent;
+  };
+
+  struct TypeHooks {
+    Loader loader;
+    Releaser releaser;
+  };
+
+  bool content_hash_of(const std::string& path, std::uint64_t& hash);
+  bool vfs_content_hash_of(const std::string& path, std::uint64_t& hash);
+  void evict(std::map<EntryKey, Entry>::iterator entry);
+  ResourceStats& stats_of(ResourceType type);
+
+  std::size_t budget_bytes;
+  std::size_t resident_bytes {};
+  const asset::Vfs* vfs;
+
+  std::unordered_map<std::string, PathRecord> paths;
+  std::map<EntryKey, Entry> entries;
+  // Most recently used at the front.
+  std::list<EntryKey> recent;
+
+  std::array<TypeHooks, RESOURCE_TYPE_COUNT> hooks;
+  std::array<ResourceStats, RESOURCE_TYPE_COUNT> type_stats {};
+};
+
+} // namespace resource
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef STREAMING_H
+#define STREAMING_H
+
+#include <any>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+#include "../asset/mapped_file.h"
+#include "../asset/vfs.h"
+#include "../mesh/obj_loader.h"
+#include "../texture/ktx2.h"
+
+namespace resource {
+
+// An asset that can be resident at several levels of detail, numbered
+// coarsest first. Level 0 is loaded before anything else and is only
+// dropped by release(); every finer level needs the ones before it, so the
+// resident levels are always 0 to n - 1.
+class StreamSource {
+public:
+  virtual ~StreamSource() = default;
+
+  virtual std::size_t level_count() const = 0;
+  // GPU memory the level takes once uploaded.
+  virtual std::size_t level_bytes(std::size_t level) const = 0;
+  // Projected diameter, in pixels, from which the level is worth having.
+  // Level 0 is always wanted.
+  virtual float level_pixels(std::size_t level) const = 0;
+
+  // Worker thread: bring the level's data into memory. Must not touch GL
+  // or anything the GL thread changes.
+  virtual bool load(std::size_t level, std::any& data) = 0;
+  // GL thread: make the level resident. Levels arrive in order.
+  virtual bool upload(std::size_t level, std::any& data) = 0;
+  // GL thread: drop the finest resident level, never level 0.
+  virtual void evict(std::size_t level) = 0;
+  // GL thread: drop everything.
+  virtual void release() = 0;
+};
+
+// A KTX2 texture streamed smallest mips first. Level 0 is the mip tail
+// (every mip of 64 pixels or less); each further level is the next larger
+// mip, made visible by lowering GL_TEXTURE_BASE_LEVEL, so sampling always
+// uses the finest mip resident. Directory files are mapped, archive and
+// embedded files are read in place.
+class StreamedTexture : public StreamSource {
+public:
+  StreamedTexture(const asset::Vfs& vfs, std::string path);
+
+  // Reads the header. False when the file is missing or not a KTX2 file
+  // this driver can sample.
+  bool open();
+
+  // 0 until level 0 is uploaded.
+  GLuint texture() const { return gl_texture; }
+  // Mip sampled from, or -1 before level 0.
+  int base_mip() const;
+
+  std::size_t level_count() const override;
+  std::size_t level_bytes(std::size_t level) const override;
+  float level_pixels(std::size_t level) const override;
+  bool load(std::size_t level, std::any& data) override;
+  bool upload(std::size_t level, std::any& data) override;
+  void evict(std::size_t level) override;
+  void release() override;
+
+private:
+  // Mips [first, last] of the file that make up a level.
+  std::array<std::size_t, 2> mips_of(std::size_t level) const;
+  const unsigned char* bytes() const;
+
+  const asset::Vfs& vfs;
+  std::string path;
+  asset::MappedFile file;
+  asset::VfsFile vfs_file;
+
+  texture::Ktx2Image header;
+  texture::GlTextureFormat format {};
+  std::vector<texture::Ktx2Level> mips;
+  // First mip of the tail.
+  std::size_t tail {};
+
+  GLuint gl_texture {};
+  std::size_t resident {};
+};
+
+// A chain of baked meshes (.mesh files from the bake tool), coarsest first,
+// each uploaded on its own; draw the finest resident one. Only directory
+// files can be streamed, as read_baked_mesh maps them.
+class StreamedMesh : public StreamSource {
+public:
+  struct Lod {
+    std::string path;
+    // As level_pixels; ignored for the first.
+    float pixels;
+  };
+
+  StreamedMesh(const asset::Vfs& vfs, std::vector<Lod> lods);
+
+  // False when a LOD is missing or not on disk.
+  bool open();
+
+  // Null until level 0 is uploaded.
+  const mesh::GpuMesh* finest() const;
+  // Dequantization matrix (see mesh::dequantize_matrix) of finest().
+  const float* finest_matrix() const;
+
+  std::size_t level_count() const override { return lods.size(); }
+  std::size_t level_bytes(std::size_t level) const override;
+  float level_pixels(std::size_t level) const override;
+  bool load(std::size_t level, std::any& data) override;
+  bool upload(std::size_t level, std::any& data) override;
+  void evict(std::size_t level) override;
+  void release() override;
+
+private:
+  const asset::Vfs& vfs;
+  std::vector<Lod> lods;
+  std::vector<std::string> native_paths;
+  std::vector<std::size_t> sizes;
+
+  std::vector<mesh::GpuMesh> resident;
+  std::vector<std::array<float, 16>> matrices;
+};
+
+struct StreamView {
+  float position[3] {};
+  // Viewport height over the vertical field of view (in radians), which
+  // turns an angular size into pixels.
+  float pixels_per_radian { 1.0f };
+};
+
+struct StreamBounds {
+  float center[3] {};
+  float radius { 1.0f };
+};
+
+struct StreamStats {
+  std::uint64_t loaded {};
+  std::uint64_t failed {};
+  std::uint64_t cancelled {};
+  std::uint64_t evicted {};
+  std::size_t resident_bytes {};
+  // Requested but not yet uploaded.
+  std::size_t pending_bytes {};
+  std::size_t pending {};
+};
+
+using StreamId = std::uint32_t;
+
+// Streams levels of detail in the order they matter most, within a memory
+// budget.
+//
+// Every update() ranks the assets by the projected size of their bounding
+// sphere, discounted when they are not visible, and from it picks how many
+// levels each should have. Every asset's level 0 comes before any finer
+// level, so a scene is drawable as soon as the coarse data is in and then
+// refines, nearest and largest first. Each asset has at most one request
+// outstanding; the workers always take the highest priority one queued,
+// and priorities are refreshed every frame.
+//
+// A request for a level that is no longer wanted (the camera moved away,
+// the asset went out of view, or was removed or cancelled) is cancelled:
+// dropped from the queue, or discarded when its load finishes.
+//
+// Resident and pending levels are counted against the budget. To make room,
+// levels beyond what an asset currently wants go first, then the finest
+// levels of assets ranked below the request; when that is not enough the
+// request waits. Level 0 is never evicted, so the budget is exceeded rather
+// than leave an asset with nothing to draw.
+//
+// GL thread only, apart from the sources' load. Call clear() while the
+// context is current before destroying the loader.
+class StreamingLoader {
+public:
+  explicit StreamingLoader(std::size_t budget_bytes = 256 << 20,
+      unsigned int worker_threads = 2,
+      std::size_t upload_budget_bytes = 8 << 20);
+  ~StreamingLoader();
+
+  StreamingLoader(const StreamingLoader&) = delete;
+  StreamingLoader& operator=(const StreamingLoader&) = delete;
+
+  StreamId add(std::shared_ptr<StreamSource> source, const StreamBounds& bounds);
+  // Cancels its request and releases what is resident.
+  void remove(StreamId id);
+
+  void set_bounds(StreamId id, const StreamBounds& bounds);
+  void set_visible(StreamId id, bool visible);
+
+  // Cancels the asset's request and stops refining it until resume(); what
+  // is resident stays, but may be evicted.
+  void cancel(StreamId id);
+  void resume(StreamId id);
+
+  // Call once a frame: ranks the assets from `view`, cancels requests no
+  // longer wanted, uploads finished loads (up to the per-frame upload
+  // budget), evicts, and issues new requests.
+  void update(const StreamView& view);
+
+  StreamSource* source(StreamId id) const;
+  std::size_t resident_levels(StreamId id) const;
+  // How many levels the last update() wanted for the asset.
+  std::size_t wanted_levels(StreamId id) const;
+
+  void set_budget(std::size_t budget_bytes);
+  std::size_t budget() const { return budget_bytes; }
+
+  const StreamStats& stats() const { return loader_stats; }
+  void print_stats() const;
+
+  // GL thread. Cancels every request and releases every asset.
+  void clear();
+
+private:
+  struct Request {
+    StreamId id;
+    std::size_t level;
+    std::size_t bytes;
+    float priority;
+    std::shared_ptr<StreamSource> source;
+    std::any data;
+    bool ok {};
+    bool cancelled {};
+  };
+
+  struct Asset {
+    std::shared_ptr<StreamSource> source;
+    StreamBounds bounds;
+    bool visible { true };
+    bool paused {};
+    // A level failed to load; it is not asked for again.
+    bool failed {};
+    std::size_t resident {};
+    std::size_t resident_bytes {};
+    std::size_t wanted { 1 };
+    float priority {};
+    std::shared_ptr<Request> request;
+  };
+
+  void rank(const StreamView& view);
+  void cancel_request(Asset& asset);
+  void collect();
+  void upload_ready();
+  void evict_level(Asset& asset);
+  // Evicts until `bytes` more fit, taking only what ranks below
+  // `priority`.
+  bool make_room(std::size_t bytes, float priority);
+  void issue_requests();
+  void worker_loop();
+
+  std::size_t budget_bytes;
+  std::size_t upload_budget_bytes;
+  std::size_t max_requests;
+  StreamStats loader_stats;
+
+  std::unordered_map<StreamId, Asset> assets;
+  StreamId next_id { 1 };
+  // Finished loads waiting for the upload budget.
+  std::vector<std::shared_ptr<Request>> ready;
+
+  std::mutex mutex;
+  std::condition_variable work_available;
+  std::vector<std::shared_ptr<Request>> queue;
+  std::vector<std::shared_ptr<Request>> finished;
+  bool stopping {};
+  std::vector<std::thread> workers;
+};
+
+} // namespace resource
+
+#endif
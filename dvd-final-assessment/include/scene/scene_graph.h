@@ -0,0 +1,122 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace threading {
+class ThreadPool;
+}
+
+namespace scene {
+
+using NodeId = std::uint32_t;
+
+constexpr NodeId NO_NODE { 0xffffffffu };
+
+// Local transform of a node relative to its parent.
+struct Transform {
+  float translation[3] { 0.0f, 0.0f, 0.0f };
+  // x, y, z, w; unit length.
+  float rotation[4] { 0.0f, 0.0f, 0.0f, 1.0f };
+  float scale[3] { 1.0f, 1.0f, 1.0f };
+};
+
+struct SceneUpdateStats {
+  // Subtrees with a changed node at their root.
+  std::size_t dirty_subtrees {};
+  // World matrices recomputed.
+  std::size_t recomputed {};
+  // Whether the order had to be rebuilt after structural changes.
+  bool reordered {};
+};
+
+// Hierarchy of transforms stored as flat arrays in depth-first order: every
+// parent comes before its children and every subtree is one contiguous
+// range of indices. World matrices are interleaved, 16 floats a node, ready
+// to upload. Local transforms are kept whole rather than per component: the
+// dirty ranges are scattered, and a node's local is then one cache line
+// instead of ten.
+//
+// set_local() only marks a node dirty. update() turns the dirty nodes into
+// the disjoint ranges of their subtrees and recomputes those ranges in one
+// forward pass each (a parent's world matrix is always final before its
+// children read it), leaving the rest of the graph untouched. Ranges do not
+// depend on each other, so they are spread over the pool, and large ones are
+// split at their children so one dirty root still uses every thread.
+//
+// Adding a node under the last subtree keeps the order. Any other add,
+// set_parent() and remove() are applied by the next update(), which
+// re-sorts the arrays in one pass; ids stay valid across the re-sort, but
+// indices and world_matrices() change.
+class SceneGraph {
+public:
+  std::size_t size() const { return ids.size(); }
+
+  void reserve(std::size_t count);
+
+  // `parent` may be NO_NODE for a root.
+  NodeId add(const Transform& local, NodeId parent = NO_NODE);
+  // Removes the node and its subtree.
+  void remove(NodeId node);
+  // Fails when `parent` is the node or one of its descendants.
+  bool set_parent(NodeId node, NodeId parent);
+  NodeId parent(NodeId node) const;
+  bool contains(NodeId node) const;
+
+  void set_local(NodeId node, const Transform& local);
+  Transform local(NodeId node) const;
+
+  // 16 floats, column-major, as of the last update().
+  const float* world_matrix(NodeId node) const;
+
+  // World matrices of all nodes in index order, and the node at an index.
+  const std::vector<float>& world_matrices() const { return worlds; }
+  NodeId node_at(std::size_t index) const { return ids[index]; }
+  std::size_t index_of(NodeId node) const { return slots[node]; }
+
+  SceneUpdateStats update();
+  SceneUpdateStats update(threading::ThreadPool& pool);
+
+private:
+  // A range of nodes [begin, end) whose first node's parent is final.
+  struct Range {
+    std::uint32_t begin;
+    std::uint32_t end;
+  };
+
+  void mark_dirty(std::uint32_t index);
+  // Applies pending structural changes, restoring depth-first order.
+  void reorder();
+  // Turns the dirty nodes into disjoint subtree ranges, clearing the marks.
+  void collect_ranges(SceneUpdateStats& stats);
+  // Computes the world matrix at the root of each range longer than
+  // `max_nodes` and replaces the range with its children's subtrees, until
+  // every range fits.
+  void split_ranges(std::size_t max_nodes);
+  // ranges[begin, end), prefetching the ranges ahead.
+  void compute_ranges(std::size_t begin, std::size_t end);
+  void compute_range(Range range);
+
+  // Per index, in depth-first order.
+  std::vector<std::uint32_t> parents;
+  std::vector<std::uint32_t> subtree_sizes;
+  std::vector<Transform> locals;
+  std::vector<float> worlds;
+  std::vector<NodeId> ids;
+  std::vector<std::uint8_t> dirty;
+  std::vector<std::uint8_t> removed;
+
+  // Per id: its index, or a free id.
+  std::vector<std::uint32_t> slots;
+  std::vector<NodeId> free_ids;
+
+  std::vector<std::uint32_t> dirty_indices;
+  std::vector<Range> ranges;
+  bool order_valid { true };
+};
+
+} // namespace scene
+
+#endif
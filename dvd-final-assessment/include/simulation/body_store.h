@@ -0,0 +1,55 @@
+#ifndef BODY_STORE_H
+#define BODY_STORE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "dvd_simulation.h"
+
+namespace threading {
+class ThreadPool;
+}
+
+namespace simulation {
+
+// Structure-of-arrays storage for many bouncing logos, laid out so the
+// integrate kernels can stream each field with full-width vector loads.
+class BodyStore {
+public:
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> vx;
+  std::vector<float> vy;
+  std::vector<float> half_width;
+  std::vector<float> half_height;
+
+  std::size_t size() const { return x.size(); }
+
+  void reserve(std::size_t count);
+  void clear();
+  void add(const DvdState& state, const DvdLogo& logo);
+
+  DvdState state(std::size_t index) const;
+};
+
+enum class BodyKernel { SCALAR, SSE41, AVX2 };
+
+// Widest kernel the running CPU supports.
+BodyKernel best_body_kernel();
+bool body_kernel_supported(BodyKernel kernel);
+const char* body_kernel_name(BodyKernel kernel);
+
+// Branchless integrate-and-reflect over [begin, end). Every kernel performs
+// the same float operations in the same order, so they agree bit for bit.
+// A body is assumed to move less than its free span per step; a single
+// reflection is applied per axis.
+void integrate_bodies(BodyStore& bodies, std::size_t begin, std::size_t end,
+    const Bounds& bounds, float dt, BodyKernel kernel);
+
+// Splits the store into chunks and integrates them across the pool.
+void integrate_bodies(BodyStore& bodies, const Bounds& bounds, float dt,
+    threading::ThreadPool& pool, BodyKernel kernel = best_body_kernel());
+
+} // namespace simulation
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef BOUNCE_EVENTS_H
+#define BOUNCE_EVENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace simulation {
+
+// A logo moving on an integer lattice. Positions are pixels measured from the
+// low wall of the free area (window size minus logo size), velocities are
+// pixels per second. Keeping the inputs integral makes every wall and corner
+// hit an exact rational time.
+struct LatticeLogo {
+  std::int64_t span_x;
+  std::int64_t span_y;
+  std::int64_t x0;
+  std::int64_t y0;
+  std::int64_t vx;
+  std::int64_t vy;
+};
+
+// numerator / denominator seconds, denominator always positive.
+struct ExactTime {
+  std::int64_t numerator;
+  std::int64_t denominator;
+
+  double seconds() const
+  {
+    return static_cast<double>(numerator) / static_cast<double>(denominator);
+  }
+};
+
+bool operator<(const ExactTime& a, const ExactTime& b);
+bool operator==(const ExactTime& a, const ExactTime& b);
+ExactTime exact_seconds(std::int64_t seconds);
+
+enum class BounceAxis { X, Y, CORNER };
+
+struct LogoPosition {
+  double x;
+  double y;
+  int direction_x;
+  int direction_y;
+};
+
+struct CornerHit {
+  ExactTime time;
+  bool right;
+  bool top;
+};
+
+// Closed-form position at any time, O(1) regardless of how many bounces
+// happened before `seconds`.
+LogoPosition position_at(const LatticeLogo& logo, double seconds);
+
+// First hit of a wall on `axis` strictly after `after`, or at or after it
+// when `inclusive` (pass exact_seconds(0) and true for the first hit from the
+// start).
+std::optional<ExactTime> next_wall_hit(const LatticeLogo& logo,
+    BounceAxis axis, ExactTime after, bool inclusive = false);
+
+// First time after `after` (or at it, when `inclusive`) at which both axes
+// hit a wall together, found by solving the linear Diophantine equation
+// between the two wall sequences. Empty if the logo never reaches a corner.
+std::optional<CornerHit> next_corner_hit(
+    const LatticeLogo& logo, ExactTime after, bool inclusive = false);
+
+struct BounceEvent {
+  ExactTime time;
+  std::size_t logo;
+  BounceAxis axis;
+};
+
+// Keeps the next wall hit of every logo in a priority queue, so advancing the
+// simulation costs one queue operation per bounce instead of one step per
+// logo per frame. Simultaneous X and Y hits are reported once as CORNER.
+class BounceScheduler {
+public:
+  std::size_t add(const LatticeLogo& logo);
+
+  std::size_t size() const { return logos.size(); }
+  const LatticeLogo& logo(std::size_t index) const { return logos[index]; }
+
+  std::optional<ExactTime> next_event_time() const;
+
+  // Pops every event up to and including `until` in time order and returns
+  // how many were reported.
+  std::size_t advance_to(ExactTime until,
+      const std::function<void(const BounceEvent&)>& on_event = nullptr);
+
+private:
+  struct Pending {
+    ExactTime time;
+    std::size_t logo;
+    BounceAxis axis;
+  };
+
+  struct Later {
+    bool operator()(const Pending& a, const Pending& b) const;
+  };
+
+  void schedule(std::size_t index, BounceAxis axis, ExactTime after,
+      bool inclusive = false);
+
+  std::vector<LatticeLogo> logos;
+  std::priority_queue<Pending, std::vector<Pending>, Later> queue;
+};
+
+} // namespace simulation
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef DVD_SIMULATION_H
+#define DVD_SIMULATION_H
+
+namespace simulation {
+
+struct Bounds {
+  float left;
+  float right;
+  float bottom;
+  float top;
+};
+
+struct DvdLogo {
+  float half_width;
+  float half_height;
+};
+
+struct DvdState {
+  float x;
+  float y;
+  float vx;
+  float vy;
+};
+
+// Advances one fixed step. Overshoot past a wall is mirrored back inside the
+// bounds in the same step, so the logo can never tunnel out of the window no
+// matter how large `dt` is relative to its speed.
+DvdState step_dvd(
+    const DvdState& state, const DvdLogo& logo, const Bounds& bounds, float dt);
+
+// Position to draw between two fixed steps; velocity is taken from `current`.
+DvdState interpolate(
+    const DvdState& previous, const DvdState& current, float alpha);
+
+} // namespace simulation
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <cstdint>
+
+namespace simulation {
+
+// Accumulates wall-clock frame time and converts it into a whole number of
+// fixed simulation steps. The simulation only ever sees `step_seconds()`, so
+// its result depends on the tick count alone and not on how frames landed.
+class FixedTimestep {
+public:
+  FixedTimestep(double tick_rate, int max_steps_per_frame);
+
+  // Returns how many fixed steps to run for a frame that took `frame_seconds`.
+  // Anything beyond `max_steps_per_frame` is dropped instead of carried over,
+  // so a long hitch slows the simulation down rather than spiralling.
+  int advance(double frame_seconds);
+
+  // How far the accumulator is into the next step, in [0, 1). Used to blend
+  // the previous and current states when rendering.
+  float alpha() const;
+
+  float step_seconds() const { return step; }
+  std::uint64_t tick() const { return ticks; }
+
+private:
+  float step;
+  double step_wall;
+  double accumulator {};
+  int max_steps;
+  std::uint64_t ticks {};
+};
+
+} // namespace simulation
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "body_store.h"
+#include "dvd_simulation.h"
+
+namespace threading {
+class ThreadPool;
+}
+
+namespace simulation {
+
+struct BodyContact {
+  std::uint32_t a;
+  std::uint32_t b;
+  float penetration;
+  bool along_x;
+};
+
+struct CollisionStats {
+  std::uint64_t pairs_tested;
+  std::uint64_t pairs_colliding;
+};
+
+// Uniform grid broad phase. Every body is binned by its centre, and the
+// bodies are then counting-sorted into cell order with their positions and
+// extents copied alongside, so the narrow phase walks contiguous memory.
+// Cells are at least as wide as the largest body, so any overlapping pair
+// sits in the same or an adjacent cell. They are widened further when the
+// bounds would otherwise need more than a few cells per body.
+class SpatialGrid {
+public:
+  void rebuild(const BodyStore& bodies, const Bounds& bounds,
+      threading::ThreadPool& pool);
+
+  // AABB-vs-AABB tests over each cell and half of its neighbours, split
+  // across the pool by rows. Contacts come back in cell order, so the result
+  // does not depend on how many threads ran.
+  CollisionStats find_contacts(
+      std::vector<BodyContact>& contacts, threading::ThreadPool& pool) const;
+
+  std::size_t columns() const { return grid_columns; }
+  std::size_t rows() const { return grid_rows; }
+  float cell_size() const { return grid_cell_size; }
+
+private:
+  std::uint64_t collide_row(
+      std::size_t row, std::vector<BodyContact>& contacts) const;
+
+  float grid_cell_size {};
+  float origin_x {};
+  float origin_y {};
+  std::size_t grid_columns {};
+  std::size_t grid_rows {};
+
+  std::vector<std::uint32_t> body_cell;
+  std::vector<std::uint32_t> cell_start;
+
+  std::vector<std::uint32_t> sorted_body;
+  std::vector<float> sorted_x;
+  std::vector<float> sorted_y;
+  std::vector<float> sorted_half_width;
+  std::vector<float> sorted_half_height;
+};
+
+// Pushes every contacting pair apart along its shallow axis and exchanges
+// their velocities on that axis (equal-mass elastic response).
+void resolve_contacts(
+    BodyStore& bodies, const std::vector<BodyContact>& contacts);
+
+// One full tick of logo-logo collisions: rebuild, narrow phase, response.
+CollisionStats collide_bodies(BodyStore& bodies, const Bounds& bounds,
+    SpatialGrid& grid, std::vector<BodyContact>& contacts,
+    threading::ThreadPool& pool);
+
+} // namespace simulation
+
+#endif
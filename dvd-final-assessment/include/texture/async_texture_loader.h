@@ -0,0 +1,108 @@
+#ifndef ASYNC_TEXTURE_LOADER_H
+#define ASYNC_TEXTURE_LOADER_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+#include "mipmap.h"
+
+namespace texture {
+
+using TextureId = std::uint32_t;
+
+struct LoadLatencyReport {
+  std::size_t loaded;
+  std::size_t failed;
+  double p50_ms;
+  double p90_ms;
+  double p99_ms;
+  double max_ms;
+};
+
+// Loads textures without blocking the frame loop. Files are read and decoded
+// with stb_image on dedicated decode threads (so slow disks never stall the
+// job system), which also build the mip chain or read it from the on-disk
+// mip cache. Every level is then uploaded on the GL thread through
+// pixel-unpack buffers a few rows at a time, never more than
+// `upload_budget_bytes` per frame. Until a texture is complete, texture()
+// returns a placeholder.
+//
+// Construct it on the GL thread once the context is current.
+class AsyncTextureLoader {
+public:
+  AsyncTextureLoader(unsigned int decode_threads = 2,
+      std::size_t upload_budget_bytes = 4 << 20,
+      const MipOptions& mip_options = {});
+  ~AsyncTextureLoader();
+
+  AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+  AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+  // GL thread only, as are all the functions below.
+  TextureId request(const std::string& path);
+
+  // Call once per frame: stages decoded pixels and uploads within the budget.
+  void update();
+
+  GLuint texture(TextureId id) const;
+  bool ready(TextureId id) const;
+  std::size_t pending() const;
+
+  LoadLatencyReport latency_report() const;
+  void print_latency_report() const;
+
+  // Must run while the GL context is still current.
+  void delete_textures();
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t STAGING_BUFFERS { 3 };
+
+  struct Request {
+    std::string path;
+    clock::time_point requested_at;
+    Ktx2Image mips;
+    bool failed {};
+    bool ready {};
+    GLuint texture {};
+    std::size_t level {};
+    int rows_uploaded {};
+  };
+
+  void decode_loop();
+  void upload_rows(Request& request, std::size_t& budget);
+  void finish(Request& request);
+
+  std::deque<Request> requests;
+  std::deque<Request*> upload_queue;
+  std::vector<double> latencies_ms;
+  std::size_t failures {};
+  std::size_t in_flight {};
+
+  std::size_t upload_budget;
+  MipOptions mip_options;
+  GLuint placeholder {};
+  std::array<GLuint, STAGING_BUFFERS> staging_buffers {};
+  std::size_t next_staging_buffer {};
+
+  std::mutex mutex;
+  std::condition_variable work_available;
+  std::deque<Request*> decode_queue;
+  std::vector<Request*> decoded;
+  bool stopping {};
+  std::vector<std::thread> decoders;
+};
+
+} // namespace texture
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+
+namespace texture {
+
+// RGBA8 source image, rows stored top to bottom as they are in the file.
+struct AtlasImage {
+  std::string name;
+  int width;
+  int height;
+  std::vector<unsigned char> rgba;
+};
+
+// Texture coordinates for a texture uploaded bottom row first (the GL
+// convention stb_image produces with vertical flip enabled).
+struct UvRect {
+  float u0;
+  float v0;
+  float u1;
+  float v1;
+};
+
+struct AtlasRegion {
+  int x;
+  int y;
+  int width;
+  int height;
+  UvRect uv;
+};
+
+struct AtlasOptions {
+  // Gutter on every side, filled by extruding the image's edge pixels so
+  // bilinear filtering never samples a neighbour.
+  int padding { 4 };
+  // Cells start and end on multiples of this, so down to mip level
+  // log2(alignment) each region still covers whole texels of its own.
+  // upload() stops the chain there.
+  int alignment { 4 };
+  int max_size { 8192 };
+};
+
+struct AtlasStats {
+  std::size_t images;
+  int width;
+  int height;
+  double occupancy;
+  double packing_ms;
+};
+
+// Packs many images into one texture with a skyline bottom-left packer so
+// sprites can be drawn from a single bound texture.
+class TextureAtlas {
+public:
+  bool build(
+      const std::vector<AtlasImage>& images, const AtlasOptions& options = {});
+
+  const AtlasRegion* find(const std::string& name) const;
+
+  int width() const { return atlas_width; }
+  int height() const { return atlas_height; }
+  const std::vector<unsigned char>& pixels() const { return atlas_pixels; }
+  const std::unordered_map<std::string, AtlasRegion>& regions() const
+  {
+    return atlas_regions;
+  }
+  const AtlasStats& stats() const { return atlas_stats; }
+
+  // Offline form: an uncompressed top-left origin TGA that stb_image can
+  // read back, plus a text manifest of "width height alignment" followed by
+  // one "name x y width height u0 v0 u1 v1" line per region.
+  bool write(
+      const std::string& image_path, const std::string& manifest_path) const;
+  bool read(const std::string& image_path, const std::string& manifest_path);
+
+  // GL thread. Returns a texture holding the atlas, mipmapped only down to
+  // the last level at which the cell alignment keeps regions apart.
+  GLuint upload() const;
+
+private:
+  bool pack(const std::vector<AtlasImage>& images, const AtlasOptions& options,
+      int width, int height, std::vector<AtlasRegion>& placed) const;
+
+  int atlas_width {};
+  int atlas_height {};
+  int atlas_alignment { 1 };
+  std::vector<unsigned char> atlas_pixels;
+  std::unordered_map<std::string, AtlasRegion> atlas_regions;
+  AtlasStats atlas_stats {};
+};
+
+// Decodes image files to RGBA8 for TextureAtlas::build; the name of each
+// image is its file stem. Files that fail to decode are reported and skipped.
+std::vector<AtlasImage> load_atlas_images(const std::vector<std::string>& paths);
+
+} // namespace texture
+
+#endif
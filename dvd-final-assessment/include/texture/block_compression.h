@@ -0,0 +1,28 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <vector>
+
+namespace texture {
+
+enum class BlockFormat { BC1, BC3, BC7 };
+
+std::size_t block_bytes(BlockFormat format);
+
+// Encoders for one 4x4 block of RGBA8 texels, given row by row.
+// BC1 stores opaque RGB in 8 bytes, BC3 adds an interpolated alpha block for
+// 16 bytes, and BC7 uses mode 6 (one RGBA subset with 4-bit indices), which
+// keeps the encoder small while handling alpha and smooth gradients well.
+void encode_bc1_block(const unsigned char* rgba, unsigned char* out);
+void encode_bc3_block(const unsigned char* rgba, unsigned char* out);
+void encode_bc7_block(const unsigned char* rgba, unsigned char* out);
+
+// Compresses a whole RGBA8 image. Edge blocks of sizes that are not a
+// multiple of four repeat the last row and column.
+std::vector<unsigned char> compress_image(
+    const unsigned char* rgba, int width, int height, BlockFormat format);
+
+} // namespace texture
+
+#endif
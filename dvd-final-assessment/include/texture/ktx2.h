@@ -0,0 +1,103 @@
+#ifndef KTX2_H
+#define KTX2_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+
+namespace texture {
+
+// VkFormat values used by KTX2 for the formats we can upload.
+enum Ktx2Format : std::uint32_t {
+  VK_FORMAT_R8G8B8A8_UNORM = 37,
+  VK_FORMAT_R8G8B8A8_SRGB = 43,
+  VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131,
+  VK_FORMAT_BC1_RGB_SRGB_BLOCK = 132,
+  VK_FORMAT_BC1_RGBA_UNORM_BLOCK = 133,
+  VK_FORMAT_BC1_RGBA_SRGB_BLOCK = 134,
+  VK_FORMAT_BC3_UNORM_BLOCK = 137,
+  VK_FORMAT_BC3_SRGB_BLOCK = 138,
+  VK_FORMAT_BC4_UNORM_BLOCK = 139,
+  VK_FORMAT_BC5_UNORM_BLOCK = 141,
+  VK_FORMAT_BC7_UNORM_BLOCK = 145,
+  VK_FORMAT_BC7_SRGB_BLOCK = 146,
+  VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK = 147,
+  VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK = 148,
+  VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK = 151,
+  VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK = 152,
+  VK_FORMAT_EAC_R11_UNORM_BLOCK = 153,
+  VK_FORMAT_EAC_R11G11_UNORM_BLOCK = 155,
+};
+
+struct GlTextureFormat {
+  GLenum internal_format;
+  // Only used for uncompressed formats.
+  GLenum format;
+  GLenum type;
+  bool compressed;
+  // Bytes per 4x4 block, or per texel when uncompressed.
+  std::size_t block_bytes;
+};
+
+// One 2D texture with its mip chain, level 0 being the full size image.
+// Supercompressed (Basis, zstd), array, cube and 3D files are rejected.
+struct Ktx2Image {
+  std::uint32_t vk_format {};
+  int width {};
+  int height {};
+  // From the KTXorientation key: KTX2 defaults to a top-left origin, our
+  // encoder writes bottom-left ("ru") to match GL texture coordinates.
+  // Top-left files are flipped on upload when uncompressed; block-compressed
+  // ones are rejected by parse_ktx2, as their blocks cannot be flipped as
+  // rows.
+  bool origin_bottom_left {};
+  // Extra key/value entries, such as the mip cache's source stamp.
+  std::vector<std::pair<std::string, std::string>> metadata;
+  std::vector<std::vector<unsigned char>> levels;
+};
+
+bool gl_texture_format(std::uint32_t vk_format, GlTextureFormat& format);
+
+// GL thread, after gladLoadGLLoader: whether the driver advertises the
+// extension or core version the format needs.
+bool gl_texture_format_supported(const GlTextureFormat& format);
+
+std::size_t ktx2_level_bytes(const GlTextureFormat& format, int width, int height);
+
+// Copy of an uncompressed level with its rows in the opposite order, for
+// uploading a top-left origin file.
+std::vector<unsigned char> flip_level_rows(const GlTextureFormat& format,
+    const unsigned char* data, int width, int height);
+
+bool read_ktx2(const std::string& path, Ktx2Image& image);
+
+// Where a level's bytes sit in the file.
+struct Ktx2Level {
+  std::size_t offset;
+  std::size_t length;
+};
+
+// Validates a KTX2 file already in memory (e.g. mapped) and fills in
+// everything but the level data, which `levels` locates instead, so levels
+// can be read one at a time. `name` is only used in messages. Offsets,
+// lengths and the level count are checked against `size` and the image
+// dimensions, so a crafted index cannot point outside the bytes.
+bool parse_ktx2(const unsigned char* bytes, std::size_t size,
+    const std::string& name, Ktx2Image& image, std::vector<Ktx2Level>& levels);
+
+bool write_ktx2(const std::string& path, const Ktx2Image& image);
+
+const std::string* find_metadata(const Ktx2Image& image, const std::string& key);
+
+// GL thread. Uploads every level with glCompressedTexImage2D (or
+// glTexImage2D for plain RGBA) and returns the texture, or 0 when the
+// format is not supported so the caller can fall back to another file.
+GLuint upload_ktx2(const Ktx2Image& image);
+
+} // namespace texture
+
+#endif
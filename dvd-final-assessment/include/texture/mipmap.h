@@ -0,0 +1,45 @@
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include <string>
+
+#include "../threading/thread_pool.h"
+#include "ktx2.h"
+
+namespace texture {
+
+enum class MipFilter { BOX, KAISER, LANCZOS };
+
+struct MipOptions {
+  MipFilter filter { MipFilter::KAISER };
+  // Treat colour as sRGB: filter in linear light and re-encode, so mips do
+  // not darken. Alpha is always linear.
+  bool srgb { true };
+};
+
+const char* mip_filter_name(MipFilter filter);
+
+// Builds the full chain down to 1x1 from RGBA8 pixels. Each level is made
+// from the previous one with a separable filter, weighting colour by alpha
+// so transparent texels do not bleed in. Rows are split across `pool` when
+// given; without one the chain is built on the calling thread.
+//
+// Returns an R8G8B8A8 image (sRGB or UNORM to match options) ready for
+// upload_ktx2 or write_ktx2.
+Ktx2Image generate_mipmaps(const unsigned char* rgba, int width, int height,
+    const MipOptions& options = {}, threading::ThreadPool* pool = nullptr);
+
+// Loads an image with its mip chain, using the cached chain at
+// mip_cache_path(path) when it was built from the same file with the same
+// options, and otherwise decoding, generating and writing that cache. Rows
+// are stored bottom to top, as the GL loaders expect.
+bool load_mipmapped_image(const std::string& path, Ktx2Image& image,
+    const MipOptions& options = {}, threading::ThreadPool* pool = nullptr);
+
+// A KTX2 file in the build directory's mip-cache (the system temp directory
+// when built without CMake), never next to the source.
+std::string mip_cache_path(const std::string& path);
+
+} // namespace texture
+
+#endif
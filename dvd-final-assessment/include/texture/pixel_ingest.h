@@ -0,0 +1,87 @@
+#ifndef PIXEL_INGEST_H
+#define PIXEL_INGEST_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../../lib/include/glad/glad.h"
+
+namespace threading {
+class ThreadPool;
+}
+
+namespace texture {
+
+struct PixelFormat {
+  GLenum internal_format;
+  GLenum format;
+  int channels;
+};
+
+// GL formats matching what stb_image decoded: 1 grey, 2 grey + alpha,
+// 3 RGB, 4 RGBA. sRGB variants apply to 3 and 4 channels only.
+PixelFormat pixel_format_for(int channels, bool srgb = false);
+
+// Largest GL_UNPACK_ALIGNMENT (8, 4, 2 or 1) that rows of this size
+// satisfy, so tightly packed RGB rows with odd widths upload correctly.
+int unpack_alignment(std::size_t row_bytes);
+
+enum class PixelKernel { SCALAR, SSSE3, AVX2 };
+
+PixelKernel best_pixel_kernel();
+bool pixel_kernel_supported(PixelKernel kernel);
+const char* pixel_kernel_name(PixelKernel kernel);
+
+// Every kernel produces the same bytes as the scalar path.
+void expand_rgb_to_rgba(const unsigned char* rgb, unsigned char* rgba,
+    std::size_t texels, PixelKernel kernel = best_pixel_kernel());
+
+// Rounds c * a / 255 exactly; alpha is left unchanged.
+void premultiply_alpha(unsigned char* rgba, std::size_t texels,
+    PixelKernel kernel = best_pixel_kernel());
+
+struct IngestOptions {
+  // Grey, grey + alpha and RGB become RGBA8, the layout every later stage
+  // (mips, atlas, block compression) expects.
+  bool expand_to_rgba { true };
+  bool premultiply_alpha { false };
+  // Bottom row first, the GL convention. Replaces stb_image's global flip
+  // so the decode threads never depend on shared state.
+  bool flip_vertically { true };
+  bool srgb { false };
+};
+
+struct IngestedImage {
+  int width {};
+  int height {};
+  PixelFormat format {};
+  std::vector<unsigned char> pixels;
+};
+
+// One pass per row: flip, expand and premultiply, with rows split across
+// `pool` when given.
+IngestedImage ingest_pixels(const unsigned char* pixels, int width,
+    int height, int channels, const IngestOptions& options = {},
+    threading::ThreadPool* pool = nullptr);
+
+// Decodes with stb_image at the file's own channel count, then ingests.
+bool load_image(const std::string& path, IngestedImage& image,
+    const IngestOptions& options = {}, threading::ThreadPool* pool = nullptr);
+
+// The same for an encoded image already in memory (e.g. embedded in a GLB).
+// Returns false without printing when the bytes do not decode.
+bool decode_image(const unsigned char* encoded, std::size_t size,
+    IngestedImage& image, const IngestOptions& options = {},
+    threading::ThreadPool* pool = nullptr);
+
+// GL thread. Uploads tightly packed rows to `level` of the bound
+// GL_TEXTURE_2D with the matching unpack alignment, and swizzles grey
+// formats so they sample as grey. Every loader's levels go through here.
+void upload_pixels(const unsigned char* pixels, int width, int height,
+    const PixelFormat& format, GLint level = 0);
+void upload_image(const IngestedImage& image, GLint level = 0);
+
+} // namespace texture
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef CHASE_LEV_DEQUE_H
+#define CHASE_LEV_DEQUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace threading {
+
+// Fixed-capacity Chase-Lev work-stealing deque of pointers, with the memory
+// orderings from Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models". The owning thread pushes and pops at the bottom; any other
+// thread may steal from the top.
+template <typename T, std::size_t Capacity> class ChaseLevDeque {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+      "capacity must be a power of two");
+
+public:
+  ChaseLevDeque()
+  {
+    for (auto& slot : buffer)
+      slot.store(nullptr, std::memory_order_relaxed);
+  }
+
+  // Owner only. Returns false when full.
+  bool push(T* item)
+  {
+    std::int64_t b = bottom.load(std::memory_order_relaxed);
+    std::int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= static_cast<std::int64_t>(Capacity))
+      return false;
+
+    buffer[b & MASK].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Owner only. Newest item first.
+  T* pop()
+  {
+    std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T* item = buffer[b & MASK].load(std::memory_order_relaxed);
+    if (t == b) {
+      if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+              std::memory_order_relaxed))
+        item = nullptr;
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return item;
+  }
+
+  // Any thread. Oldest item first; nullptr when empty or when another thief
+  // won the race.
+  T* steal()
+  {
+    std::int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+      return nullptr;
+
+    T* item = buffer[t & MASK].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return nullptr;
+
+    return item;
+  }
+
+  // Approximate; only meaningful on the owning thread.
+  std::int64_t size() const
+  {
+    return bottom.load(std::memory_order_relaxed)
+        - top.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr std::int64_t MASK = static_cast<std::int64_t>(Capacity) - 1;
+
+  alignas(64) std::atomic<std::int64_t> top { 0 };
+  alignas(64) std::atomic<std::int64_t> bottom { 0 };
+  alignas(64) std::array<std::atomic<T*>, Capacity> buffer;
+};
+
+} // namespace threading
+
+#endif
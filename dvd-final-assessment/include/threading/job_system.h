@@ -0,0 +1,157 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chase_lev_deque.h"
+
+namespace threading {
+
+constexpr std::size_t JOB_PAYLOAD_BYTES { 64 };
+constexpr std::size_t MAX_JOBS_PER_THREAD { 4096 };
+
+// A unit of work. `unfinished` counts the job itself plus every child that
+// has not finished yet, so waiting on a parent waits on the whole tree.
+struct alignas(64) Job {
+  void (*function)(Job&);
+  Job* parent;
+  std::atomic<std::int32_t> unfinished;
+  alignas(16) unsigned char payload[JOB_PAYLOAD_BYTES];
+};
+
+// Work-stealing scheduler. Every thread owns a Chase-Lev deque; it runs its
+// own jobs newest-first and steals the oldest job from a random victim when
+// it runs dry.
+//
+// Jobs come from a per-thread ring of MAX_JOBS_PER_THREAD slots, so no more
+// than that many jobs created by one thread may be alive at once. Only the
+// thread that constructed the system and the workers may create, run or wait
+// on jobs (asserted), and that thread destroys it, running any jobs still
+// queued.
+class JobSystem {
+public:
+  explicit JobSystem(
+      unsigned int thread_count = std::thread::hardware_concurrency(),
+      bool pin_to_cores = false);
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  unsigned int size() const { return static_cast<unsigned int>(queues.size()); }
+
+  // `work` must fit in the payload and be trivially destructible, which
+  // covers lambdas capturing pointers, references and small values.
+  template <typename F> Job* create_job(F&& work, Job* parent = nullptr);
+
+  void run(Job* job);
+
+  // Runs other jobs on this thread until `job` and all its children finish.
+  void wait(Job* job);
+
+  // Calls body(begin, end) over [0, count). Ranges are split lazily: a job
+  // halves its range only when its own deque has been emptied by thieves, so
+  // chunking adapts to how busy the other threads are. No chunk is smaller
+  // than `min_chunk`.
+  template <typename F>
+  void parallel_for(std::size_t count, const F& body, std::size_t min_chunk = 1);
+
+private:
+  struct alignas(64) ThreadQueue {
+    ChaseLevDeque<Job, MAX_JOBS_PER_THREAD> deque;
+    std::unique_ptr<Job[]> jobs { new Job[MAX_JOBS_PER_THREAD] };
+    std::uint32_t next_job {};
+    std::uint32_t random_state {};
+  };
+
+  Job* allocate_job(Job* parent);
+  Job* find_job();
+  void execute(Job* job);
+  void finish(Job* job);
+  void worker_loop(unsigned int index);
+  ThreadQueue& local_queue();
+
+  template <typename F>
+  void split_range(std::size_t begin, std::size_t end, std::size_t grain,
+      const F& body, Job* root);
+
+  std::vector<std::unique_ptr<ThreadQueue>> queues;
+  std::vector<std::thread> workers;
+
+  std::atomic<bool> stopping { false };
+  std::atomic<int> sleeping { 0 };
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_signal;
+};
+
+template <typename F> Job* JobSystem::create_job(F&& work, Job* parent)
+{
+  using Work = std::decay_t<F>;
+  static_assert(sizeof(Work) <= JOB_PAYLOAD_BYTES, "job payload too large");
+  static_assert(alignof(Work) <= 16, "job payload over-aligned");
+  static_assert(std::is_trivially_destructible_v<Work>,
+      "job payload must be trivially destructible");
+
+  Job* job = allocate_job(parent);
+  new (job->payload) Work(std::forward<F>(work));
+  job->function = [](Job& self) {
+    (*std::launder(reinterpret_cast<Work*>(self.payload)))();
+  };
+
+  return job;
+}
+
+template <typename F>
+void JobSystem::parallel_for(
+    std::size_t count, const F& body, std::size_t min_chunk)
+{
+  if (count == 0)
+    return;
+
+  // Start from a few chunks per thread; lazy splitting refines from there.
+  std::size_t grain = std::max<std::size_t>(
+      std::max<std::size_t>(min_chunk, 1), count / (size() * 64));
+
+  Job* root = create_job([] {});
+  split_range(0, count, grain, body, root);
+  finish(root);
+  wait(root);
+}
+
+template <typename F>
+void JobSystem::split_range(std::size_t begin, std::size_t end,
+    std::size_t grain, const F& body, Job* root)
+{
+  while (end - begin > grain) {
+    if (local_queue().deque.size() > 0) {
+      body(begin, begin + grain);
+      begin += grain;
+      continue;
+    }
+
+    std::size_t middle = begin + (end - begin) / 2;
+    run(create_job(
+        [this, middle, end, grain, &body, root] {
+          split_range(middle, end, grain, body, root);
+        },
+        root));
+    end = middle;
+  }
+
+  body(begin, end);
+}
+
+} // namespace threading
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "job_system.h"
+
+namespace threading {
+
+template <typename T = void> class Task;
+
+namespace detail {
+
+  struct TaskPromiseBase {
+    // Resumed when the task finishes; empty for a spawned task, which frees
+    // itself instead.
+    std::coroutine_handle<> continuation;
+    bool detached {};
+
+    struct FinalAwaiter {
+      bool await_ready() const noexcept { return false; }
+
+      template <typename Promise>
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<Promise> handle) noexcept
+      {
+        TaskPromiseBase& promise = handle.promise();
+        if (promise.continuation)
+          return promise.continuation;
+        if (promise.detached)
+          handle.destroy();
+        return std::noop_coroutine();
+      }
+
+      void await_resume() const noexcept { }
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    // Failures are results, as everywhere else in the engine; an exception
+    // escaping a task is a bug.
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+
+  template <typename T> struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    template <typename U> void return_value(U&& result)
+    {
+      value.emplace(std::forward<U>(result));
+    }
+    T take() { return std::move(*value); }
+  };
+
+  template <> struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept { }
+    void take() const noexcept { }
+  };
+
+} // namespace detail
+
+// A coroutine that produces a T. Tasks are lazy: nothing runs until the
+// task is awaited, which starts it on the awaiting thread and resumes the
+// awaiter, wherever the task happens to finish, through symmetric transfer
+// (so long chains of synchronous tasks do not grow the stack).
+//
+// Where a task runs is decided by what it awaits: Vfs::read_async resumes
+// on the mounting thread, switch_to() on a job system worker,
+// ResumeQueue::schedule() on the queue's thread and FenceQueue on the GL
+// thread. Move-only; destroying a task that has not finished destroys the
+// coroutine with it.
+template <typename T> class Task {
+public:
+  using promise_type = detail::TaskPromise<T>;
+
+  Task() = default;
+  explicit Task(std::coroutine_handle<promise_type> handle)
+      : handle(handle)
+  {
+  }
+  Task(Task&& other) noexcept
+      : handle(std::exchange(other.handle, {}))
+  {
+  }
+  Task& operator=(Task&& other) noexcept
+  {
+    if (this != &other) {
+      if (handle)
+        handle.destroy();
+      handle = std::exchange(other.handle, {});
+    }
+    return *this;
+  }
+  ~Task()
+  {
+    if (handle)
+      handle.destroy();
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  bool valid() const { return static_cast<bool>(handle); }
+
+  auto operator co_await() && noexcept
+  {
+    struct Awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() const noexcept { return false; }
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<> awaiting) noexcept
+      {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      T await_resume() { return handle.promise().take(); }
+    };
+    return Awaiter { handle };
+  }
+
+  // Hands the coroutine over to whoever finishes it; see spawn().
+  std::coroutine_handle<promise_type> release()
+  {
+    return std::exchange(handle, {});
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle;
+};
+
+namespace detail {
+
+  template <typename T> Task<T> TaskPromise<T>::get_return_object() noexcept
+  {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+  }
+
+  inline Task<void> TaskPromise<void>::get_return_object() noexcept
+  {
+    return Task<void>(
+        std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+  }
+
+} // namespace detail
+
+// Starts a task on this thread without waiting for it. The coroutine frees
+// itself when it finishes, so whatever it refers to must outlive it.
+inline void spawn(Task<void> task)
+{
+  auto handle = task.release();
+  handle.promise().detached = true;
+  handle.resume();
+}
+
+// Coroutines waiting to continue on one particular thread, typically the GL
+// thread. Any thread may schedule onto the queue; the owning thread resumes
+// them from drain(), once a frame. Coroutines that schedule again while
+// being drained wait for the next drain, so a loop that keeps yielding
+// cannot starve the frame.
+class ResumeQueue {
+public:
+  struct Awaiter {
+    ResumeQueue& queue;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      queue.push(handle);
+    }
+    void await_resume() const noexcept { }
+  };
+
+  Awaiter schedule() { return { *this }; }
+
+  void push(std::coroutine_handle<> handle);
+
+  // Owning thread. Returns how many coroutines were resumed.
+  std::size_t drain();
+  std::size_t pending() const;
+
+private:
+  mutable std::mutex mutex;
+  std::vector<std::coroutine_handle<>> waiting;
+  std::vector<std::coroutine_handle<>> running;
+};
+
+// Resumes the awaiting coroutine as a job on `jobs`, for CPU work (decoding,
+// mip generation) that must stay off the frame loop. Same restriction as
+// JobSystem::run: only await this on the thread that constructed the
+// system or on one of its workers, and the system needs at least one
+// worker thread, as the constructing thread only runs jobs while it waits.
+inline auto switch_to(JobSystem& jobs)
+{
+  struct Awaiter {
+    JobSystem& jobs;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      jobs.run(jobs.create_job([handle] { handle.resume(); }));
+    }
+    void await_resume() const noexcept { }
+  };
+  return Awaiter { jobs };
+}
+
+namespace detail {
+
+  struct SyncWaitState {
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done {};
+  };
+
+  template <typename T>
+  Task<void> signal_when_done(
+      Task<T> task, std::optional<T>& result, SyncWaitState& state)
+  {
+    result.emplace(co_await std::move(task));
+    // Notified under the lock: the waiter cannot return, and take the
+    // state with it, until the lock is released.
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.done = true;
+    state.finished.notify_one();
+  }
+
+  inline Task<void> signal_when_done(Task<void> task, SyncWaitState& state)
+  {
+    co_await std::move(task);
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.done = true;
+    state.finished.notify_one();
+  }
+
+} // namespace detail
+
+// Blocks until the task finishes and returns its result. For tools,
+// benchmarks and start-up; never call it on a thread whose ResumeQueue (or
+// Vfs::update) the task needs, as nothing would drain it.
+template <typename T> T sync_wait(Task<T> task)
+{
+  detail::SyncWaitState state;
+  if constexpr (std::is_void_v<T>) {
+    spawn(detail::signal_when_done(std::move(task), state));
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&state] { return state.done; });
+  } else {
+    std::optional<T> result;
+    spawn(detail::signal_when_done(std::move(task), result, state));
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&state] { return state.done; });
+    return std::move(*result);
+  }
+}
+
+} // namespace threading
+
+#endif
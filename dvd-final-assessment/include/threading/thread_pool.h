@@ -0,0 +1,58 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace threading {
+
+// Fixed set of worker threads that split a range into chunks. The calling
+// thread takes part in the work, so a pool of N runs N-1 extra threads.
+// parallel_for is meant to be called from one thread at a time.
+class ThreadPool {
+public:
+  explicit ThreadPool(
+      unsigned int thread_count = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  unsigned int size() const
+  {
+    return static_cast<unsigned int>(workers.size()) + 1;
+  }
+
+  // Calls body(begin, end) for every `chunk_size` slice of [0, count) and
+  // returns once all slices are done.
+  void parallel_for(std::size_t count, std::size_t chunk_size,
+      const std::function<void(std::size_t, std::size_t)>& body);
+
+private:
+  void worker_loop();
+  void run_chunks();
+
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+
+  const std::function<void(std::size_t, std::size_t)>* job {};
+  std::size_t job_count {};
+  std::size_t job_chunk {};
+  std::atomic<std::size_t> next_chunk {};
+  std::size_t pending_workers {};
+  std::uint64_t generation {};
+  bool stopping {};
+};
+
+} // namespace threading
+
+#endif
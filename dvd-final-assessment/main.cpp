@@ -10,23 +10,40 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 
-#include "lib/stb_image.hpp"
+#include "include/asset/vfs.h"
+#include "include/gl_object/gl_object.h"
+#include "include/resource/hot_reload.h"
+#include "include/resource/resource_cache.h"
+#include "include/simulation/bounce_events.h"
+#include "include/simulation/dvd_simulation.h"
+#include "include/simulation/fixed_timestep.h"
+#include "include/texture/async_texture_loader.h"
+#include "include/texture/ktx2.h"
+#include "include/texture/mipmap.h"
+#include "include/texture/pixel_ingest.h"
+#include "include/threading/task.h"
 
-#include <fstream>
 #include <iostream>
-#include <sstream>
+#include <map>
 #include <string_view>
 
 constexpr int WINDOW_WIDTH { 800 };
 constexpr int WINDOW_HEIGHT { 600 };
 
-void log_shader_error(
-    const unsigned int shader, const std::string& message = "")
+constexpr double SIMULATION_TICK_RATE { 120.0 };
+constexpr int MAX_CATCH_UP_STEPS { 8 };
+
+// Passing this evaluates the logo in closed form from the wall-hit schedule
+// instead of stepping it every frame.
+constexpr std::string_view EVENT_DRIVEN_FLAG { "--event-driven" };
+
+void log_program_error(
+    const unsigned int program, const std::string& message = "")
 {
   const unsigned int LOG_BUFFER_SIZE_BYTES = 512;
   char log_info[LOG_BUFFER_SIZE_BYTES];
 
-  glGetShaderInfoLog(shader, LOG_BUFFER_SIZE_BYTES, nullptr, log_info);
+  glGetProgramInfoLog(program, LOG_BUFFER_SIZE_BYTES, nullptr, log_info);
 
   if (!message.empty()) {
     std::cout << message << std::endl;
@@ -36,6 +53,39 @@ void log_shader_error(
   std::exit(EXIT_FAILURE);
 }
 
+// Compiles and links a program for a hot reload. Unlike start-up, a broken
+// edit must not end the program, so failures print and return 0.
+GLuint link_program(
+    const std::string& vertex_source, const std::string& fragment_source)
+{
+  const GLuint vertex
+      = resource::compile_shader(vertex_source, GL_VERTEX_SHADER, "vertex.vs");
+  const GLuint fragment = resource::compile_shader(
+      fragment_source, GL_FRAGMENT_SHADER, "fragment.fs");
+  GLuint program = 0;
+
+  if (vertex && fragment) {
+    program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+
+    int linked {};
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+      char log_info[512];
+      glGetProgramInfoLog(program, sizeof(log_info), nullptr, log_info);
+      std::cout << "Error::Shader::Program::Linking\n" << log_info << std::endl;
+      glDeleteProgram(program);
+      program = 0;
+    }
+  }
+
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+  return program;
+}
+
 void processInputs(GLFWwindow* window)
 {
   if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
@@ -51,27 +101,85 @@ unsigned int uniform_locator(GLuint shader_program, const GLchar* name)
   return uniform_located;
 }
 
-std::string get_absolute_path(const std::string& relative_path)
+// The build directory, wherever the program is started from.
+std::filesystem::path executable_directory()
 {
-  return std::filesystem::current_path().string() + "/" + relative_path;
+  std::error_code error;
+  const auto executable = std::filesystem::read_symlink("/proc/self/exe", error);
+  return error ? std::filesystem::current_path() : executable.parent_path();
 }
 
-std::string read_from_file(const std::string& filepath)
+// The shaders compiled into the binary come first, so the app starts with
+// no file I/O for them, wherever the binary is. Then the baked output (the
+// logo's BC7 copy) and the sources next to the build directory: the logo
+// PNG, which is not embedded, resolves to a file there, so it streams in
+// through the async loader and is watched for hot reload. The packed
+// archive (mapped, with the logo's mips already built) serves what the
+// source tree no longer has.
+//
+// Setting DVD_ASSET_DIR (e.g. to the source directory) mounts that
+// directory ahead of everything, embedded files included, so edited
+// shaders are used and hot reloaded without a rebuild.
+void mount_assets(asset::Vfs& assets)
 {
-  std::string file_contents;
-  std::ifstream file;
-  std::stringstream ss;
+  const auto build = executable_directory();
+  const auto source = build.parent_path();
+
+  if (const char* live = std::getenv("DVD_ASSET_DIR"))
+    assets.mount_directory(live);
+
+  assets.mount_embedded(asset::embedded_assets, asset::embedded_asset_count);
 
-  file.open(filepath);
-  if (!file.is_open()) {
-    std::cout << "failed to load file: " << filepath << "\n";
+  if (std::filesystem::is_directory(build / "baked"))
+    assets.mount_directory((build / "baked").string());
+  if (std::filesystem::is_directory(source / "texture"))
+    assets.mount_directory((source / "texture").string(), "texture");
+  assets.mount_directory(source.string(), "", false);
+  if (std::filesystem::exists(build / "assets.pak"))
+    assets.mount_archive((build / "assets.pak").string());
+}
+
+// Loads the block-compressed logo without holding up the first frame: the
+// file is read on the Vfs I/O thread, parsed on a job and uploaded back on
+// the GL thread. `texture` stays 0 when the file is missing or unsupported.
+threading::Task<void> load_compressed_logo(asset::Vfs& assets,
+    threading::JobSystem& jobs, threading::ResumeQueue& gl_thread,
+    GLuint& texture)
+{
+  const std::string path = "texture/dvd-logo.ktx2";
+  if (!assets.exists(path))
+    co_return;
+
+  const asset::VfsFile file = co_await assets.read_async(path);
+  if (!file.ok)
+    co_return;
+
+  co_await threading::switch_to(jobs);
+  texture::Ktx2Image image;
+  std::vector<texture::Ktx2Level> levels;
+  if (!texture::parse_ktx2(file.data(), file.size(), path, image, levels))
+    co_return;
+  for (const auto& level : levels) {
+    image.levels.emplace_back(file.data() + level.offset,
+        file.data() + level.offset + level.length);
   }
 
-  ss << file.rdbuf();
-  file_contents = ss.str();
-  file.close();
+  co_await gl_thread.schedule();
+  texture = texture::upload_ktx2(image);
+}
+
+// Maps a lattice position (pixels from the low walls of the free area) to the
+// logo centre in normalized device coordinates.
+simulation::DvdState lattice_to_ndc(const simulation::LogoPosition& position,
+    const simulation::DvdLogo& logo, const simulation::Bounds& bounds)
+{
+  float pixel_x = (bounds.right - bounds.left) / WINDOW_WIDTH;
+  float pixel_y = (bounds.top - bounds.bottom) / WINDOW_HEIGHT;
 
-  return file_contents;
+  return { bounds.left + logo.half_width
+          + static_cast<float>(position.x) * pixel_x,
+    bounds.bottom + logo.half_height + static_cast<float>(position.y) * pixel_y,
+    position.direction_x * pixel_x, position.direction_y * pixel_y };
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
@@ -79,8 +187,18 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
   glViewport(0, 0, width, height);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+  bool event_driven = false;
+  for (int i = 1; i < argc; i++) {
+    if (argv[i] == EVENT_DRIVEN_FLAG) {
+      event_driven = true;
+    } else {
+      std::cout << "usage: " << argv[0] << " [" << EVENT_DRIVEN_FLAG << "]\n";
+      std::exit(EXIT_FAILURE);
+    }
+  }
+
   if (!glfwInit()) {
     std::cout << "Failed to initialize glfw\n";
     std::exit(EXIT_FAILURE);
@@ -109,128 +227,197 @@ int main()
 
   glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-  auto vertex_shader_path = get_absolute_path("../vertex.vs");
-  auto fragment_shader_path = get_absolute_path("../fragment.fs");
+  asset::Vfs assets;
+  mount_assets(assets);
+  resource::ResourceCache resources(256 << 20, &assets);
 
-  auto read_vshader_source = read_from_file(vertex_shader_path);
-  const char* vertex_shader_source = read_vshader_source.c_str();
+  const auto vertex_shader = resources.shader("vertex.vs");
+  const auto fragment_shader = resources.shader("fragment.fs");
 
-  auto read_fshader_source = read_from_file(fragment_shader_path);
-  auto fragment_shader_source = read_fshader_source.c_str();
+  if (!vertex_shader || !fragment_shader) {
+    glfwTerminate();
+    std::exit(EXIT_FAILURE);
+  }
 
   const GLfloat gl_data[] = { 0.1f, 0.1f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
     0.1f, -0.1f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, -0.1f, -0.1f, 0.0f, 0.0f,
     0.0f, 1.0f, 0.0f, 0.0f, -0.1f, 0.1f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f };
 
-  const unsigned int indices[] = { 0, 1, 3, 1, 2, 3 };
-
-  GLuint vertex_array_object, vertex_buffer_object, element_buffer_object;
-  glGenVertexArrays(1, &vertex_array_object);
-  glBindVertexArray(vertex_array_object);
-
-  glGenBuffers(1, &vertex_buffer_object);
-  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(gl_data), gl_data, GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer_object);
-  glBufferData(
-      GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(
-      1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(
-      2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-
-  GLuint texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-  glTexParameteri(
-      GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  int width, height, nr_channels;
-  stbi_set_flip_vertically_on_load(true);
-
-  auto texture_image_path = get_absolute_path("../texture/dvd-logo.png");
-  unsigned char* tex_data
-      = stbi_load(texture_image_path.c_str(), &width, &height, &nr_channels, 0);
-
-  if (tex_data) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB,
-        GL_UNSIGNED_BYTE, tex_data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
-  }
-  stbi_image_free(tex_data);
+  const GLuint indices[] = { 0, 1, 3, 1, 2, 3 };
+
+  gl_object::VAO vertex_array_object;
+  vertex_array_object.bind_vao();
+
+  gl_object::VBO vertex_buffer_object(gl_data, sizeof(gl_data));
+  gl_object::EBO element_buffer_object(indices, sizeof(indices));
+
+  const GLsizei stride = 8 * sizeof(float);
+  vertex_array_object.link_attribute(vertex_buffer_object, 0, 3, stride, 0);
+  vertex_array_object.link_attribute(
+      vertex_buffer_object, 1, 2, stride, 3 * sizeof(float));
+  vertex_array_object.link_attribute(
+      vertex_buffer_object, 2, 2, stride, 6 * sizeof(float));
+
+  // A logo on disk streams in through the async loader; the archived one
+  // (no source tree next to the build) is in memory and goes through the
+  // cache.
+  texture::AsyncTextureLoader texture_loader;
+  const auto logo_path = assets.native_path("texture/dvd-logo.png");
+  resource::Handle<resource::TextureResource> resident_logo;
+  texture::TextureId dvd_logo_texture {};
+  if (logo_path.empty())
+    resident_logo = resources.texture("texture/dvd-logo.png");
+  else
+    dvd_logo_texture = texture_loader.request(logo_path);
+  bool texture_report_printed = false;
+
+  // A block-compressed logo from bake or texture-compressor takes a quarter
+  // of the memory; the PNG is drawn until it arrives, and instead of it when
+  // it is missing or unsupported. The queue is declared first so it outlives
+  // the workers: a job still parsing when the window closes schedules onto
+  // it while the JobSystem joins.
+  threading::ResumeQueue gl_thread;
+  threading::JobSystem jobs(2);
+  GLuint compressed_logo_texture = 0;
+  threading::spawn(load_compressed_logo(
+      assets, jobs, gl_thread, compressed_logo_texture));
+
   glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, texture);
 
   auto program_shader { glCreateProgram() };
 
-  auto vertex_shader { glCreateShader(GL_VERTEX_SHADER) };
-
-  auto fragment_shader { glCreateShader(GL_FRAGMENT_SHADER) };
-
-  glShaderSource(vertex_shader, 1, &vertex_shader_source, nullptr);
-  glShaderSource(fragment_shader, 1, &fragment_shader_source, nullptr);
+  int link_flag {};
 
-  int compile_flag {};
-
-  glCompileShader(vertex_shader);
-  glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &compile_flag);
-
-  if (!compile_flag) {
-    log_shader_error(vertex_shader, "Error::Shader::Vertex::Compilation");
-  }
-
-  glCompileShader(fragment_shader);
-  glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &compile_flag);
-
-  if (!compile_flag) {
-    log_shader_error(fragment_shader, "Error::Shader::Fragment::Compilation");
-  }
-
-  glAttachShader(program_shader, vertex_shader);
-  glAttachShader(program_shader, fragment_shader);
+  glAttachShader(program_shader, vertex_shader->shader);
+  glAttachShader(program_shader, fragment_shader->shader);
 
   glLinkProgram(program_shader);
-  glGetShaderiv(program_shader, GL_LINK_STATUS, &compile_flag);
+  glGetProgramiv(program_shader, GL_LINK_STATUS, &link_flag);
 
-  if (!compile_flag) {
-    log_shader_error(program_shader, "Error::Shader::Program::Linking");
+  if (!link_flag) {
+    log_program_error(program_shader, "Error::Shader::Program::Linking");
   }
 
   glValidateProgram(program_shader);
   glUseProgram(program_shader);
   glUniform1i(uniform_locator(program_shader, "texture1"), 0);
 
-  float current_frame {}, last_frame {}, delta_frame {};
-
-  glm::vec2 dvd_texture_position(0.0f, 0.0f);
-  glm::vec2 dvd_texture_velocity(0.001f, 0.001f);
+  double current_frame {}, last_frame { glfwGetTime() }, delta_frame {};
 
   auto transform_loc = uniform_locator(program_shader, "transform");
-  glm::mat4 trans = glm::mat4(1.0f);
 
-  float dvd_texture_halfwidth = 0.1f;
-  float dvd_texture_halfheight = 0.1f;
+  // Edits to files on disk (see DVD_ASSET_DIR) are picked up while running:
+  // a shader or anything it includes relinks the program, and the logo is
+  // decoded again. Embedded files never change and are not watched.
+  resource::HotReloader reloader(assets);
+  std::map<std::string, std::string> shader_sources;
+  GLuint reloaded_logo_texture = 0;
+
+  const resource::ReloadRecipe shader_recipe {
+    [&assets](const std::string& path, resource::ReloadPayload& payload) {
+      std::string source;
+      if (!resource::load_shader_source(
+              &assets, path, source, &payload.dependencies))
+        return false;
+      payload.data = std::move(source);
+      return true;
+    },
+    [&shader_sources](const std::string& path, resource::ReloadPayload& payload) {
+      shader_sources[path] = std::any_cast<std::string&>(payload.data);
+      return true;
+    }
+  };
+  for (const char* path : { "vertex.vs", "fragment.fs" }) {
+    std::vector<std::string> includes;
+    resource::load_shader_source(&assets, path, shader_sources[path], &includes);
+    reloader.add(path, shader_recipe, includes);
+  }
 
-  const float WINDOW_LEFT = -1.0f;
-  const float WINDOW_RIGHT = 1.0f;
-  const float WINDOW_BOTTOM = -1.0f;
-  const float WINDOW_TOP = 1.0f;
+  // The program only exists through its shaders, so it has nothing to
+  // prepare; relinking needs GL and happens in apply.
+  const resource::ReloadRecipe program_recipe {
+    [](const std::string&, resource::ReloadPayload&) { return true; },
+    [&](const std::string&, resource::ReloadPayload&) {
+      GLuint program = link_program(
+          shader_sources["vertex.vs"], shader_sources["fragment.fs"]);
+      if (!program)
+        return false;
+
+      glDeleteProgram(program_shader);
+      program_shader = program;
+      glUseProgram(program_shader);
+      glUniform1i(uniform_locator(program_shader, "texture1"), 0);
+      transform_loc = uniform_locator(program_shader, "transform");
+      return true;
+    }
+  };
+  reloader.add("dvd-logo.program", program_recipe, { "vertex.vs", "fragment.fs" });
+
+  const resource::ReloadRecipe logo_recipe {
+    [&assets](const std::string& path, resource::ReloadPayload& payload) {
+      asset::VfsFile file;
+      texture::IngestedImage image;
+      if (!assets.read(path, file)
+          || !texture::decode_image(file.data(), file.size(), image))
+        return false;
+
+      payload.data = texture::generate_mipmaps(
+          image.pixels.data(), image.width, image.height);
+      return true;
+    },
+    [&reloaded_logo_texture](
+        const std::string&, resource::ReloadPayload& payload) {
+      GLuint logo = texture::upload_ktx2(
+          std::any_cast<texture::Ktx2Image&>(payload.data));
+      if (!logo)
+        return false;
+
+      glDeleteTextures(1, &reloaded_logo_texture);
+      reloaded_logo_texture = logo;
+      return true;
+    }
+  };
+  reloader.add("texture/dvd-logo.png", logo_recipe);
+
+  glm::mat4 trans = glm::mat4(1.0f);
+
+  const simulation::DvdLogo dvd_logo { 0.1f, 0.1f };
+  const simulation::Bounds window_bounds { -1.0f, 1.0f, -1.0f, 1.0f };
+
+  simulation::DvdState dvd_state { 0.0f, 0.0f, 0.6f, 0.45f };
+  simulation::DvdState previous_dvd_state = dvd_state;
+
+  simulation::FixedTimestep timestep(SIMULATION_TICK_RATE, MAX_CATCH_UP_STEPS);
+
+  const std::int64_t logo_width_px = static_cast<std::int64_t>(
+      dvd_logo.half_width * WINDOW_WIDTH);
+  const std::int64_t logo_height_px = static_cast<std::int64_t>(
+      dvd_logo.half_height * WINDOW_HEIGHT);
+
+  simulation::BounceScheduler bounce_scheduler;
+  const auto lattice_logo = bounce_scheduler.logo(bounce_scheduler.add(
+      { WINDOW_WIDTH - logo_width_px, WINDOW_HEIGHT - logo_height_px,
+          (WINDOW_WIDTH - logo_width_px) / 2,
+          (WINDOW_HEIGHT - logo_height_px) / 2, 240, 135 }));
+
+  if (event_driven) {
+    auto corner = simulation::next_corner_hit(
+        lattice_logo, simulation::exact_seconds(0), true);
+    if (corner) {
+      std::cout << "next corner hit at " << corner->time.seconds() << " s ("
+                << (corner->top ? "top" : "bottom") << "-"
+                << (corner->right ? "right" : "left") << ")" << std::endl;
+    } else {
+      std::cout << "this logo never hits a corner" << std::endl;
+    }
+  }
 
   while (!glfwWindowShouldClose(window)) {
     processInputs(window);
+    // Between frames, so nothing is still drawing with what gets replaced.
+    reloader.update();
+    assets.update();
+    gl_thread.drain();
 
     glClear(GL_COLOR_BUFFER_BIT);
     glClearColor(0.3f, 0.3f, 0.9f, 1.0f);
@@ -239,45 +426,69 @@ int main()
     delta_frame = current_frame - last_frame;
     last_frame = current_frame;
 
-    if (dvd_texture_position.x - dvd_texture_halfwidth < WINDOW_LEFT) {
-      dvd_texture_velocity.x = -dvd_texture_velocity.x;
-
-    } else if (dvd_texture_position.x + dvd_texture_halfwidth > WINDOW_RIGHT) {
-      dvd_texture_velocity.x = -dvd_texture_velocity.x;
+    simulation::DvdState dvd_texture_position {};
+
+    if (event_driven) {
+      simulation::ExactTime now { static_cast<std::int64_t>(
+                                      current_frame * 1000.0),
+        1000 };
+      bounce_scheduler.advance_to(now, [](const simulation::BounceEvent& e) {
+        if (e.axis == simulation::BounceAxis::CORNER)
+          std::cout << "corner hit at " << e.time.seconds() << " s\n";
+      });
+
+      dvd_texture_position = lattice_to_ndc(
+          simulation::position_at(lattice_logo, current_frame), dvd_logo,
+          window_bounds);
+    } else {
+      const int steps = timestep.advance(delta_frame);
+      for (int step = 0; step < steps; step++) {
+        previous_dvd_state = dvd_state;
+        dvd_state = simulation::step_dvd(
+            dvd_state, dvd_logo, window_bounds, timestep.step_seconds());
+      }
+
+      dvd_texture_position = simulation::interpolate(
+          previous_dvd_state, dvd_state, timestep.alpha());
     }
-    if (dvd_texture_position.y - dvd_texture_halfheight < WINDOW_BOTTOM) {
-      dvd_texture_velocity.y = -dvd_texture_velocity.y;
 
-    } else if (dvd_texture_position.y + dvd_texture_halfheight > WINDOW_TOP) {
-      dvd_texture_velocity.y = -dvd_texture_velocity.y;
-    }
-
-    dvd_texture_position += dvd_texture_velocity * delta_frame;
-
-    std::cout << "x: " << dvd_texture_position.x
-              << " y: " << dvd_texture_position.y << std::endl;
-
-    trans = glm::translate(
-        trans, glm::vec3(dvd_texture_position.x, dvd_texture_position.y, 0.0f));
+    trans = glm::translate(glm::mat4(1.0f),
+        glm::vec3(dvd_texture_position.x, dvd_texture_position.y, 0.0f));
 
     glUseProgram(program_shader);
     glUniformMatrix4fv(transform_loc, 1, GL_FALSE, glm::value_ptr(trans));
-    glBindVertexArray(vertex_array_object);
+    vertex_array_object.bind_vao();
 
-    glBindTexture(GL_TEXTURE_2D, texture);
+    texture_loader.update();
+    if (!texture_report_printed && texture_loader.pending() == 0) {
+      texture_loader.print_latency_report();
+      texture_report_printed = true;
+    }
+    if (reloaded_logo_texture)
+      glBindTexture(GL_TEXTURE_2D, reloaded_logo_texture);
+    else if (compressed_logo_texture)
+      glBindTexture(GL_TEXTURE_2D, compressed_logo_texture);
+    else if (resident_logo)
+      glBindTexture(GL_TEXTURE_2D, resident_logo->texture);
+    else
+      glBindTexture(GL_TEXTURE_2D, texture_loader.texture(dvd_logo_texture));
 
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    vertex_array_object.unbind_vao();
 
     glfwPollEvents();
     glfwSwapBuffers(window);
   }
-  glDeleteShader(vertex_shader);
-  glDeleteShader(fragment_shader);
-
-  glDeleteBuffers(1, &vertex_buffer_object);
-  glDeleteBuffers(1, &element_buffer_object);
-  glDeleteVertexArrays(1, &vertex_array_object);
+  resources.print_stats();
+  resources.clear();
+  glDeleteProgram(program_shader);
+
+  vertex_buffer_object.delete_vbo();
+  element_buffer_object.delete_ebo();
+  vertex_array_object.delete_vao();
+  texture_loader.delete_textures();
+  glDeleteTextures(1, &compressed_logo_texture);
+  glDeleteTextures(1, &reloaded_logo_texture);
 
   glfwTerminate();
 }
@@ -0,0 +1,329 @@
+#include "../../include/asset/asset_archive.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr std::array<char, 8> ARCHIVE_MAGIC { 'D', 'V', 'D', 'P', 'A', 'C',
+  'K', '\0' };
+constexpr std::uint32_t ARCHIVE_VERSION { 1 };
+constexpr std::size_t HEADER_BYTES { 64 };
+constexpr std::size_t TOC_ENTRY_BYTES { 64 };
+// Cache line and SIMD friendly; also a multiple of every GL unpack
+// alignment.
+constexpr std::size_t DATA_ALIGNMENT { 64 };
+
+template <typename T> T read_le(const unsigned char* bytes)
+{
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+template <typename T> void write_le(unsigned char* bytes, T value)
+{
+  std::memcpy(bytes, &value, sizeof(T));
+}
+
+std::size_t align_up(std::size_t value, std::size_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+std::uint64_t name_hash(std::string_view name)
+{
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+std::size_t texture_bytes(
+    std::uint32_t width, std::uint32_t height, std::uint32_t level_count)
+{
+  std::size_t bytes = 0;
+  for (std::uint32_t level = 0; level < level_count; level++) {
+    bytes += static_cast<std::size_t>(std::max(1u, width >> level))
+        * std::max(1u, height >> level) * 4;
+  }
+  return bytes;
+}
+
+} // namespace
+
+const char* asset::asset_kind_name(AssetKind kind)
+{
+  switch (kind) {
+  case AssetKind::RAW:
+    return "raw";
+  case AssetKind::SHADER:
+    return "shader";
+  case AssetKind::TEXTURE:
+    return "texture";
+  case AssetKind::MESH:
+    return "mesh";
+  default:
+    return "unknown";
+  }
+}
+
+bool asset::AssetArchive::open(const std::string& path)
+{
+  close();
+
+  if (!file.open(path)) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return false;
+  }
+
+  const unsigned char* bytes = file.data();
+  const std::size_t size = file.size();
+
+  auto reject = [&](const char* reason) {
+    std::cout << "invalid asset archive (" << reason << "): " << path
+              << std::endl;
+    close();
+    return false;
+  };
+
+  if (size < HEADER_BYTES
+      || std::memcmp(bytes, ARCHIVE_MAGIC.data(), ARCHIVE_MAGIC.size()) != 0)
+    return reject("bad magic");
+  if (read_le<std::uint32_t>(bytes + 8) != ARCHIVE_VERSION)
+    return reject("unsupported version");
+
+  const auto entry_count = read_le<std::uint32_t>(bytes + 12);
+  const auto toc_offset = read_le<std::uint64_t>(bytes + 16);
+  const auto strings_offset = read_le<std::uint64_t>(bytes + 24);
+  const auto strings_bytes = read_le<std::uint64_t>(bytes + 32);
+
+  if (read_le<std::uint64_t>(bytes + 40) != size)
+    return reject("truncated");
+  // Written as differences from the size so a crafted offset cannot wrap.
+  const std::size_t toc_bytes = entry_count * TOC_ENTRY_BYTES;
+  if (toc_bytes > size || toc_offset > size - toc_bytes
+      || strings_bytes > size || strings_offset > size - strings_bytes)
+    return reject("table of contents out of range");
+
+  archive_entries.reserve(entry_count);
+  name_hashes.reserve(entry_count);
+
+  for (std::uint32_t i = 0; i < entry_count; i++) {
+    const unsigned char* toc = bytes + toc_offset + i * TOC_ENTRY_BYTES;
+    const auto hash = read_le<std::uint64_t>(toc);
+    const auto name_offset = read_le<std::uint32_t>(toc + 8);
+    const auto name_length = read_le<std::uint32_t>(toc + 12);
+    const auto data_offset = read_le<std::uint64_t>(toc + 16);
+    const auto data_size = read_le<std::uint64_t>(toc + 24);
+
+    if (static_cast<std::uint64_t>(name_offset) + name_length > strings_bytes
+        || data_size > size || data_offset > size - data_size
+        || data_offset % DATA_ALIGNMENT != 0)
+      return reject("entry out of range");
+
+    AssetEntry entry {
+      { reinterpret_cast<const char*>(bytes + strings_offset + name_offset),
+          name_length },
+      static_cast<AssetKind>(read_le<std::uint32_t>(toc + 40)),
+      bytes + data_offset,
+      static_cast<std::size_t>(data_size),
+      read_le<std::uint64_t>(toc + 32),
+      read_le<std::uint32_t>(toc + 44),
+      read_le<std::uint32_t>(toc + 48),
+      read_le<std::uint32_t>(toc + 52),
+      read_le<std::uint32_t>(toc + 56),
+    };
+
+    // At most a full chain down to 1x1, and a base level that fits in the
+    // data, before the level sizes are added up.
+    if (entry.kind == AssetKind::TEXTURE
+        && (entry.format != GL_RGBA8 || entry.width == 0 || entry.height == 0
+            || entry.level_count == 0
+            || entry.level_count > static_cast<std::uint32_t>(
+                   std::bit_width(std::max(entry.width, entry.height)))
+            || static_cast<std::uint64_t>(entry.width) * entry.height
+                > entry.size / 4
+            || texture_bytes(entry.width, entry.height, entry.level_count)
+                != entry.size))
+      return reject("texture size mismatch");
+
+    if (!name_hashes.empty() && hash < name_hashes.back())
+      return reject("table of contents not sorted");
+
+    archive_entries.push_back(entry);
+    name_hashes.push_back(hash);
+  }
+
+  return true;
+}
+
+void asset::AssetArchive::close()
+{
+  archive_entries.clear();
+  name_hashes.clear();
+  file.close();
+}
+
+const asset::AssetEntry* asset::AssetArchive::find(std::string_view name) const
+{
+  const std::uint64_t hash = name_hash(name);
+  auto candidate
+      = std::lower_bound(name_hashes.begin(), name_hashes.end(), hash);
+
+  for (; candidate != name_hashes.end() && *candidate == hash; ++candidate) {
+    const AssetEntry& entry = archive_entries[candidate - name_hashes.begin()];
+    if (entry.name == name)
+      return &entry;
+  }
+
+  return nullptr;
+}
+
+void asset::AssetArchive::prefetch(const AssetEntry& entry) const
+{
+  file.prefetch(static_cast<std::size_t>(entry.data - file.data()), entry.size);
+}
+
+bool asset::write_archive(
+    const std::string& path, std::vector<ArchiveInput> inputs)
+{
+  std::sort(inputs.begin(), inputs.end(),
+      [](const ArchiveInput& a, const ArchiveInput& b) {
+        const auto hash_a = name_hash(a.name);
+        const auto hash_b = name_hash(b.name);
+        return hash_a != hash_b ? hash_a < hash_b : a.name < b.name;
+      });
+
+  for (std::size_t i = 1; i < inputs.size(); i++) {
+    if (inputs[i].name == inputs[i - 1].name) {
+      std::cout << "duplicate asset name: " << inputs[i].name << std::endl;
+      return false;
+    }
+  }
+
+  std::string strings;
+  std::vector<std::uint32_t> name_offsets;
+  for (const auto& input : inputs) {
+    name_offsets.push_back(static_cast<std::uint32_t>(strings.size()));
+    strings += input.name;
+  }
+
+  const std::size_t toc_offset = HEADER_BYTES;
+  const std::size_t strings_offset
+      = toc_offset + inputs.size() * TOC_ENTRY_BYTES;
+
+  std::vector<std::size_t> data_offsets;
+  std::size_t end = align_up(strings_offset + strings.size(), DATA_ALIGNMENT);
+  for (const auto& input : inputs) {
+    data_offsets.push_back(end);
+    end = align_up(end + input.data.size(), DATA_ALIGNMENT);
+  }
+
+  std::vector<unsigned char> out(end, 0);
+  std::memcpy(out.data(), ARCHIVE_MAGIC.data(), ARCHIVE_MAGIC.size());
+  write_le<std::uint32_t>(out.data() + 8, ARCHIVE_VERSION);
+  write_le<std::uint32_t>(
+      out.data() + 12, static_cast<std::uint32_t>(inputs.size()));
+  write_le<std::uint64_t>(out.data() + 16, toc_offset);
+  write_le<std::uint64_t>(out.data() + 24, strings_offset);
+  write_le<std::uint64_t>(out.data() + 32, strings.size());
+  write_le<std::uint64_t>(out.data() + 40, out.size());
+
+  for (std::size_t i = 0; i < inputs.size(); i++) {
+    const ArchiveInput& input = inputs[i];
+    unsigned char* toc = out.data() + toc_offset + i * TOC_ENTRY_BYTES;
+    write_le<std::uint64_t>(toc, name_hash(input.name));
+    write_le<std::uint32_t>(toc + 8, name_offsets[i]);
+    write_le<std::uint32_t>(toc + 12, static_cast<std::uint32_t>(input.name.size()));
+    write_le<std::uint64_t>(toc + 16, data_offsets[i]);
+    write_le<std::uint64_t>(toc + 24, input.data.size());
+    write_le<std::uint64_t>(toc + 32, input.content_hash);
+    write_le<std::uint32_t>(toc + 40, static_cast<std::uint32_t>(input.kind));
+    write_le<std::uint32_t>(toc + 44, input.width);
+    write_le<std::uint32_t>(toc + 48, input.height);
+    write_le<std::uint32_t>(toc + 52, input.level_count);
+    write_le<std::uint32_t>(toc + 56, input.format);
+
+    std::copy(input.data.begin(), input.data.end(),
+        out.begin() + static_cast<std::ptrdiff_t>(data_offsets[i]));
+  }
+  std::copy(strings.begin(), strings.end(),
+      out.begin() + static_cast<std::ptrdiff_t>(strings_offset));
+
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(out.data()),
+      static_cast<std::streamsize>(out.size()));
+  if (!file) {
+    std::cout << "failed to write file: " << path << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+GLuint asset::upload_texture(const AssetEntry& entry)
+{
+  if (entry.kind != AssetKind::TEXTURE)
+    return 0;
+
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+      entry.level_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  const unsigned char* level_data = entry.data;
+  for (std::uint32_t level = 0; level < entry.level_count; level++) {
+    const auto width = static_cast<GLsizei>(std::max(1u, entry.width >> level));
+    const auto height
+        = static_cast<GLsizei>(std::max(1u, entry.height >> level));
+    glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8, width,
+        height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level_data);
+    level_data += static_cast<std::size_t>(width) * height * 4;
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+      static_cast<GLint>(entry.level_count) - 1);
+
+  return texture;
+}
+
+void asset::upload_buffer(GLenum target, const AssetEntry& entry, GLenum usage)
+{
+  glBufferData(target, static_cast<GLsizeiptr>(entry.size), entry.data, usage);
+}
+
+GLuint asset::compile_shader(const AssetEntry& entry, GLenum stage)
+{
+  if (entry.kind != AssetKind::SHADER)
+    return 0;
+
+  const auto* source = reinterpret_cast<const GLchar*>(entry.data);
+  const auto length = static_cast<GLint>(entry.size);
+
+  GLuint shader = glCreateShader(stage);
+  glShaderSource(shader, 1, &source, &length);
+  glCompileShader(shader);
+
+  int compiled {};
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (!compiled) {
+    char log_info[512];
+    glGetShaderInfoLog(shader, sizeof(log_info), nullptr, log_info);
+    std::cout << "failed to compile shader: " << entry.name << "\n"
+              << log_info << std::endl;
+    glDeleteShader(shader);
+    return 0;
+  }
+
+  return shader;
+}
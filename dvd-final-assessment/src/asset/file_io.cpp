@@ -0,0 +1,391 @@
+#include "../../include/asset/file_io.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define FILE_IO_URING 1
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef FILE_IO_URING
+
+// A minimal io_uring over the raw syscalls, so there is no liburing
+// dependency. Only what the batch reader needs: IORING_OP_READ and
+// waiting for completions.
+struct asset::IoRing {
+  int descriptor { -1 };
+  void* sq_ring { MAP_FAILED };
+  std::size_t sq_ring_bytes {};
+  void* cq_ring { MAP_FAILED };
+  std::size_t cq_ring_bytes {};
+  io_uring_sqe* sqes { static_cast<io_uring_sqe*>(MAP_FAILED) };
+  std::size_t sqes_bytes {};
+
+  unsigned* sq_tail {};
+  unsigned* sq_mask {};
+  unsigned* sq_array {};
+  unsigned* cq_head {};
+  unsigned* cq_tail {};
+  unsigned* cq_mask {};
+  io_uring_cqe* cqes {};
+
+  unsigned int entries {};
+  unsigned int unsubmitted {};
+
+  ~IoRing()
+  {
+    if (sqes != MAP_FAILED)
+      munmap(sqes, sqes_bytes);
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+      munmap(cq_ring, cq_ring_bytes);
+    if (sq_ring != MAP_FAILED)
+      munmap(sq_ring, sq_ring_bytes);
+    if (descriptor >= 0)
+      ::close(descriptor);
+  }
+
+  bool setup(unsigned int depth)
+  {
+    io_uring_params params {};
+    descriptor
+        = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+    if (descriptor < 0)
+      return false;
+
+    entries = params.sq_entries;
+    sq_ring_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_bytes
+        = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+      sq_ring_bytes = cq_ring_bytes = std::max(sq_ring_bytes, cq_ring_bytes);
+
+    sq_ring = mmap(nullptr, sq_ring_bytes, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, descriptor, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED)
+      return false;
+
+    cq_ring = single_mmap
+        ? sq_ring
+        : mmap(nullptr, cq_ring_bytes, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, descriptor, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED)
+      return false;
+
+    sqes_bytes = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_bytes,
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor,
+        IORING_OFF_SQES));
+    if (sqes == MAP_FAILED)
+      return false;
+
+    auto* sq = static_cast<unsigned char*>(sq_ring);
+    auto* cq = static_cast<unsigned char*>(cq_ring);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  // Queues a read; the caller keeps at most `entries` in flight.
+  void queue_read(int file, void* buffer, unsigned int bytes,
+      std::uint64_t offset, std::uint64_t user_data)
+  {
+    const unsigned tail = *sq_tail;
+    const unsigned index = tail & *sq_mask;
+
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = file;
+    sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+    sqe.len = bytes;
+    sqe.off = offset;
+    sqe.user_data = user_data;
+
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    unsubmitted++;
+  }
+
+  // Submits everything queued and blocks until at least one completion.
+  bool submit_and_wait()
+  {
+    for (;;) {
+      long result = syscall(__NR_io_uring_enter, descriptor, unsubmitted, 1,
+          IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (result >= 0) {
+        unsubmitted -= static_cast<unsigned int>(result);
+        return true;
+      }
+      if (errno != EINTR)
+        return false;
+    }
+  }
+
+  template <typename Handle> void reap(const Handle& handle)
+  {
+    unsigned head = *cq_head;
+    const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      const io_uring_cqe& cqe = cqes[head & *cq_mask];
+      handle(cqe.user_data, cqe.res);
+    }
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+  }
+};
+
+#else
+
+struct asset::IoRing {
+};
+
+#endif
+
+namespace {
+
+void report_failure(const std::string& path)
+{
+  std::cout << "failed to load file: " << path << std::endl;
+}
+
+} // namespace
+
+bool asset::read_path_supported(ReadPath path)
+{
+  switch (path) {
+  case ReadPath::BUFFERED:
+  case ReadPath::MAPPED:
+    return true;
+#ifdef FILE_IO_URING
+  case ReadPath::IO_URING: {
+    // Containers and older kernels often refuse io_uring_setup.
+    static const bool supported = IoRing {}.setup(1);
+    return supported;
+  }
+#endif
+  default:
+    return false;
+  }
+}
+
+asset::ReadPath asset::best_read_path()
+{
+  return read_path_supported(ReadPath::IO_URING) ? ReadPath::IO_URING
+                                                 : ReadPath::BUFFERED;
+}
+
+const char* asset::read_path_name(ReadPath path)
+{
+  switch (path) {
+  case ReadPath::BUFFERED:
+    return "buffered";
+  case ReadPath::MAPPED:
+    return "mmap";
+  case ReadPath::IO_URING:
+    return "io_uring";
+  default:
+    return "unknown";
+  }
+}
+
+const unsigned char* asset::FileRead::data() const
+{
+  return mapping.is_open() ? mapping.data() : bytes.data();
+}
+
+std::size_t asset::FileRead::size() const
+{
+  return mapping.is_open() ? mapping.size() : bytes.size();
+}
+
+bool asset::read_file(const std::string& path, std::vector<unsigned char>& bytes)
+{
+  // A directory opens as a stream too, and reports a nonsense size.
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(path, error))
+    return false;
+
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    return false;
+
+  const std::streamoff size = file.tellg();
+  if (size < 0)
+    return false;
+
+  bytes.resize(static_cast<std::size_t>(size));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(bytes.data()),
+      static_cast<std::streamsize>(bytes.size()));
+  return static_cast<bool>(file);
+}
+
+asset::FileReader::FileReader(ReadPath path, unsigned int queue_depth)
+    : read_path(read_path_supported(path) ? path : ReadPath::BUFFERED)
+    , queue_depth(queue_depth)
+{
+#ifdef FILE_IO_URING
+  if (read_path == ReadPath::IO_URING) {
+    ring = std::make_unique<IoRing>();
+    if (!ring->setup(queue_depth)) {
+      ring.reset();
+      read_path = ReadPath::BUFFERED;
+    }
+  }
+#endif
+}
+
+asset::FileReader::~FileReader() = default;
+
+bool asset::FileReader::read(std::vector<FileRead>& reads,
+    const std::function<void(std::size_t)>& on_complete)
+{
+  if (read_path == ReadPath::IO_URING)
+    return read_uring(reads, on_complete);
+
+  bool all_ok = true;
+  for (std::size_t i = 0; i < reads.size(); i++) {
+    FileRead& file = reads[i];
+    file.ok = read_path == ReadPath::MAPPED ? file.mapping.open(file.path)
+                                            : read_file(file.path, file.bytes);
+    if (!file.ok) {
+      report_failure(file.path);
+      all_ok = false;
+    }
+    if (on_complete)
+      on_complete(i);
+  }
+
+  return all_ok;
+}
+
+#ifdef FILE_IO_URING
+
+bool asset::FileReader::read_uring(std::vector<FileRead>& reads,
+    const std::function<void(std::size_t)>& on_complete)
+{
+  struct InFlight {
+    int file;
+    std::size_t done;
+  };
+
+  // Files are opened only as slots free up, so a large batch never holds
+  // more than queue_depth descriptors.
+  std::vector<InFlight> in_flight(reads.size(), { -1, 0 });
+  std::size_t next = 0;
+  std::size_t outstanding = 0;
+  bool all_ok = true;
+
+  auto finish = [&](std::size_t index, bool ok) {
+    if (in_flight[index].file >= 0)
+      ::close(in_flight[index].file);
+    in_flight[index].file = -1;
+    reads[index].ok = ok;
+    if (!ok) {
+      reads[index].bytes.clear();
+      report_failure(reads[index].path);
+      all_ok = false;
+    }
+    if (on_complete)
+      on_complete(index);
+  };
+
+  // Reads are capped below 2 GiB, the most a single read returns.
+  auto queue_rest = [&](std::size_t index) {
+    auto& bytes = reads[index].bytes;
+    const std::size_t offset = in_flight[index].done;
+    const auto length = static_cast<unsigned int>(
+        std::min<std::size_t>(bytes.size() - offset, 1u << 30));
+    ring->queue_read(
+        in_flight[index].file, bytes.data() + offset, length, offset, index);
+  };
+
+  while (next < reads.size() || outstanding > 0) {
+    while (next < reads.size() && outstanding < ring->entries) {
+      const std::size_t index = next++;
+      FileRead& file = reads[index];
+
+      const int descriptor = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+      struct stat status;
+      if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+        if (descriptor >= 0)
+          ::close(descriptor);
+        finish(index, false);
+        continue;
+      }
+
+      in_flight[index] = { descriptor, 0 };
+      file.bytes.resize(static_cast<std::size_t>(status.st_size));
+      if (file.bytes.empty()) {
+        finish(index, true);
+        continue;
+      }
+
+      queue_rest(index);
+      outstanding++;
+    }
+
+    if (outstanding == 0)
+      break;
+
+    if (!ring->submit_and_wait()) {
+      std::cout << "io_uring_enter failed: " << std::strerror(errno)
+                << std::endl;
+      for (std::size_t index = 0; index < reads.size(); index++) {
+        if (in_flight[index].file >= 0 || index >= next)
+          finish(index, false);
+      }
+      return false;
+    }
+
+    ring->reap([&](std::uint64_t user_data, int result) {
+      const auto index = static_cast<std::size_t>(user_data);
+      InFlight& read = in_flight[index];
+
+      // A zero-byte result before the end means the file shrank.
+      if (result <= 0) {
+        outstanding--;
+        finish(index, false);
+        return;
+      }
+
+      read.done += static_cast<std::size_t>(result);
+      if (read.done < reads[index].bytes.size()) {
+        queue_rest(index);
+        return;
+      }
+
+      outstanding--;
+      finish(index, true);
+    });
+  }
+
+  return all_ok;
+}
+
+#else
+
+bool asset::FileReader::read_uring(std::vector<FileRead>& reads,
+    const std::function<void(std::size_t)>& on_complete)
+{
+  (void)reads;
+  (void)on_complete;
+  return false;
+}
+
+#endif
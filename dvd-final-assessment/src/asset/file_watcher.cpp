@@ -0,0 +1,117 @@
+#include "../../include/asset/file_watcher.h"
+
+#include <filesystem>
+#include <iostream>
+
+#if defined(__linux__) && __has_include(<sys/inotify.h>)
+#define FILE_WATCHER_INOTIFY 1
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+asset::FileWatcher::FileWatcher(std::chrono::milliseconds debounce)
+    : debounce(debounce)
+{
+#ifdef FILE_WATCHER_INOTIFY
+  descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+asset::FileWatcher::~FileWatcher()
+{
+#ifdef FILE_WATCHER_INOTIFY
+  if (descriptor >= 0)
+    ::close(descriptor);
+#endif
+}
+
+bool asset::FileWatcher::watch_file(const std::string& path)
+{
+  std::error_code error;
+  const auto absolute = std::filesystem::absolute(path, error);
+  if (error)
+    return false;
+  return watch_directory(absolute.parent_path().string());
+}
+
+bool asset::FileWatcher::watch_directory(const std::string& directory)
+{
+#ifdef FILE_WATCHER_INOTIFY
+  if (descriptor < 0)
+    return false;
+
+  std::error_code error;
+  const std::string canonical
+      = std::filesystem::canonical(directory, error).string();
+  if (error)
+    return false;
+  if (watched.count(canonical))
+    return true;
+
+  // CLOSE_WRITE rather than MODIFY: one event per save, not per write().
+  // MOVED_TO and CREATE catch editors that replace the file.
+  const int watch = inotify_add_watch(descriptor, canonical.c_str(),
+      IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+  if (watch < 0) {
+    std::cout << "failed to watch directory: " << canonical << std::endl;
+    return false;
+  }
+
+  directories[watch] = canonical;
+  watched.insert(canonical);
+  return true;
+#else
+  (void)directory;
+  return false;
+#endif
+}
+
+void asset::FileWatcher::drain()
+{
+#ifdef FILE_WATCHER_INOTIFY
+  alignas(inotify_event) char buffer[16 << 10];
+  const auto now = clock::now();
+
+  while (true) {
+    const ssize_t length = ::read(descriptor, buffer, sizeof(buffer));
+    if (length <= 0)
+      return;
+
+    for (ssize_t offset = 0; offset < length;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+      auto directory = directories.find(event->wd);
+      if (directory == directories.end() || event->len == 0
+          || (event->mask & IN_ISDIR))
+        continue;
+
+      const std::string path = directory->second + "/" + event->name;
+      auto [entry, inserted] = pending.try_emplace(path, Pending { now, now });
+      if (!inserted)
+        entry->second.last_event = now;
+    }
+  }
+#endif
+}
+
+std::vector<asset::FileWatcher::Change> asset::FileWatcher::poll()
+{
+  std::vector<Change> changes;
+  if (descriptor < 0)
+    return changes;
+
+  drain();
+
+  const auto now = clock::now();
+  for (auto it = pending.begin(); it != pending.end();) {
+    if (now - it->second.last_event >= debounce) {
+      changes.push_back({ it->first, it->second.first_event });
+      it = pending.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  return changes;
+}
@@ -0,0 +1,125 @@
+#include "../../include/asset/mapped_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// An empty file opens like any other, but there is nothing to map; data()
+// points here so it is never null while the file is open.
+const unsigned char EMPTY_FILE[1] {};
+
+} // namespace
+
+asset::MappedFile::~MappedFile() { close(); }
+
+asset::MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+  *this = std::move(other);
+}
+
+asset::MappedFile& asset::MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this != &other) {
+    close();
+    bytes = std::exchange(other.bytes, nullptr);
+    length = std::exchange(other.length, 0);
+    mapped = std::exchange(other.mapped, false);
+    fallback = std::move(other.fallback);
+  }
+
+  return *this;
+}
+
+bool asset::MappedFile::open(const std::string& path)
+{
+  close();
+
+#ifdef MAPPED_FILE_POSIX
+  int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (descriptor < 0)
+    return false;
+
+  struct stat status;
+  if (fstat(descriptor, &status) != 0 || status.st_size < 0) {
+    ::close(descriptor);
+    return false;
+  }
+
+  // mmap rejects a zero length.
+  if (status.st_size == 0) {
+    ::close(descriptor);
+    bytes = EMPTY_FILE;
+    return true;
+  }
+
+  void* view = mmap(nullptr, static_cast<std::size_t>(status.st_size),
+      PROT_READ, MAP_PRIVATE, descriptor, 0);
+  // The mapping keeps the file referenced after the descriptor is closed.
+  ::close(descriptor);
+  if (view == MAP_FAILED)
+    return false;
+
+  bytes = static_cast<const unsigned char*>(view);
+  length = static_cast<std::size_t>(status.st_size);
+  mapped = true;
+  return true;
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    return false;
+
+  fallback.resize(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(fallback.data()),
+      static_cast<std::streamsize>(fallback.size()));
+  if (!file) {
+    fallback.clear();
+    return false;
+  }
+
+  bytes = fallback.empty() ? EMPTY_FILE : fallback.data();
+  length = fallback.size();
+  return true;
+#endif
+}
+
+void asset::MappedFile::close()
+{
+#ifdef MAPPED_FILE_POSIX
+  if (mapped)
+    munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+
+  bytes = nullptr;
+  length = 0;
+  mapped = false;
+  fallback.clear();
+}
+
+void asset::MappedFile::prefetch(std::size_t offset, std::size_t size) const
+{
+#ifdef MAPPED_FILE_POSIX
+  if (!mapped || offset >= length)
+    return;
+
+  // madvise wants a page aligned start.
+  const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t start = offset / page * page;
+  const std::size_t end = std::min(length, offset + size);
+  madvise(const_cast<unsigned char*>(bytes) + start, end - start,
+      MADV_WILLNEED);
+#else
+  (void)offset;
+  (void)size;
+#endif
+}
@@ -0,0 +1,424 @@
+#include "../../include/asset/vfs.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+// Async directory reads the I/O thread hands to FileReader at once.
+constexpr std::size_t READ_BATCH { 64 };
+
+std::string join(const std::string& prefix, std::string_view name)
+{
+  if (prefix.empty())
+    return std::string(name);
+  return prefix + "/" + std::string(name);
+}
+
+// The path relative to a mount's prefix, or false when it is outside it.
+bool strip_prefix(
+    const std::string& prefix, const std::string& path, std::string& relative)
+{
+  if (prefix.empty()) {
+    relative = path;
+    return true;
+  }
+  if (path.size() <= prefix.size() || path.compare(0, prefix.size(), prefix)
+      || path[prefix.size()] != '/')
+    return false;
+
+  relative = path.substr(prefix.size() + 1);
+  return true;
+}
+
+} // namespace
+
+const char* asset::mount_kind_name(MountKind kind)
+{
+  switch (kind) {
+  case MountKind::DIRECTORY:
+    return "directory";
+  case MountKind::ARCHIVE:
+    return "archive";
+  case MountKind::EMBEDDED:
+    return "embedded";
+  default:
+    return "unknown";
+  }
+}
+
+asset::Vfs::Vfs(ReadPath read_path)
+    : read_path(read_path)
+{
+}
+
+asset::Vfs::~Vfs()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+  if (io_thread.joinable())
+    io_thread.join();
+}
+
+std::string asset::Vfs::normalize(std::string_view path)
+{
+  std::vector<std::string_view> parts;
+  std::size_t start = 0;
+  while (start <= path.size()) {
+    std::size_t end = path.find_first_of("/\\", start);
+    if (end == std::string_view::npos)
+      end = path.size();
+
+    const std::string_view part = path.substr(start, end - start);
+    if (part == "..") {
+      if (!parts.empty())
+        parts.pop_back();
+    } else if (!part.empty() && part != ".") {
+      parts.push_back(part);
+    }
+    start = end + 1;
+  }
+
+  std::string normalized;
+  for (const auto& part : parts) {
+    if (!normalized.empty())
+      normalized += '/';
+    normalized += part;
+  }
+  return normalized;
+}
+
+bool asset::Vfs::mount_directory(
+    const std::string& root, const std::string& prefix, bool recursive)
+{
+  std::error_code error;
+  if (!std::filesystem::is_directory(root, error)) {
+    std::cout << "failed to mount directory: " << root << std::endl;
+    return false;
+  }
+
+  Mount mount { MountKind::DIRECTORY, normalize(prefix),
+    std::filesystem::canonical(root, error), recursive, nullptr };
+  mounts.push_back(std::move(mount));
+  index_mount(mounts.size() - 1);
+  return true;
+}
+
+bool asset::Vfs::mount_archive(const std::string& path, const std::string& prefix)
+{
+  auto archive = std::make_unique<AssetArchive>();
+  if (!archive->open(path)) {
+    std::cout << "failed to mount archive: " << path << std::endl;
+    return false;
+  }
+
+  mounts.push_back({ MountKind::ARCHIVE, normalize(prefix), {}, false,
+      std::move(archive) });
+  index_mount(mounts.size() - 1);
+  return true;
+}
+
+void asset::Vfs::mount_embedded(
+    const EmbeddedAsset* assets, std::size_t count, const std::string& prefix)
+{
+  mounts.push_back(
+      { MountKind::EMBEDDED, normalize(prefix), {}, false, nullptr, assets,
+          count });
+  index_mount(mounts.size() - 1);
+}
+
+// try_emplace keeps what an earlier mount already put in the index, which is
+// what gives earlier mounts priority.
+void asset::Vfs::index_mount(std::size_t mount_index)
+{
+  const Mount& mount = mounts[mount_index];
+
+  switch (mount.kind) {
+  case MountKind::DIRECTORY: {
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(mount.root,
+             std::filesystem::directory_options::skip_permission_denied,
+             error);
+        !error && it != std::filesystem::recursive_directory_iterator();
+        it.increment(error)) {
+      if (!mount.recursive && it.depth() == 0 && it->is_directory(error))
+        it.disable_recursion_pending();
+      if (!it->is_regular_file(error))
+        continue;
+
+      const auto relative
+          = it->path().lexically_relative(mount.root).generic_string();
+      const auto size = it->file_size(error);
+      const auto modified = it->last_write_time(error);
+      if (error) {
+        error.clear();
+        continue;
+      }
+
+      index.try_emplace(join(mount.prefix, relative),
+          IndexEntry { { MountKind::DIRECTORY, mount_index,
+              static_cast<std::size_t>(size), modified, 0, nullptr } });
+    }
+    break;
+  }
+  case MountKind::ARCHIVE:
+    for (const auto& entry : mount.archive->entries()) {
+      index.try_emplace(join(mount.prefix, entry.name),
+          IndexEntry { { MountKind::ARCHIVE, mount_index, entry.size, {},
+                           entry.content_hash, &entry },
+              entry.data });
+    }
+    break;
+  case MountKind::EMBEDDED:
+    for (std::size_t i = 0; i < mount.embedded_count; i++) {
+      const EmbeddedAsset& asset = mount.embedded[i];
+      index.try_emplace(join(mount.prefix, normalize(asset.name)),
+          IndexEntry { { MountKind::EMBEDDED, mount_index, asset.size, {}, 0,
+                           nullptr },
+              asset.data });
+    }
+    break;
+  }
+}
+
+const asset::Vfs::IndexEntry* asset::Vfs::find(std::string_view path) const
+{
+  auto found = index.find(normalize(path));
+  return found == index.end() ? nullptr : &found->second;
+}
+
+const asset::VfsStat* asset::Vfs::stat(std::string_view path) const
+{
+  const IndexEntry* entry = find(path);
+  return entry ? &entry->stat : nullptr;
+}
+
+std::string asset::Vfs::native_path(std::string_view path) const
+{
+  const std::string normalized = normalize(path);
+  auto found = index.find(normalized);
+  if (found == index.end() || found->second.stat.kind != MountKind::DIRECTORY)
+    return {};
+
+  const Mount& mount = mounts[found->second.stat.mount];
+  std::string relative;
+  strip_prefix(mount.prefix, normalized, relative);
+  return (mount.root / relative).string();
+}
+
+bool asset::Vfs::read(std::string_view path, VfsFile& file) const
+{
+  file = {};
+  file.path = normalize(path);
+
+  auto found = index.find(file.path);
+  if (found == index.end()) {
+    std::cout << "failed to load file: " << file.path << std::endl;
+    return false;
+  }
+
+  const IndexEntry& entry = found->second;
+  if (entry.data) {
+    file.view = entry.data;
+    file.view_size = entry.stat.size;
+    file.ok = true;
+    return true;
+  }
+
+  file.ok = read_file(native_path(file.path), file.bytes);
+  return file.ok;
+}
+
+void asset::Vfs::read_async(std::string_view path, ReadCallback on_complete)
+{
+  PendingRead request { {}, {}, std::move(on_complete) };
+  request.file.path = normalize(path);
+  outstanding++;
+
+  auto found = index.find(request.file.path);
+  if (found == index.end() || found->second.data) {
+    if (found == index.end()) {
+      std::cout << "failed to load file: " << request.file.path << std::endl;
+    } else {
+      request.file.view = found->second.data;
+      request.file.view_size = found->second.stat.size;
+      request.file.ok = true;
+    }
+    ready.push_back(std::move(request));
+    return;
+  }
+
+  request.native = native_path(request.file.path);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued.push_back(std::move(request));
+    if (!io_thread.joinable())
+      io_thread = std::thread(&Vfs::io_loop, this);
+  }
+  work_available.notify_one();
+}
+
+asset::VfsRead asset::Vfs::read_async(std::string_view path)
+{
+  return { *this, std::string(path), {} };
+}
+
+void asset::VfsRead::await_suspend(std::coroutine_handle<> handle)
+{
+  vfs.read_async(path, [this, handle](VfsFile& completed) {
+    file = std::move(completed);
+    handle.resume();
+  });
+}
+
+void asset::Vfs::io_loop()
+{
+  FileReader reader(read_path, READ_BATCH);
+
+  while (true) {
+    std::vector<PendingRead> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      work_available.wait(lock, [this] { return stopping || !queued.empty(); });
+      if (stopping)
+        return;
+
+      while (!queued.empty() && batch.size() < READ_BATCH) {
+        batch.push_back(std::move(queued.front()));
+        queued.pop_front();
+      }
+    }
+
+    std::vector<FileRead> reads(batch.size());
+    for (std::size_t i = 0; i < batch.size(); i++)
+      reads[i].path = batch[i].native;
+    reader.read(reads);
+
+    for (std::size_t i = 0; i < batch.size(); i++) {
+      VfsFile& file = batch[i].file;
+      file.ok = reads[i].ok;
+      if (reads[i].ok && !reads[i].bytes.empty()) {
+        file.bytes = std::move(reads[i].bytes);
+      } else if (reads[i].ok) {
+        file.bytes.assign(reads[i].data(), reads[i].data() + reads[i].size());
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto& request : batch)
+        finished.push_back(std::move(request));
+    }
+    work_done.notify_all();
+  }
+}
+
+std::size_t asset::Vfs::update()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& request : finished)
+      ready.push_back(std::move(request));
+    finished.clear();
+  }
+
+  // Callbacks may queue more reads, which land in `ready` for next time.
+  std::vector<PendingRead> delivering;
+  delivering.swap(ready);
+  for (auto& request : delivering) {
+    outstanding--;
+    if (request.on_complete)
+      request.on_complete(request.file);
+  }
+
+  return delivering.size();
+}
+
+void asset::Vfs::wait_all()
+{
+  while (outstanding > 0) {
+    if (update() > 0)
+      continue;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this] { return !finished.empty(); });
+  }
+}
+
+bool asset::Vfs::lookup(
+    std::size_t mount_index, const std::string& path, IndexEntry& entry) const
+{
+  const Mount& mount = mounts[mount_index];
+  std::string relative;
+  if (!strip_prefix(mount.prefix, path, relative))
+    return false;
+
+  switch (mount.kind) {
+  case MountKind::DIRECTORY: {
+    if (!mount.recursive && relative.find('/') != std::string::npos)
+      return false;
+
+    std::error_code error;
+    const auto native = mount.root / relative;
+    if (!std::filesystem::is_regular_file(native, error))
+      return false;
+    const auto size = std::filesystem::file_size(native, error);
+    const auto modified = std::filesystem::last_write_time(native, error);
+    if (error)
+      return false;
+
+    entry = { { MountKind::DIRECTORY, mount_index,
+        static_cast<std::size_t>(size), modified, 0, nullptr } };
+    return true;
+  }
+  case MountKind::ARCHIVE: {
+    const AssetEntry* found = mount.archive->find(relative);
+    if (!found)
+      return false;
+
+    entry = { { MountKind::ARCHIVE, mount_index, found->size, {},
+                  found->content_hash, found },
+      found->data };
+    return true;
+  }
+  case MountKind::EMBEDDED:
+    for (std::size_t i = 0; i < mount.embedded_count; i++) {
+      const EmbeddedAsset& asset = mount.embedded[i];
+      if (normalize(asset.name) == relative) {
+        entry = { { MountKind::EMBEDDED, mount_index, asset.size, {}, 0,
+                      nullptr },
+          asset.data };
+        return true;
+      }
+    }
+    return false;
+  }
+
+  return false;
+}
+
+void asset::Vfs::refresh(std::string_view path)
+{
+  const std::string normalized = normalize(path);
+
+  for (std::size_t i = 0; i < mounts.size(); i++) {
+    IndexEntry entry;
+    if (lookup(i, normalized, entry)) {
+      index.insert_or_assign(normalized, entry);
+      return;
+    }
+  }
+
+  index.erase(normalized);
+}
+
+void asset::Vfs::rescan()
+{
+  index.clear();
+  for (std::size_t i = 0; i < mounts.size(); i++)
+    index_mount(i);
+}
@@ -0,0 +1,87 @@
+#include "../../include/ecs/logo_systems.h"
+#include "../../include/threading/thread_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+// As in Query: a few chunks per thread.
+constexpr std::size_t CHUNKS_PER_THREAD { 8 };
+
+} // namespace
+
+ecs::Entity ecs::LogoSystems::create_logo(World& world,
+    const simulation::DvdState& state, const simulation::DvdLogo& logo)
+{
+  return world.create(state, logo, Visibility { 1 });
+}
+
+void ecs::LogoSystems::simulate(World& world,
+    const simulation::Bounds& bounds, float dt, threading::ThreadPool& pool)
+{
+  moving.each_chunk(world, pool,
+      [&](std::size_t count, simulation::DvdState* states,
+          const simulation::DvdLogo* logos) {
+        for (std::size_t i = 0; i < count; i++)
+          states[i] = simulation::step_dvd(states[i], logos[i], bounds, dt);
+      });
+}
+
+void ecs::LogoSystems::cull(World& world, const simulation::Bounds& view,
+    threading::ThreadPool& pool)
+{
+  culled.each_chunk(world, pool,
+      [&](std::size_t count, const simulation::DvdState* states,
+          const simulation::DvdLogo* logos, Visibility* visibility) {
+        for (std::size_t i = 0; i < count; i++) {
+          // & rather than &&: about half the logos are visible in a typical
+          // view, and a branch per test would mispredict on every other.
+          const bool inside = (states[i].x + logos[i].half_width >= view.left)
+              & (states[i].x - logos[i].half_width <= view.right)
+              & (states[i].y + logos[i].half_height >= view.bottom)
+              & (states[i].y - logos[i].half_height <= view.top);
+          visibility[i].visible = inside;
+        }
+      });
+}
+
+void ecs::LogoSystems::extract(World& world,
+    std::vector<LogoInstance>& instances, threading::ThreadPool& pool)
+{
+  const auto& chunks = drawn.chunks(world);
+  offsets.assign(chunks.size() + 1, 0);
+  const std::size_t grain = std::max<std::size_t>(
+      1, chunks.size() / (pool.size() * CHUNKS_PER_THREAD));
+
+  pool.parallel_for(
+      chunks.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; c++) {
+          const auto* visibility = chunks[c].column<const Visibility>();
+          std::size_t visible = 0;
+          for (std::size_t i = 0; i < chunks[c].size(); i++)
+            visible += visibility[i].visible;
+          offsets[c + 1] = visible;
+        }
+      });
+
+  for (std::size_t c = 0; c < chunks.size(); c++)
+    offsets[c + 1] += offsets[c];
+  instances.resize(offsets.back());
+
+  pool.parallel_for(
+      chunks.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; c++) {
+          const auto* states = chunks[c].column<const simulation::DvdState>();
+          const auto* logos = chunks[c].column<const simulation::DvdLogo>();
+          const auto* visibility = chunks[c].column<const Visibility>();
+
+          LogoInstance* out = instances.data() + offsets[c];
+          for (std::size_t i = 0; i < chunks[c].size(); i++) {
+            if (visibility[i].visible) {
+              *out++ = { states[i].x, states[i].y, logos[i].half_width,
+                logos[i].half_height };
+            }
+          }
+        }
+      });
+}
@@ -0,0 +1,230 @@
+#include "../../include/ecs/world.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace {
+
+std::array<ecs::ComponentInfo, ecs::MAX_COMPONENTS> component_infos;
+std::atomic<ecs::ComponentId> next_component_id { 0 };
+
+std::size_t align_up(std::size_t value)
+{
+  return (value + ecs::COLUMN_ALIGNMENT - 1) / ecs::COLUMN_ALIGNMENT
+      * ecs::COLUMN_ALIGNMENT;
+}
+
+std::byte* allocate_chunk()
+{
+  return static_cast<std::byte*>(::operator new(
+      ecs::CHUNK_BYTES, std::align_val_t { ecs::COLUMN_ALIGNMENT }));
+}
+
+void free_chunk(std::byte* chunk)
+{
+  ::operator delete(chunk, std::align_val_t { ecs::COLUMN_ALIGNMENT });
+}
+
+} // namespace
+
+ecs::ComponentId ecs::detail::register_component(
+    std::size_t size, std::size_t alignment)
+{
+  const ComponentId id = next_component_id.fetch_add(1);
+  if (id >= MAX_COMPONENTS) {
+    std::cout << "ecs: more than " << MAX_COMPONENTS << " component types"
+              << std::endl;
+    std::abort();
+  }
+
+  component_infos[id] = { size, alignment };
+  return id;
+}
+
+const ecs::ComponentInfo& ecs::component_info(ComponentId id)
+{
+  return component_infos[id];
+}
+
+ecs::Archetype::Archetype(const ComponentMask& components)
+    : components(components)
+{
+  offsets.fill(NO_COLUMN);
+  add_edges.fill(NO_EDGE);
+  remove_edges.fill(NO_EDGE);
+
+  std::size_t row_bytes = sizeof(Entity);
+  for (ComponentId id = 0; id < MAX_COMPONENTS; id++) {
+    if (components.test(id)) {
+      ids.push_back(id);
+      row_bytes += component_info(id).size;
+    }
+  }
+
+  // Every column may lose up to a cache line to alignment.
+  capacity = (CHUNK_BYTES - COLUMN_ALIGNMENT * (ids.size() + 1)) / row_bytes;
+
+  std::size_t offset = align_up(capacity * sizeof(Entity));
+  for (auto id : ids) {
+    offsets[id] = static_cast<std::uint32_t>(offset);
+    offset = align_up(offset + capacity * component_info(id).size);
+  }
+}
+
+ecs::Archetype::~Archetype()
+{
+  for (auto* chunk : chunks)
+    free_chunk(chunk);
+}
+
+std::size_t ecs::Archetype::push(Entity entity)
+{
+  const std::size_t row = count;
+  if (row / capacity == chunks.size())
+    chunks.push_back(allocate_chunk());
+
+  reinterpret_cast<Entity*>(chunks[row / capacity])[row % capacity] = entity;
+  count++;
+  return row;
+}
+
+ecs::Entity ecs::Archetype::swap_remove(std::size_t row)
+{
+  const std::size_t last = count - 1;
+  Entity moved;
+  if (row != last) {
+    moved = entities(last / capacity)[last % capacity];
+    reinterpret_cast<Entity*>(chunks[row / capacity])[row % capacity] = moved;
+    for (auto id : ids) {
+      std::memcpy(row_address(row, id), row_address(last, id),
+          component_info(id).size);
+    }
+  }
+  count--;
+
+  // One empty chunk is kept, so an archetype going back and forth across a
+  // chunk boundary does not allocate every time.
+  while (chunks.size() > chunk_count() + 1) {
+    free_chunk(chunks.back());
+    chunks.pop_back();
+  }
+
+  return moved;
+}
+
+ecs::World::World() { find_archetype({}); }
+
+ecs::World::~World() = default;
+
+ecs::Entity ecs::World::create(const ComponentMask& mask)
+{
+  std::uint32_t index;
+  if (!free_indices.empty()) {
+    index = free_indices.back();
+    free_indices.pop_back();
+  } else {
+    index = static_cast<std::uint32_t>(records.size());
+    records.push_back({ 0, 0, 0 });
+  }
+
+  const std::uint32_t archetype = find_archetype(mask);
+  Record& record = records[index];
+  const Entity entity { index, record.generation };
+  record.archetype = archetype;
+  record.row
+      = static_cast<std::uint32_t>(archetypes[archetype]->push(entity));
+  live++;
+  return entity;
+}
+
+void ecs::World::destroy(Entity entity)
+{
+  if (!alive(entity))
+    return;
+
+  Record& record = records[entity.index];
+  remove_row(record.archetype, record.row);
+  record.generation++;
+  free_indices.push_back(entity.index);
+  live--;
+}
+
+bool ecs::World::alive(Entity entity) const
+{
+  return entity.index < records.size()
+      && records[entity.index].generation == entity.generation;
+}
+
+void ecs::World::clear()
+{
+  for (auto& archetype : archetypes) {
+    for (std::size_t c = 0; c < archetype->chunk_count(); c++) {
+      const Entity* entities = archetype->entities(c);
+      for (std::size_t i = 0; i < archetype->chunk_size(c); i++) {
+        records[entities[i].index].generation++;
+        free_indices.push_back(entities[i].index);
+      }
+    }
+    archetype->count = 0;
+  }
+  live = 0;
+}
+
+std::uint32_t ecs::World::find_archetype(const ComponentMask& mask)
+{
+  // Entities tend to be created in runs of the same kind.
+  if (last_found != NO_ARCHETYPE && archetypes[last_found]->components == mask)
+    return last_found;
+
+  auto found = archetype_index.find(mask);
+  if (found != archetype_index.end()) {
+    last_found = found->second;
+    return last_found;
+  }
+
+  const auto index = static_cast<std::uint32_t>(archetypes.size());
+  archetypes.push_back(std::make_unique<Archetype>(mask));
+  archetype_index.emplace(mask, index);
+  last_found = index;
+  return index;
+}
+
+void ecs::World::move(Entity entity, ComponentId id, bool adding)
+{
+  const std::uint32_t source_index = records[entity.index].archetype;
+
+  auto& edges = adding ? archetypes[source_index]->add_edges
+                       : archetypes[source_index]->remove_edges;
+  if (edges[id] == Archetype::NO_EDGE) {
+    ComponentMask mask = archetypes[source_index]->components;
+    mask.set(id, adding);
+    edges[id] = find_archetype(mask);
+  }
+
+  const std::uint32_t target_index = edges[id];
+  Archetype& source = *archetypes[source_index];
+  Archetype& target = *archetypes[target_index];
+  Record& record = records[entity.index];
+
+  const std::size_t row = target.push(entity);
+  for (auto component : target.ids) {
+    if (source.components.test(component)) {
+      std::memcpy(target.row_address(row, component),
+          source.row_address(record.row, component),
+          component_info(component).size);
+    }
+  }
+
+  remove_row(source_index, record.row);
+  record.archetype = target_index;
+  record.row = static_cast<std::uint32_t>(row);
+}
+
+void ecs::World::remove_row(std::uint32_t archetype, std::size_t row)
+{
+  const Entity moved = archetypes[archetype]->swap_remove(row);
+  if (moved.index != Entity {}.index)
+    records[moved.index].row = static_cast<std::uint32_t>(row);
+}
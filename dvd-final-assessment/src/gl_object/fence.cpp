@@ -0,0 +1,69 @@
+#include "../../include/gl_object/fence.h"
+
+#include <cstring>
+
+gl_object::FenceQueue::~FenceQueue()
+{
+  for (const auto& entry : waiting)
+    glDeleteSync(entry.fence);
+}
+
+gl_object::FenceQueue::Awaiter gl_object::FenceQueue::signaled()
+{
+  return { *this, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) };
+}
+
+std::size_t gl_object::FenceQueue::poll()
+{
+  std::size_t resumed = 0;
+  while (!waiting.empty()) {
+    // A zero timeout only asks; the flush makes sure the fence is on its
+    // way to the GPU rather than sitting in the driver's queue.
+    const GLenum status = glClientWaitSync(
+        waiting.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+      break;
+
+    // WAIT_FAILED means a lost context; resume anyway rather than leave
+    // the coroutine hanging.
+    const Waiting entry = waiting.front();
+    waiting.pop_front();
+    glDeleteSync(entry.fence);
+    entry.handle.resume();
+    resumed++;
+  }
+
+  return resumed;
+}
+
+threading::Task<std::vector<unsigned char>> gl_object::read_pixels(
+    FenceQueue& fences, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  const std::size_t size = static_cast<std::size_t>(width) * height * 4;
+  std::vector<unsigned char> pixels;
+
+  GLuint buffer;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+  glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr,
+      GL_STREAM_READ);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  co_await fences.signaled();
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+  const void* mapped = glMapBufferRange(
+      GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+  if (mapped) {
+    pixels.resize(size);
+    std::memcpy(pixels.data(), mapped, size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glDeleteBuffers(1, &buffer);
+
+  co_return pixels;
+}
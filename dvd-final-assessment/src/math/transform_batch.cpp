@@ -0,0 +1,652 @@
+#include "../../include/math/transform_batch.h"
+#include "../../include/threading/thread_pool.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define TRANSFORM_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Small enough that a chunk's models, MVPs and normals (164 bytes an
+// object) stay in L2 between the three passes.
+constexpr std::size_t TRANSFORMS_PER_CHUNK { 2048 };
+
+struct TrsArrays {
+  const float* t[3];
+  const float* q[4];
+  const float* s[3];
+};
+
+struct Matrices {
+  float* m[16];
+};
+
+struct ConstMatrices {
+  const float* m[16];
+};
+
+// A view-projection shared by every object, or one matrix per object.
+struct LeftOperand {
+  const float* shared;
+  ConstMatrices batch;
+};
+
+TrsArrays arrays_of(const math::TransformBatch& transforms)
+{
+  return { { transforms.tx.data(), transforms.ty.data(), transforms.tz.data() },
+    { transforms.qx.data(), transforms.qy.data(), transforms.qz.data(),
+        transforms.qw.data() },
+    { transforms.sx.data(), transforms.sy.data(), transforms.sz.data() } };
+}
+
+Matrices arrays_of(math::MatrixBatch& matrices)
+{
+  Matrices arrays;
+  for (int e = 0; e < 16; e++)
+    arrays.m[e] = matrices.m[e].data();
+  return arrays;
+}
+
+ConstMatrices arrays_of(const math::MatrixBatch& matrices)
+{
+  ConstMatrices arrays;
+  for (int e = 0; e < 16; e++)
+    arrays.m[e] = matrices.m[e].data();
+  return arrays;
+}
+
+// The scalar paths are also the tail loops of the vector kernels.
+void compose_scalar(
+    TrsArrays trs, std::size_t begin, std::size_t end, Matrices out)
+{
+  for (std::size_t i = begin; i < end; i++) {
+    const float translation[3] = { trs.t[0][i], trs.t[1][i], trs.t[2][i] };
+    const float rotation[4]
+        = { trs.q[0][i], trs.q[1][i], trs.q[2][i], trs.q[3][i] };
+    const float scale[3] = { trs.s[0][i], trs.s[1][i], trs.s[2][i] };
+
+    float model[16];
+    math::compose_matrix(translation, rotation, scale, model);
+    for (int e = 0; e < 16; e++)
+      out.m[e][i] = model[e];
+  }
+}
+
+void multiply_scalar(LeftOperand left, ConstMatrices right, std::size_t begin,
+    std::size_t end, Matrices out)
+{
+  for (std::size_t i = begin; i < end; i++) {
+    float l[16], r[16], product[16];
+    for (int e = 0; e < 16; e++) {
+      l[e] = left.shared ? left.shared[e] : left.batch.m[e][i];
+      r[e] = right.m[e][i];
+    }
+
+    math::multiply_matrix(l, r, product);
+    for (int e = 0; e < 16; e++)
+      out.m[e][i] = product[e];
+  }
+}
+
+// Columns of the inverse-transpose are the cross products of the other two
+// columns over the determinant.
+void normal_scalar(ConstMatrices models, std::size_t begin, std::size_t end,
+    float* const* out)
+{
+  for (std::size_t i = begin; i < end; i++) {
+    const float a[3] = { models.m[0][i], models.m[1][i], models.m[2][i] };
+    const float b[3] = { models.m[4][i], models.m[5][i], models.m[6][i] };
+    const float c[3] = { models.m[8][i], models.m[9][i], models.m[10][i] };
+
+    const float bc[3] = { b[1] * c[2] - b[2] * c[1], b[2] * c[0] - b[0] * c[2],
+      b[0] * c[1] - b[1] * c[0] };
+    const float ca[3] = { c[1] * a[2] - c[2] * a[1], c[2] * a[0] - c[0] * a[2],
+      c[0] * a[1] - c[1] * a[0] };
+    const float ab[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+      a[0] * b[1] - a[1] * b[0] };
+
+    const float det = a[0] * bc[0] + a[1] * bc[1] + a[2] * bc[2];
+    const float inverse_det = 1.0f / det;
+    for (int row = 0; row < 3; row++) {
+      out[row][i] = bc[row] * inverse_det;
+      out[3 + row][i] = ca[row] * inverse_det;
+      out[6 + row][i] = ab[row] * inverse_det;
+    }
+  }
+}
+
+#ifdef TRANSFORM_BATCH_X86
+
+// Rotation matrix terms times a column's scale: (1 - 2(p + q)) * scale on
+// the diagonal, 2(p +- q) * scale off it.
+__attribute__((target("sse4.1"))) __m128 diagonal(
+    __m128 p, __m128 q, __m128 scale)
+{
+  const __m128 twice = _mm_mul_ps(_mm_set1_ps(2.0f), _mm_add_ps(p, q));
+  return _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), twice), scale);
+}
+
+__attribute__((target("sse4.1"))) __m128 sum(__m128 p, __m128 q, __m128 scale)
+{
+  return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f), _mm_add_ps(p, q)), scale);
+}
+
+__attribute__((target("sse4.1"))) __m128 difference(
+    __m128 p, __m128 q, __m128 scale)
+{
+  return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f), _mm_sub_ps(p, q)), scale);
+}
+
+__attribute__((target("sse4.1"))) void cross(
+    const __m128* p, const __m128* q, __m128* result)
+{
+  result[0] = _mm_sub_ps(_mm_mul_ps(p[1], q[2]), _mm_mul_ps(p[2], q[1]));
+  result[1] = _mm_sub_ps(_mm_mul_ps(p[2], q[0]), _mm_mul_ps(p[0], q[2]));
+  result[2] = _mm_sub_ps(_mm_mul_ps(p[0], q[1]), _mm_mul_ps(p[1], q[0]));
+}
+
+__attribute__((target("avx2"))) __m256 diagonal(
+    __m256 p, __m256 q, __m256 scale)
+{
+  const __m256 twice = _mm256_mul_ps(_mm256_set1_ps(2.0f), _mm256_add_ps(p, q));
+  return _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), twice), scale);
+}
+
+__attribute__((target("avx2"))) __m256 sum(__m256 p, __m256 q, __m256 scale)
+{
+  return _mm256_mul_ps(
+      _mm256_mul_ps(_mm256_set1_ps(2.0f), _mm256_add_ps(p, q)), scale);
+}
+
+__attribute__((target("avx2"))) __m256 difference(
+    __m256 p, __m256 q, __m256 scale)
+{
+  return _mm256_mul_ps(
+      _mm256_mul_ps(_mm256_set1_ps(2.0f), _mm256_sub_ps(p, q)), scale);
+}
+
+__attribute__((target("avx2"))) void cross(
+    const __m256* p, const __m256* q, __m256* result)
+{
+  result[0]
+      = _mm256_sub_ps(_mm256_mul_ps(p[1], q[2]), _mm256_mul_ps(p[2], q[1]));
+  result[1]
+      = _mm256_sub_ps(_mm256_mul_ps(p[2], q[0]), _mm256_mul_ps(p[0], q[2]));
+  result[2]
+      = _mm256_sub_ps(_mm256_mul_ps(p[0], q[1]), _mm256_mul_ps(p[1], q[0]));
+}
+
+__attribute__((target("sse4.1"))) void compose_sse41(
+    TrsArrays trs, std::size_t begin, std::size_t end, Matrices out)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    const __m128 x = _mm_loadu_ps(trs.q[0] + i);
+    const __m128 y = _mm_loadu_ps(trs.q[1] + i);
+    const __m128 z = _mm_loadu_ps(trs.q[2] + i);
+    const __m128 w = _mm_loadu_ps(trs.q[3] + i);
+
+    const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y),
+                 zz = _mm_mul_ps(z, z);
+    const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z),
+                 yz = _mm_mul_ps(y, z);
+    const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y),
+                 wz = _mm_mul_ps(w, z);
+
+    const __m128 sx = _mm_loadu_ps(trs.s[0] + i);
+    const __m128 sy = _mm_loadu_ps(trs.s[1] + i);
+    const __m128 sz = _mm_loadu_ps(trs.s[2] + i);
+
+    _mm_storeu_ps(out.m[0] + i, diagonal(yy, zz, sx));
+    _mm_storeu_ps(out.m[1] + i, sum(xy, wz, sx));
+    _mm_storeu_ps(out.m[2] + i, difference(xz, wy, sx));
+    _mm_storeu_ps(out.m[3] + i, zero);
+    _mm_storeu_ps(out.m[4] + i, difference(xy, wz, sy));
+    _mm_storeu_ps(out.m[5] + i, diagonal(xx, zz, sy));
+    _mm_storeu_ps(out.m[6] + i, sum(yz, wx, sy));
+    _mm_storeu_ps(out.m[7] + i, zero);
+    _mm_storeu_ps(out.m[8] + i, sum(xz, wy, sz));
+    _mm_storeu_ps(out.m[9] + i, difference(yz, wx, sz));
+    _mm_storeu_ps(out.m[10] + i, diagonal(xx, yy, sz));
+    _mm_storeu_ps(out.m[11] + i, zero);
+    _mm_storeu_ps(out.m[12] + i, _mm_loadu_ps(trs.t[0] + i));
+    _mm_storeu_ps(out.m[13] + i, _mm_loadu_ps(trs.t[1] + i));
+    _mm_storeu_ps(out.m[14] + i, _mm_loadu_ps(trs.t[2] + i));
+    _mm_storeu_ps(out.m[15] + i, one);
+  }
+  compose_scalar(trs, i, end, out);
+}
+
+__attribute__((target("sse4.1"))) void multiply_sse41(LeftOperand left,
+    ConstMatrices right, std::size_t begin, std::size_t end, Matrices out)
+{
+  __m128 l[16];
+  if (left.shared) {
+    for (int e = 0; e < 16; e++)
+      l[e] = _mm_set1_ps(left.shared[e]);
+  }
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    if (!left.shared) {
+      for (int e = 0; e < 16; e++)
+        l[e] = _mm_loadu_ps(left.batch.m[e] + i);
+    }
+
+    for (int column = 0; column < 4; column++) {
+      const __m128 r0 = _mm_loadu_ps(right.m[column * 4] + i);
+      const __m128 r1 = _mm_loadu_ps(right.m[column * 4 + 1] + i);
+      const __m128 r2 = _mm_loadu_ps(right.m[column * 4 + 2] + i);
+      const __m128 r3 = _mm_loadu_ps(right.m[column * 4 + 3] + i);
+      for (int row = 0; row < 4; row++) {
+        __m128 value = _mm_mul_ps(l[row], r0);
+        value = _mm_add_ps(value, _mm_mul_ps(l[4 + row], r1));
+        value = _mm_add_ps(value, _mm_mul_ps(l[8 + row], r2));
+        value = _mm_add_ps(value, _mm_mul_ps(l[12 + row], r3));
+        _mm_storeu_ps(out.m[column * 4 + row] + i, value);
+      }
+    }
+  }
+  multiply_scalar(left, right, i, end, out);
+}
+
+__attribute__((target("sse4.1"))) void normal_sse41(ConstMatrices models,
+    std::size_t begin, std::size_t end, float* const* out)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    __m128 a[3], b[3], c[3];
+    for (int row = 0; row < 3; row++) {
+      a[row] = _mm_loadu_ps(models.m[row] + i);
+      b[row] = _mm_loadu_ps(models.m[4 + row] + i);
+      c[row] = _mm_loadu_ps(models.m[8 + row] + i);
+    }
+
+    __m128 bc[3], ca[3], ab[3];
+    cross(b, c, bc);
+    cross(c, a, ca);
+    cross(a, b, ab);
+
+    __m128 det = _mm_mul_ps(a[0], bc[0]);
+    det = _mm_add_ps(det, _mm_mul_ps(a[1], bc[1]));
+    det = _mm_add_ps(det, _mm_mul_ps(a[2], bc[2]));
+    const __m128 inverse_det = _mm_div_ps(one, det);
+
+    for (int row = 0; row < 3; row++) {
+      _mm_storeu_ps(out[row] + i, _mm_mul_ps(bc[row], inverse_det));
+      _mm_storeu_ps(out[3 + row] + i, _mm_mul_ps(ca[row], inverse_det));
+      _mm_storeu_ps(out[6 + row] + i, _mm_mul_ps(ab[row], inverse_det));
+    }
+  }
+  normal_scalar(models, i, end, out);
+}
+
+__attribute__((target("avx2"))) void compose_avx2(
+    TrsArrays trs, std::size_t begin, std::size_t end, Matrices out)
+{
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 zero = _mm256_setzero_ps();
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    const __m256 x = _mm256_loadu_ps(trs.q[0] + i);
+    const __m256 y = _mm256_loadu_ps(trs.q[1] + i);
+    const __m256 z = _mm256_loadu_ps(trs.q[2] + i);
+    const __m256 w = _mm256_loadu_ps(trs.q[3] + i);
+
+    const __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y),
+                 zz = _mm256_mul_ps(z, z);
+    const __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z),
+                 yz = _mm256_mul_ps(y, z);
+    const __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y),
+                 wz = _mm256_mul_ps(w, z);
+
+    const __m256 sx = _mm256_loadu_ps(trs.s[0] + i);
+    const __m256 sy = _mm256_loadu_ps(trs.s[1] + i);
+    const __m256 sz = _mm256_loadu_ps(trs.s[2] + i);
+
+    _mm256_storeu_ps(out.m[0] + i, diagonal(yy, zz, sx));
+    _mm256_storeu_ps(out.m[1] + i, sum(xy, wz, sx));
+    _mm256_storeu_ps(out.m[2] + i, difference(xz, wy, sx));
+    _mm256_storeu_ps(out.m[3] + i, zero);
+    _mm256_storeu_ps(out.m[4] + i, difference(xy, wz, sy));
+    _mm256_storeu_ps(out.m[5] + i, diagonal(xx, zz, sy));
+    _mm256_storeu_ps(out.m[6] + i, sum(yz, wx, sy));
+    _mm256_storeu_ps(out.m[7] + i, zero);
+    _mm256_storeu_ps(out.m[8] + i, sum(xz, wy, sz));
+    _mm256_storeu_ps(out.m[9] + i, difference(yz, wx, sz));
+    _mm256_storeu_ps(out.m[10] + i, diagonal(xx, yy, sz));
+    _mm256_storeu_ps(out.m[11] + i, zero);
+    _mm256_storeu_ps(out.m[12] + i, _mm256_loadu_ps(trs.t[0] + i));
+    _mm256_storeu_ps(out.m[13] + i, _mm256_loadu_ps(trs.t[1] + i));
+    _mm256_storeu_ps(out.m[14] + i, _mm256_loadu_ps(trs.t[2] + i));
+    _mm256_storeu_ps(out.m[15] + i, one);
+  }
+  compose_scalar(trs, i, end, out);
+}
+
+__attribute__((target("avx2"))) void multiply_avx2(LeftOperand left,
+    ConstMatrices right, std::size_t begin, std::size_t end, Matrices out)
+{
+  __m256 l[16];
+  if (left.shared) {
+    for (int e = 0; e < 16; e++)
+      l[e] = _mm256_set1_ps(left.shared[e]);
+  }
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    if (!left.shared) {
+      for (int e = 0; e < 16; e++)
+        l[e] = _mm256_loadu_ps(left.batch.m[e] + i);
+    }
+
+    for (int column = 0; column < 4; column++) {
+      const __m256 r0 = _mm256_loadu_ps(right.m[column * 4] + i);
+      const __m256 r1 = _mm256_loadu_ps(right.m[column * 4 + 1] + i);
+      const __m256 r2 = _mm256_loadu_ps(right.m[column * 4 + 2] + i);
+      const __m256 r3 = _mm256_loadu_ps(right.m[column * 4 + 3] + i);
+      for (int row = 0; row < 4; row++) {
+        __m256 value = _mm256_mul_ps(l[row], r0);
+        value = _mm256_add_ps(value, _mm256_mul_ps(l[4 + row], r1));
+        value = _mm256_add_ps(value, _mm256_mul_ps(l[8 + row], r2));
+        value = _mm256_add_ps(value, _mm256_mul_ps(l[12 + row], r3));
+        _mm256_storeu_ps(out.m[column * 4 + row] + i, value);
+      }
+    }
+  }
+  multiply_scalar(left, right, i, end, out);
+}
+
+__attribute__((target("avx2"))) void normal_avx2(ConstMatrices models,
+    std::size_t begin, std::size_t end, float* const* out)
+{
+  const __m256 one = _mm256_set1_ps(1.0f);
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    __m256 a[3], b[3], c[3];
+    for (int row = 0; row < 3; row++) {
+      a[row] = _mm256_loadu_ps(models.m[row] + i);
+      b[row] = _mm256_loadu_ps(models.m[4 + row] + i);
+      c[row] = _mm256_loadu_ps(models.m[8 + row] + i);
+    }
+
+    __m256 bc[3], ca[3], ab[3];
+    cross(b, c, bc);
+    cross(c, a, ca);
+    cross(a, b, ab);
+
+    __m256 det = _mm256_mul_ps(a[0], bc[0]);
+    det = _mm256_add_ps(det, _mm256_mul_ps(a[1], bc[1]));
+    det = _mm256_add_ps(det, _mm256_mul_ps(a[2], bc[2]));
+    const __m256 inverse_det = _mm256_div_ps(one, det);
+
+    for (int row = 0; row < 3; row++) {
+      _mm256_storeu_ps(out[row] + i, _mm256_mul_ps(bc[row], inverse_det));
+      _mm256_storeu_ps(out[3 + row] + i, _mm256_mul_ps(ca[row], inverse_det));
+      _mm256_storeu_ps(out[6 + row] + i, _mm256_mul_ps(ab[row], inverse_det));
+    }
+  }
+  normal_scalar(models, i, end, out);
+}
+
+#endif
+
+void multiply(LeftOperand left, const math::MatrixBatch& right,
+    std::size_t begin, std::size_t end, math::MatrixBatch& out,
+    math::TransformKernel kernel)
+{
+  switch (kernel) {
+#ifdef TRANSFORM_BATCH_X86
+  case math::TransformKernel::AVX2:
+    multiply_avx2(left, arrays_of(right), begin, end, arrays_of(out));
+    return;
+  case math::TransformKernel::SSE41:
+    multiply_sse41(left, arrays_of(right), begin, end, arrays_of(out));
+    return;
+#endif
+  default:
+    multiply_scalar(left, arrays_of(right), begin, end, arrays_of(out));
+    return;
+  }
+}
+
+} // namespace
+
+void math::compose_matrix(const float* translation, const float* rotation,
+    const float* scale, float* out)
+{
+  const float x = rotation[0];
+  const float y = rotation[1];
+  const float z = rotation[2];
+  const float w = rotation[3];
+
+  const float xx = x * x, yy = y * y, zz = z * z;
+  const float xy = x * y, xz = x * z, yz = y * z;
+  const float wx = w * x, wy = w * y, wz = w * z;
+
+  out[0] = (1.0f - 2.0f * (yy + zz)) * scale[0];
+  out[1] = (2.0f * (xy + wz)) * scale[0];
+  out[2] = (2.0f * (xz - wy)) * scale[0];
+  out[3] = 0.0f;
+  out[4] = (2.0f * (xy - wz)) * scale[1];
+  out[5] = (1.0f - 2.0f * (xx + zz)) * scale[1];
+  out[6] = (2.0f * (yz + wx)) * scale[1];
+  out[7] = 0.0f;
+  out[8] = (2.0f * (xz + wy)) * scale[2];
+  out[9] = (2.0f * (yz - wx)) * scale[2];
+  out[10] = (1.0f - 2.0f * (xx + yy)) * scale[2];
+  out[11] = 0.0f;
+  out[12] = translation[0];
+  out[13] = translation[1];
+  out[14] = translation[2];
+  out[15] = 1.0f;
+}
+
+void math::multiply_matrix(const float* left, const float* right, float* out)
+{
+  for (int column = 0; column < 4; column++) {
+    for (int row = 0; row < 4; row++) {
+      out[column * 4 + row] = left[row] * right[column * 4]
+          + left[4 + row] * right[column * 4 + 1]
+          + left[8 + row] * right[column * 4 + 2]
+          + left[12 + row] * right[column * 4 + 3];
+    }
+  }
+}
+
+void math::TransformBatch::reserve(std::size_t count)
+{
+  for (auto* component : { &tx, &ty, &tz, &qx, &qy, &qz, &qw, &sx, &sy, &sz })
+    component->reserve(count);
+}
+
+void math::TransformBatch::clear()
+{
+  for (auto* component : { &tx, &ty, &tz, &qx, &qy, &qz, &qw, &sx, &sy, &sz })
+    component->clear();
+}
+
+void math::TransformBatch::add(
+    const float* translation, const float* rotation, const float* scale)
+{
+  tx.push_back(translation[0]);
+  ty.push_back(translation[1]);
+  tz.push_back(translation[2]);
+  qx.push_back(rotation[0]);
+  qy.push_back(rotation[1]);
+  qz.push_back(rotation[2]);
+  qw.push_back(rotation[3]);
+  sx.push_back(scale[0]);
+  sy.push_back(scale[1]);
+  sz.push_back(scale[2]);
+}
+
+void math::MatrixBatch::resize(std::size_t count)
+{
+  for (auto& element : m)
+    element.resize(count);
+}
+
+void math::MatrixBatch::store_interleaved(
+    std::size_t begin, std::size_t end, float* out) const
+{
+  std::size_t i = begin;
+#if defined(TRANSFORM_BATCH_X86) && defined(__SSE__)
+  // Four objects at a time: a 4x4 transpose turns one column's elements of
+  // four objects into that column of each object.
+  for (; i + 4 <= end; i += 4) {
+    float* first = out + (i - begin) * 16;
+    for (int column = 0; column < 4; column++) {
+      __m128 r0 = _mm_loadu_ps(m[column * 4].data() + i);
+      __m128 r1 = _mm_loadu_ps(m[column * 4 + 1].data() + i);
+      __m128 r2 = _mm_loadu_ps(m[column * 4 + 2].data() + i);
+      __m128 r3 = _mm_loadu_ps(m[column * 4 + 3].data() + i);
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      _mm_storeu_ps(first + column * 4, r0);
+      _mm_storeu_ps(first + 16 + column * 4, r1);
+      _mm_storeu_ps(first + 32 + column * 4, r2);
+      _mm_storeu_ps(first + 48 + column * 4, r3);
+    }
+  }
+#endif
+  for (; i < end; i++) {
+    for (int e = 0; e < 16; e++)
+      out[(i - begin) * 16 + e] = m[e][i];
+  }
+}
+
+void math::Matrix3Batch::resize(std::size_t count)
+{
+  for (auto& element : m)
+    element.resize(count);
+}
+
+void math::Matrix3Batch::store_interleaved(
+    std::size_t begin, std::size_t end, float* out) const
+{
+  for (std::size_t i = begin; i < end; i++) {
+    for (int e = 0; e < 9; e++)
+      out[(i - begin) * 9 + e] = m[e][i];
+  }
+}
+
+bool math::transform_kernel_supported(TransformKernel kernel)
+{
+  switch (kernel) {
+  case TransformKernel::SCALAR:
+    return true;
+#ifdef TRANSFORM_BATCH_X86
+  case TransformKernel::SSE41:
+    return __builtin_cpu_supports("sse4.1");
+  case TransformKernel::AVX2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+math::TransformKernel math::best_transform_kernel()
+{
+  static const TransformKernel best = [] {
+    if (transform_kernel_supported(TransformKernel::AVX2))
+      return TransformKernel::AVX2;
+    if (transform_kernel_supported(TransformKernel::SSE41))
+      return TransformKernel::SSE41;
+    return TransformKernel::SCALAR;
+  }();
+
+  return best;
+}
+
+const char* math::transform_kernel_name(TransformKernel kernel)
+{
+  switch (kernel) {
+  case TransformKernel::SCALAR:
+    return "scalar";
+  case TransformKernel::SSE41:
+    return "sse4.1";
+  case TransformKernel::AVX2:
+    return "avx2";
+  default:
+    return "unknown";
+  }
+}
+
+void math::compose_models(const TransformBatch& transforms, std::size_t begin,
+    std::size_t end, MatrixBatch& models, TransformKernel kernel)
+{
+  switch (kernel) {
+#ifdef TRANSFORM_BATCH_X86
+  case TransformKernel::AVX2:
+    compose_avx2(arrays_of(transforms), begin, end, arrays_of(models));
+    return;
+  case TransformKernel::SSE41:
+    compose_sse41(arrays_of(transforms), begin, end, arrays_of(models));
+    return;
+#endif
+  default:
+    compose_scalar(arrays_of(transforms), begin, end, arrays_of(models));
+    return;
+  }
+}
+
+void math::multiply_matrices(const float* left, const MatrixBatch& right,
+    std::size_t begin, std::size_t end, MatrixBatch& out,
+    TransformKernel kernel)
+{
+  multiply({ left, {} }, right, begin, end, out, kernel);
+}
+
+void math::multiply_matrices(const MatrixBatch& left, const MatrixBatch& right,
+    std::size_t begin, std::size_t end, MatrixBatch& out,
+    TransformKernel kernel)
+{
+  multiply({ nullptr, arrays_of(left) }, right, begin, end, out, kernel);
+}
+
+void math::normal_matrices(const MatrixBatch& models, std::size_t begin,
+    std::size_t end, Matrix3Batch& normals, TransformKernel kernel)
+{
+  float* out[9];
+  for (int e = 0; e < 9; e++)
+    out[e] = normals.m[e].data();
+
+  switch (kernel) {
+#ifdef TRANSFORM_BATCH_X86
+  case TransformKernel::AVX2:
+    normal_avx2(arrays_of(models), begin, end, out);
+    return;
+  case TransformKernel::SSE41:
+    normal_sse41(arrays_of(models), begin, end, out);
+    return;
+#endif
+  default:
+    normal_scalar(arrays_of(models), begin, end, out);
+    return;
+  }
+}
+
+void math::compute_transforms(const TransformBatch& transforms,
+    const float* view_projection, MatrixBatch& models, MatrixBatch& mvps,
+    Matrix3Batch& normals, threading::ThreadPool& pool, TransformKernel kernel)
+{
+  models.resize(transforms.size());
+  mvps.resize(transforms.size());
+  normals.resize(transforms.size());
+
+  pool.parallel_for(transforms.size(), TRANSFORMS_PER_CHUNK,
+      [&](std::size_t begin, std::size_t end) {
+        compose_models(transforms, begin, end, models, kernel);
+        multiply_matrices(view_projection, models, begin, end, mvps, kernel);
+        normal_matrices(models, begin, end, normals, kernel);
+      });
+}
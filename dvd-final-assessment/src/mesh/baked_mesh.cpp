@@ -0,0 +1,404 @@
+#include "../../include/mesh/baked_mesh.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr std::array<char, 8> MESH_MAGIC { 'D', 'V', 'D', 'M', 'E', 'S', 'H',
+  '\0' };
+constexpr std::uint32_t MESH_VERSION { 1 };
+constexpr std::size_t HEADER_BYTES { 64 };
+constexpr std::size_t ARRAY_ALIGNMENT { 16 };
+
+template <typename T> T read_le(const unsigned char* bytes)
+{
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+template <typename T> void write_le(unsigned char* bytes, T value)
+{
+  std::memcpy(bytes, &value, sizeof(T));
+}
+
+std::size_t align_up(std::size_t value)
+{
+  return (value + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+}
+
+std::size_t index_bytes(GLenum index_type)
+{
+  return index_type == GL_UNSIGNED_SHORT ? 2 : 4;
+}
+
+// Round to nearest even, with overflow to infinity and gradual underflow.
+std::uint16_t to_half(float value)
+{
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const std::uint32_t sign = (bits >> 16) & 0x8000;
+  const std::uint32_t biased = (bits >> 23) & 0xff;
+  std::uint32_t mantissa = bits & 0x7fffff;
+
+  if (biased == 0xff)
+    return static_cast<std::uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+
+  const int exponent = static_cast<int>(biased) - 127 + 15;
+  if (exponent >= 31)
+    return static_cast<std::uint16_t>(sign | 0x7c00);
+
+  if (exponent <= 0) {
+    if (exponent < -10)
+      return static_cast<std::uint16_t>(sign);
+    mantissa |= 0x800000;
+    const int shift = 14 - exponent;
+    std::uint32_t half = mantissa >> shift;
+    const std::uint32_t rest = mantissa & ((1u << shift) - 1);
+    const std::uint32_t middle = 1u << (shift - 1);
+    if (rest > middle || (rest == middle && (half & 1)))
+      half++;
+    return static_cast<std::uint16_t>(sign | half);
+  }
+
+  // A carry out of the mantissa correctly bumps the exponent.
+  std::uint32_t half = sign | (static_cast<std::uint32_t>(exponent) << 10)
+      | (mantissa >> 13);
+  const std::uint32_t rest = mantissa & 0x1fff;
+  if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+    half++;
+  return static_cast<std::uint16_t>(half);
+}
+
+std::uint32_t pack_10(float value)
+{
+  const auto q
+      = static_cast<std::int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f)
+          * 511.0f));
+  return static_cast<std::uint32_t>(q) & 0x3ff;
+}
+
+// Next fanning vertex: a live candidate that will still be in the cache
+// after its remaining triangles are emitted, preferring the oldest; else
+// the most recent dead end, else the next live vertex in input order.
+int next_vertex(const std::vector<int>& candidates,
+    const std::vector<unsigned int>& live, const std::vector<unsigned int>& stamp,
+    unsigned int time, unsigned int cache_size, std::vector<int>& dead_ends,
+    std::size_t& cursor)
+{
+  int best = -1;
+  int best_priority = -1;
+  for (int vertex : candidates) {
+    if (live[vertex] == 0)
+      continue;
+
+    int priority = 0;
+    if (time - stamp[vertex] + 2 * live[vertex] <= cache_size)
+      priority = static_cast<int>(time - stamp[vertex]);
+    if (priority > best_priority) {
+      best_priority = priority;
+      best = vertex;
+    }
+  }
+  if (best >= 0)
+    return best;
+
+  while (!dead_ends.empty()) {
+    const int vertex = dead_ends.back();
+    dead_ends.pop_back();
+    if (live[vertex] > 0)
+      return vertex;
+  }
+
+  for (; cursor < live.size(); cursor++) {
+    if (live[cursor] > 0)
+      return static_cast<int>(cursor++);
+  }
+
+  return -1;
+}
+
+void tipsify(std::vector<GLuint>& indices, std::size_t vertex_count,
+    unsigned int cache_size)
+{
+  const std::size_t triangle_count = indices.size() / 3;
+
+  // Triangles around each vertex, as offsets into one array.
+  std::vector<unsigned int> live(vertex_count, 0);
+  for (GLuint index : indices)
+    live[index]++;
+
+  std::vector<std::size_t> first(vertex_count + 1, 0);
+  for (std::size_t v = 0; v < vertex_count; v++)
+    first[v + 1] = first[v] + live[v];
+
+  std::vector<std::uint32_t> adjacency(indices.size());
+  std::vector<std::size_t> fill(first.begin(), first.end() - 1);
+  for (std::size_t i = 0; i < indices.size(); i++)
+    adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+
+  // Time stamps start far enough back that every vertex is a cache miss.
+  std::vector<unsigned int> stamp(vertex_count, 0);
+  unsigned int time = cache_size + 1;
+
+  std::vector<bool> emitted(triangle_count, false);
+  std::vector<int> dead_ends;
+  std::vector<int> candidates;
+  std::vector<GLuint> output;
+  output.reserve(indices.size());
+
+  std::size_t cursor = 1;
+  int fan = vertex_count > 0 ? 0 : -1;
+  while (fan >= 0) {
+    candidates.clear();
+
+    for (std::size_t a = first[fan]; a < first[fan + 1]; a++) {
+      const std::uint32_t triangle = adjacency[a];
+      if (emitted[triangle])
+        continue;
+
+      for (int corner = 0; corner < 3; corner++) {
+        const GLuint vertex = indices[triangle * 3 + corner];
+        output.push_back(vertex);
+        dead_ends.push_back(static_cast<int>(vertex));
+        candidates.push_back(static_cast<int>(vertex));
+        live[vertex]--;
+        if (time - stamp[vertex] > cache_size)
+          stamp[vertex] = time++;
+      }
+      emitted[triangle] = true;
+    }
+
+    fan = next_vertex(candidates, live, stamp, time, cache_size, dead_ends,
+        cursor);
+  }
+
+  indices = std::move(output);
+}
+
+} // namespace
+
+void mesh::optimize_mesh(MeshData& mesh, unsigned int cache_size)
+{
+  tipsify(mesh.indices, mesh.vertices.size(), cache_size);
+
+  std::vector<GLuint> remap(mesh.vertices.size(), 0xffffffffu);
+  std::vector<MeshVertex> vertices;
+  vertices.reserve(mesh.vertices.size());
+
+  for (GLuint& index : mesh.indices) {
+    if (remap[index] == 0xffffffffu) {
+      remap[index] = static_cast<GLuint>(vertices.size());
+      vertices.push_back(mesh.vertices[index]);
+    }
+    index = remap[index];
+  }
+
+  mesh.vertices = std::move(vertices);
+}
+
+double mesh::average_cache_miss_ratio(const std::vector<GLuint>& indices,
+    std::size_t vertex_count, unsigned int cache_size)
+{
+  if (indices.empty())
+    return 0.0;
+
+  // FIFO: a vertex is cached while fewer than cache_size misses followed it.
+  std::vector<std::size_t> missed_at(vertex_count, 0);
+  std::size_t misses = 0;
+  for (GLuint index : indices) {
+    if (missed_at[index] == 0 || misses - missed_at[index] >= cache_size)
+      missed_at[index] = ++misses;
+  }
+
+  return static_cast<double>(misses) / (indices.size() / 3);
+}
+
+void mesh::quantize_mesh(const MeshData& mesh, BakedMesh& baked)
+{
+  float low[3] { 0.0f, 0.0f, 0.0f };
+  float high[3] { 0.0f, 0.0f, 0.0f };
+  for (std::size_t i = 0; i < mesh.vertices.size(); i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      const float value = mesh.vertices[i].position[axis];
+      low[axis] = i == 0 ? value : std::min(low[axis], value);
+      high[axis] = i == 0 ? value : std::max(high[axis], value);
+    }
+  }
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = 0.5f * (high[axis] - low[axis]);
+    baked.position_offset[axis] = 0.5f * (low[axis] + high[axis]);
+    baked.position_scale[axis] = extent > 0.0f ? extent : 1.0f;
+  }
+
+  baked.vertex_count = static_cast<std::uint32_t>(mesh.vertices.size());
+  baked.index_count = static_cast<std::uint32_t>(mesh.indices.size());
+  baked.index_type = mesh.vertices.size() <= 0x10000 ? GL_UNSIGNED_SHORT
+                                                     : GL_UNSIGNED_INT;
+
+  const std::size_t vertex_bytes = baked.vertex_count * BAKED_VERTEX_BYTES;
+  baked.storage.assign(
+      align_up(vertex_bytes) + baked.index_count * index_bytes(baked.index_type),
+      0);
+
+  unsigned char* out = baked.storage.data();
+  for (const MeshVertex& vertex : mesh.vertices) {
+    for (int axis = 0; axis < 3; axis++) {
+      const float normalized
+          = (vertex.position[axis] - baked.position_offset[axis])
+          / baked.position_scale[axis];
+      write_le<std::int16_t>(out + axis * 2,
+          static_cast<std::int16_t>(std::lround(
+              std::clamp(normalized, -1.0f, 1.0f) * 32767.0f)));
+    }
+    write_le<std::uint32_t>(out + 8,
+        pack_10(vertex.normal[0]) | pack_10(vertex.normal[1]) << 10
+            | pack_10(vertex.normal[2]) << 20);
+    write_le<std::uint16_t>(out + 12, to_half(vertex.uv[0]));
+    write_le<std::uint16_t>(out + 14, to_half(vertex.uv[1]));
+    out += BAKED_VERTEX_BYTES;
+  }
+
+  out = baked.storage.data() + align_up(vertex_bytes);
+  for (GLuint index : mesh.indices) {
+    if (baked.index_type == GL_UNSIGNED_SHORT) {
+      write_le<std::uint16_t>(out, static_cast<std::uint16_t>(index));
+      out += 2;
+    } else {
+      write_le<std::uint32_t>(out, index);
+      out += 4;
+    }
+  }
+
+  baked.file.close();
+  baked.vertices = baked.storage.data();
+  baked.indices = baked.storage.data() + align_up(vertex_bytes);
+}
+
+bool mesh::write_baked_mesh(const std::string& path, const BakedMesh& baked)
+{
+  const std::size_t vertex_bytes = baked.vertex_count * BAKED_VERTEX_BYTES;
+  const std::size_t indices_offset = HEADER_BYTES + align_up(vertex_bytes);
+
+  std::vector<unsigned char> header(HEADER_BYTES, 0);
+  std::memcpy(header.data(), MESH_MAGIC.data(), MESH_MAGIC.size());
+  write_le<std::uint32_t>(header.data() + 8, MESH_VERSION);
+  write_le<std::uint32_t>(header.data() + 12, baked.vertex_count);
+  write_le<std::uint32_t>(header.data() + 16, baked.index_count);
+  write_le<std::uint32_t>(header.data() + 20, baked.index_type);
+  for (int axis = 0; axis < 3; axis++) {
+    write_le<float>(header.data() + 24 + axis * 4, baked.position_offset[axis]);
+    write_le<float>(header.data() + 36 + axis * 4, baked.position_scale[axis]);
+  }
+  write_le<std::uint64_t>(header.data() + 48, HEADER_BYTES);
+  write_le<std::uint64_t>(header.data() + 56, indices_offset);
+
+  const std::vector<unsigned char> padding(
+      align_up(vertex_bytes) - vertex_bytes, 0);
+
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(header.data()),
+      static_cast<std::streamsize>(header.size()));
+  file.write(reinterpret_cast<const char*>(baked.vertices),
+      static_cast<std::streamsize>(vertex_bytes));
+  file.write(reinterpret_cast<const char*>(padding.data()),
+      static_cast<std::streamsize>(padding.size()));
+  file.write(reinterpret_cast<const char*>(baked.indices),
+      static_cast<std::streamsize>(
+          baked.index_count * index_bytes(baked.index_type)));
+  if (!file) {
+    std::cout << "failed to write file: " << path << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool mesh::read_baked_mesh(const std::string& path, BakedMesh& baked)
+{
+  baked.storage.clear();
+  if (!baked.file.open(path)) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return false;
+  }
+
+  const unsigned char* bytes = baked.file.data();
+  const std::size_t size = baked.file.size();
+  if (size < HEADER_BYTES
+      || std::memcmp(bytes, MESH_MAGIC.data(), MESH_MAGIC.size()) != 0
+      || read_le<std::uint32_t>(bytes + 8) != MESH_VERSION) {
+    std::cout << "not a baked mesh: " << path << std::endl;
+    baked.file.close();
+    return false;
+  }
+
+  baked.vertex_count = read_le<std::uint32_t>(bytes + 12);
+  baked.index_count = read_le<std::uint32_t>(bytes + 16);
+  baked.index_type = read_le<std::uint32_t>(bytes + 20);
+  for (int axis = 0; axis < 3; axis++) {
+    baked.position_offset[axis] = read_le<float>(bytes + 24 + axis * 4);
+    baked.position_scale[axis] = read_le<float>(bytes + 36 + axis * 4);
+  }
+
+  const auto vertices_offset = read_le<std::uint64_t>(bytes + 48);
+  const auto indices_offset = read_le<std::uint64_t>(bytes + 56);
+  // Compared against what is left after each offset, so a crafted offset
+  // cannot wrap the sum back inside the file.
+  auto fits = [size](std::uint64_t offset, std::uint64_t length) {
+    return length <= size && offset <= size - length;
+  };
+  if ((baked.index_type != GL_UNSIGNED_SHORT
+          && baked.index_type != GL_UNSIGNED_INT)
+      || !fits(vertices_offset,
+          std::uint64_t { baked.vertex_count } * BAKED_VERTEX_BYTES)
+      || !fits(indices_offset,
+          std::uint64_t { baked.index_count }
+              * index_bytes(baked.index_type))) {
+    std::cout << "corrupt baked mesh: " << path << std::endl;
+    baked.file.close();
+    return false;
+  }
+
+  baked.vertices = bytes + vertices_offset;
+  baked.indices = bytes + indices_offset;
+  return true;
+}
+
+void mesh::dequantize_matrix(const BakedMesh& baked, float* matrix)
+{
+  std::fill(matrix, matrix + 16, 0.0f);
+  for (int axis = 0; axis < 3; axis++) {
+    matrix[axis * 5] = baked.position_scale[axis];
+    matrix[12 + axis] = baked.position_offset[axis];
+  }
+  matrix[15] = 1.0f;
+}
+
+mesh::GpuMesh mesh::upload_baked_mesh(const BakedMesh& baked)
+{
+  gl_object::VAO vao;
+  vao.bind_vao();
+
+  // The wrappers take typed pointers, but glBufferData only sees bytes.
+  gl_object::VBO vbo(reinterpret_cast<const GLfloat*>(baked.vertices),
+      static_cast<GLsizeiptr>(baked.vertex_count * BAKED_VERTEX_BYTES));
+  gl_object::EBO ebo(reinterpret_cast<const GLuint*>(baked.indices),
+      static_cast<GLsizeiptr>(
+          baked.index_count * index_bytes(baked.index_type)));
+
+  constexpr auto stride = static_cast<GLsizei>(BAKED_VERTEX_BYTES);
+  vao.link_attribute(vbo, 0, 3, stride, 0, GL_SHORT, GL_TRUE);
+  vao.link_attribute(vbo, 1, 4, stride, 8, GL_INT_2_10_10_10_REV, GL_TRUE);
+  vao.link_attribute(vbo, 2, 2, stride, 12, GL_HALF_FLOAT);
+
+  vao.unbind_vao();
+  return { vao, vbo, ebo, static_cast<GLsizei>(baked.index_count),
+    baked.index_type };
+}
@@ -0,0 +1,1066 @@
+#include "../../include/mesh/gltf.h"
+#include "../../include/asset/mapped_file.h"
+#include "../../include/texture/mipmap.h"
+#include "../../include/texture/pixel_ingest.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::uint32_t GLB_MAGIC { 0x46546c67 };
+constexpr std::uint32_t GLB_VERSION { 2 };
+constexpr std::uint32_t CHUNK_JSON { 0x4e4f534a };
+constexpr std::uint32_t CHUNK_BIN { 0x004e4942 };
+constexpr int MAX_JSON_DEPTH { 64 };
+
+constexpr GLenum COMPONENT_UNSIGNED_BYTE { 5121 };
+constexpr GLenum COMPONENT_UNSIGNED_SHORT { 5123 };
+constexpr GLenum COMPONENT_FLOAT { 5126 };
+
+template <typename T> T read_le(const unsigned char* bytes)
+{
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+double milliseconds_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(clock_type::now() - start)
+      .count();
+}
+
+// Just enough JSON for glTF: a DOM with lookups that return null for
+// anything missing, so optional glTF properties read as their defaults.
+struct JsonValue {
+  enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+  Type type { Type::NUL };
+  bool boolean {};
+  double number {};
+  std::string string;
+  std::vector<JsonValue> array;
+  std::vector<std::pair<std::string, JsonValue>> object;
+
+  const JsonValue& operator[](std::string_view key) const
+  {
+    static const JsonValue null;
+    for (const auto& [name, value] : object) {
+      if (name == key)
+        return value;
+    }
+    return null;
+  }
+
+  const JsonValue& operator[](std::size_t index) const
+  {
+    static const JsonValue null;
+    return index < array.size() ? array[index] : null;
+  }
+
+  bool is_null() const { return type == Type::NUL; }
+  std::size_t size() const { return array.size(); }
+
+  double number_or(double fallback) const
+  {
+    return type == Type::NUMBER ? number : fallback;
+  }
+  int int_or(int fallback) const
+  {
+    return type == Type::NUMBER ? static_cast<int>(number) : fallback;
+  }
+  std::size_t size_or(std::size_t fallback) const
+  {
+    return type == Type::NUMBER && number >= 0
+        ? static_cast<std::size_t>(number)
+        : fallback;
+  }
+  bool bool_or(bool fallback) const
+  {
+    return type == Type::BOOLEAN ? boolean : fallback;
+  }
+};
+
+class JsonParser {
+public:
+  JsonParser(const char* text, std::size_t size)
+      : p(text)
+      , end(text + size)
+  {
+  }
+
+  bool parse(JsonValue& value)
+  {
+    if (!parse_value(value, 0))
+      return false;
+    skip_space();
+    return p == end;
+  }
+
+private:
+  void skip_space()
+  {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+      p++;
+  }
+
+  bool consume(std::string_view literal)
+  {
+    if (static_cast<std::size_t>(end - p) < literal.size()
+        || std::string_view(p, literal.size()) != literal)
+      return false;
+    p += literal.size();
+    return true;
+  }
+
+  bool parse_value(JsonValue& value, int depth)
+  {
+    if (depth > MAX_JSON_DEPTH)
+      return false;
+
+    skip_space();
+    if (p == end)
+      return false;
+
+    switch (*p) {
+    case '{':
+      return parse_object(value, depth);
+    case '[':
+      return parse_array(value, depth);
+    case '"':
+      value.type = JsonValue::Type::STRING;
+      return parse_string(value.string);
+    case 't':
+      value.type = JsonValue::Type::BOOLEAN;
+      value.boolean = true;
+      return consume("true");
+    case 'f':
+      value.type = JsonValue::Type::BOOLEAN;
+      value.boolean = false;
+      return consume("false");
+    case 'n':
+      value.type = JsonValue::Type::NUL;
+      return consume("null");
+    default: {
+      value.type = JsonValue::Type::NUMBER;
+      auto [next, error] = std::from_chars(p, end, value.number);
+      p = next;
+      return error == std::errc();
+    }
+    }
+  }
+
+  bool parse_object(JsonValue& value, int depth)
+  {
+    value.type = JsonValue::Type::OBJECT;
+    p++;
+    skip_space();
+    if (p < end && *p == '}') {
+      p++;
+      return true;
+    }
+
+    for (;;) {
+      skip_space();
+      std::string key;
+      if (p == end || *p != '"' || !parse_string(key))
+        return false;
+
+      skip_space();
+      if (p == end || *p++ != ':')
+        return false;
+
+      JsonValue member;
+      if (!parse_value(member, depth + 1))
+        return false;
+      value.object.emplace_back(std::move(key), std::move(member));
+
+      skip_space();
+      if (p == end)
+        return false;
+      if (*p == '}') {
+        p++;
+        return true;
+      }
+      if (*p++ != ',')
+        return false;
+    }
+  }
+
+  bool parse_array(JsonValue& value, int depth)
+  {
+    value.type = JsonValue::Type::ARRAY;
+    p++;
+    skip_space();
+    if (p < end && *p == ']') {
+      p++;
+      return true;
+    }
+
+    for (;;) {
+      value.array.emplace_back();
+      if (!parse_value(value.array.back(), depth + 1))
+        return false;
+
+      skip_space();
+      if (p == end)
+        return false;
+      if (*p == ']') {
+        p++;
+        return true;
+      }
+      if (*p++ != ',')
+        return false;
+    }
+  }
+
+  bool parse_hex4(std::uint32_t& code)
+  {
+    if (end - p < 4)
+      return false;
+    auto [next, error] = std::from_chars(p, p + 4, code, 16);
+    if (error != std::errc() || next != p + 4)
+      return false;
+    p += 4;
+    return true;
+  }
+
+  static void append_utf8(std::string& out, std::uint32_t code)
+  {
+    if (code < 0x80) {
+      out += static_cast<char>(code);
+    } else if (code < 0x800) {
+      out += static_cast<char>(0xc0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+      out += static_cast<char>(0xe0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    } else {
+      out += static_cast<char>(0xf0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+  }
+
+  bool parse_string(std::string& out)
+  {
+    p++;
+    while (p < end && *p != '"') {
+      if (*p != '\\') {
+        out += *p++;
+        continue;
+      }
+
+      if (++p == end)
+        return false;
+      const char escape = *p++;
+      switch (escape) {
+      case '"':
+      case '\\':
+      case '/':
+        out += escape;
+        break;
+      case 'b':
+        out += '\b';
+        break;
+      case 'f':
+        out += '\f';
+        break;
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'u': {
+        std::uint32_t code;
+        if (!parse_hex4(code))
+          return false;
+        if (code >= 0xd800 && code < 0xdc00) {
+          std::uint32_t low;
+          if (!consume("\\u") || !parse_hex4(low) || low < 0xdc00
+              || low >= 0xe000)
+            return false;
+          code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        }
+        append_utf8(out, code);
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+
+    if (p == end)
+      return false;
+    p++;
+    return true;
+  }
+
+  const char* p;
+  const char* end;
+};
+
+std::size_t component_bytes(GLenum component_type)
+{
+  switch (component_type) {
+  case GL_BYTE:
+  case GL_UNSIGNED_BYTE:
+    return 1;
+  case GL_SHORT:
+  case GL_UNSIGNED_SHORT:
+    return 2;
+  case GL_UNSIGNED_INT:
+  case GL_FLOAT:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+int component_count(const std::string& type)
+{
+  if (type == "SCALAR")
+    return 1;
+  if (type == "VEC2")
+    return 2;
+  if (type == "VEC3")
+    return 3;
+  if (type == "VEC4" || type == "MAT2")
+    return 4;
+  if (type == "MAT3")
+    return 9;
+  if (type == "MAT4")
+    return 16;
+  return 0;
+}
+
+bool attribute_location(const std::string& name, GLuint& location)
+{
+  static const std::pair<const char*, GLuint> locations[] {
+    { "POSITION", mesh::GLTF_POSITION }, { "NORMAL", mesh::GLTF_NORMAL },
+    { "TEXCOORD_0", mesh::GLTF_TEXCOORD_0 }, { "TANGENT", mesh::GLTF_TANGENT },
+    { "COLOR_0", mesh::GLTF_COLOR_0 }, { "JOINTS_0", mesh::GLTF_JOINTS_0 },
+    { "WEIGHTS_0", mesh::GLTF_WEIGHTS_0 }
+  };
+
+  for (const auto& [attribute, slot] : locations) {
+    if (name == attribute) {
+      location = slot;
+      return true;
+    }
+  }
+  return false;
+}
+
+struct BufferView {
+  std::size_t offset;
+  std::size_t length;
+  std::size_t stride;
+};
+
+struct Accessor {
+  int view;
+  std::size_t offset;
+  GLenum component_type;
+  int components;
+  std::size_t count;
+  bool normalized;
+  const JsonValue* sparse;
+
+  std::size_t element_bytes() const
+  {
+    return component_bytes(component_type) * components;
+  }
+};
+
+// Where an accessor's data lives in GL.
+struct GlAccessor {
+  GLuint buffer;
+  std::size_t offset;
+  GLsizei stride;
+  GLenum component_type;
+};
+
+struct DecodedImage {
+  bool srgb {};
+  bool ok {};
+  texture::Ktx2Image mips;
+};
+
+class GlbLoader {
+public:
+  GlbLoader(const JsonValue& json, const unsigned char* bin,
+      std::size_t bin_size, mesh::GltfScene& scene)
+      : json(json)
+      , bin(bin)
+      , bin_size(bin_size)
+      , scene(scene)
+  {
+  }
+
+  bool read_views_and_accessors()
+  {
+    for (const auto& view : json["bufferViews"].array) {
+      BufferView parsed { view["byteOffset"].size_or(0),
+        view["byteLength"].size_or(0), view["byteStride"].size_or(0) };
+      if (view["buffer"].int_or(0) != 0
+          || parsed.offset + parsed.length > bin_size) {
+        std::cout << "glTF bufferView outside the BIN chunk" << std::endl;
+        return false;
+      }
+      views.push_back(parsed);
+    }
+
+    for (const auto& accessor : json["accessors"].array) {
+      Accessor parsed { accessor["bufferView"].int_or(-1),
+        accessor["byteOffset"].size_or(0),
+        static_cast<GLenum>(accessor["componentType"].int_or(0)),
+        component_count(accessor["type"].string), accessor["count"].size_or(0),
+        accessor["normalized"].bool_or(false),
+        accessor["sparse"].is_null() ? nullptr : &accessor["sparse"] };
+
+      if (parsed.element_bytes() == 0 || parsed.view >= int(views.size())
+          || !in_view(parsed)) {
+        std::cout << "invalid glTF accessor" << std::endl;
+        return false;
+      }
+      accessors.push_back(parsed);
+    }
+
+    return true;
+  }
+
+  bool read_materials()
+  {
+    auto texture_index = [](const JsonValue& info) {
+      return info["index"].int_or(-1);
+    };
+
+    for (const auto& material : json["materials"].array) {
+      mesh::GltfMaterial parsed;
+      parsed.name = material["name"].string;
+
+      const JsonValue& pbr = material["pbrMetallicRoughness"];
+      for (int i = 0; i < 4; i++) {
+        parsed.base_color[i] = static_cast<float>(
+            pbr["baseColorFactor"][i].number_or(parsed.base_color[i]));
+      }
+      parsed.base_color_texture = texture_index(pbr["baseColorTexture"]);
+      parsed.metallic
+          = static_cast<float>(pbr["metallicFactor"].number_or(1.0));
+      parsed.roughness
+          = static_cast<float>(pbr["roughnessFactor"].number_or(1.0));
+      parsed.metallic_roughness_texture
+          = texture_index(pbr["metallicRoughnessTexture"]);
+      parsed.normal_texture = texture_index(material["normalTexture"]);
+      parsed.occlusion_texture = texture_index(material["occlusionTexture"]);
+      parsed.emissive_texture = texture_index(material["emissiveTexture"]);
+      for (int i = 0; i < 3; i++) {
+        parsed.emissive[i] = static_cast<float>(
+            material["emissiveFactor"][i].number_or(0.0));
+      }
+
+      const std::string& alpha_mode = material["alphaMode"].string;
+      parsed.alpha_mode = alpha_mode == "MASK" ? mesh::AlphaMode::MASK
+          : alpha_mode == "BLEND"              ? mesh::AlphaMode::BLEND
+                                               : mesh::AlphaMode::OPAQUE;
+      parsed.alpha_cutoff
+          = static_cast<float>(material["alphaCutoff"].number_or(0.5));
+      parsed.double_sided = material["doubleSided"].bool_or(false);
+
+      scene.materials.push_back(parsed);
+    }
+
+    return true;
+  }
+
+  // Colour textures are stored sRGB; everything else is data.
+  std::vector<DecodedImage> plan_images() const
+  {
+    std::vector<DecodedImage> images(json["images"].size());
+    const JsonValue& textures = json["textures"];
+
+    for (const auto& material : scene.materials) {
+      for (int texture :
+          { material.base_color_texture, material.emissive_texture }) {
+        if (texture < 0)
+          continue;
+        const int source
+            = textures[static_cast<std::size_t>(texture)]["source"].int_or(-1);
+        if (source >= 0 && source < int(images.size()))
+          images[source].srgb = true;
+      }
+    }
+
+    return images;
+  }
+
+  // Worker side: decode and build the mip chain, no GL.
+  void decode_image(std::size_t index, DecodedImage& image) const
+  {
+    const JsonValue& source = json["images"][index];
+    const int view = source["bufferView"].int_or(-1);
+    if (view < 0 || view >= int(views.size()))
+      return;
+
+    texture::IngestedImage decoded;
+    // glTF puts the first row at v = 0, which is where GL reads it from,
+    // so the rows stay in file order.
+    if (!texture::decode_image(bin + views[view].offset, views[view].length,
+            decoded,
+            { .flip_vertically = false, .srgb = image.srgb })) {
+      return;
+    }
+
+    image.mips = texture::generate_mipmaps(decoded.pixels.data(),
+        decoded.width, decoded.height,
+        { texture::MipFilter::KAISER, image.srgb });
+    image.ok = true;
+  }
+
+  bool upload_meshes()
+  {
+    for (const auto& mesh : json["meshes"].array) {
+      mesh::GltfMesh parsed;
+      parsed.name = mesh["name"].string;
+
+      for (const auto& primitive : mesh["primitives"].array) {
+        mesh::GltfPrimitive uploaded;
+        if (!upload_primitive(primitive, uploaded))
+          return false;
+        parsed.primitives.push_back(uploaded);
+      }
+
+      scene.meshes.push_back(std::move(parsed));
+    }
+
+    return true;
+  }
+
+  void upload_textures(const std::vector<DecodedImage>& images)
+  {
+    for (const auto& texture : json["textures"].array) {
+      const int source = texture["source"].int_or(-1);
+      if (source < 0 || source >= int(images.size()) || !images[source].ok) {
+        std::cout << "glTF texture has no embedded image; skipped"
+                  << std::endl;
+        scene.textures.push_back(0);
+        continue;
+      }
+
+      const DecodedImage& image = images[source];
+      // No sampler (-1) indexes past the end and reads as the defaults.
+      const JsonValue& sampler = json["samplers"][static_cast<std::size_t>(
+          texture["sampler"].int_or(-1))];
+
+      GLuint name;
+      glGenTextures(1, &name);
+      glBindTexture(GL_TEXTURE_2D, name);
+      glTexParameteri(
+          GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sampler["wrapS"].int_or(GL_REPEAT));
+      glTexParameteri(
+          GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, sampler["wrapT"].int_or(GL_REPEAT));
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+          sampler["minFilter"].int_or(GL_LINEAR_MIPMAP_LINEAR));
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+          sampler["magFilter"].int_or(GL_LINEAR));
+
+      const texture::PixelFormat format
+          = texture::pixel_format_for(4, image.srgb);
+      const auto level_count = static_cast<GLint>(image.mips.levels.size());
+      for (GLint level = 0; level < level_count; level++) {
+        texture::upload_pixels(image.mips.levels[level].data(),
+            std::max(1, image.mips.width >> level),
+            std::max(1, image.mips.height >> level), format, level);
+      }
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+
+      scene.textures.push_back(name);
+    }
+  }
+
+  bool read_nodes()
+  {
+    const JsonValue& nodes = json["nodes"];
+    scene.nodes.resize(nodes.size());
+
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+      const JsonValue& node = nodes[i];
+      mesh::GltfNode& parsed = scene.nodes[i];
+      parsed.name = node["name"].string;
+      parsed.mesh = node["mesh"].int_or(-1);
+      if (parsed.mesh >= int(scene.meshes.size()))
+        parsed.mesh = -1;
+      local_transform(node, parsed.local);
+
+      for (const auto& child : node["children"].array) {
+        const int index = child.int_or(-1);
+        if (index < 0 || index >= int(nodes.size())
+            || scene.nodes[index].parent >= 0 || index == int(i)) {
+          std::cout << "invalid glTF node hierarchy" << std::endl;
+          return false;
+        }
+        scene.nodes[index].parent = static_cast<int>(i);
+        parsed.children.push_back(index);
+      }
+    }
+
+    const JsonValue& scenes = json["scenes"];
+    if (scenes.size() > 0) {
+      const JsonValue& chosen
+          = scenes[static_cast<std::size_t>(json["scene"].int_or(0))];
+      for (const auto& root : chosen["nodes"].array) {
+        const int index = root.int_or(-1);
+        if (index >= 0 && index < int(nodes.size()))
+          scene.roots.push_back(index);
+      }
+    } else {
+      for (std::size_t i = 0; i < scene.nodes.size(); i++) {
+        if (scene.nodes[i].parent < 0)
+          scene.roots.push_back(static_cast<int>(i));
+      }
+    }
+
+    // Unique parents still allow a cycle (0 -> 1 -> 0), and a scene may
+    // list a node that is also some root's descendant, so a node reached
+    // twice means the hierarchy is not a forest.
+    std::vector<char> visited(scene.nodes.size(), 0);
+    std::vector<int> stack;
+    for (int root : scene.roots) {
+      if (visited[root]) {
+        std::cout << "invalid glTF node hierarchy" << std::endl;
+        return false;
+      }
+      visited[root] = 1;
+      std::memcpy(scene.nodes[root].world, scene.nodes[root].local,
+          sizeof(float) * 16);
+      stack.push_back(root);
+    }
+    while (!stack.empty()) {
+      const mesh::GltfNode& node = scene.nodes[stack.back()];
+      stack.pop_back();
+      for (int child : node.children) {
+        if (visited[child]) {
+          std::cout << "invalid glTF node hierarchy" << std::endl;
+          return false;
+        }
+        visited[child] = 1;
+        multiply(node.world, scene.nodes[child].local,
+            scene.nodes[child].world);
+        stack.push_back(child);
+      }
+    }
+
+    return true;
+  }
+
+private:
+  bool in_view(const Accessor& accessor) const
+  {
+    if (accessor.view < 0 || accessor.count == 0)
+      return true;
+
+    const BufferView& view = views[accessor.view];
+    const std::size_t stride
+        = view.stride ? view.stride : accessor.element_bytes();
+    return accessor.offset + stride * (accessor.count - 1)
+        + accessor.element_bytes()
+        <= view.length;
+  }
+
+  GLuint upload(const void* data, std::size_t bytes)
+  {
+    // GL_COPY_WRITE_BUFFER leaves the array and element bindings, and so
+    // whatever vertex array is bound, untouched.
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(bytes), data,
+        GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    scene.buffers.push_back(buffer);
+    return buffer;
+  }
+
+  GLuint view_buffer(int view)
+  {
+    auto found = view_buffers.find(view);
+    if (found != view_buffers.end())
+      return found->second;
+
+    const GLuint buffer = upload(bin + views[view].offset, views[view].length);
+    scene.stats.direct_bytes += views[view].length;
+    view_buffers.emplace(view, buffer);
+    return buffer;
+  }
+
+  // Tightly packed copy with sparse values applied.
+  bool repack(const Accessor& accessor, std::vector<unsigned char>& out) const
+  {
+    const std::size_t element = accessor.element_bytes();
+    out.assign(element * accessor.count, 0);
+
+    if (accessor.view >= 0) {
+      const BufferView& view = views[accessor.view];
+      const std::size_t stride = view.stride ? view.stride : element;
+      const unsigned char* source = bin + view.offset + accessor.offset;
+      for (std::size_t i = 0; i < accessor.count; i++)
+        std::memcpy(&out[i * element], source + i * stride, element);
+    }
+
+    if (!accessor.sparse)
+      return true;
+
+    const JsonValue& sparse = *accessor.sparse;
+    const std::size_t count = sparse["count"].size_or(0);
+    const JsonValue& indices = sparse["indices"];
+    const JsonValue& values = sparse["values"];
+    const int index_view = indices["bufferView"].int_or(-1);
+    const int value_view = values["bufferView"].int_or(-1);
+    const auto index_type
+        = static_cast<GLenum>(indices["componentType"].int_or(0));
+    const std::size_t index_bytes = component_bytes(index_type);
+
+    if (index_view < 0 || index_view >= int(views.size()) || value_view < 0
+        || value_view >= int(views.size()) || index_bytes == 0)
+      return false;
+
+    const std::size_t index_offset = indices["byteOffset"].size_or(0);
+    const std::size_t value_offset = values["byteOffset"].size_or(0);
+    if (index_offset + count * index_bytes > views[index_view].length
+        || value_offset + count * element > views[value_view].length)
+      return false;
+
+    const unsigned char* index_data
+        = bin + views[index_view].offset + index_offset;
+    const unsigned char* value_data
+        = bin + views[value_view].offset + value_offset;
+    for (std::size_t i = 0; i < count; i++) {
+      std::uint32_t target = index_bytes == 1 ? index_data[i]
+          : index_bytes == 2
+          ? read_le<std::uint16_t>(index_data + i * 2)
+          : read_le<std::uint32_t>(index_data + i * 4);
+      if (target >= accessor.count)
+        return false;
+      std::memcpy(&out[target * element], value_data + i * element, element);
+    }
+
+    return true;
+  }
+
+  bool gl_accessor(int index, bool as_indices, GlAccessor& out)
+  {
+    if (index < 0 || index >= int(accessors.size()))
+      return false;
+
+    const Accessor& accessor = accessors[index];
+    const bool widen = as_indices
+        && accessor.component_type == COMPONENT_UNSIGNED_BYTE;
+
+    if (accessor.view >= 0 && !accessor.sparse && !widen) {
+      out = { view_buffer(accessor.view), accessor.offset,
+        static_cast<GLsizei>(views[accessor.view].stride),
+        accessor.component_type };
+      return true;
+    }
+
+    std::vector<unsigned char> packed;
+    if (!repack(accessor, packed))
+      return false;
+
+    GLenum component_type = accessor.component_type;
+    if (widen) {
+      std::vector<unsigned char> wide(packed.size() * 2);
+      for (std::size_t i = 0; i < packed.size(); i++) {
+        const auto value = static_cast<std::uint16_t>(packed[i]);
+        std::memcpy(&wide[i * 2], &value, 2);
+      }
+      packed = std::move(wide);
+      component_type = COMPONENT_UNSIGNED_SHORT;
+    }
+
+    scene.stats.repacked_bytes += packed.size();
+    out = { upload(packed.data(), packed.size()), 0, 0, component_type };
+    return true;
+  }
+
+  bool upload_primitive(
+      const JsonValue& primitive, mesh::GltfPrimitive& uploaded)
+  {
+    const JsonValue& attributes = primitive["attributes"];
+    const int position = attributes["POSITION"].int_or(-1);
+    if (position < 0 || position >= int(accessors.size())) {
+      std::cout << "glTF primitive without POSITION" << std::endl;
+      return false;
+    }
+
+    uploaded.mode = static_cast<GLenum>(primitive["mode"].int_or(GL_TRIANGLES));
+    uploaded.material = primitive["material"].int_or(-1);
+    uploaded.count = static_cast<GLsizei>(accessors[position].count);
+
+    glGenVertexArrays(1, &uploaded.vertex_array);
+    glBindVertexArray(uploaded.vertex_array);
+    scene.vertex_arrays.push_back(uploaded.vertex_array);
+
+    for (const auto& [name, value] : attributes.object) {
+      GLuint location;
+      GlAccessor source;
+      if (!attribute_location(name, location))
+        continue;
+      const int index = value.int_or(-1);
+      if (index >= 0 && index < int(accessors.size())
+          && accessors[index].components > 4)
+        continue;
+      if (!gl_accessor(index, false, source)) {
+        std::cout << "invalid glTF attribute: " << name << std::endl;
+        glBindVertexArray(0);
+        return false;
+      }
+
+      const Accessor& accessor = accessors[index];
+      const auto pointer = reinterpret_cast<const void*>(source.offset);
+
+      glBindBuffer(GL_ARRAY_BUFFER, source.buffer);
+      if (location == mesh::GLTF_JOINTS_0
+          && source.component_type != COMPONENT_FLOAT) {
+        glVertexAttribIPointer(location, accessor.components,
+            source.component_type, source.stride, pointer);
+      } else {
+        glVertexAttribPointer(location, accessor.components,
+            source.component_type, accessor.normalized ? GL_TRUE : GL_FALSE,
+            source.stride, pointer);
+      }
+      glEnableVertexAttribArray(location);
+    }
+
+    const int indices = primitive["indices"].int_or(-1);
+    if (indices >= 0) {
+      GlAccessor source;
+      if (!gl_accessor(indices, true, source)) {
+        std::cout << "invalid glTF index accessor" << std::endl;
+        glBindVertexArray(0);
+        return false;
+      }
+
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, source.buffer);
+      uploaded.index_type = source.component_type;
+      uploaded.index_offset = source.offset;
+      uploaded.count = static_cast<GLsizei>(accessors[indices].count);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+  }
+
+  static void multiply(const float* a, const float* b, float* out)
+  {
+    for (int column = 0; column < 4; column++) {
+      for (int row = 0; row < 4; row++) {
+        float sum = 0.0f;
+        for (int k = 0; k < 4; k++)
+          sum += a[k * 4 + row] * b[column * 4 + k];
+        out[column * 4 + row] = sum;
+      }
+    }
+  }
+
+  // matrix, or translation * rotation * scale.
+  static void local_transform(const JsonValue& node, float* out)
+  {
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.size() == 16) {
+      for (std::size_t i = 0; i < 16; i++)
+        out[i] = static_cast<float>(matrix[i].number_or(0.0));
+      return;
+    }
+
+    const JsonValue& t = node["translation"];
+    const JsonValue& r = node["rotation"];
+    const JsonValue& s = node["scale"];
+    const float x = static_cast<float>(r[0].number_or(0.0));
+    const float y = static_cast<float>(r[1].number_or(0.0));
+    const float z = static_cast<float>(r[2].number_or(0.0));
+    const float w = static_cast<float>(r[3].number_or(1.0));
+    const float scale[3] { static_cast<float>(s[0].number_or(1.0)),
+      static_cast<float>(s[1].number_or(1.0)),
+      static_cast<float>(s[2].number_or(1.0)) };
+
+    const float rotation[9] { 1 - 2 * (y * y + z * z), 2 * (x * y + z * w),
+      2 * (x * z - y * w), 2 * (x * y - z * w), 1 - 2 * (x * x + z * z),
+      2 * (y * z + x * w), 2 * (x * z + y * w), 2 * (y * z - x * w),
+      1 - 2 * (x * x + y * y) };
+
+    for (int column = 0; column < 3; column++) {
+      for (int row = 0; row < 3; row++)
+        out[column * 4 + row] = rotation[column * 3 + row] * scale[column];
+      out[column * 4 + 3] = 0.0f;
+    }
+    for (int row = 0; row < 3; row++)
+      out[12 + row] = static_cast<float>(t[row].number_or(0.0));
+    out[15] = 1.0f;
+  }
+
+  const JsonValue& json;
+  const unsigned char* bin;
+  std::size_t bin_size;
+  mesh::GltfScene& scene;
+
+  std::vector<BufferView> views;
+  std::vector<Accessor> accessors;
+  std::map<int, GLuint> view_buffers;
+};
+
+} // namespace
+
+bool mesh::load_glb(
+    const std::string& path, GltfScene& scene, threading::ThreadPool* pool)
+{
+  const auto start = clock_type::now();
+  scene = {};
+
+  asset::MappedFile file;
+  if (!file.open(path)) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return false;
+  }
+
+  const unsigned char* bytes = file.data();
+  const std::size_t size = file.size();
+  if (size < 20 || read_le<std::uint32_t>(bytes) != GLB_MAGIC
+      || read_le<std::uint32_t>(bytes + 4) != GLB_VERSION
+      || read_le<std::uint32_t>(bytes + 8) > size) {
+    std::cout << "not a glTF 2.0 binary: " << path << std::endl;
+    return false;
+  }
+
+  // The JSON chunk comes first; the BIN chunk, when present, follows.
+  const unsigned char* json_text = nullptr;
+  const unsigned char* bin = nullptr;
+  std::size_t json_size = 0;
+  std::size_t bin_size = 0;
+  for (std::size_t offset = 12; offset + 8 <= size;) {
+    const auto length = read_le<std::uint32_t>(bytes + offset);
+    const auto type = read_le<std::uint32_t>(bytes + offset + 4);
+    if (offset + 8 + length > size)
+      break;
+
+    if (type == CHUNK_JSON && !json_text) {
+      json_text = bytes + offset + 8;
+      json_size = length;
+    } else if (type == CHUNK_BIN && !bin) {
+      bin = bytes + offset + 8;
+      bin_size = length;
+    }
+    offset += 8 + ((length + 3) & ~std::size_t { 3 });
+  }
+
+  // Geometry and images are read straight from the mapping; start paging
+  // it in now.
+  file.prefetch(0, size);
+  scene.stats.map_ms = milliseconds_since(start);
+
+  auto stage = clock_type::now();
+  JsonValue json;
+  if (!json_text
+      || !JsonParser(reinterpret_cast<const char*>(json_text), json_size)
+              .parse(json)) {
+    std::cout << "invalid glTF JSON: " << path << std::endl;
+    return false;
+  }
+  for (const auto& buffer : json["buffers"].array) {
+    if (!buffer["uri"].is_null()) {
+      std::cout << "external glTF buffers are not supported: " << path
+                << std::endl;
+      return false;
+    }
+  }
+
+  GlbLoader loader(json, bin, bin_size, scene);
+  if (!loader.read_views_and_accessors() || !loader.read_materials()) {
+    delete_scene(scene);
+    return false;
+  }
+  scene.stats.json_ms = milliseconds_since(stage);
+
+  // Images decode on the workers while this thread uploads geometry.
+  auto images = loader.plan_images();
+  scene.stats.image_count = images.size();
+  std::thread decoder([&] {
+    const auto decode_start = clock_type::now();
+    auto decode = [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; i++)
+        loader.decode_image(i, images[i]);
+    };
+
+    if (pool)
+      pool->parallel_for(images.size(), 1, decode);
+    else
+      decode(0, images.size());
+    scene.stats.image_decode_ms = milliseconds_since(decode_start);
+  });
+
+  stage = clock_type::now();
+  const bool meshes_ok = loader.upload_meshes();
+  scene.stats.buffer_upload_ms = milliseconds_since(stage);
+
+  decoder.join();
+
+  if (!meshes_ok || !loader.read_nodes()) {
+    delete_scene(scene);
+    return false;
+  }
+
+  stage = clock_type::now();
+  loader.upload_textures(images);
+  scene.stats.texture_upload_ms = milliseconds_since(stage);
+
+  scene.stats.total_ms = milliseconds_since(start);
+  return true;
+}
+
+void mesh::print_load_report(const GltfLoadStats& stats)
+{
+  std::cout << "glTF loaded in " << stats.total_ms << " ms | map "
+            << stats.map_ms << " ms, json " << stats.json_ms
+            << " ms, buffers " << stats.buffer_upload_ms << " ms, "
+            << stats.image_count << " image(s) decoded in "
+            << stats.image_decode_ms << " ms, textures "
+            << stats.texture_upload_ms << " ms | " << stats.direct_bytes
+            << " bytes uploaded as stored, " << stats.repacked_bytes
+            << " re-packed" << std::endl;
+}
+
+void mesh::delete_scene(GltfScene& scene)
+{
+  glDeleteVertexArrays(
+      static_cast<GLsizei>(scene.vertex_arrays.size()),
+      scene.vertex_arrays.data());
+  glDeleteBuffers(
+      static_cast<GLsizei>(scene.buffers.size()), scene.buffers.data());
+  glDeleteTextures(
+      static_cast<GLsizei>(scene.textures.size()), scene.textures.data());
+
+  scene.vertex_arrays.clear();
+  scene.buffers.clear();
+  scene.textures.clear();
+  scene.meshes.clear();
+}
@@ -0,0 +1,478 @@
+#include "../../include/mesh/obj_loader.h"
+#include "../../include/asset/mapped_file.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr std::size_t MIN_CHUNK_BYTES { 256 << 10 };
+constexpr std::size_t CHUNKS_PER_THREAD { 4 };
+constexpr std::uint32_t EMPTY_SLOT { 0xffffffffu };
+
+enum class LineKind { POSITION, TEXCOORD, NORMAL, FACE, OTHER };
+
+// Zero-based attribute indices; -1 when the corner has no such attribute.
+struct Corner {
+  std::int32_t position;
+  std::int32_t texcoord;
+  std::int32_t normal;
+
+  bool operator==(const Corner&) const = default;
+};
+
+struct AttributeCounts {
+  std::size_t positions;
+  std::size_t texcoords;
+  std::size_t normals;
+};
+
+struct Chunk {
+  const char* begin;
+  const char* end;
+  // Lines in this chunk, then the lines in every chunk before it.
+  AttributeCounts counts {};
+  AttributeCounts base {};
+  // Three per triangle.
+  std::vector<Corner> corners;
+  bool ok { true };
+};
+
+struct Attributes {
+  std::vector<float> positions;
+  std::vector<float> texcoords;
+  std::vector<float> normals;
+};
+
+bool is_space(char c) { return c == ' ' || c == '\t'; }
+
+const char* skip_space(const char* p, const char* end)
+{
+  while (p < end && is_space(*p))
+    p++;
+  return p;
+}
+
+// Classifies the statement at `p` and moves `p` past its keyword.
+LineKind line_kind(const char*& p, const char* end)
+{
+  p = skip_space(p, end);
+  if (end - p < 2)
+    return LineKind::OTHER;
+
+  if (p[0] == 'v') {
+    if (is_space(p[1])) {
+      p += 2;
+      return LineKind::POSITION;
+    }
+    if (end - p >= 3 && is_space(p[2])) {
+      const char kind = p[1];
+      p += 3;
+      if (kind == 't')
+        return LineKind::TEXCOORD;
+      if (kind == 'n')
+        return LineKind::NORMAL;
+    }
+    return LineKind::OTHER;
+  }
+
+  if (p[0] == 'f' && is_space(p[1])) {
+    p += 2;
+    return LineKind::FACE;
+  }
+
+  return LineKind::OTHER;
+}
+
+// Calls line(begin, end) for every line, without the line break.
+template <typename Line>
+void for_each_line(const char* begin, const char* end, const Line& line)
+{
+  while (begin < end) {
+    const auto* newline = static_cast<const char*>(
+        std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+    const char* line_end = newline ? newline : end;
+    const char* trimmed = line_end;
+    if (trimmed > begin && trimmed[-1] == '\r')
+      trimmed--;
+
+    line(begin, trimmed);
+    begin = newline ? newline + 1 : end;
+  }
+}
+
+bool parse_floats(const char* p, const char* end, float* out,
+    std::size_t required, std::size_t count)
+{
+  for (std::size_t i = 0; i < count; i++) {
+    p = skip_space(p, end);
+    if (p < end && *p == '+')
+      p++;
+
+    auto [next, error] = std::from_chars(p, end, out[i]);
+    if (error != std::errc()) {
+      if (i < required)
+        return false;
+      // Optional trailing components (vt's v) default to zero.
+      std::fill(out + i, out + count, 0.0f);
+      return true;
+    }
+    p = next;
+  }
+
+  return true;
+}
+
+// OBJ indices are one-based, or negative to count back from the latest
+// attribute. `seen` is how many of that attribute precede this line.
+bool resolve_index(
+    const char*& p, const char* end, std::size_t seen, std::int32_t& index)
+{
+  std::int64_t value;
+  auto [next, error] = std::from_chars(p, end, value);
+  if (error != std::errc() || value == 0)
+    return false;
+
+  p = next;
+  value = value > 0 ? value - 1 : static_cast<std::int64_t>(seen) + value;
+  if (value < 0 || value > INT32_MAX)
+    return false;
+
+  index = static_cast<std::int32_t>(value);
+  return true;
+}
+
+bool parse_face(const char* p, const char* end, const AttributeCounts& seen,
+    std::vector<Corner>& corners)
+{
+  Corner first {};
+  Corner previous {};
+  int corner_count = 0;
+
+  for (p = skip_space(p, end); p < end; p = skip_space(p, end)) {
+    Corner corner { -1, -1, -1 };
+    if (!resolve_index(p, end, seen.positions, corner.position))
+      return false;
+
+    if (p < end && *p == '/') {
+      p++;
+      if (p < end && *p != '/' && !is_space(*p)
+          && !resolve_index(p, end, seen.texcoords, corner.texcoord))
+        return false;
+
+      if (p < end && *p == '/') {
+        p++;
+        if (!resolve_index(p, end, seen.normals, corner.normal))
+          return false;
+      }
+    }
+
+    if (p < end && !is_space(*p))
+      return false;
+
+    if (corner_count == 0) {
+      first = corner;
+    } else if (corner_count >= 2) {
+      corners.push_back(first);
+      corners.push_back(previous);
+      corners.push_back(corner);
+    }
+    previous = corner;
+    corner_count++;
+  }
+
+  return corner_count >= 3;
+}
+
+void count_chunk(Chunk& chunk)
+{
+  for_each_line(chunk.begin, chunk.end, [&](const char* p, const char* end) {
+    switch (line_kind(p, end)) {
+    case LineKind::POSITION:
+      chunk.counts.positions++;
+      break;
+    case LineKind::TEXCOORD:
+      chunk.counts.texcoords++;
+      break;
+    case LineKind::NORMAL:
+      chunk.counts.normals++;
+      break;
+    default:
+      break;
+    }
+  });
+}
+
+void parse_chunk(Chunk& chunk, Attributes& attributes)
+{
+  AttributeCounts seen = chunk.base;
+
+  for_each_line(chunk.begin, chunk.end, [&](const char* p, const char* end) {
+    if (!chunk.ok)
+      return;
+
+    switch (line_kind(p, end)) {
+    case LineKind::POSITION:
+      chunk.ok = parse_floats(
+          p, end, &attributes.positions[seen.positions++ * 3], 3, 3);
+      break;
+    case LineKind::TEXCOORD:
+      chunk.ok = parse_floats(
+          p, end, &attributes.texcoords[seen.texcoords++ * 2], 1, 2);
+      break;
+    case LineKind::NORMAL:
+      chunk.ok
+          = parse_floats(p, end, &attributes.normals[seen.normals++ * 3], 3, 3);
+      break;
+    case LineKind::FACE:
+      chunk.ok = parse_face(p, end, seen, chunk.corners);
+      break;
+    default:
+      break;
+    }
+  });
+}
+
+std::vector<Chunk> split_lines(
+    const char* text, std::size_t size, std::size_t chunk_count)
+{
+  std::vector<Chunk> chunks;
+  const char* begin = text;
+  const char* end = text + size;
+
+  for (std::size_t i = 1; i <= chunk_count && begin < end; i++) {
+    const char* split = i == chunk_count ? end : text + size * i / chunk_count;
+    if (split < begin)
+      split = begin;
+
+    const auto* newline = static_cast<const char*>(
+        std::memchr(split, '\n', static_cast<std::size_t>(end - split)));
+    split = newline ? newline + 1 : end;
+
+    chunks.push_back({ begin, split, {}, {}, {}, true });
+    begin = split;
+  }
+
+  return chunks;
+}
+
+template <typename Body>
+void for_each_chunk(
+    threading::ThreadPool* pool, std::size_t count, const Body& body)
+{
+  if (!pool) {
+    for (std::size_t i = 0; i < count; i++)
+      body(i);
+    return;
+  }
+
+  pool->parallel_for(count, 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++)
+      body(i);
+  });
+}
+
+std::uint32_t hash_corner(const Corner& corner)
+{
+  std::uint32_t hash = static_cast<std::uint32_t>(corner.position) * 0x9e3779b1u
+      ^ static_cast<std::uint32_t>(corner.texcoord) * 0x85ebca77u
+      ^ static_cast<std::uint32_t>(corner.normal) * 0xc2b2ae3du;
+  hash ^= hash >> 16;
+  hash *= 0x7feb352du;
+  hash ^= hash >> 15;
+  return hash;
+}
+
+// Open addressing over indices into `unique`; kept at most half full.
+class CornerTable {
+public:
+  explicit CornerTable(std::size_t expected)
+  {
+    std::size_t capacity = 1024;
+    while (capacity < expected * 2)
+      capacity *= 2;
+    slots.assign(capacity, EMPTY_SLOT);
+  }
+
+  std::uint32_t insert(const Corner& corner)
+  {
+    if ((unique.size() + 1) * 2 > slots.size())
+      grow();
+
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t slot = hash_corner(corner) & mask;;
+        slot = (slot + 1) & mask) {
+      if (slots[slot] == EMPTY_SLOT) {
+        slots[slot] = static_cast<std::uint32_t>(unique.size());
+        unique.push_back(corner);
+        return slots[slot];
+      }
+      if (unique[slots[slot]] == corner)
+        return slots[slot];
+    }
+  }
+
+  const std::vector<Corner>& corners() const { return unique; }
+
+private:
+  void grow()
+  {
+    slots.assign(slots.size() * 2, EMPTY_SLOT);
+    const std::size_t mask = slots.size() - 1;
+    for (std::uint32_t i = 0; i < unique.size(); i++) {
+      std::size_t slot = hash_corner(unique[i]) & mask;
+      while (slots[slot] != EMPTY_SLOT)
+        slot = (slot + 1) & mask;
+      slots[slot] = i;
+    }
+  }
+
+  std::vector<std::uint32_t> slots;
+  std::vector<Corner> unique;
+};
+
+bool in_range(std::int32_t index, std::size_t count)
+{
+  return index < 0 || static_cast<std::size_t>(index) < count;
+}
+
+} // namespace
+
+bool mesh::parse_obj(const char* text, std::size_t size, MeshData& mesh,
+    threading::ThreadPool* pool)
+{
+  mesh.vertices.clear();
+  mesh.indices.clear();
+
+  std::size_t chunk_count = 1;
+  if (pool) {
+    chunk_count = std::clamp<std::size_t>(size / MIN_CHUNK_BYTES, 1,
+        pool->size() * CHUNKS_PER_THREAD);
+  }
+  auto chunks = split_lines(text, size, chunk_count);
+
+  for_each_chunk(pool, chunks.size(), [&](std::size_t i) {
+    count_chunk(chunks[i]);
+  });
+
+  AttributeCounts total {};
+  for (auto& chunk : chunks) {
+    chunk.base = total;
+    total.positions += chunk.counts.positions;
+    total.texcoords += chunk.counts.texcoords;
+    total.normals += chunk.counts.normals;
+  }
+
+  Attributes attributes;
+  attributes.positions.resize(total.positions * 3);
+  attributes.texcoords.resize(total.texcoords * 2);
+  attributes.normals.resize(total.normals * 3);
+
+  for_each_chunk(pool, chunks.size(), [&](std::size_t i) {
+    parse_chunk(chunks[i], attributes);
+  });
+
+  std::size_t corner_count = 0;
+  for (const auto& chunk : chunks) {
+    if (!chunk.ok)
+      return false;
+    corner_count += chunk.corners.size();
+  }
+
+  CornerTable table(total.positions);
+  mesh.indices.reserve(corner_count);
+  for (const auto& chunk : chunks) {
+    for (const Corner& corner : chunk.corners) {
+      if (!in_range(corner.position, total.positions)
+          || !in_range(corner.texcoord, total.texcoords)
+          || !in_range(corner.normal, total.normals))
+        return false;
+      mesh.indices.push_back(table.insert(corner));
+    }
+  }
+
+  const auto& unique = table.corners();
+  mesh.vertices.resize(unique.size());
+  auto build = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++) {
+      const Corner& corner = unique[i];
+      MeshVertex& vertex = mesh.vertices[i];
+      std::memcpy(vertex.position,
+          &attributes.positions[static_cast<std::size_t>(corner.position) * 3],
+          sizeof(vertex.position));
+
+      if (corner.normal >= 0) {
+        std::memcpy(vertex.normal,
+            &attributes.normals[static_cast<std::size_t>(corner.normal) * 3],
+            sizeof(vertex.normal));
+      } else {
+        std::fill(std::begin(vertex.normal), std::end(vertex.normal), 0.0f);
+      }
+
+      if (corner.texcoord >= 0) {
+        std::memcpy(vertex.uv,
+            &attributes.texcoords[static_cast<std::size_t>(corner.texcoord)
+                * 2],
+            sizeof(vertex.uv));
+      } else {
+        std::fill(std::begin(vertex.uv), std::end(vertex.uv), 0.0f);
+      }
+    }
+  };
+
+  if (pool)
+    pool->parallel_for(unique.size(), 1 << 16, build);
+  else
+    build(0, unique.size());
+
+  return true;
+}
+
+bool mesh::load_obj(
+    const std::string& path, MeshData& mesh, threading::ThreadPool* pool)
+{
+  asset::MappedFile file;
+  if (!file.open(path)) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return false;
+  }
+
+  if (!parse_obj(reinterpret_cast<const char*>(file.data()), file.size(), mesh,
+          pool)) {
+    std::cout << "failed to parse OBJ: " << path << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+mesh::GpuMesh mesh::upload_mesh(const MeshData& mesh)
+{
+  gl_object::VAO vao;
+  vao.bind_vao();
+
+  gl_object::VBO vbo(reinterpret_cast<const GLfloat*>(mesh.vertices.data()),
+      static_cast<GLsizeiptr>(mesh.vertices.size() * sizeof(MeshVertex)));
+  gl_object::EBO ebo(mesh.indices.data(),
+      static_cast<GLsizeiptr>(mesh.indices.size() * sizeof(GLuint)));
+
+  constexpr auto stride = static_cast<GLsizei>(sizeof(MeshVertex));
+  vao.link_attribute(vbo, 0, 3, stride, offsetof(MeshVertex, position));
+  vao.link_attribute(vbo, 1, 3, stride, offsetof(MeshVertex, normal));
+  vao.link_attribute(vbo, 2, 2, stride, offsetof(MeshVertex, uv));
+
+  vao.unbind_vao();
+  return { vao, vbo, ebo, static_cast<GLsizei>(mesh.indices.size()),
+    GL_UNSIGNED_INT };
+}
+
+void mesh::delete_mesh(GpuMesh& mesh)
+{
+  mesh.vao.delete_vao();
+  mesh.vbo.delete_vbo();
+  mesh.ebo.delete_ebo();
+  mesh.index_count = 0;
+}
@@ -0,0 +1,107 @@
+#include "../../include/resource/dependency_graph.h"
+
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
+
+namespace {
+
+const std::vector<std::string> NO_EDGES;
+
+void erase_edge(std::vector<std::string>& edges, const std::string& node)
+{
+  edges.erase(std::remove(edges.begin(), edges.end(), node), edges.end());
+}
+
+} // namespace
+
+void resource::DependencyGraph::set_dependencies(
+    const std::string& asset, const std::vector<std::string>& dependencies)
+{
+  remove(asset);
+
+  auto& edges = forward[asset];
+  for (const auto& dependency : dependencies) {
+    if (dependency == asset
+        || std::find(edges.begin(), edges.end(), dependency) != edges.end())
+      continue;
+    edges.push_back(dependency);
+    reverse[dependency].push_back(asset);
+  }
+}
+
+void resource::DependencyGraph::remove(const std::string& asset)
+{
+  auto found = forward.find(asset);
+  if (found == forward.end())
+    return;
+
+  for (const auto& dependency : found->second) {
+    auto dependents = reverse.find(dependency);
+    erase_edge(dependents->second, asset);
+    if (dependents->second.empty())
+      reverse.erase(dependents);
+  }
+  forward.erase(found);
+}
+
+const std::vector<std::string>& resource::DependencyGraph::dependencies(
+    const std::string& asset) const
+{
+  auto found = forward.find(asset);
+  return found == forward.end() ? NO_EDGES : found->second;
+}
+
+const std::vector<std::string>& resource::DependencyGraph::dependents(
+    const std::string& asset) const
+{
+  auto found = reverse.find(asset);
+  return found == reverse.end() ? NO_EDGES : found->second;
+}
+
+std::vector<std::string> resource::DependencyGraph::affected(
+    const std::vector<std::string>& changed) const
+{
+  // Walk up the reverse edges to collect the set...
+  std::unordered_set<std::string> members(changed.begin(), changed.end());
+  std::deque<std::string> frontier(changed.begin(), changed.end());
+  while (!frontier.empty()) {
+    const std::string asset = std::move(frontier.front());
+    frontier.pop_front();
+    for (const auto& dependent : dependents(asset)) {
+      if (members.insert(dependent).second)
+        frontier.push_back(dependent);
+    }
+  }
+
+  // ...then order it with Kahn's algorithm over the edges inside the set.
+  std::unordered_map<std::string, std::size_t> waiting_on;
+  for (const auto& asset : members) {
+    std::size_t count = 0;
+    for (const auto& dependency : dependencies(asset))
+      count += members.count(dependency);
+    waiting_on[asset] = count;
+  }
+
+  std::vector<std::string> order;
+  order.reserve(members.size());
+  for (const auto& [asset, count] : waiting_on) {
+    if (count == 0)
+      order.push_back(asset);
+  }
+
+  for (std::size_t next = 0; next < order.size(); next++) {
+    for (const auto& dependent : dependents(order[next])) {
+      auto waiting = waiting_on.find(dependent);
+      if (waiting != waiting_on.end() && --waiting->second == 0)
+        order.push_back(dependent);
+    }
+  }
+
+  for (const auto& [asset, count] : waiting_on) {
+    if (count > 0)
+      order.push_back(asset);
+  }
+
+  return order;
+}
@@ -0,0 +1,204 @@
+#include "../../include/resource/hot_reload.h"
+#include "../../include/asset/vfs.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+resource::HotReloader::HotReloader(asset::Vfs& vfs, unsigned int worker_threads,
+    std::chrono::milliseconds debounce)
+    : vfs(vfs)
+    , watcher(debounce)
+{
+  for (unsigned int i = 0; i < std::max(1u, worker_threads); i++)
+    workers.emplace_back(&HotReloader::worker_loop, this);
+}
+
+resource::HotReloader::~HotReloader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+  for (auto& worker : workers)
+    worker.join();
+}
+
+namespace {
+
+std::vector<std::string> normalize_all(const std::vector<std::string>& paths)
+{
+  std::vector<std::string> normalized;
+  for (const auto& path : paths)
+    normalized.push_back(asset::Vfs::normalize(path));
+  return normalized;
+}
+
+} // namespace
+
+void resource::HotReloader::add(const std::string& path, ReloadRecipe recipe,
+    const std::vector<std::string>& dependencies)
+{
+  const std::string node = asset::Vfs::normalize(path);
+  recipes[node] = std::move(recipe);
+  watch(node);
+  add_dependencies(node, dependencies);
+}
+
+void resource::HotReloader::add_dependencies(
+    const std::string& path, const std::vector<std::string>& dependencies)
+{
+  const std::string node = asset::Vfs::normalize(path);
+  const auto added = normalize_all(dependencies);
+
+  auto edges = dependency_graph.dependencies(node);
+  edges.insert(edges.end(), added.begin(), added.end());
+  dependency_graph.set_dependencies(node, edges);
+
+  for (const auto& dependency : added)
+    watch(dependency);
+}
+
+void resource::HotReloader::watch(const std::string& path)
+{
+  const std::string native = vfs.native_path(path);
+  if (native.empty() || watched_files.count(native))
+    return;
+
+  if (!watcher.watch_file(native))
+    return;
+
+  watched_files.insert(native);
+  watched_directories[std::filesystem::path(native).parent_path().string()]
+      = std::filesystem::path(path).parent_path().generic_string();
+}
+
+std::size_t resource::HotReloader::update()
+{
+  if (!batch.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      unfinished -= finished;
+      finished = 0;
+    }
+    return unfinished == 0 ? apply_batch() : 0;
+  }
+
+  const auto changes = watcher.poll();
+  if (!changes.empty())
+    start_batch(changes);
+  return 0;
+}
+
+void resource::HotReloader::start_batch(
+    const std::vector<asset::FileWatcher::Change>& changes)
+{
+  std::vector<std::string> changed;
+  auto changed_at = clock::time_point::max();
+  for (const auto& change : changes) {
+    const std::filesystem::path native(change.path);
+    auto directory = watched_directories.find(native.parent_path().string());
+    if (directory == watched_directories.end())
+      continue;
+
+    // Nothing reads the Vfs index while no batch is in flight. New files
+    // are refreshed too, so a reload can include them.
+    const std::string path = asset::Vfs::normalize(
+        directory->second + "/" + native.filename().string());
+    vfs.refresh(path);
+    if (!watched_files.count(change.path))
+      continue;
+
+    changed.push_back(path);
+    changed_at = std::min(changed_at, change.first_event);
+  }
+
+  for (const auto& path : dependency_graph.affected(changed)) {
+    auto recipe = recipes.find(path);
+    if (recipe != recipes.end())
+      batch.push_back({ path, recipe->second, {}, false, changed_at, 0.0 });
+  }
+  if (batch.empty())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& job : batch)
+      queue.push_back(&job);
+  }
+  unfinished = batch.size();
+  work_available.notify_all();
+}
+
+std::size_t resource::HotReloader::apply_batch()
+{
+  std::size_t applied = 0;
+  std::unordered_set<std::string> failed;
+  for (auto& job : batch) {
+    const auto& dependencies = dependency_graph.dependencies(job.path);
+    if (std::any_of(dependencies.begin(), dependencies.end(),
+            [&](const std::string& path) { return failed.count(path); })) {
+      failed.insert(job.path);
+      continue;
+    }
+
+    const auto apply_start = clock::now();
+    if (!job.prepared || !job.recipe.apply(job.path, job.payload)) {
+      std::cout << "failed to reload " << job.path
+                << "; keeping the previous version" << std::endl;
+      failed.insert(job.path);
+      continue;
+    }
+    const auto done = clock::now();
+
+    if (!job.payload.dependencies.empty()) {
+      const auto dependencies = normalize_all(job.payload.dependencies);
+      dependency_graph.set_dependencies(job.path, dependencies);
+      for (const auto& dependency : dependencies)
+        watch(dependency);
+    }
+
+    // Formatted on its own stream so std::cout keeps its flags.
+    std::ostringstream message;
+    message << std::fixed << std::setprecision(1) << "reloaded " << job.path
+            << " in "
+            << std::chrono::duration<double, std::milli>(done - job.changed_at)
+                   .count()
+            << " ms (prepare " << job.prepare_ms << " ms, apply "
+            << std::chrono::duration<double, std::milli>(done - apply_start)
+                   .count()
+            << " ms)";
+    std::cout << message.str() << std::endl;
+    applied++;
+  }
+
+  batch.clear();
+  return applied;
+}
+
+void resource::HotReloader::worker_loop()
+{
+  while (true) {
+    Job* job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      work_available.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (stopping)
+        return;
+      job = queue.front();
+      queue.pop_front();
+    }
+
+    const auto start = clock::now();
+    job->prepared = job->recipe.prepare(job->path, job->payload);
+    job->prepare_ms
+        = std::chrono::duration<double, std::milli>(clock::now() - start)
+              .count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished++;
+  }
+}
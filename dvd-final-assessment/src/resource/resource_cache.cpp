@@ -0,0 +1,566 @@
+#include "../../include/resource/resource_cache.h"
+#include "../../include/asset/file_io.h"
+#include "../../include/asset/vfs.h"
+#include "../../include/mesh/obj_loader.h"
+#include "../../include/texture/mipmap.h"
+#include "../../include/texture/pixel_ingest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr std::uint64_t HASH_MULTIPLIER { 0x9e3779b97f4a7c15ull };
+constexpr int MAX_INCLUDE_DEPTH { 16 };
+
+std::uint64_t mix(std::uint64_t value)
+{
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ull;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebull;
+  value ^= value >> 31;
+  return value;
+}
+
+std::size_t type_index(resource::ResourceType type)
+{
+  return static_cast<std::size_t>(type);
+}
+
+std::shared_ptr<resource::Resource> upload_mips(const texture::Ktx2Image& mips)
+{
+  auto resource = std::make_shared<resource::TextureResource>();
+  resource->width = mips.width;
+  resource->height = mips.height;
+
+  glGenTextures(1, &resource->texture);
+  glBindTexture(GL_TEXTURE_2D, resource->texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(
+      GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  // The mip generator works on RGBA8, so every level is four channels.
+  const texture::PixelFormat format = texture::pixel_format_for(4);
+  const auto level_count = static_cast<GLint>(mips.levels.size());
+  for (GLint level = 0; level < level_count; level++) {
+    texture::upload_pixels(mips.levels[level].data(),
+        std::max(1, mips.width >> level), std::max(1, mips.height >> level),
+        format, level);
+    resource->bytes += mips.levels[level].size();
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+
+  return resource;
+}
+
+// Reads a source file through the VFS when there is one, else from disk.
+bool read_source(const asset::Vfs* vfs, const std::string& path,
+    asset::VfsFile& file)
+{
+  if (vfs)
+    return vfs->read(path, file);
+
+  file.path = path;
+  file.ok = asset::read_file(path, file.bytes);
+  if (!file.ok)
+    std::cout << "failed to load file: " << path << std::endl;
+  return file.ok;
+}
+
+std::shared_ptr<resource::Resource> load_texture(
+    const asset::Vfs* vfs, const std::string& path)
+{
+  // Archived textures are stored baked and go to GL as they are.
+  const asset::VfsStat* stat = vfs ? vfs->stat(path) : nullptr;
+  if (stat && stat->archive_entry
+      && stat->archive_entry->kind == asset::AssetKind::TEXTURE) {
+    const asset::AssetEntry& entry = *stat->archive_entry;
+    auto resource = std::make_shared<resource::TextureResource>();
+    resource->texture = asset::upload_texture(entry);
+    resource->width = static_cast<int>(entry.width);
+    resource->height = static_cast<int>(entry.height);
+    resource->bytes = entry.size;
+    return resource;
+  }
+
+  // Files on disk keep their mip cache next to the source.
+  const std::string native = vfs ? vfs->native_path(path) : path;
+  texture::Ktx2Image mips;
+  if (!native.empty()) {
+    if (!texture::load_mipmapped_image(native, mips))
+      return nullptr;
+    return upload_mips(mips);
+  }
+
+  asset::VfsFile file;
+  texture::IngestedImage image;
+  if (!read_source(vfs, path, file)
+      || !texture::decode_image(file.data(), file.size(), image)) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return nullptr;
+  }
+
+  return upload_mips(
+      texture::generate_mipmaps(image.pixels.data(), image.width, image.height));
+}
+
+std::shared_ptr<resource::Resource> load_shader(
+    const asset::Vfs* vfs, const std::string& path)
+{
+  const GLenum stage = resource::shader_stage_for(path);
+  if (stage == GL_NONE) {
+    std::cout << "unknown shader stage: " << path << std::endl;
+    return nullptr;
+  }
+
+  std::string source;
+  if (!resource::load_shader_source(vfs, path, source))
+    return nullptr;
+
+  auto resource = std::make_shared<resource::ShaderResource>();
+  resource->stage = stage;
+  resource->bytes = source.size();
+  resource->shader = resource::compile_shader(source, stage, path);
+  if (!resource->shader)
+    return nullptr;
+
+  return resource;
+}
+
+std::shared_ptr<resource::Resource> load_mesh(
+    const asset::Vfs* vfs, const std::string& path)
+{
+  if (std::filesystem::path(path).extension() != ".obj") {
+    std::cout << "unknown mesh format: " << path << std::endl;
+    return nullptr;
+  }
+
+  mesh::MeshData data;
+  const std::string native = vfs ? vfs->native_path(path) : path;
+  if (!native.empty()) {
+    if (!mesh::load_obj(native, data))
+      return nullptr;
+  } else {
+    asset::VfsFile file;
+    if (!read_source(vfs, path, file)
+        || !mesh::parse_obj(reinterpret_cast<const char*>(file.data()),
+            file.size(), data)) {
+      std::cout << "failed to load file: " << path << std::endl;
+      return nullptr;
+    }
+  }
+
+  const auto uploaded = mesh::upload_mesh(data);
+
+  auto resource = std::make_shared<resource::MeshResource>();
+  resource->vertex_array = uploaded.vao.ID;
+  resource->vertex_buffer = uploaded.vbo.ID;
+  resource->element_buffer = uploaded.ebo.ID;
+  resource->index_count = uploaded.index_count;
+  resource->bytes = data.vertices.size() * sizeof(mesh::MeshVertex)
+      + data.indices.size() * sizeof(GLuint);
+  return resource;
+}
+
+// Everything the default loaders read from the path rather than the file:
+// identical bytes loaded as a.vs and b.fs compile to different shaders.
+std::uint64_t path_inputs(resource::ResourceType type, const std::string& path)
+{
+  const std::filesystem::path file(path);
+  switch (type) {
+  case resource::ResourceType::SHADER: {
+    const std::string directory = file.parent_path().string();
+    return mix(resource::shader_stage_for(path)
+        ^ resource::hash_bytes(directory.data(), directory.size()));
+  }
+  case resource::ResourceType::MESH: {
+    const std::string extension = file.extension().string();
+    return resource::hash_bytes(extension.data(), extension.size());
+  }
+  default:
+    return 0;
+  }
+}
+
+void release_texture(resource::Resource& resource)
+{
+  auto& texture = static_cast<resource::TextureResource&>(resource);
+  glDeleteTextures(1, &texture.texture);
+}
+
+void release_shader(resource::Resource& resource)
+{
+  glDeleteShader(static_cast<resource::ShaderResource&>(resource).shader);
+}
+
+void release_mesh(resource::Resource& resource)
+{
+  auto& mesh = static_cast<resource::MeshResource&>(resource);
+  glDeleteVertexArrays(1, &mesh.vertex_array);
+  glDeleteBuffers(1, &mesh.vertex_buffer);
+  glDeleteBuffers(1, &mesh.element_buffer);
+}
+
+} // namespace
+
+const char* resource::resource_type_name(ResourceType type)
+{
+  switch (type) {
+  case ResourceType::TEXTURE:
+    return "texture";
+  case ResourceType::SHADER:
+    return "shader";
+  case ResourceType::MESH:
+    return "mesh";
+  default:
+    return "unknown";
+  }
+}
+
+std::uint64_t resource::hash_bytes(const void* data, std::size_t size)
+{
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t hash = mix(size);
+
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ mix(word)) * HASH_MULTIPLIER;
+  }
+
+  std::uint64_t tail = 0;
+  std::memcpy(&tail, bytes + i, size - i);
+  hash = (hash ^ mix(tail)) * HASH_MULTIPLIER;
+
+  return mix(hash);
+}
+
+bool resource::hash_file(const std::string& path, std::uint64_t& hash)
+{
+  asset::MappedFile file;
+  if (!file.open(path))
+    return false;
+
+  hash = hash_bytes(file.data(), file.size());
+  return true;
+}
+
+GLenum resource::shader_stage_for(const std::string& path)
+{
+  const std::string extension = std::filesystem::path(path).extension().string();
+  if (extension == ".vs" || extension == ".vert")
+    return GL_VERTEX_SHADER;
+  if (extension == ".fs" || extension == ".frag")
+    return GL_FRAGMENT_SHADER;
+  if (extension == ".gs" || extension == ".geom")
+    return GL_GEOMETRY_SHADER;
+  return GL_NONE;
+}
+
+namespace {
+
+bool expand_includes(const asset::Vfs* vfs, const std::string& path,
+    int depth, std::string& source, std::vector<std::string>* includes)
+{
+  if (depth > MAX_INCLUDE_DEPTH) {
+    std::cout << "includes nested too deeply: " << path << std::endl;
+    return false;
+  }
+
+  asset::VfsFile file;
+  if (!read_source(vfs, path, file))
+    return false;
+
+  const std::string_view text(
+      reinterpret_cast<const char*>(file.data()), file.size());
+  std::size_t start = 0;
+  while (start < text.size()) {
+    std::size_t end = text.find('\n', start);
+    end = end == std::string_view::npos ? text.size() : end + 1;
+    const std::string_view line = text.substr(start, end - start);
+    start = end;
+
+    const auto first = line.find_first_not_of(" \t");
+    if (first == std::string_view::npos
+        || line.compare(first, 8, "#include") != 0) {
+      source += line;
+      continue;
+    }
+
+    const auto open = line.find('"', first);
+    const auto close = line.find('"', open + 1);
+    if (open == std::string_view::npos || close == std::string_view::npos) {
+      std::cout << "malformed #include in " << path << std::endl;
+      return false;
+    }
+
+    const std::string included = (std::filesystem::path(path).parent_path()
+        / std::string(line.substr(open + 1, close - open - 1)))
+                                     .lexically_normal()
+                                     .generic_string();
+    if (includes)
+      includes->push_back(included);
+    if (!expand_includes(vfs, included, depth + 1, source, includes))
+      return false;
+    if (!source.empty() && source.back() != '\n')
+      source += '\n';
+  }
+
+  return true;
+}
+
+} // namespace
+
+bool resource::load_shader_source(const asset::Vfs* vfs,
+    const std::string& path, std::string& source,
+    std::vector<std::string>* includes)
+{
+  source.clear();
+  return expand_includes(vfs, path, 0, source, includes);
+}
+
+GLuint resource::compile_shader(
+    const std::string& source, GLenum stage, const std::string& name)
+{
+  GLuint shader = glCreateShader(stage);
+  const auto* text = source.data();
+  const auto length = static_cast<GLint>(source.size());
+  glShaderSource(shader, 1, &text, &length);
+  glCompileShader(shader);
+
+  int compiled {};
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (!compiled) {
+    char log_info[512];
+    glGetShaderInfoLog(shader, sizeof(log_info), nullptr, log_info);
+    std::cout << "failed to compile shader: " << name << "\n"
+              << log_info << std::endl;
+    glDeleteShader(shader);
+    return 0;
+  }
+
+  return shader;
+}
+
+resource::ResourceCache::ResourceCache(
+    std::size_t budget_bytes, const asset::Vfs* vfs)
+    : budget_bytes(budget_bytes)
+    , vfs(vfs)
+{
+  hooks[type_index(ResourceType::TEXTURE)] = {
+    [vfs](const std::string& path) { return load_texture(vfs, path); },
+    release_texture
+  };
+  hooks[type_index(ResourceType::SHADER)] = {
+    [vfs](const std::string& path) { return load_shader(vfs, path); },
+    release_shader
+  };
+  hooks[type_index(ResourceType::MESH)] = {
+    [vfs](const std::string& path) { return load_mesh(vfs, path); },
+    release_mesh
+  };
+}
+
+void resource::ResourceCache::set_loader(
+    ResourceType type, Loader loader, Releaser releaser)
+{
+  hooks[type_index(type)] = { std::move(loader), std::move(releaser) };
+}
+
+bool resource::ResourceCache::content_hash_of(
+    const std::string& path, std::uint64_t& hash)
+{
+  if (vfs)
+    return vfs_content_hash_of(path, hash);
+
+  std::error_code error;
+  auto size = std::filesystem::file_size(path, error);
+  if (error)
+    return false;
+  auto modified = std::filesystem::last_write_time(path, error);
+  if (error)
+    return false;
+
+  auto record = paths.find(path);
+  if (record != paths.end() && record->second.size == size
+      && record->second.modified == modified) {
+    hash = record->second.content_hash;
+    return true;
+  }
+
+  if (!hash_file(path, hash))
+    return false;
+
+  paths[path] = { size, modified, hash };
+  return true;
+}
+
+// Same scheme over the VFS index, which already knows size and modification
+// time, so a known path costs no syscalls at all.
+bool resource::ResourceCache::vfs_content_hash_of(
+    const std::string& path, std::uint64_t& hash)
+{
+  const asset::VfsStat* stat = vfs->stat(path);
+  if (!stat)
+    return false;
+  if (stat->content_hash) {
+    hash = stat->content_hash;
+    return true;
+  }
+
+  auto record = paths.find(path);
+  if (record != paths.end() && record->second.size == stat->size
+      && record->second.modified == stat->modified) {
+    hash = record->second.content_hash;
+    return true;
+  }
+
+  const std::string native = vfs->native_path(path);
+  if (!native.empty()) {
+    if (!hash_file(native, hash))
+      return false;
+  } else {
+    asset::VfsFile file;
+    if (!vfs->read(path, file))
+      return false;
+    hash = hash_bytes(file.data(), file.size());
+  }
+
+  paths[path] = { stat->size, stat->modified, hash };
+  return true;
+}
+
+std::shared_ptr<const resource::Resource> resource::ResourceCache::acquire(
+    ResourceType type, const std::string& path)
+{
+  std::error_code error;
+  const std::string canonical = vfs
+      ? asset::Vfs::normalize(path)
+      : std::filesystem::weakly_canonical(path, error).string();
+
+  std::uint64_t content_hash;
+  if (error || !content_hash_of(canonical, content_hash)) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return nullptr;
+  }
+
+  ResourceStats& counters = stats_of(type);
+  const EntryKey key { type, content_hash, path_inputs(type, canonical) };
+
+  auto found = entries.find(key);
+  if (found != entries.end()) {
+    counters.hits++;
+    recent.splice(recent.begin(), recent, found->second.recent);
+    return found->second.resource;
+  }
+
+  counters.misses++;
+  const TypeHooks& type_hooks = hooks[type_index(type)];
+  if (!type_hooks.loader) {
+    std::cout << "no loader registered for " << resource_type_name(type)
+              << ": " << path << std::endl;
+    return nullptr;
+  }
+
+  std::shared_ptr<Resource> resource = type_hooks.loader(canonical);
+  if (!resource)
+    return nullptr;
+
+  recent.push_front(key);
+  entries.emplace(key, Entry { resource, recent.begin() });
+  resident_bytes += resource->bytes;
+  counters.resident_bytes += resource->bytes;
+  counters.resident_count++;
+
+  trim();
+  return resource;
+}
+
+void resource::ResourceCache::set_budget(std::size_t budget)
+{
+  budget_bytes = budget;
+  trim();
+}
+
+void resource::ResourceCache::trim()
+{
+  auto candidate = recent.end();
+  while (resident_bytes > budget_bytes && candidate != recent.begin()) {
+    --candidate;
+    auto entry = entries.find(*candidate);
+
+    // Only the cache holds it: nobody is drawing with it.
+    if (entry->second.resource.use_count() == 1) {
+      auto next = std::next(candidate);
+      evict(entry);
+      candidate = next;
+    }
+  }
+}
+
+void resource::ResourceCache::evict(std::map<EntryKey, Entry>::iterator entry)
+{
+  const ResourceType type = entry->first.type;
+  Resource& resource = *entry->second.resource;
+
+  if (hooks[type_index(type)].releaser)
+    hooks[type_index(type)].releaser(resource);
+
+  ResourceStats& counters = stats_of(type);
+  counters.evictions++;
+  counters.resident_bytes -= resource.bytes;
+  counters.resident_count--;
+  resident_bytes -= resource.bytes;
+
+  recent.erase(entry->second.recent);
+  entries.erase(entry);
+}
+
+resource::ResourceStats& resource::ResourceCache::stats_of(ResourceType type)
+{
+  return type_stats[type_index(type)];
+}
+
+const resource::ResourceStats& resource::ResourceCache::stats(
+    ResourceType type) const
+{
+  return type_stats[type_index(type)];
+}
+
+void resource::ResourceCache::print_stats() const
+{
+  for (std::size_t i = 0; i < RESOURCE_TYPE_COUNT; i++) {
+    const auto type = static_cast<ResourceType>(i);
+    const ResourceStats& counters = type_stats[i];
+    std::cout << resource_type_name(type) << ": " << counters.hits
+              << " hits, " << counters.misses << " misses, "
+              << counters.evictions << " evictions, "
+              << counters.resident_count << " resident ("
+              << counters.resident_bytes / 1024 << " KiB)" << std::endl;
+  }
+  std::cout << "resident: " << resident_bytes / 1024 << " / "
+            << budget_bytes / 1024 << " KiB" << std::endl;
+}
+
+void resource::ResourceCache::clear()
+{
+  for (auto& [key, entry] : entries) {
+    if (hooks[type_index(key.type)].releaser)
+      hooks[type_index(key.type)].releaser(*entry.resource);
+  }
+
+  entries.clear();
+  recent.clear();
+  paths.clear();
+  resident_bytes = 0;
+  for (auto& counters : type_stats) {
+    counters.resident_bytes = 0;
+    counters.resident_count = 0;
+  }
+}
@@ -0,0 +1,654 @@
+#include "../../include/resource/streaming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "../../include/mesh/baked_mesh.h"
+
+namespace {
+
+// Mips this size or smaller are loaded together as level 0.
+constexpr int TAIL_PIXELS { 64 };
+// Bounds containing the camera count as this many pixels across.
+constexpr float NEAR_PIXELS { 1.0e6f };
+// Assets out of view still rank, far behind anything visible.
+constexpr float HIDDEN_WEIGHT { 1.0f / 16.0f };
+// Every level 0 outranks every finer level.
+constexpr float LEVEL_ZERO_PRIORITY { 1.0e9f };
+constexpr std::size_t PAGE_BYTES { 4096 };
+
+// Faults the range in on the worker, so the upload does not stall on the
+// disk.
+void touch_pages(const unsigned char* data, std::size_t size)
+{
+  unsigned char sum = 0;
+  for (std::size_t offset = 0; offset < size; offset += PAGE_BYTES)
+    sum ^= data[offset];
+  if (size > 0)
+    sum ^= data[size - 1];
+
+  // Keeps the reads without storing the result anywhere.
+#if defined(__GNUC__)
+  asm volatile("" : : "r"(sum));
+#else
+  volatile unsigned char sink = sum;
+  (void)sink;
+#endif
+}
+
+} // namespace
+
+resource::StreamedTexture::StreamedTexture(const asset::Vfs& vfs, std::string path)
+    : vfs(vfs)
+    , path(std::move(path))
+{
+}
+
+bool resource::StreamedTexture::open()
+{
+  const std::string native = vfs.native_path(path);
+  if (!native.empty() ? !file.open(native) : !vfs.read(path, vfs_file)) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return false;
+  }
+
+  const std::size_t size = file.is_open() ? file.size() : vfs_file.size();
+  if (!texture::parse_ktx2(bytes(), size, path, header, mips))
+    return false;
+
+  texture::gl_texture_format(header.vk_format, format);
+  if (!texture::gl_texture_format_supported(format)) {
+    std::cout << "texture format " << header.vk_format
+              << " is not supported by this driver" << std::endl;
+    return false;
+  }
+
+  tail = mips.size() - 1;
+  for (std::size_t mip = 0; mip < mips.size(); mip++) {
+    if (std::max(header.width >> mip, header.height >> mip) <= TAIL_PIXELS) {
+      tail = mip;
+      break;
+    }
+  }
+
+  return true;
+}
+
+const unsigned char* resource::StreamedTexture::bytes() const
+{
+  return file.is_open() ? file.data() : vfs_file.data();
+}
+
+int resource::StreamedTexture::base_mip() const
+{
+  return resident == 0 ? -1 : static_cast<int>(tail - (resident - 1));
+}
+
+std::array<std::size_t, 2> resource::StreamedTexture::mips_of(
+    std::size_t level) const
+{
+  if (level == 0)
+    return { tail, mips.size() - 1 };
+  return { tail - level, tail - level };
+}
+
+std::size_t resource::StreamedTexture::level_count() const
+{
+  return mips.empty() ? 0 : tail + 1;
+}
+
+std::size_t resource::StreamedTexture::level_bytes(std::size_t level) const
+{
+  const auto [first, last] = mips_of(level);
+  std::size_t bytes = 0;
+  for (std::size_t mip = first; mip <= last; mip++)
+    bytes += mips[mip].length;
+  return bytes;
+}
+
+float resource::StreamedTexture::level_pixels(std::size_t level) const
+{
+  if (level == 0)
+    return 0.0f;
+
+  // Wanted once the next coarser mip would be magnified.
+  const std::size_t mip = mips_of(level)[0];
+  return 0.5f
+      * static_cast<float>(std::max(header.width >> mip, header.height >> mip));
+}
+
+bool resource::StreamedTexture::load(std::size_t level, std::any&)
+{
+  const auto [first, last] = mips_of(level);
+  for (std::size_t mip = first; mip <= last; mip++) {
+    if (file.is_open())
+      file.prefetch(mips[mip].offset, mips[mip].length);
+    touch_pages(bytes() + mips[mip].offset, mips[mip].length);
+  }
+  return true;
+}
+
+bool resource::StreamedTexture::upload(std::size_t level, std::any&)
+{
+  if (level == 0) {
+    glGenTextures(1, &gl_texture);
+    glBindTexture(GL_TEXTURE_2D, gl_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+        static_cast<GLint>(mips.size() - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+        mips.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  } else {
+    glBindTexture(GL_TEXTURE_2D, gl_texture);
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  const auto [first, last] = mips_of(level);
+  for (std::size_t mip = first; mip <= last; mip++) {
+    const int width = std::max(1, header.width >> mip);
+    const int height = std::max(1, header.height >> mip);
+    const unsigned char* data = bytes() + mips[mip].offset;
+
+    if (format.compressed) {
+      glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(mip),
+          format.internal_format, width, height, 0,
+          static_cast<GLsizei>(mips[mip].length), data);
+    } else if (!header.origin_bottom_left) {
+      glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(mip),
+          format.internal_format, width, height, 0, format.format, format.type,
+          texture::flip_level_rows(format, data, width, height).data());
+    } else {
+      glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(mip),
+          format.internal_format, width, height, 0, format.format, format.type,
+          data);
+    }
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  // Levels below the base are never sampled, so the texture stays complete
+  // while the larger mips are missing.
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(first));
+  resident = level + 1;
+  return true;
+}
+
+void resource::StreamedTexture::evict(std::size_t level)
+{
+  const auto mip = static_cast<GLint>(mips_of(level)[0]);
+  glBindTexture(GL_TEXTURE_2D, gl_texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, mip + 1);
+
+  // Respecifying the mip as empty is what lets the driver free it.
+  if (format.compressed) {
+    glCompressedTexImage2D(
+        GL_TEXTURE_2D, mip, format.internal_format, 0, 0, 0, 0, nullptr);
+  } else {
+    glTexImage2D(GL_TEXTURE_2D, mip, format.internal_format, 0, 0, 0,
+        format.format, format.type, nullptr);
+  }
+  resident = level;
+}
+
+void resource::StreamedTexture::release()
+{
+  if (gl_texture != 0)
+    glDeleteTextures(1, &gl_texture);
+  gl_texture = 0;
+  resident = 0;
+}
+
+resource::StreamedMesh::StreamedMesh(const asset::Vfs& vfs, std::vector<Lod> lods)
+    : vfs(vfs)
+    , lods(std::move(lods))
+{
+}
+
+bool resource::StreamedMesh::open()
+{
+  native_paths.clear();
+  sizes.clear();
+  for (const auto& lod : lods) {
+    const asset::VfsStat* stat = vfs.stat(lod.path);
+    std::string native = vfs.native_path(lod.path);
+    if (stat == nullptr || native.empty()) {
+      std::cout << "failed to load file: " << lod.path << std::endl;
+      return false;
+    }
+    native_paths.push_back(std::move(native));
+    sizes.push_back(stat->size);
+  }
+  return !lods.empty();
+}
+
+const mesh::GpuMesh* resource::StreamedMesh::finest() const
+{
+  return resident.empty() ? nullptr : &resident.back();
+}
+
+const float* resource::StreamedMesh::finest_matrix() const
+{
+  return matrices.empty() ? nullptr : matrices.back().data();
+}
+
+std::size_t resource::StreamedMesh::level_bytes(std::size_t level) const
+{
+  return sizes[level];
+}
+
+float resource::StreamedMesh::level_pixels(std::size_t level) const
+{
+  return level == 0 ? 0.0f : lods[level].pixels;
+}
+
+bool resource::StreamedMesh::load(std::size_t level, std::any& data)
+{
+  // Shared, as std::any needs a copyable value and the mapping is not.
+  auto baked = std::make_shared<mesh::BakedMesh>();
+  if (!mesh::read_baked_mesh(native_paths[level], *baked))
+    return false;
+
+  touch_pages(baked->file.data(), baked->file.size());
+  data = std::move(baked);
+  return true;
+}
+
+bool resource::StreamedMesh::upload(std::size_t, std::any& data)
+{
+  const auto& baked = *std::any_cast<std::shared_ptr<mesh::BakedMesh>&>(data);
+  resident.push_back(mesh::upload_baked_mesh(baked));
+  mesh::dequantize_matrix(baked, matrices.emplace_back().data());
+  data.reset();
+  return true;
+}
+
+void resource::StreamedMesh::evict(std::size_t)
+{
+  mesh::delete_mesh(resident.back());
+  resident.pop_back();
+  matrices.pop_back();
+}
+
+void resource::StreamedMesh::release()
+{
+  for (auto& lod : resident)
+    mesh::delete_mesh(lod);
+  resident.clear();
+  matrices.clear();
+}
+
+resource::StreamingLoader::StreamingLoader(std::size_t budget_bytes,
+    unsigned int worker_threads, std::size_t upload_budget_bytes)
+    : budget_bytes(budget_bytes)
+    , upload_budget_bytes(upload_budget_bytes)
+    , max_requests(16 * std::max(1u, worker_threads))
+{
+  for (unsigned int i = 0; i < std::max(1u, worker_threads); i++)
+    workers.emplace_back(&StreamingLoader::worker_loop, this);
+}
+
+resource::StreamingLoader::~StreamingLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+  for (auto& worker : workers)
+    worker.join();
+}
+
+resource::StreamId resource::StreamingLoader::add(
+    std::shared_ptr<StreamSource> source, const StreamBounds& bounds)
+{
+  const StreamId id = next_id++;
+  Asset& asset = assets[id];
+  asset.source = std::move(source);
+  asset.bounds = bounds;
+  return id;
+}
+
+void resource::StreamingLoader::remove(StreamId id)
+{
+  auto found = assets.find(id);
+  if (found == assets.end())
+    return;
+
+  cancel_request(found->second);
+  found->second.source->release();
+  loader_stats.resident_bytes -= found->second.resident_bytes;
+  assets.erase(found);
+}
+
+void resource::StreamingLoader::set_bounds(StreamId id, const StreamBounds& bounds)
+{
+  auto found = assets.find(id);
+  if (found != assets.end())
+    found->second.bounds = bounds;
+}
+
+void resource::StreamingLoader::set_visible(StreamId id, bool visible)
+{
+  auto found = assets.find(id);
+  if (found != assets.end())
+    found->second.visible = visible;
+}
+
+void resource::StreamingLoader::cancel(StreamId id)
+{
+  auto found = assets.find(id);
+  if (found == assets.end())
+    return;
+
+  found->second.paused = true;
+  cancel_request(found->second);
+}
+
+void resource::StreamingLoader::resume(StreamId id)
+{
+  auto found = assets.find(id);
+  if (found != assets.end())
+    found->second.paused = false;
+}
+
+resource::StreamSource* resource::StreamingLoader::source(StreamId id) const
+{
+  auto found = assets.find(id);
+  return found == assets.end() ? nullptr : found->second.source.get();
+}
+
+std::size_t resource::StreamingLoader::resident_levels(StreamId id) const
+{
+  auto found = assets.find(id);
+  return found == assets.end() ? 0 : found->second.resident;
+}
+
+std::size_t resource::StreamingLoader::wanted_levels(StreamId id) const
+{
+  auto found = assets.find(id);
+  return found == assets.end() ? 0 : found->second.wanted;
+}
+
+void resource::StreamingLoader::set_budget(std::size_t budget_bytes)
+{
+  this->budget_bytes = budget_bytes;
+}
+
+void resource::StreamingLoader::update(const StreamView& view)
+{
+  rank(view);
+
+  for (auto& [id, asset] : assets) {
+    if (asset.request
+        && (asset.paused || asset.request->level >= asset.wanted))
+      cancel_request(asset);
+  }
+
+  collect();
+  upload_ready();
+
+  // Only needed after the budget shrank; requests are issued to fit.
+  make_room(0, LEVEL_ZERO_PRIORITY);
+
+  issue_requests();
+}
+
+void resource::StreamingLoader::rank(const StreamView& view)
+{
+  for (auto& [id, asset] : assets) {
+    const auto& bounds = asset.bounds;
+    const float dx = bounds.center[0] - view.position[0];
+    const float dy = bounds.center[1] - view.position[1];
+    const float dz = bounds.center[2] - view.position[2];
+    const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    const float pixels = distance <= bounds.radius
+        ? NEAR_PIXELS
+        : 2.0f * std::asin(bounds.radius / distance) * view.pixels_per_radian;
+
+    const StreamSource& source = *asset.source;
+    std::size_t wanted = 1;
+    if (asset.visible) {
+      while (wanted < source.level_count()
+          && source.level_pixels(wanted) <= pixels)
+        wanted++;
+    }
+
+    asset.wanted = std::min(wanted, source.level_count());
+    asset.priority = asset.visible ? pixels : pixels * HIDDEN_WEIGHT;
+  }
+
+  auto request_priority = [this](const Request& request) {
+    const float priority = assets.at(request.id).priority;
+    return request.level == 0 ? LEVEL_ZERO_PRIORITY + priority : priority;
+  };
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto& request : queue)
+    request->priority = request_priority(*request);
+  for (auto& request : ready)
+    request->priority = request_priority(*request);
+}
+
+void resource::StreamingLoader::cancel_request(Asset& asset)
+{
+  if (!asset.request)
+    return;
+
+  const auto request = std::move(asset.request);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    request->cancelled = true;
+    queue.erase(std::remove(queue.begin(), queue.end(), request), queue.end());
+  }
+  ready.erase(std::remove(ready.begin(), ready.end(), request), ready.end());
+
+  loader_stats.pending_bytes -= request->bytes;
+  loader_stats.pending--;
+  loader_stats.cancelled++;
+}
+
+void resource::StreamingLoader::collect()
+{
+  std::vector<std::shared_ptr<Request>> done;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done.swap(finished);
+  }
+
+  for (auto& request : done) {
+    // Cancelled while a worker had it; already accounted for.
+    if (request->cancelled)
+      continue;
+
+    if (request->ok) {
+      ready.push_back(std::move(request));
+      continue;
+    }
+
+    Asset& asset = assets.at(request->id);
+    asset.request.reset();
+    asset.failed = true;
+    loader_stats.pending_bytes -= request->bytes;
+    loader_stats.pending--;
+    loader_stats.failed++;
+  }
+}
+
+void resource::StreamingLoader::upload_ready()
+{
+  std::sort(ready.begin(), ready.end(), [](const auto& a, const auto& b) {
+    return a->priority > b->priority;
+  });
+
+  // At least one upload a frame, however large.
+  std::size_t uploaded_bytes = 0;
+  std::size_t uploaded = 0;
+  for (; uploaded < ready.size(); uploaded++) {
+    Request& request = *ready[uploaded];
+    if (uploaded_bytes > 0
+        && uploaded_bytes + request.bytes > upload_budget_bytes)
+      break;
+    uploaded_bytes += request.bytes;
+
+    Asset& asset = assets.at(request.id);
+    asset.request.reset();
+    loader_stats.pending_bytes -= request.bytes;
+    loader_stats.pending--;
+
+    if (!asset.source->upload(request.level, request.data)) {
+      asset.failed = true;
+      loader_stats.failed++;
+      continue;
+    }
+
+    asset.resident++;
+    asset.resident_bytes += request.bytes;
+    loader_stats.resident_bytes += request.bytes;
+    loader_stats.loaded++;
+  }
+
+  ready.erase(ready.begin(), ready.begin() + static_cast<std::ptrdiff_t>(uploaded));
+}
+
+void resource::StreamingLoader::evict_level(Asset& asset)
+{
+  // The request would no longer follow on from what is resident.
+  cancel_request(asset);
+
+  const std::size_t level = asset.resident - 1;
+  const std::size_t bytes = asset.source->level_bytes(level);
+  asset.source->evict(level);
+  asset.resident--;
+  asset.resident_bytes -= bytes;
+  loader_stats.resident_bytes -= bytes;
+  loader_stats.evicted++;
+}
+
+bool resource::StreamingLoader::make_room(std::size_t bytes, float priority)
+{
+  while (loader_stats.resident_bytes + loader_stats.pending_bytes + bytes
+      > budget_bytes) {
+    // Levels nobody wants first, then the lowest ranked.
+    Asset* victim = nullptr;
+    bool victim_unwanted = false;
+    for (auto& [id, asset] : assets) {
+      if (asset.resident <= 1)
+        continue;
+
+      const bool unwanted = asset.resident > asset.wanted;
+      if (!unwanted && asset.priority >= priority)
+        continue;
+      if (victim == nullptr || (unwanted && !victim_unwanted)
+          || (unwanted == victim_unwanted && asset.priority < victim->priority)) {
+        victim = &asset;
+        victim_unwanted = unwanted;
+      }
+    }
+
+    if (victim == nullptr)
+      return false;
+    evict_level(*victim);
+  }
+
+  return true;
+}
+
+void resource::StreamingLoader::issue_requests()
+{
+  if (loader_stats.pending >= max_requests)
+    return;
+
+  std::vector<std::pair<float, StreamId>> candidates;
+  for (const auto& [id, asset] : assets) {
+    if (!asset.request && !asset.paused && !asset.failed
+        && asset.resident < asset.wanted) {
+      const float priority = asset.resident == 0
+          ? LEVEL_ZERO_PRIORITY + asset.priority
+          : asset.priority;
+      candidates.emplace_back(priority, id);
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  for (const auto& [priority, id] : candidates) {
+    if (loader_stats.pending >= max_requests)
+      break;
+
+    Asset& asset = assets.at(id);
+    // Evictions for an earlier candidate may have taken this one's levels.
+    if (asset.request || asset.resident >= asset.wanted)
+      continue;
+
+    const std::size_t level = asset.resident;
+    const std::size_t bytes = asset.source->level_bytes(level);
+    if (!make_room(bytes, priority) && level > 0)
+      continue;
+
+    auto request = std::make_shared<Request>();
+    request->id = id;
+    request->level = level;
+    request->bytes = bytes;
+    request->priority = priority;
+    request->source = asset.source;
+    asset.request = request;
+    loader_stats.pending_bytes += bytes;
+    loader_stats.pending++;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back(std::move(request));
+    }
+    work_available.notify_one();
+  }
+}
+
+void resource::StreamingLoader::worker_loop()
+{
+  while (true) {
+    std::shared_ptr<Request> request;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      work_available.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (stopping)
+        return;
+
+      auto best = std::max_element(queue.begin(), queue.end(),
+          [](const auto& a, const auto& b) { return a->priority < b->priority; });
+      request = std::move(*best);
+      queue.erase(best);
+    }
+
+    request->ok = request->source->load(request->level, request->data);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished.push_back(std::move(request));
+  }
+}
+
+void resource::StreamingLoader::print_stats() const
+{
+  // Formatted on its own stream so std::cout keeps its flags.
+  std::ostringstream message;
+  message << "streaming: " << assets.size() << " assets, " << std::fixed
+          << std::setprecision(1)
+          << loader_stats.resident_bytes / double(1 << 20) << " of "
+          << budget_bytes / double(1 << 20) << " MiB resident, "
+          << loader_stats.pending << " pending, " << loader_stats.loaded
+          << " loaded, " << loader_stats.cancelled << " cancelled, "
+          << loader_stats.evicted << " evicted, " << loader_stats.failed
+          << " failed";
+  std::cout << message.str() << std::endl;
+}
+
+void resource::StreamingLoader::clear()
+{
+  while (!assets.empty())
+    remove(assets.begin()->first);
+}
@@ -0,0 +1,357 @@
+#include "../../include/scene/scene_graph.h"
+#include "../../include/math/transform_batch.h"
+#include "../../include/threading/thread_pool.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+constexpr std::uint32_t NO_INDEX { 0xffffffffu };
+
+// Ranges longer than this are split at their children before being spread
+// over the pool.
+constexpr std::size_t NODES_PER_RANGE { 4096 };
+// Chunks handed to each thread, so uneven ranges still balance.
+constexpr std::size_t CHUNKS_PER_THREAD { 8 };
+// Dirty ranges are scattered and mostly a handful of nodes long, so their
+// cost is cache misses; this many ranges ahead are prefetched.
+constexpr std::size_t PREFETCH_RANGES { 8 };
+
+inline void prefetch(const void* address)
+{
+#if defined(__GNUC__)
+  __builtin_prefetch(address);
+#else
+  (void)address;
+#endif
+}
+
+template <typename T>
+void permute(std::vector<T>& values, const std::vector<std::uint32_t>& order)
+{
+  std::vector<T> sorted;
+  sorted.reserve(order.size());
+  for (auto index : order)
+    sorted.push_back(values[index]);
+  values.swap(sorted);
+}
+
+} // namespace
+
+void scene::SceneGraph::reserve(std::size_t count)
+{
+  parents.reserve(count);
+  subtree_sizes.reserve(count);
+  locals.reserve(count);
+  worlds.reserve(count * 16);
+  ids.reserve(count);
+  dirty.reserve(count);
+  removed.reserve(count);
+  slots.reserve(count);
+}
+
+scene::NodeId scene::SceneGraph::add(const Transform& local, NodeId parent)
+{
+  const auto index = static_cast<std::uint32_t>(size());
+  const std::uint32_t parent_index
+      = parent == NO_NODE ? NO_INDEX : slots[parent];
+
+  NodeId id;
+  if (!free_ids.empty()) {
+    id = free_ids.back();
+    free_ids.pop_back();
+    slots[id] = index;
+  } else {
+    id = static_cast<NodeId>(slots.size());
+    slots.push_back(index);
+  }
+
+  parents.push_back(parent_index);
+  subtree_sizes.push_back(1);
+  locals.push_back(local);
+  worlds.resize(worlds.size() + 16);
+  ids.push_back(id);
+  dirty.push_back(0);
+  removed.push_back(0);
+
+  // Appending to the subtree that ends the arrays keeps them depth-first;
+  // anything else waits for a re-sort.
+  if (order_valid && parent_index != NO_INDEX) {
+    if (parent_index + subtree_sizes[parent_index] == index) {
+      for (auto p = parent_index; p != NO_INDEX; p = parents[p])
+        subtree_sizes[p]++;
+    } else {
+      order_valid = false;
+    }
+  }
+
+  mark_dirty(index);
+  return id;
+}
+
+void scene::SceneGraph::remove(NodeId node)
+{
+  removed[slots[node]] = 1;
+  order_valid = false;
+}
+
+bool scene::SceneGraph::set_parent(NodeId node, NodeId parent)
+{
+  const auto index = slots[node];
+  const std::uint32_t parent_index
+      = parent == NO_NODE ? NO_INDEX : slots[parent];
+
+  for (auto p = parent_index; p != NO_INDEX; p = parents[p]) {
+    if (p == index) {
+      std::cout << "scene graph: cannot parent node " << node << " to "
+                << parent << ", which is in its subtree" << std::endl;
+      return false;
+    }
+  }
+
+  if (parents[index] != parent_index) {
+    parents[index] = parent_index;
+    order_valid = false;
+    mark_dirty(index);
+  }
+
+  return true;
+}
+
+scene::NodeId scene::SceneGraph::parent(NodeId node) const
+{
+  const auto parent_index = parents[slots[node]];
+  return parent_index == NO_INDEX ? NO_NODE : ids[parent_index];
+}
+
+bool scene::SceneGraph::contains(NodeId node) const
+{
+  return node < slots.size() && slots[node] != NO_INDEX;
+}
+
+void scene::SceneGraph::set_local(NodeId node, const Transform& local)
+{
+  const auto index = slots[node];
+  locals[index] = local;
+  mark_dirty(index);
+}
+
+scene::Transform scene::SceneGraph::local(NodeId node) const
+{
+  return locals[slots[node]];
+}
+
+const float* scene::SceneGraph::world_matrix(NodeId node) const
+{
+  return worlds.data() + static_cast<std::size_t>(slots[node]) * 16;
+}
+
+scene::SceneUpdateStats scene::SceneGraph::update()
+{
+  SceneUpdateStats stats;
+  if (!order_valid) {
+    reorder();
+    stats.reordered = true;
+  }
+
+  collect_ranges(stats);
+  compute_ranges(0, ranges.size());
+
+  return stats;
+}
+
+scene::SceneUpdateStats scene::SceneGraph::update(threading::ThreadPool& pool)
+{
+  SceneUpdateStats stats;
+  if (!order_valid) {
+    reorder();
+    stats.reordered = true;
+  }
+
+  collect_ranges(stats);
+  split_ranges(NODES_PER_RANGE);
+
+  const std::size_t chunk = std::max<std::size_t>(
+      1, ranges.size() / (pool.size() * CHUNKS_PER_THREAD));
+  pool.parallel_for(
+      ranges.size(), chunk, [this](std::size_t begin, std::size_t end) {
+        compute_ranges(begin, end);
+      });
+
+  return stats;
+}
+
+void scene::SceneGraph::mark_dirty(std::uint32_t index)
+{
+  if (!dirty[index]) {
+    dirty[index] = 1;
+    dirty_indices.push_back(index);
+  }
+}
+
+void scene::SceneGraph::reorder()
+{
+  const std::size_t count = size();
+
+  // Children of each node in index order, so siblings keep their order.
+  std::vector<std::uint32_t> first_child(count + 1, 0);
+  for (auto parent_index : parents) {
+    if (parent_index != NO_INDEX)
+      first_child[parent_index + 1]++;
+  }
+  for (std::size_t i = 0; i < count; i++)
+    first_child[i + 1] += first_child[i];
+
+  std::vector<std::uint32_t> children(first_child[count]);
+  std::vector<std::uint32_t> filled(first_child.begin(), first_child.end() - 1);
+  for (std::size_t i = 0; i < count; i++) {
+    if (parents[i] != NO_INDEX)
+      children[filled[parents[i]]++] = static_cast<std::uint32_t>(i);
+  }
+
+  // Depth-first from each root. Descendants of a removed node are removed
+  // with it and their ids freed.
+  std::vector<std::uint32_t> order;
+  order.reserve(count);
+  std::vector<std::uint32_t> stack;
+  for (std::size_t root = 0; root < count; root++) {
+    if (parents[root] != NO_INDEX)
+      continue;
+
+    stack.push_back(static_cast<std::uint32_t>(root));
+    while (!stack.empty()) {
+      const auto index = stack.back();
+      stack.pop_back();
+
+      if (parents[index] != NO_INDEX && removed[parents[index]])
+        removed[index] = 1;
+      if (removed[index]) {
+        slots[ids[index]] = NO_INDEX;
+        free_ids.push_back(ids[index]);
+      } else {
+        order.push_back(index);
+      }
+
+      for (auto c = first_child[index + 1]; c > first_child[index]; c--)
+        stack.push_back(children[c - 1]);
+    }
+  }
+
+  std::vector<std::uint32_t> new_index(count, NO_INDEX);
+  for (std::size_t i = 0; i < order.size(); i++)
+    new_index[order[i]] = static_cast<std::uint32_t>(i);
+
+  std::vector<std::uint32_t> sorted_parents;
+  sorted_parents.reserve(order.size());
+  for (auto index : order) {
+    sorted_parents.push_back(
+        parents[index] == NO_INDEX ? NO_INDEX : new_index[parents[index]]);
+  }
+  parents.swap(sorted_parents);
+
+  permute(locals, order);
+  permute(ids, order);
+  permute(dirty, order);
+
+  std::vector<float> sorted_worlds(order.size() * 16);
+  for (std::size_t i = 0; i < order.size(); i++) {
+    std::copy_n(worlds.data() + static_cast<std::size_t>(order[i]) * 16, 16,
+        sorted_worlds.data() + i * 16);
+  }
+  worlds.swap(sorted_worlds);
+
+  removed.assign(order.size(), 0);
+  subtree_sizes.assign(order.size(), 1);
+  for (std::size_t i = order.size(); i-- > 0;) {
+    if (parents[i] != NO_INDEX)
+      subtree_sizes[parents[i]] += subtree_sizes[i];
+  }
+
+  dirty_indices.clear();
+  for (std::size_t i = 0; i < order.size(); i++) {
+    slots[ids[i]] = static_cast<std::uint32_t>(i);
+    if (dirty[i])
+      dirty_indices.push_back(static_cast<std::uint32_t>(i));
+  }
+
+  order_valid = true;
+}
+
+void scene::SceneGraph::collect_ranges(SceneUpdateStats& stats)
+{
+  // In depth-first order a dirty node's subtree either contains the next
+  // dirty node or ends before it.
+  std::sort(dirty_indices.begin(), dirty_indices.end());
+
+  ranges.clear();
+  std::uint32_t covered = 0;
+  for (auto index : dirty_indices) {
+    dirty[index] = 0;
+    if (index < covered)
+      continue;
+
+    covered = index + subtree_sizes[index];
+    ranges.push_back({ index, covered });
+    stats.recomputed += subtree_sizes[index];
+  }
+  dirty_indices.clear();
+
+  stats.dirty_subtrees = ranges.size();
+}
+
+void scene::SceneGraph::split_ranges(std::size_t max_nodes)
+{
+  std::vector<Range> pending;
+  pending.swap(ranges);
+
+  while (!pending.empty()) {
+    const Range range = pending.back();
+    pending.pop_back();
+
+    if (range.end - range.begin <= max_nodes) {
+      ranges.push_back(range);
+      continue;
+    }
+
+    compute_range({ range.begin, range.begin + 1 });
+    for (auto child = range.begin + 1; child < range.end;
+         child += subtree_sizes[child])
+      pending.push_back({ child, child + subtree_sizes[child] });
+  }
+}
+
+void scene::SceneGraph::compute_ranges(std::size_t begin, std::size_t end)
+{
+  for (std::size_t r = begin; r < end; r++) {
+    if (r + PREFETCH_RANGES < end) {
+      const auto ahead = ranges[r + PREFETCH_RANGES].begin;
+      const float* world = worlds.data() + static_cast<std::size_t>(ahead) * 16;
+      prefetch(&locals[ahead]);
+      prefetch(world);
+      prefetch(world + 15);
+      prefetch(&parents[ahead]);
+    }
+    compute_range(ranges[r]);
+  }
+}
+
+void scene::SceneGraph::compute_range(Range range)
+{
+  for (auto i = range.begin; i < range.end; i++) {
+    const Transform& transform = locals[i];
+
+    float* world = worlds.data() + static_cast<std::size_t>(i) * 16;
+    if (parents[i] == NO_INDEX) {
+      math::compose_matrix(transform.translation, transform.rotation,
+          transform.scale, world);
+    } else {
+      float local[16];
+      math::compose_matrix(transform.translation, transform.rotation,
+          transform.scale, local);
+      math::multiply_matrix(
+          worlds.data() + static_cast<std::size_t>(parents[i]) * 16, local,
+          world);
+    }
+  }
+}
@@ -0,0 +1,254 @@
+#include "../../include/simulation/body_store.h"
+#include "../../include/threading/thread_pool.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BODY_STORE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr std::size_t BODIES_PER_CHUNK { 16384 };
+
+struct BodyArrays {
+  float* x;
+  float* y;
+  float* vx;
+  float* vy;
+  const float* half_width;
+  const float* half_height;
+};
+
+BodyArrays arrays_of(simulation::BodyStore& bodies)
+{
+  return { bodies.x.data(), bodies.y.data(), bodies.vx.data(),
+    bodies.vy.data(), bodies.half_width.data(), bodies.half_height.data() };
+}
+
+// The scalar path is also the tail loop of the vector kernels.
+inline void reflect_scalar(
+    float& position, float& velocity, float extent, float low, float high,
+    float dt)
+{
+  float lo = low + extent;
+  float hi = high - extent;
+  float p = position + velocity * dt;
+
+  bool below = p < lo;
+  bool above = p > hi;
+  float speed = velocity < 0.0f ? -velocity : velocity;
+
+  p = below ? lo + (lo - p) : p;
+  p = above ? hi - (p - hi) : p;
+  velocity = below ? speed : velocity;
+  velocity = above ? -speed : velocity;
+  position = p;
+}
+
+void integrate_scalar(BodyArrays b, std::size_t begin, std::size_t end,
+    const simulation::Bounds& bounds, float dt)
+{
+  for (std::size_t i = begin; i < end; i++) {
+    reflect_scalar(
+        b.x[i], b.vx[i], b.half_width[i], bounds.left, bounds.right, dt);
+    reflect_scalar(
+        b.y[i], b.vy[i], b.half_height[i], bounds.bottom, bounds.top, dt);
+  }
+}
+
+#ifdef BODY_STORE_X86
+
+__attribute__((target("sse4.1"))) inline void reflect_sse41(float* position,
+    float* velocity, const float* extent, __m128 low, __m128 high, __m128 dt)
+{
+  const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+  __m128 e = _mm_loadu_ps(extent);
+  __m128 v = _mm_loadu_ps(velocity);
+  __m128 lo = _mm_add_ps(low, e);
+  __m128 hi = _mm_sub_ps(high, e);
+  __m128 p = _mm_add_ps(_mm_loadu_ps(position), _mm_mul_ps(v, dt));
+
+  __m128 below = _mm_cmplt_ps(p, lo);
+  __m128 above = _mm_cmpgt_ps(p, hi);
+  __m128 speed = _mm_andnot_ps(sign_mask, v);
+
+  p = _mm_blendv_ps(p, _mm_add_ps(lo, _mm_sub_ps(lo, p)), below);
+  p = _mm_blendv_ps(p, _mm_sub_ps(hi, _mm_sub_ps(p, hi)), above);
+  v = _mm_blendv_ps(v, speed, below);
+  v = _mm_blendv_ps(v, _mm_or_ps(speed, sign_mask), above);
+
+  _mm_storeu_ps(position, p);
+  _mm_storeu_ps(velocity, v);
+}
+
+__attribute__((target("sse4.1"))) void integrate_sse41(BodyArrays b,
+    std::size_t begin, std::size_t end, const simulation::Bounds& bounds,
+    float dt)
+{
+  const __m128 left = _mm_set1_ps(bounds.left);
+  const __m128 right = _mm_set1_ps(bounds.right);
+  const __m128 bottom = _mm_set1_ps(bounds.bottom);
+  const __m128 top = _mm_set1_ps(bounds.top);
+  const __m128 step = _mm_set1_ps(dt);
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    reflect_sse41(b.x + i, b.vx + i, b.half_width + i, left, right, step);
+    reflect_sse41(b.y + i, b.vy + i, b.half_height + i, bottom, top, step);
+  }
+  integrate_scalar(b, i, end, bounds, dt);
+}
+
+__attribute__((target("avx2"))) inline void reflect_avx2(float* position,
+    float* velocity, const float* extent, __m256 low, __m256 high, __m256 dt)
+{
+  const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+
+  __m256 e = _mm256_loadu_ps(extent);
+  __m256 v = _mm256_loadu_ps(velocity);
+  __m256 lo = _mm256_add_ps(low, e);
+  __m256 hi = _mm256_sub_ps(high, e);
+  __m256 p = _mm256_add_ps(_mm256_loadu_ps(position), _mm256_mul_ps(v, dt));
+
+  __m256 below = _mm256_cmp_ps(p, lo, _CMP_LT_OQ);
+  __m256 above = _mm256_cmp_ps(p, hi, _CMP_GT_OQ);
+  __m256 speed = _mm256_andnot_ps(sign_mask, v);
+
+  p = _mm256_blendv_ps(p, _mm256_add_ps(lo, _mm256_sub_ps(lo, p)), below);
+  p = _mm256_blendv_ps(p, _mm256_sub_ps(hi, _mm256_sub_ps(p, hi)), above);
+  v = _mm256_blendv_ps(v, speed, below);
+  v = _mm256_blendv_ps(v, _mm256_or_ps(speed, sign_mask), above);
+
+  _mm256_storeu_ps(position, p);
+  _mm256_storeu_ps(velocity, v);
+}
+
+__attribute__((target("avx2"))) void integrate_avx2(BodyArrays b,
+    std::size_t begin, std::size_t end, const simulation::Bounds& bounds,
+    float dt)
+{
+  const __m256 left = _mm256_set1_ps(bounds.left);
+  const __m256 right = _mm256_set1_ps(bounds.right);
+  const __m256 bottom = _mm256_set1_ps(bounds.bottom);
+  const __m256 top = _mm256_set1_ps(bounds.top);
+  const __m256 step = _mm256_set1_ps(dt);
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    reflect_avx2(b.x + i, b.vx + i, b.half_width + i, left, right, step);
+    reflect_avx2(b.y + i, b.vy + i, b.half_height + i, bottom, top, step);
+  }
+  integrate_scalar(b, i, end, bounds, dt);
+}
+
+#endif
+
+} // namespace
+
+void simulation::BodyStore::reserve(std::size_t count)
+{
+  x.reserve(count);
+  y.reserve(count);
+  vx.reserve(count);
+  vy.reserve(count);
+  half_width.reserve(count);
+  half_height.reserve(count);
+}
+
+void simulation::BodyStore::clear()
+{
+  x.clear();
+  y.clear();
+  vx.clear();
+  vy.clear();
+  half_width.clear();
+  half_height.clear();
+}
+
+void simulation::BodyStore::add(const DvdState& state, const DvdLogo& logo)
+{
+  x.push_back(state.x);
+  y.push_back(state.y);
+  vx.push_back(state.vx);
+  vy.push_back(state.vy);
+  half_width.push_back(logo.half_width);
+  half_height.push_back(logo.half_height);
+}
+
+simulation::DvdState simulation::BodyStore::state(std::size_t index) const
+{
+  return { x[index], y[index], vx[index], vy[index] };
+}
+
+bool simulation::body_kernel_supported(BodyKernel kernel)
+{
+  switch (kernel) {
+  case BodyKernel::SCALAR:
+    return true;
+#ifdef BODY_STORE_X86
+  case BodyKernel::SSE41:
+    return __builtin_cpu_supports("sse4.1");
+  case BodyKernel::AVX2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+simulation::BodyKernel simulation::best_body_kernel()
+{
+  static const BodyKernel best = [] {
+    if (body_kernel_supported(BodyKernel::AVX2))
+      return BodyKernel::AVX2;
+    if (body_kernel_supported(BodyKernel::SSE41))
+      return BodyKernel::SSE41;
+    return BodyKernel::SCALAR;
+  }();
+
+  return best;
+}
+
+const char* simulation::body_kernel_name(BodyKernel kernel)
+{
+  switch (kernel) {
+  case BodyKernel::SCALAR:
+    return "scalar";
+  case BodyKernel::SSE41:
+    return "sse4.1";
+  case BodyKernel::AVX2:
+    return "avx2";
+  default:
+    return "unknown";
+  }
+}
+
+void simulation::integrate_bodies(BodyStore& bodies, std::size_t begin,
+    std::size_t end, const Bounds& bounds, float dt, BodyKernel kernel)
+{
+  BodyArrays arrays = arrays_of(bodies);
+
+  switch (kernel) {
+#ifdef BODY_STORE_X86
+  case BodyKernel::AVX2:
+    integrate_avx2(arrays, begin, end, bounds, dt);
+    return;
+  case BodyKernel::SSE41:
+    integrate_sse41(arrays, begin, end, bounds, dt);
+    return;
+#endif
+  default:
+    integrate_scalar(arrays, begin, end, bounds, dt);
+    return;
+  }
+}
+
+void simulation::integrate_bodies(BodyStore& bodies, const Bounds& bounds,
+    float dt, threading::ThreadPool& pool, BodyKernel kernel)
+{
+  pool.parallel_for(bodies.size(), BODIES_PER_CHUNK,
+      [&](std::size_t begin, std::size_t end) {
+        integrate_bodies(bodies, begin, end, bounds, dt, kernel);
+      });
+}
@@ -0,0 +1,317 @@
+#include "../../include/simulation/bounce_events.h"
+
+#include <cmath>
+
+namespace {
+
+__extension__ typedef __int128 wide;
+
+// One axis of a LatticeLogo, mirrored so that the speed is never negative.
+// Wall hits then happen exactly when start + speed * t is a multiple of span.
+struct AxisMotion {
+  wide span;
+  wide start;
+  wide speed;
+  bool mirrored;
+};
+
+AxisMotion axis_motion(
+    const simulation::LatticeLogo& logo, simulation::BounceAxis axis)
+{
+  bool x = axis == simulation::BounceAxis::X;
+  std::int64_t span = x ? logo.span_x : logo.span_y;
+  std::int64_t position = x ? logo.x0 : logo.y0;
+  std::int64_t velocity = x ? logo.vx : logo.vy;
+
+  if (velocity < 0)
+    return { span, span - position, -static_cast<wide>(velocity), true };
+  return { span, position, velocity, false };
+}
+
+wide abs_wide(wide value) { return value < 0 ? -value : value; }
+
+wide gcd_wide(wide a, wide b)
+{
+  a = abs_wide(a);
+  b = abs_wide(b);
+  while (b != 0) {
+    wide r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+wide floor_div(wide a, wide b)
+{
+  wide q = a / b;
+  if ((a % b != 0) && ((a < 0) != (b < 0)))
+    q--;
+  return q;
+}
+
+wide positive_mod(wide a, wide m)
+{
+  wide r = a % m;
+  return r < 0 ? r + m : r;
+}
+
+// Returns g = gcd(a, b) and sets x, y so that a * x + b * y = g.
+wide extended_gcd(wide a, wide b, wide& x, wide& y)
+{
+  wide old_r = a, r = b;
+  wide old_x = 1, next_x = 0;
+  wide old_y = 0, next_y = 1;
+
+  while (r != 0) {
+    wide q = old_r / r;
+    wide t = old_r - q * r;
+    old_r = r;
+    r = t;
+    t = old_x - q * next_x;
+    old_x = next_x;
+    next_x = t;
+    t = old_y - q * next_y;
+    old_y = next_y;
+    next_y = t;
+  }
+
+  x = old_x;
+  y = old_y;
+  return old_r;
+}
+
+simulation::ExactTime make_time(wide numerator, wide denominator)
+{
+  if (denominator < 0) {
+    numerator = -numerator;
+    denominator = -denominator;
+  }
+  wide g = gcd_wide(numerator, denominator);
+  if (g > 1) {
+    numerator /= g;
+    denominator /= g;
+  }
+
+  return { static_cast<std::int64_t>(numerator),
+    static_cast<std::int64_t>(denominator) };
+}
+
+// Smallest wall index a whose hit time (a * span - start) / speed is strictly
+// later than `after`, or not earlier than it when `inclusive`.
+wide first_wall_index(
+    const AxisMotion& motion, simulation::ExactTime after, bool inclusive)
+{
+  wide p = after.numerator;
+  wide q = after.denominator;
+  wide travelled = p * motion.speed + motion.start * q;
+  if (inclusive)
+    travelled--;
+  return floor_div(travelled, motion.span * q) + 1;
+}
+
+bool hits_wall_at(const AxisMotion& motion, simulation::ExactTime time)
+{
+  if (motion.speed == 0)
+    return false;
+
+  wide q = time.denominator;
+  return positive_mod(
+             motion.start * q + motion.speed * time.numerator, motion.span * q)
+      == 0;
+}
+
+double fold_axis(const AxisMotion& motion, double seconds, int& direction)
+{
+  double span = static_cast<double>(motion.span);
+  double travelled = static_cast<double>(motion.start)
+      + static_cast<double>(motion.speed) * seconds;
+
+  double phase = std::fmod(travelled, 2.0 * span);
+  if (phase < 0.0)
+    phase += 2.0 * span;
+
+  bool forward = phase < span;
+  double folded = forward ? phase : 2.0 * span - phase;
+
+  direction = (forward != motion.mirrored) ? 1 : -1;
+  return motion.mirrored ? span - folded : folded;
+}
+
+} // namespace
+
+bool simulation::operator<(const ExactTime& a, const ExactTime& b)
+{
+  return static_cast<wide>(a.numerator) * b.denominator
+      < static_cast<wide>(b.numerator) * a.denominator;
+}
+
+bool simulation::operator==(const ExactTime& a, const ExactTime& b)
+{
+  return static_cast<wide>(a.numerator) * b.denominator
+      == static_cast<wide>(b.numerator) * a.denominator;
+}
+
+simulation::ExactTime simulation::exact_seconds(std::int64_t seconds)
+{
+  return { seconds, 1 };
+}
+
+simulation::LogoPosition simulation::position_at(
+    const LatticeLogo& logo, double seconds)
+{
+  LogoPosition position {};
+
+  AxisMotion x = axis_motion(logo, BounceAxis::X);
+  AxisMotion y = axis_motion(logo, BounceAxis::Y);
+
+  if (x.speed == 0) {
+    position.x = static_cast<double>(logo.x0);
+  } else {
+    position.x = fold_axis(x, seconds, position.direction_x);
+  }
+
+  if (y.speed == 0) {
+    position.y = static_cast<double>(logo.y0);
+  } else {
+    position.y = fold_axis(y, seconds, position.direction_y);
+  }
+
+  return position;
+}
+
+std::optional<simulation::ExactTime> simulation::next_wall_hit(
+    const LatticeLogo& logo, BounceAxis axis, ExactTime after, bool inclusive)
+{
+  AxisMotion motion = axis_motion(logo, axis);
+  if (motion.speed == 0 || motion.span <= 0)
+    return std::nullopt;
+
+  wide index = first_wall_index(motion, after, inclusive);
+  return make_time(index * motion.span - motion.start, motion.speed);
+}
+
+std::optional<simulation::CornerHit> simulation::next_corner_hit(
+    const LatticeLogo& logo, ExactTime after, bool inclusive)
+{
+  AxisMotion x = axis_motion(logo, BounceAxis::X);
+  AxisMotion y = axis_motion(logo, BounceAxis::Y);
+  if (x.span <= 0 || y.span <= 0)
+    return std::nullopt;
+
+  // A stationary axis parked on a wall turns every hit of the other axis into
+  // a corner; parked anywhere else it never reaches one.
+  if (x.speed == 0 || y.speed == 0) {
+    if (x.speed == 0 && y.speed == 0)
+      return std::nullopt;
+
+    const AxisMotion& still = x.speed == 0 ? x : y;
+    if (still.start != 0 && still.start != still.span)
+      return std::nullopt;
+
+    BounceAxis moving_axis = x.speed == 0 ? BounceAxis::Y : BounceAxis::X;
+    const AxisMotion& moving = x.speed == 0 ? y : x;
+    wide index = first_wall_index(moving, after, inclusive);
+    bool moving_high = (index % 2 != 0) != moving.mirrored;
+    bool still_high = (x.speed == 0 ? logo.x0 : logo.y0) == still.span;
+
+    CornerHit hit { make_time(index * moving.span - moving.start, moving.speed),
+      false, false };
+    hit.right = moving_axis == BounceAxis::X ? moving_high : still_high;
+    hit.top = moving_axis == BounceAxis::Y ? moving_high : still_high;
+    return hit;
+  }
+
+  // Wall hits on x are at (a * Sx - sx) / ux and on y at (b * Sy - sy) / uy.
+  // Equal times need a * Sx * uy - b * Sy * ux = sx * uy - sy * ux.
+  wide A = x.span * y.speed;
+  wide B = y.span * x.speed;
+  wide C = x.start * y.speed - y.start * x.speed;
+
+  wide p, q;
+  wide g = extended_gcd(A, B, p, q);
+  if (C % g != 0)
+    return std::nullopt;
+
+  wide period = B / g;
+  wide a0 = positive_mod(p % period * ((C / g) % period), period);
+
+  wide a_min = first_wall_index(x, after, inclusive);
+  wide a = a0 + floor_div(a_min - a0 + period - 1, period) * period;
+
+  CornerHit hit { make_time(a * x.span - x.start, x.speed), false, false };
+
+  wide b_times_span = (a * x.span - x.start) * y.speed / x.speed + y.start;
+  wide b = b_times_span / y.span;
+
+  hit.right = (a % 2 != 0) != x.mirrored;
+  hit.top = (b % 2 != 0) != y.mirrored;
+  return hit;
+}
+
+bool simulation::BounceScheduler::Later::operator()(
+    const Pending& a, const Pending& b) const
+{
+  if (!(a.time == b.time))
+    return b.time < a.time;
+  if (a.logo != b.logo)
+    return a.logo > b.logo;
+  return a.axis > b.axis;
+}
+
+std::size_t simulation::BounceScheduler::add(const LatticeLogo& logo)
+{
+  std::size_t index = logos.size();
+  logos.push_back(logo);
+
+  schedule(index, BounceAxis::X, exact_seconds(0), true);
+  schedule(index, BounceAxis::Y, exact_seconds(0), true);
+
+  return index;
+}
+
+std::optional<simulation::ExactTime>
+simulation::BounceScheduler::next_event_time() const
+{
+  if (queue.empty())
+    return std::nullopt;
+  return queue.top().time;
+}
+
+std::size_t simulation::BounceScheduler::advance_to(ExactTime until,
+    const std::function<void(const BounceEvent&)>& on_event)
+{
+  std::size_t reported = 0;
+
+  while (!queue.empty() && !(until < queue.top().time)) {
+    Pending pending = queue.top();
+    queue.pop();
+    schedule(pending.logo, pending.axis, pending.time);
+
+    BounceAxis other
+        = pending.axis == BounceAxis::X ? BounceAxis::Y : BounceAxis::X;
+    bool corner = hits_wall_at(
+        axis_motion(logos[pending.logo], other), pending.time);
+
+    // X sorts before Y at equal times, so the X half of a corner reports it
+    // and the Y half is only rescheduled.
+    if (corner && pending.axis == BounceAxis::Y)
+      continue;
+
+    BounceEvent event { pending.time, pending.logo,
+      corner ? BounceAxis::CORNER : pending.axis };
+    if (on_event)
+      on_event(event);
+    reported++;
+  }
+
+  return reported;
+}
+
+void simulation::BounceScheduler::schedule(
+    std::size_t index, BounceAxis axis, ExactTime after, bool inclusive)
+{
+  auto time = next_wall_hit(logos[index], axis, after, inclusive);
+  if (time)
+    queue.push({ *time, index, axis });
+}
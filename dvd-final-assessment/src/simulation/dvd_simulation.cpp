@@ -0,0 +1,50 @@
+#include "../../include/simulation/dvd_simulation.h"
+
+namespace {
+
+// Reflects `position` off [low, high] until it lies inside, flipping the sign
+// of `velocity` once per bounce.
+void reflect_axis(float& position, float& velocity, float low, float high)
+{
+  if (high <= low) {
+    position = (low + high) * 0.5f;
+    return;
+  }
+
+  while (position < low || position > high) {
+    if (position < low) {
+      position = low + (low - position);
+      velocity = -velocity;
+    } else {
+      position = high - (position - high);
+      velocity = -velocity;
+    }
+  }
+}
+
+} // namespace
+
+simulation::DvdState simulation::step_dvd(
+    const DvdState& state, const DvdLogo& logo, const Bounds& bounds, float dt)
+{
+  DvdState next = state;
+  next.x = state.x + state.vx * dt;
+  next.y = state.y + state.vy * dt;
+
+  reflect_axis(next.x, next.vx, bounds.left + logo.half_width,
+      bounds.right - logo.half_width);
+  reflect_axis(next.y, next.vy, bounds.bottom + logo.half_height,
+      bounds.top - logo.half_height);
+
+  return next;
+}
+
+simulation::DvdState simulation::interpolate(
+    const DvdState& previous, const DvdState& current, float alpha)
+{
+  DvdState blended = current;
+  blended.x = previous.x + (current.x - previous.x) * alpha;
+  blended.y = previous.y + (current.y - previous.y) * alpha;
+
+  return blended;
+}
@@ -0,0 +1,32 @@
+#include "../../include/simulation/fixed_timestep.h"
+
+simulation::FixedTimestep::FixedTimestep(
+    double tick_rate, int max_steps_per_frame)
+    : step(static_cast<float>(1.0 / tick_rate))
+    , step_wall(1.0 / tick_rate)
+    , max_steps(max_steps_per_frame)
+{
+}
+
+int simulation::FixedTimestep::advance(double frame_seconds)
+{
+  if (frame_seconds > 0.0)
+    accumulator += frame_seconds;
+
+  int steps = 0;
+  while (accumulator >= step_wall && steps < max_steps) {
+    accumulator -= step_wall;
+    steps++;
+  }
+
+  if (steps == max_steps && accumulator >= step_wall)
+    accumulator = 0.0;
+
+  ticks += steps;
+  return steps;
+}
+
+float simulation::FixedTimestep::alpha() const
+{
+  return static_cast<float>(accumulator / step_wall);
+}
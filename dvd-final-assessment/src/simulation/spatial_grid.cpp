@@ -0,0 +1,212 @@
+#include "../../include/simulation/spatial_grid.h"
+#include "../../include/threading/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+constexpr std::size_t BODIES_PER_CHUNK { 16384 };
+constexpr std::size_t ROWS_PER_CHUNK { 4 };
+// Tiny bodies in large bounds would otherwise ask for far more cells than
+// bodies. Past this many cells per body the cells are widened instead.
+constexpr float MAX_CELLS_PER_BODY { 4.0f };
+
+// The half neighbourhood: pairs across the other four neighbours are found
+// from the other side, so every pair is tested exactly once.
+constexpr int NEIGHBOUR_OFFSETS[][2] { { 1, 0 }, { -1, 1 }, { 0, 1 },
+  { 1, 1 } };
+
+} // namespace
+
+void simulation::SpatialGrid::rebuild(const BodyStore& bodies,
+    const Bounds& bounds, threading::ThreadPool& pool)
+{
+  const std::size_t count = bodies.size();
+
+  if (count == 0) {
+    grid_columns = 0;
+    grid_rows = 0;
+    body_cell.clear();
+    cell_start.assign(1, 0);
+    sorted_body.clear();
+    sorted_x.clear();
+    sorted_y.clear();
+    sorted_half_width.clear();
+    sorted_half_height.clear();
+    return;
+  }
+
+  float largest = 0.0f;
+  for (std::size_t i = 0; i < count; i++) {
+    largest = std::max(
+        largest, std::max(bodies.half_width[i], bodies.half_height[i]));
+  }
+
+  float width = bounds.right - bounds.left;
+  float height = bounds.top - bounds.bottom;
+  // Bounding both the area and the longer side keeps the cell count within
+  // about 3 * max_cells + 1, which also keeps it inside body_cell's 32 bits.
+  const float max_cells = MAX_CELLS_PER_BODY * static_cast<float>(count);
+  grid_cell_size = std::max({ 2.0f * largest,
+      std::sqrt(width * height / max_cells),
+      std::max(width, height) / max_cells, 1e-6f });
+  origin_x = bounds.left;
+  origin_y = bounds.bottom;
+  grid_columns = std::max<std::size_t>(
+      1, static_cast<std::size_t>(std::ceil(width / grid_cell_size)));
+  grid_rows = std::max<std::size_t>(
+      1, static_cast<std::size_t>(std::ceil(height / grid_cell_size)));
+
+  body_cell.resize(count);
+  pool.parallel_for(
+      count, BODIES_PER_CHUNK, [&](std::size_t begin, std::size_t end) {
+        const float inverse = 1.0f / grid_cell_size;
+        const float max_column = static_cast<float>(grid_columns - 1);
+        const float max_row = static_cast<float>(grid_rows - 1);
+
+        for (std::size_t i = begin; i < end; i++) {
+          float column = std::clamp(
+              std::floor((bodies.x[i] - origin_x) * inverse), 0.0f,
+              max_column);
+          float row = std::clamp(
+              std::floor((bodies.y[i] - origin_y) * inverse), 0.0f, max_row);
+          body_cell[i] = static_cast<std::uint32_t>(row) * grid_columns
+              + static_cast<std::uint32_t>(column);
+        }
+      });
+
+  const std::size_t cells = grid_columns * grid_rows;
+  cell_start.assign(cells + 1, 0);
+  for (std::size_t i = 0; i < count; i++)
+    cell_start[body_cell[i] + 1]++;
+  for (std::size_t cell = 0; cell < cells; cell++)
+    cell_start[cell + 1] += cell_start[cell];
+
+  sorted_body.resize(count);
+  sorted_x.resize(count);
+  sorted_y.resize(count);
+  sorted_half_width.resize(count);
+  sorted_half_height.resize(count);
+
+  std::vector<std::uint32_t> cursor(cell_start.begin(), cell_start.end() - 1);
+  for (std::size_t i = 0; i < count; i++) {
+    std::uint32_t slot = cursor[body_cell[i]]++;
+    sorted_body[slot] = static_cast<std::uint32_t>(i);
+    sorted_x[slot] = bodies.x[i];
+    sorted_y[slot] = bodies.y[i];
+    sorted_half_width[slot] = bodies.half_width[i];
+    sorted_half_height[slot] = bodies.half_height[i];
+  }
+}
+
+std::uint64_t simulation::SpatialGrid::collide_row(
+    std::size_t row, std::vector<BodyContact>& contacts) const
+{
+  std::uint64_t tested = 0;
+
+  auto test = [&](std::uint32_t i, std::uint32_t j) {
+    tested++;
+
+    float overlap_x = sorted_half_width[i] + sorted_half_width[j]
+        - std::fabs(sorted_x[i] - sorted_x[j]);
+    float overlap_y = sorted_half_height[i] + sorted_half_height[j]
+        - std::fabs(sorted_y[i] - sorted_y[j]);
+    if (overlap_x <= 0.0f || overlap_y <= 0.0f)
+      return;
+
+    bool along_x = overlap_x < overlap_y;
+    contacts.push_back({ sorted_body[i], sorted_body[j],
+        along_x ? overlap_x : overlap_y, along_x });
+  };
+
+  for (std::size_t column = 0; column < grid_columns; column++) {
+    std::size_t cell = row * grid_columns + column;
+    std::uint32_t begin = cell_start[cell];
+    std::uint32_t end = cell_start[cell + 1];
+
+    for (std::uint32_t i = begin; i < end; i++) {
+      for (std::uint32_t j = i + 1; j < end; j++)
+        test(i, j);
+    }
+
+    for (const auto& offset : NEIGHBOUR_OFFSETS) {
+      std::ptrdiff_t neighbour_column
+          = static_cast<std::ptrdiff_t>(column) + offset[0];
+      std::size_t neighbour_row = row + offset[1];
+      if (neighbour_column < 0
+          || neighbour_column >= static_cast<std::ptrdiff_t>(grid_columns)
+          || neighbour_row >= grid_rows)
+        continue;
+
+      std::size_t neighbour = neighbour_row * grid_columns + neighbour_column;
+      std::uint32_t neighbour_begin = cell_start[neighbour];
+      std::uint32_t neighbour_end = cell_start[neighbour + 1];
+
+      for (std::uint32_t i = begin; i < end; i++) {
+        for (std::uint32_t j = neighbour_begin; j < neighbour_end; j++)
+          test(i, j);
+      }
+    }
+  }
+
+  return tested;
+}
+
+simulation::CollisionStats simulation::SpatialGrid::find_contacts(
+    std::vector<BodyContact>& contacts, threading::ThreadPool& pool) const
+{
+  const std::size_t chunks = (grid_rows + ROWS_PER_CHUNK - 1) / ROWS_PER_CHUNK;
+  std::vector<std::vector<BodyContact>> chunk_contacts(chunks);
+  std::atomic<std::uint64_t> tested { 0 };
+
+  pool.parallel_for(
+      grid_rows, ROWS_PER_CHUNK, [&](std::size_t begin, std::size_t end) {
+        auto& found = chunk_contacts[begin / ROWS_PER_CHUNK];
+        std::uint64_t chunk_tested = 0;
+        for (std::size_t row = begin; row < end; row++)
+          chunk_tested += collide_row(row, found);
+        tested.fetch_add(chunk_tested, std::memory_order_relaxed);
+      });
+
+  contacts.clear();
+  for (const auto& found : chunk_contacts)
+    contacts.insert(contacts.end(), found.begin(), found.end());
+
+  return { tested.load(), contacts.size() };
+}
+
+void simulation::resolve_contacts(
+    BodyStore& bodies, const std::vector<BodyContact>& contacts)
+{
+  for (const auto& contact : contacts) {
+    std::vector<float>& position = contact.along_x ? bodies.x : bodies.y;
+    std::vector<float>& velocity = contact.along_x ? bodies.vx : bodies.vy;
+
+    float push = contact.penetration * 0.5f;
+    if (position[contact.a] < position[contact.b]) {
+      position[contact.a] -= push;
+      position[contact.b] += push;
+    } else {
+      position[contact.a] += push;
+      position[contact.b] -= push;
+    }
+
+    float relative = (velocity[contact.b] - velocity[contact.a])
+        * (position[contact.b] - position[contact.a]);
+    if (relative < 0.0f)
+      std::swap(velocity[contact.a], velocity[contact.b]);
+  }
+}
+
+simulation::CollisionStats simulation::collide_bodies(BodyStore& bodies,
+    const Bounds& bounds, SpatialGrid& grid,
+    std::vector<BodyContact>& contacts, threading::ThreadPool& pool)
+{
+  grid.rebuild(bodies, bounds, pool);
+  CollisionStats stats = grid.find_contacts(contacts, pool);
+  resolve_contacts(bodies, contacts);
+
+  return stats;
+}
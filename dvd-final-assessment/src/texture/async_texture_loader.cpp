@@ -0,0 +1,262 @@
+#include "../../include/texture/async_texture_loader.h"
+#include "../../include/texture/pixel_ingest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Grey and magenta checkerboard, obvious on screen while the real image
+// streams in.
+constexpr unsigned char PLACEHOLDER_PIXELS[] = { 128, 128, 128, 255, 255, 0,
+  255, 255, 255, 0, 255, 255, 128, 128, 128, 255 };
+
+double percentile(const std::vector<double>& sorted, double fraction)
+{
+  if (sorted.empty())
+    return 0.0;
+
+  std::size_t rank = static_cast<std::size_t>(fraction * (sorted.size() - 1));
+  return sorted[rank];
+}
+
+} // namespace
+
+texture::AsyncTextureLoader::AsyncTextureLoader(
+    unsigned int decode_threads, std::size_t upload_budget_bytes,
+    const MipOptions& mip_options)
+    : upload_budget(std::max<std::size_t>(upload_budget_bytes, 1))
+    , mip_options(mip_options)
+{
+  glGenTextures(1, &placeholder);
+  glBindTexture(GL_TEXTURE_2D, placeholder);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+      PLACEHOLDER_PIXELS);
+
+  glGenBuffers(STAGING_BUFFERS, staging_buffers.data());
+
+  for (unsigned int i = 0; i < std::max(1u, decode_threads); i++)
+    decoders.emplace_back([this] { decode_loop(); });
+}
+
+texture::AsyncTextureLoader::~AsyncTextureLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+
+  for (auto& decoder : decoders)
+    decoder.join();
+}
+
+texture::TextureId texture::AsyncTextureLoader::request(const std::string& path)
+{
+  TextureId id = static_cast<TextureId>(requests.size());
+
+  requests.emplace_back();
+  Request& request = requests.back();
+  request.path = path;
+  request.requested_at = clock::now();
+  in_flight++;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    decode_queue.push_back(&request);
+  }
+  work_available.notify_one();
+
+  return id;
+}
+
+void texture::AsyncTextureLoader::decode_loop()
+{
+  for (;;) {
+    Request* request;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      work_available.wait(
+          lock, [this] { return stopping || !decode_queue.empty(); });
+      if (stopping)
+        return;
+
+      request = decode_queue.front();
+      decode_queue.pop_front();
+    }
+
+    request->failed
+        = !load_mipmapped_image(request->path, request->mips, mip_options);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    decoded.push_back(request);
+  }
+}
+
+void texture::AsyncTextureLoader::update()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    upload_queue.insert(upload_queue.end(), decoded.begin(), decoded.end());
+    decoded.clear();
+  }
+
+  std::size_t budget = upload_budget;
+  while (budget > 0 && !upload_queue.empty()) {
+    Request& request = *upload_queue.front();
+
+    if (request.failed) {
+      std::cout << "failed to load texture: " << request.path << "\n";
+      failures++;
+      if (request.texture != 0)
+        glDeleteTextures(1, &request.texture);
+      request.texture = 0;
+      finish(request);
+      continue;
+    }
+
+    upload_rows(request, budget);
+    if (request.failed)
+      continue;
+    if (request.level == request.mips.levels.size()) {
+      std::chrono::duration<double, std::milli> latency
+          = clock::now() - request.requested_at;
+      latencies_ms.push_back(latency.count());
+      request.ready = true;
+      finish(request);
+    }
+  }
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void texture::AsyncTextureLoader::upload_rows(
+    Request& request, std::size_t& budget)
+{
+  // Mip chains are RGBA8 whatever the source's channel count.
+  const PixelFormat format = pixel_format_for(4);
+
+  if (request.texture == 0) {
+    glGenTextures(1, &request.texture);
+    glBindTexture(GL_TEXTURE_2D, request.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(
+        GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // Storage only; the rows arrive through the staging buffers.
+    const auto level_count = static_cast<GLint>(request.mips.levels.size());
+    for (GLint level = 0; level < level_count; level++) {
+      upload_pixels(nullptr,
+          std::max(1, request.mips.width >> level),
+          std::max(1, request.mips.height >> level), format, level);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+  }
+
+  const auto level = static_cast<GLint>(request.level);
+  const int width = std::max(1, request.mips.width >> level);
+  const int height = std::max(1, request.mips.height >> level);
+  const unsigned char* pixels = request.mips.levels[request.level].data();
+
+  // At least one row per call so an image wider than the budget still
+  // makes progress.
+  const std::size_t row_bytes
+      = static_cast<std::size_t>(width) * format.channels;
+  int rows = static_cast<int>(
+      std::max<std::size_t>(1, budget / row_bytes));
+  rows = std::min(rows, height - request.rows_uploaded);
+  const std::size_t bytes = row_bytes * rows;
+
+  GLuint staging = staging_buffers[next_staging_buffer++ % STAGING_BUFFERS];
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+
+  // Uploading from a buffer that was never filled would show garbage, so a
+  // failed map (or an unmap that lost the contents) fails the request.
+  void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (!mapped) {
+    request.failed = true;
+    return;
+  }
+  std::memcpy(mapped, pixels + row_bytes * request.rows_uploaded, bytes);
+  if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE) {
+    request.failed = true;
+    return;
+  }
+
+  glBindTexture(GL_TEXTURE_2D, request.texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment(row_bytes));
+  glTexSubImage2D(GL_TEXTURE_2D, level, 0, request.rows_uploaded, width,
+      rows, format.format, GL_UNSIGNED_BYTE, nullptr);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  request.rows_uploaded += rows;
+  budget -= std::min(budget, bytes);
+
+  if (request.rows_uploaded == height) {
+    request.level++;
+    request.rows_uploaded = 0;
+  }
+}
+
+void texture::AsyncTextureLoader::finish(Request& request)
+{
+  request.mips = {};
+  upload_queue.pop_front();
+  in_flight--;
+}
+
+GLuint texture::AsyncTextureLoader::texture(TextureId id) const
+{
+  const Request& request = requests[id];
+  return request.ready ? request.texture : placeholder;
+}
+
+bool texture::AsyncTextureLoader::ready(TextureId id) const
+{
+  return requests[id].ready;
+}
+
+std::size_t texture::AsyncTextureLoader::pending() const { return in_flight; }
+
+texture::LoadLatencyReport texture::AsyncTextureLoader::latency_report() const
+{
+  std::vector<double> sorted = latencies_ms;
+  std::sort(sorted.begin(), sorted.end());
+
+  return { sorted.size(), failures, percentile(sorted, 0.50),
+    percentile(sorted, 0.90), percentile(sorted, 0.99),
+    sorted.empty() ? 0.0 : sorted.back() };
+}
+
+void texture::AsyncTextureLoader::print_latency_report() const
+{
+  LoadLatencyReport report = latency_report();
+
+  std::cout << "textures loaded: " << report.loaded
+            << " (failed: " << report.failed << ")"
+            << " | latency p50 " << report.p50_ms << " ms, p90 "
+            << report.p90_ms << " ms, p99 " << report.p99_ms << " ms, max "
+            << report.max_ms << " ms" << std::endl;
+}
+
+void texture::AsyncTextureLoader::delete_textures()
+{
+  for (auto& request : requests) {
+    if (request.texture != 0)
+      glDeleteTextures(1, &request.texture);
+    request.texture = 0;
+    request.ready = false;
+  }
+
+  glDeleteBuffers(STAGING_BUFFERS, staging_buffers.data());
+  glDeleteTextures(1, &placeholder);
+  placeholder = 0;
+}
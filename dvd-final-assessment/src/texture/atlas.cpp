@@ -0,0 +1,394 @@
+#include "../../include/texture/atlas.h"
+#include "../../include/texture/mipmap.h"
+#include "../../include/texture/pixel_ingest.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <unordered_set>
+
+namespace {
+
+constexpr int BYTES_PER_PIXEL { 4 };
+
+struct SkylineSegment {
+  int x;
+  int y;
+  int width;
+};
+
+int round_up(int value, int multiple)
+{
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+// Bottom-left skyline packer: each rectangle goes where its top edge ends up
+// lowest, ties broken by the leftmost position.
+class Skyline {
+public:
+  Skyline(int width, int height)
+      : width(width)
+      , height(height)
+      , segments { { 0, 0, width } }
+  {
+  }
+
+  bool insert(int rect_width, int rect_height, int& out_x, int& out_y)
+  {
+    int best_index = -1;
+    int best_top = height + 1;
+    int best_y = 0;
+
+    for (std::size_t i = 0; i < segments.size(); i++) {
+      int y;
+      if (!fits(i, rect_width, rect_height, y))
+        continue;
+
+      if (y + rect_height < best_top) {
+        best_top = y + rect_height;
+        best_index = static_cast<int>(i);
+        best_y = y;
+      }
+    }
+
+    if (best_index < 0)
+      return false;
+
+    out_x = segments[best_index].x;
+    out_y = best_y;
+    add_level(best_index, out_x, out_y + rect_height, rect_width);
+    return true;
+  }
+
+private:
+  bool fits(std::size_t index, int rect_width, int rect_height, int& y) const
+  {
+    int x = segments[index].x;
+    if (x + rect_width > width)
+      return false;
+
+    y = 0;
+    int remaining = rect_width;
+    for (std::size_t i = index; remaining > 0; i++) {
+      y = std::max(y, segments[i].y);
+      if (y + rect_height > height)
+        return false;
+      remaining -= segments[i].width;
+    }
+
+    return true;
+  }
+
+  void add_level(int index, int x, int y, int level_width)
+  {
+    segments.insert(segments.begin() + index, { x, y, level_width });
+
+    for (std::size_t i = index + 1; i < segments.size(); i++) {
+      SkylineSegment& previous = segments[i - 1];
+      SkylineSegment& segment = segments[i];
+      int previous_end = previous.x + previous.width;
+      if (segment.x >= previous_end)
+        break;
+
+      int shrink = previous_end - segment.x;
+      segment.x += shrink;
+      segment.width -= shrink;
+      if (segment.width > 0)
+        break;
+
+      segments.erase(segments.begin() + i);
+      i--;
+    }
+
+    for (std::size_t i = 0; i + 1 < segments.size();) {
+      if (segments[i].y == segments[i + 1].y) {
+        segments[i].width += segments[i + 1].width;
+        segments.erase(segments.begin() + i + 1);
+      } else {
+        i++;
+      }
+    }
+  }
+
+  int width;
+  int height;
+  std::vector<SkylineSegment> segments;
+};
+
+// Copies `image` into the atlas with its top-left at (x, y) and extrudes its
+// edge pixels across the surrounding cell out to (cell_x, cell_y, cell_w,
+// cell_h).
+void blit_with_gutter(std::vector<unsigned char>& atlas, int atlas_width,
+    const texture::AtlasImage& image, int x, int y, int cell_x, int cell_y,
+    int cell_width, int cell_height)
+{
+  for (int row = cell_y; row < cell_y + cell_height; row++) {
+    int source_row = std::clamp(row - y, 0, image.height - 1);
+    const unsigned char* source
+        = image.rgba.data() + source_row * image.width * BYTES_PER_PIXEL;
+    unsigned char* target
+        = atlas.data() + (row * atlas_width + cell_x) * BYTES_PER_PIXEL;
+
+    for (int column = cell_x; column < cell_x + cell_width; column++) {
+      int source_column = std::clamp(column - x, 0, image.width - 1);
+      std::copy_n(source + source_column * BYTES_PER_PIXEL, BYTES_PER_PIXEL,
+          target);
+      target += BYTES_PER_PIXEL;
+    }
+  }
+}
+
+texture::UvRect uv_for(const texture::AtlasRegion& region, int width, int height)
+{
+  float w = static_cast<float>(width);
+  float h = static_cast<float>(height);
+
+  return { region.x / w, 1.0f - (region.y + region.height) / h,
+    (region.x + region.width) / w, 1.0f - region.y / h };
+}
+
+} // namespace
+
+bool texture::TextureAtlas::pack(const std::vector<AtlasImage>& images,
+    const AtlasOptions& options, int width, int height,
+    std::vector<AtlasRegion>& placed) const
+{
+  std::vector<std::size_t> order(images.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    if (images[a].height != images[b].height)
+      return images[a].height > images[b].height;
+    return images[a].width > images[b].width;
+  });
+
+  const int alignment = std::max(1, options.alignment);
+  Skyline skyline(width, height);
+  placed.assign(images.size(), {});
+
+  for (std::size_t index : order) {
+    const AtlasImage& image = images[index];
+    int cell_width = round_up(image.width + 2 * options.padding, alignment);
+    int cell_height = round_up(image.height + 2 * options.padding, alignment);
+
+    int x, y;
+    if (!skyline.insert(cell_width, cell_height, x, y))
+      return false;
+
+    placed[index] = { x + options.padding, y + options.padding, image.width,
+      image.height, {} };
+  }
+
+  return true;
+}
+
+bool texture::TextureAtlas::build(
+    const std::vector<AtlasImage>& images, const AtlasOptions& options)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  // Each name is a lookup key, so a second image with the same stem would
+  // be packed but unreachable.
+  std::unordered_set<std::string> names;
+  for (const auto& image : images) {
+    if (!names.insert(image.name).second) {
+      std::cout << "atlas: duplicate image name " << image.name << "\n";
+      return false;
+    }
+  }
+
+  std::size_t used_area = 0;
+  for (const auto& image : images)
+    used_area += static_cast<std::size_t>(image.width) * image.height;
+
+  // Smallest power-of-two square that could hold the images, then grow one
+  // side at a time until the packer succeeds.
+  int width = 64;
+  int height = 64;
+  while (static_cast<std::size_t>(width) * height < used_area)
+    (width <= height ? width : height) *= 2;
+
+  std::vector<AtlasRegion> placed;
+  while (!pack(images, options, width, height, placed)) {
+    if (width >= options.max_size && height >= options.max_size) {
+      std::cout << "atlas: images do not fit in " << options.max_size << "x"
+                << options.max_size << "\n";
+      return false;
+    }
+    (width <= height ? width : height) *= 2;
+  }
+
+  atlas_width = width;
+  atlas_height = height;
+  atlas_alignment = std::max(1, options.alignment);
+  atlas_pixels.assign(
+      static_cast<std::size_t>(width) * height * BYTES_PER_PIXEL, 0);
+  atlas_regions.clear();
+
+  const int alignment = atlas_alignment;
+  for (std::size_t i = 0; i < images.size(); i++) {
+    AtlasRegion region = placed[i];
+    int cell_x = region.x - options.padding;
+    int cell_y = region.y - options.padding;
+    int cell_width = round_up(images[i].width + 2 * options.padding, alignment);
+    int cell_height
+        = round_up(images[i].height + 2 * options.padding, alignment);
+
+    blit_with_gutter(atlas_pixels, width, images[i], region.x, region.y, cell_x,
+        cell_y, cell_width, cell_height);
+
+    region.uv = uv_for(region, width, height);
+    atlas_regions.emplace(images[i].name, region);
+  }
+
+  std::chrono::duration<double, std::milli> elapsed
+      = std::chrono::steady_clock::now() - start;
+  atlas_stats = { images.size(), width, height,
+    static_cast<double>(used_area) / (static_cast<double>(width) * height),
+    elapsed.count() };
+
+  return true;
+}
+
+const texture::AtlasRegion* texture::TextureAtlas::find(
+    const std::string& name) const
+{
+  auto found = atlas_regions.find(name);
+  return found == atlas_regions.end() ? nullptr : &found->second;
+}
+
+bool texture::TextureAtlas::write(
+    const std::string& image_path, const std::string& manifest_path) const
+{
+  std::ofstream image(image_path, std::ios::binary);
+  if (!image.is_open()) {
+    std::cout << "failed to open file for writing: " << image_path << "\n";
+    return false;
+  }
+
+  // Uncompressed true-colour TGA, 32 bits per pixel, origin at the top left.
+  unsigned char header[18] {};
+  header[2] = 2;
+  header[12] = atlas_width & 0xff;
+  header[13] = (atlas_width >> 8) & 0xff;
+  header[14] = atlas_height & 0xff;
+  header[15] = (atlas_height >> 8) & 0xff;
+  header[16] = 32;
+  header[17] = 0x28;
+  image.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+  std::vector<unsigned char> bgra(atlas_pixels.size());
+  for (std::size_t i = 0; i < atlas_pixels.size(); i += BYTES_PER_PIXEL) {
+    bgra[i] = atlas_pixels[i + 2];
+    bgra[i + 1] = atlas_pixels[i + 1];
+    bgra[i + 2] = atlas_pixels[i];
+    bgra[i + 3] = atlas_pixels[i + 3];
+  }
+  image.write(reinterpret_cast<const char*>(bgra.data()), bgra.size());
+
+  std::ofstream manifest(manifest_path);
+  if (!manifest.is_open()) {
+    std::cout << "failed to open file for writing: " << manifest_path << "\n";
+    return false;
+  }
+
+  manifest << atlas_width << " " << atlas_height << " " << atlas_alignment
+           << "\n";
+  for (const auto& [name, region] : atlas_regions) {
+    manifest << name << " " << region.x << " " << region.y << " "
+             << region.width << " " << region.height << " " << region.uv.u0
+             << " " << region.uv.v0 << " " << region.uv.u1 << " "
+             << region.uv.v1 << "\n";
+  }
+
+  return image.good() && manifest.good();
+}
+
+bool texture::TextureAtlas::read(
+    const std::string& image_path, const std::string& manifest_path)
+{
+  std::ifstream manifest(manifest_path);
+  if (!manifest.is_open()) {
+    std::cout << "failed to load file: " << manifest_path << "\n";
+    return false;
+  }
+
+  IngestedImage image;
+  if (!load_image(image_path, image, { .flip_vertically = false }))
+    return false;
+
+  const int width = image.width;
+  const int height = image.height;
+  atlas_width = width;
+  atlas_height = height;
+  atlas_pixels = std::move(image.pixels);
+
+  int manifest_width, manifest_height;
+  manifest >> manifest_width >> manifest_height >> atlas_alignment;
+  atlas_alignment = std::max(1, atlas_alignment);
+
+  atlas_regions.clear();
+  std::string name;
+  AtlasRegion region;
+  while (manifest >> name >> region.x >> region.y >> region.width
+      >> region.height >> region.uv.u0 >> region.uv.v0 >> region.uv.u1
+      >> region.uv.v1)
+    atlas_regions[name] = region;
+
+  atlas_stats = { atlas_regions.size(), width, height, 0.0, 0.0 };
+  return manifest_width == width && manifest_height == height;
+}
+
+GLuint texture::TextureAtlas::upload() const
+{
+  const IngestedImage bottom_up = ingest_pixels(
+      atlas_pixels.data(), atlas_width, atlas_height, BYTES_PER_PIXEL);
+
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(
+      GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  // Box filtered so each aligned cell only averages its own texels.
+  const Ktx2Image mips = generate_mipmaps(
+      bottom_up.pixels.data(), atlas_width, atlas_height,
+      { MipFilter::BOX, true });
+  // Past log2 of the alignment a texel straddles two cells, and each
+  // region would bleed into its neighbours.
+  const auto level_count = static_cast<GLint>(std::min<std::size_t>(
+      mips.levels.size(),
+      std::countr_zero(static_cast<unsigned int>(atlas_alignment)) + 1));
+  for (GLint level = 0; level < level_count; level++) {
+    upload_pixels(mips.levels[level].data(), std::max(1, atlas_width >> level),
+        std::max(1, atlas_height >> level), bottom_up.format, level);
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+
+  return texture;
+}
+
+std::vector<texture::AtlasImage> texture::load_atlas_images(
+    const std::vector<std::string>& paths)
+{
+  std::vector<AtlasImage> images;
+
+  for (const auto& path : paths) {
+    IngestedImage loaded;
+    if (!load_image(path, loaded, { .flip_vertically = false }))
+      continue;
+
+    images.push_back({ std::filesystem::path(path).stem().string(),
+        loaded.width, loaded.height, std::move(loaded.pixels) });
+  }
+
+  return images;
+}
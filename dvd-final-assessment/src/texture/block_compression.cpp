@@ -0,0 +1,353 @@
+#include "../../include/texture/block_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+constexpr int BLOCK_TEXELS { 16 };
+
+// Principal axis of the block's colours (the first `channels` components),
+// found by power iteration on the covariance matrix. Returns the mean and
+// the range of projections onto the axis.
+void principal_axis(const unsigned char* rgba, int channels, float* mean,
+    float* axis, float& min_projection, float& max_projection)
+{
+  for (int c = 0; c < channels; c++) {
+    mean[c] = 0.0f;
+    for (int i = 0; i < BLOCK_TEXELS; i++)
+      mean[c] += rgba[i * 4 + c];
+    mean[c] /= BLOCK_TEXELS;
+  }
+
+  float covariance[4][4] {};
+  for (int i = 0; i < BLOCK_TEXELS; i++) {
+    for (int a = 0; a < channels; a++) {
+      for (int b = 0; b < channels; b++) {
+        covariance[a][b]
+            += (rgba[i * 4 + a] - mean[a]) * (rgba[i * 4 + b] - mean[b]);
+      }
+    }
+  }
+
+  for (int c = 0; c < channels; c++)
+    axis[c] = 1.0f;
+
+  for (int iteration = 0; iteration < 8; iteration++) {
+    float next[4] {};
+    for (int a = 0; a < channels; a++) {
+      for (int b = 0; b < channels; b++)
+        next[a] += covariance[a][b] * axis[b];
+    }
+
+    float length = 0.0f;
+    for (int c = 0; c < channels; c++)
+      length += next[c] * next[c];
+    length = std::sqrt(length);
+    if (length < 1e-6f)
+      break;
+
+    for (int c = 0; c < channels; c++)
+      axis[c] = next[c] / length;
+  }
+
+  min_projection = 1e30f;
+  max_projection = -1e30f;
+  for (int i = 0; i < BLOCK_TEXELS; i++) {
+    float projection = 0.0f;
+    for (int c = 0; c < channels; c++)
+      projection += (rgba[i * 4 + c] - mean[c]) * axis[c];
+    min_projection = std::min(min_projection, projection);
+    max_projection = std::max(max_projection, projection);
+  }
+}
+
+std::uint16_t to_rgb565(const float* rgb)
+{
+  auto quantize = [](float value, int bits) {
+    int max = (1 << bits) - 1;
+    return static_cast<std::uint16_t>(
+        std::clamp(static_cast<int>(value * max / 255.0f + 0.5f), 0, max));
+  };
+
+  return static_cast<std::uint16_t>((quantize(rgb[0], 5) << 11)
+      | (quantize(rgb[1], 6) << 5) | quantize(rgb[2], 5));
+}
+
+void from_rgb565(std::uint16_t color, int* rgb)
+{
+  int r = (color >> 11) & 31;
+  int g = (color >> 5) & 63;
+  int b = color & 31;
+  rgb[0] = (r << 3) | (r >> 2);
+  rgb[1] = (g << 2) | (g >> 4);
+  rgb[2] = (b << 3) | (b >> 2);
+}
+
+void write_le16(unsigned char* out, std::uint16_t value)
+{
+  out[0] = value & 0xff;
+  out[1] = value >> 8;
+}
+
+// BC1 colour block in four-colour mode (first endpoint greater).
+void encode_color_block(const unsigned char* rgba, unsigned char* out)
+{
+  float mean[4], axis[4], low, high;
+  principal_axis(rgba, 3, mean, axis, low, high);
+
+  float end0[3], end1[3];
+  for (int c = 0; c < 3; c++) {
+    end0[c] = std::clamp(mean[c] + axis[c] * high, 0.0f, 255.0f);
+    end1[c] = std::clamp(mean[c] + axis[c] * low, 0.0f, 255.0f);
+  }
+
+  std::uint16_t color0 = to_rgb565(end0);
+  std::uint16_t color1 = to_rgb565(end1);
+  if (color0 < color1)
+    std::swap(color0, color1);
+
+  std::uint32_t indices = 0;
+  if (color0 != color1) {
+    int palette[4][3];
+    from_rgb565(color0, palette[0]);
+    from_rgb565(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+      int best = 0;
+      int best_error = 1 << 30;
+      for (int p = 0; p < 4; p++) {
+        int error = 0;
+        for (int c = 0; c < 3; c++) {
+          int d = rgba[i * 4 + c] - palette[p][c];
+          error += d * d;
+        }
+        if (error < best_error) {
+          best_error = error;
+          best = p;
+        }
+      }
+      indices |= static_cast<std::uint32_t>(best) << (2 * i);
+    }
+  }
+
+  write_le16(out, color0);
+  write_le16(out + 2, color1);
+  for (int b = 0; b < 4; b++)
+    out[4 + b] = (indices >> (8 * b)) & 0xff;
+}
+
+// BC4-style alpha block in eight-value mode.
+void encode_alpha_block(const unsigned char* rgba, unsigned char* out)
+{
+  int alpha0 = 0;
+  int alpha1 = 255;
+  for (int i = 0; i < BLOCK_TEXELS; i++) {
+    alpha0 = std::max<int>(alpha0, rgba[i * 4 + 3]);
+    alpha1 = std::min<int>(alpha1, rgba[i * 4 + 3]);
+  }
+
+  std::uint64_t indices = 0;
+  if (alpha0 != alpha1) {
+    int palette[8] { alpha0, alpha1 };
+    for (int i = 1; i < 7; i++)
+      palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+      int best = 0;
+      int best_error = 1 << 30;
+      for (int p = 0; p < 8; p++) {
+        int error = std::abs(rgba[i * 4 + 3] - palette[p]);
+        if (error < best_error) {
+          best_error = error;
+          best = p;
+        }
+      }
+      indices |= static_cast<std::uint64_t>(best) << (3 * i);
+    }
+  }
+
+  out[0] = static_cast<unsigned char>(alpha0);
+  out[1] = static_cast<unsigned char>(alpha1);
+  for (int b = 0; b < 6; b++)
+    out[2 + b] = (indices >> (8 * b)) & 0xff;
+}
+
+constexpr int BC7_WEIGHTS_4BIT[16] { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43,
+  47, 51, 55, 60, 64 };
+
+class BitWriter {
+public:
+  explicit BitWriter(unsigned char* out)
+      : out(out)
+  {
+    std::fill(out, out + 16, 0);
+  }
+
+  void write(std::uint32_t value, int bits)
+  {
+    for (int i = 0; i < bits; i++, position++) {
+      if ((value >> i) & 1)
+        out[position / 8] |= static_cast<unsigned char>(1 << (position % 8));
+    }
+  }
+
+private:
+  unsigned char* out;
+  int position {};
+};
+
+} // namespace
+
+std::size_t texture::block_bytes(BlockFormat format)
+{
+  return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+void texture::encode_bc1_block(const unsigned char* rgba, unsigned char* out)
+{
+  encode_color_block(rgba, out);
+}
+
+void texture::encode_bc3_block(const unsigned char* rgba, unsigned char* out)
+{
+  encode_alpha_block(rgba, out);
+  encode_color_block(rgba, out + 8);
+}
+
+void texture::encode_bc7_block(const unsigned char* rgba, unsigned char* out)
+{
+  float mean[4], axis[4], low, high;
+  principal_axis(rgba, 4, mean, axis, low, high);
+
+  float end[2][4];
+  for (int c = 0; c < 4; c++) {
+    end[0][c] = std::clamp(mean[c] + axis[c] * low, 0.0f, 255.0f);
+    end[1][c] = std::clamp(mean[c] + axis[c] * high, 0.0f, 255.0f);
+  }
+
+  // Mode 6 endpoints are 7 bits per channel plus one shared low bit
+  // (p-bit) per endpoint; try all four p-bit pairs and keep the best.
+  int best_error = 1 << 30;
+  int best_endpoints[2][4] {};
+  int best_pbits[2] {};
+  int best_indices[BLOCK_TEXELS] {};
+
+  for (int pbits = 0; pbits < 4; pbits++) {
+    int pbit[2] = { pbits & 1, pbits >> 1 };
+    int quantized[2][4];
+    int expanded[2][4];
+    for (int e = 0; e < 2; e++) {
+      for (int c = 0; c < 4; c++) {
+        int value = static_cast<int>(
+            std::lround((end[e][c] - pbit[e]) / 2.0f));
+        quantized[e][c] = std::clamp(value, 0, 127);
+        expanded[e][c] = (quantized[e][c] << 1) | pbit[e];
+      }
+    }
+
+    int palette[16][4];
+    for (int i = 0; i < 16; i++) {
+      int w = BC7_WEIGHTS_4BIT[i];
+      for (int c = 0; c < 4; c++)
+        palette[i][c] = ((64 - w) * expanded[0][c] + w * expanded[1][c] + 32)
+            >> 6;
+    }
+
+    int error = 0;
+    int indices[BLOCK_TEXELS];
+    for (int t = 0; t < BLOCK_TEXELS; t++) {
+      int best = 0;
+      int best_texel_error = 1 << 30;
+      for (int i = 0; i < 16; i++) {
+        int texel_error = 0;
+        for (int c = 0; c < 4; c++) {
+          int d = rgba[t * 4 + c] - palette[i][c];
+          texel_error += d * d;
+        }
+        if (texel_error < best_texel_error) {
+          best_texel_error = texel_error;
+          best = i;
+        }
+      }
+      indices[t] = best;
+      error += best_texel_error;
+    }
+
+    if (error < best_error) {
+      best_error = error;
+      std::copy(&quantized[0][0], &quantized[0][0] + 8, &best_endpoints[0][0]);
+      best_pbits[0] = pbit[0];
+      best_pbits[1] = pbit[1];
+      std::copy(indices, indices + BLOCK_TEXELS, best_indices);
+    }
+  }
+
+  // The first index is stored with an implicit zero top bit; swap the
+  // endpoints if needed to make that true.
+  if (best_indices[0] & 8) {
+    for (int c = 0; c < 4; c++)
+      std::swap(best_endpoints[0][c], best_endpoints[1][c]);
+    std::swap(best_pbits[0], best_pbits[1]);
+    for (int& index : best_indices)
+      index = 15 - index;
+  }
+
+  BitWriter bits(out);
+  bits.write(1 << 6, 7);
+  for (int c = 0; c < 4; c++) {
+    bits.write(best_endpoints[0][c], 7);
+    bits.write(best_endpoints[1][c], 7);
+  }
+  bits.write(best_pbits[0], 1);
+  bits.write(best_pbits[1], 1);
+  bits.write(best_indices[0], 3);
+  for (int t = 1; t < BLOCK_TEXELS; t++)
+    bits.write(best_indices[t], 4);
+}
+
+std::vector<unsigned char> texture::compress_image(
+    const unsigned char* rgba, int width, int height, BlockFormat format)
+{
+  const int blocks_x = (width + 3) / 4;
+  const int blocks_y = (height + 3) / 4;
+  const std::size_t bytes = block_bytes(format);
+
+  std::vector<unsigned char> compressed(
+      static_cast<std::size_t>(blocks_x) * blocks_y * bytes);
+
+  unsigned char block[BLOCK_TEXELS * 4];
+  for (int by = 0; by < blocks_y; by++) {
+    for (int bx = 0; bx < blocks_x; bx++) {
+      for (int ty = 0; ty < 4; ty++) {
+        int y = std::min(by * 4 + ty, height - 1);
+        for (int tx = 0; tx < 4; tx++) {
+          int x = std::min(bx * 4 + tx, width - 1);
+          std::copy_n(rgba + (static_cast<std::size_t>(y) * width + x) * 4, 4,
+              block + (ty * 4 + tx) * 4);
+        }
+      }
+
+      unsigned char* out
+          = compressed.data() + (static_cast<std::size_t>(by) * blocks_x + bx) * bytes;
+      switch (format) {
+      case BlockFormat::BC1:
+        encode_bc1_block(block, out);
+        break;
+      case BlockFormat::BC3:
+        encode_bc3_block(block, out);
+        break;
+      case BlockFormat::BC7:
+        encode_bc7_block(block, out);
+        break;
+      }
+    }
+  }
+
+  return compressed;
+}
@@ -0,0 +1,541 @@
+#include "../../include/texture/ktx2.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+constexpr std::array<unsigned char, 12> KTX2_IDENTIFIER { 0xAB, 'K', 'T', 'X',
+  ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+constexpr std::size_t HEADER_BYTES { 80 };
+constexpr std::size_t LEVEL_INDEX_ENTRY_BYTES { 24 };
+
+struct FormatEntry {
+  std::uint32_t vk_format;
+  texture::GlTextureFormat gl;
+};
+
+constexpr FormatEntry FORMATS[] = {
+  { texture::VK_FORMAT_R8G8B8A8_UNORM,
+      { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, false, 4 } },
+  { texture::VK_FORMAT_R8G8B8A8_SRGB,
+      { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, false, 4 } },
+  { texture::VK_FORMAT_BC1_RGB_UNORM_BLOCK,
+      { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 0, 0, true, 8 } },
+  { texture::VK_FORMAT_BC1_RGB_SRGB_BLOCK,
+      { GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, 0, 0, true, 8 } },
+  { texture::VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+      { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 0, 0, true, 8 } },
+  { texture::VK_FORMAT_BC1_RGBA_SRGB_BLOCK,
+      { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 0, 0, true, 8 } },
+  { texture::VK_FORMAT_BC3_UNORM_BLOCK,
+      { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 0, 0, true, 16 } },
+  { texture::VK_FORMAT_BC3_SRGB_BLOCK,
+      { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 0, 0, true, 16 } },
+  { texture::VK_FORMAT_BC4_UNORM_BLOCK,
+      { GL_COMPRESSED_RED_RGTC1, 0, 0, true, 8 } },
+  { texture::VK_FORMAT_BC5_UNORM_BLOCK,
+      { GL_COMPRESSED_RG_RGTC2, 0, 0, true, 16 } },
+  { texture::VK_FORMAT_BC7_UNORM_BLOCK,
+      { GL_COMPRESSED_RGBA_BPTC_UNORM, 0, 0, true, 16 } },
+  { texture::VK_FORMAT_BC7_SRGB_BLOCK,
+      { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 0, 0, true, 16 } },
+  { texture::VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,
+      { GL_COMPRESSED_RGB8_ETC2, 0, 0, true, 8 } },
+  { texture::VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK,
+      { GL_COMPRESSED_SRGB8_ETC2, 0, 0, true, 8 } },
+  { texture::VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,
+      { GL_COMPRESSED_RGBA8_ETC2_EAC, 0, 0, true, 16 } },
+  { texture::VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK,
+      { GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, 0, 0, true, 16 } },
+  { texture::VK_FORMAT_EAC_R11_UNORM_BLOCK,
+      { GL_COMPRESSED_R11_EAC, 0, 0, true, 8 } },
+  { texture::VK_FORMAT_EAC_R11G11_UNORM_BLOCK,
+      { GL_COMPRESSED_RG11_EAC, 0, 0, true, 16 } },
+};
+
+// KTX2 is little-endian, as is every platform we build for.
+template <typename T> T read_le(const unsigned char* bytes)
+{
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+template <typename T> void append_le(std::vector<unsigned char>& out, T value)
+{
+  unsigned char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+void patch_le(std::vector<unsigned char>& out, std::size_t offset, T value)
+{
+  std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+void pad_to(std::vector<unsigned char>& out, std::size_t alignment)
+{
+  while (out.size() % alignment != 0)
+    out.push_back(0);
+}
+
+std::uint32_t sample_word(std::uint32_t bit_offset, std::uint32_t bit_length,
+    std::uint32_t channel, std::uint32_t qualifiers = 0)
+{
+  return bit_offset | ((bit_length - 1) << 16) | (channel << 24)
+      | (qualifiers << 28);
+}
+
+// Basic data format descriptor block (Khronos Data Format spec) for the
+// formats the writer supports. Returns false for anything else.
+bool append_dfd(std::vector<unsigned char>& out, std::uint32_t vk_format)
+{
+  constexpr std::uint32_t MODEL_RGBSDA { 1 };
+  constexpr std::uint32_t MODEL_BC1A { 128 };
+  constexpr std::uint32_t MODEL_BC3 { 130 };
+  constexpr std::uint32_t MODEL_BC7 { 134 };
+  constexpr std::uint32_t PRIMARIES_BT709 { 1 };
+  constexpr std::uint32_t TRANSFER_LINEAR { 1 };
+  constexpr std::uint32_t TRANSFER_SRGB { 2 };
+  constexpr std::uint32_t CHANNEL_ALPHA { 15 };
+  constexpr std::uint32_t QUALIFIER_LINEAR { 1 };
+
+  struct Sample {
+    std::uint32_t word;
+    std::uint32_t upper;
+  };
+
+  std::uint32_t model;
+  std::uint32_t transfer = TRANSFER_LINEAR;
+  std::uint32_t block_dimensions = 0x00000303; // 4x4x1x1, stored minus one.
+  std::uint32_t bytes_plane0;
+  std::vector<Sample> samples;
+
+  switch (vk_format) {
+  case texture::VK_FORMAT_R8G8B8A8_SRGB:
+    transfer = TRANSFER_SRGB;
+    [[fallthrough]];
+  case texture::VK_FORMAT_R8G8B8A8_UNORM:
+    model = MODEL_RGBSDA;
+    block_dimensions = 0;
+    bytes_plane0 = 4;
+    for (std::uint32_t channel = 0; channel < 3; channel++)
+      samples.push_back({ sample_word(channel * 8, 8, channel), 255 });
+    samples.push_back({ sample_word(24, 8, CHANNEL_ALPHA,
+                            transfer == TRANSFER_SRGB ? QUALIFIER_LINEAR : 0),
+        255 });
+    break;
+  case texture::VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    transfer = TRANSFER_SRGB;
+    [[fallthrough]];
+  case texture::VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    model = MODEL_BC1A;
+    bytes_plane0 = 8;
+    samples.push_back({ sample_word(0, 64, 0), 0xffffffff });
+    break;
+  case texture::VK_FORMAT_BC3_SRGB_BLOCK:
+    transfer = TRANSFER_SRGB;
+    [[fallthrough]];
+  case texture::VK_FORMAT_BC3_UNORM_BLOCK:
+    model = MODEL_BC3;
+    bytes_plane0 = 16;
+    samples.push_back({ sample_word(0, 64, CHANNEL_ALPHA,
+                            transfer == TRANSFER_SRGB ? QUALIFIER_LINEAR : 0),
+        0xffffffff });
+    samples.push_back({ sample_word(64, 64, 0), 0xffffffff });
+    break;
+  case texture::VK_FORMAT_BC7_SRGB_BLOCK:
+    transfer = TRANSFER_SRGB;
+    [[fallthrough]];
+  case texture::VK_FORMAT_BC7_UNORM_BLOCK:
+    model = MODEL_BC7;
+    bytes_plane0 = 16;
+    samples.push_back({ sample_word(0, 128, 0), 0xffffffff });
+    break;
+  default:
+    return false;
+  }
+
+  std::uint32_t block_size = 24 + 16 * static_cast<std::uint32_t>(samples.size());
+  append_le<std::uint32_t>(out, 4 + block_size);
+  append_le<std::uint32_t>(out, 0); // Khronos vendor, basic descriptor type.
+  append_le<std::uint32_t>(out, 2 | (block_size << 16));
+  append_le<std::uint32_t>(out, model | (PRIMARIES_BT709 << 8) | (transfer << 16));
+  append_le<std::uint32_t>(out, block_dimensions);
+  append_le<std::uint32_t>(out, bytes_plane0);
+  append_le<std::uint32_t>(out, 0);
+  for (const auto& sample : samples) {
+    append_le<std::uint32_t>(out, sample.word);
+    append_le<std::uint32_t>(out, 0);
+    append_le<std::uint32_t>(out, 0);
+    append_le<std::uint32_t>(out, sample.upper);
+  }
+
+  return true;
+}
+
+void append_key_value(
+    std::vector<unsigned char>& out, const std::string& key, const std::string& value)
+{
+  append_le<std::uint32_t>(
+      out, static_cast<std::uint32_t>(key.size() + value.size() + 2));
+  out.insert(out.end(), key.begin(), key.end());
+  out.push_back(0);
+  out.insert(out.end(), value.begin(), value.end());
+  out.push_back(0);
+  pad_to(out, 4);
+}
+
+void parse_key_values(const unsigned char* data, std::size_t size,
+    std::vector<std::pair<std::string, std::string>>& entries)
+{
+  std::size_t offset = 0;
+  while (offset + 4 <= size) {
+    std::uint32_t length = read_le<std::uint32_t>(data + offset);
+    offset += 4;
+    if (offset + length > size)
+      break;
+
+    std::string entry(reinterpret_cast<const char*>(data + offset), length);
+    std::size_t separator = entry.find('\0');
+    if (separator != std::string::npos) {
+      std::string value = entry.substr(separator + 1);
+      if (!value.empty() && value.back() == '\0')
+        value.pop_back();
+      entries.emplace_back(entry.substr(0, separator), value);
+    }
+
+    offset += (length + 3) & ~std::size_t { 3 };
+  }
+}
+
+} // namespace
+
+bool texture::gl_texture_format(std::uint32_t vk_format, GlTextureFormat& format)
+{
+  for (const auto& entry : FORMATS) {
+    if (entry.vk_format == vk_format) {
+      format = entry.gl;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool texture::gl_texture_format_supported(const GlTextureFormat& format)
+{
+  switch (format.internal_format) {
+  case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    return GLAD_GL_EXT_texture_compression_s3tc;
+  case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    return GLAD_GL_EXT_texture_compression_s3tc && GLAD_GL_EXT_texture_sRGB;
+  case GL_COMPRESSED_RED_RGTC1:
+  case GL_COMPRESSED_RG_RGTC2:
+    return GLAD_GL_VERSION_3_0 || GLAD_GL_ARB_texture_compression_rgtc;
+  case GL_COMPRESSED_RGBA_BPTC_UNORM:
+  case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+    return GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_compression_bptc;
+  case GL_COMPRESSED_RGB8_ETC2:
+  case GL_COMPRESSED_SRGB8_ETC2:
+  case GL_COMPRESSED_RGBA8_ETC2_EAC:
+  case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+  case GL_COMPRESSED_R11_EAC:
+  case GL_COMPRESSED_RG11_EAC:
+    return GLAD_GL_VERSION_4_3;
+  default:
+    return !format.compressed;
+  }
+}
+
+std::size_t texture::ktx2_level_bytes(
+    const GlTextureFormat& format, int width, int height)
+{
+  if (!format.compressed)
+    return static_cast<std::size_t>(width) * height * format.block_bytes;
+
+  std::size_t blocks_x = (width + 3) / 4;
+  std::size_t blocks_y = (height + 3) / 4;
+  return blocks_x * blocks_y * format.block_bytes;
+}
+
+std::vector<unsigned char> texture::flip_level_rows(
+    const GlTextureFormat& format, const unsigned char* data, int width,
+    int height)
+{
+  const std::size_t row_bytes
+      = static_cast<std::size_t>(width) * format.block_bytes;
+  std::vector<unsigned char> flipped(row_bytes * height);
+  for (int row = 0; row < height; row++) {
+    std::copy_n(data + row_bytes * (height - 1 - row), row_bytes,
+        flipped.data() + row_bytes * row);
+  }
+
+  return flipped;
+}
+
+bool texture::parse_ktx2(const unsigned char* bytes, std::size_t size,
+    const std::string& name, Ktx2Image& image, std::vector<Ktx2Level>& levels)
+{
+  if (size < HEADER_BYTES
+      || !std::equal(KTX2_IDENTIFIER.begin(), KTX2_IDENTIFIER.end(), bytes)) {
+    std::cout << "not a KTX2 file: " << name << std::endl;
+    return false;
+  }
+
+  const unsigned char* header = bytes + KTX2_IDENTIFIER.size();
+  std::uint32_t vk_format = read_le<std::uint32_t>(header);
+  std::uint32_t width = read_le<std::uint32_t>(header + 8);
+  std::uint32_t height = read_le<std::uint32_t>(header + 12);
+  std::uint32_t depth = read_le<std::uint32_t>(header + 16);
+  std::uint32_t layers = read_le<std::uint32_t>(header + 20);
+  std::uint32_t faces = read_le<std::uint32_t>(header + 24);
+  std::uint32_t level_count = std::max<std::uint32_t>(
+      read_le<std::uint32_t>(header + 28), 1);
+  std::uint32_t supercompression = read_le<std::uint32_t>(header + 32);
+  std::uint32_t kvd_offset = read_le<std::uint32_t>(header + 44);
+  std::uint32_t kvd_length = read_le<std::uint32_t>(header + 48);
+
+  GlTextureFormat format;
+  if (!gl_texture_format(vk_format, format)) {
+    std::cout << "unsupported KTX2 format " << vk_format << ": " << name
+              << std::endl;
+    return false;
+  }
+
+  if (depth > 1 || layers > 1 || faces != 1 || supercompression != 0
+      || width == 0 || height == 0
+      || std::max(width, height)
+          > static_cast<std::uint32_t>(std::numeric_limits<int>::max())) {
+    std::cout << "only plain 2D KTX2 textures are supported: " << name
+              << std::endl;
+    return false;
+  }
+
+  // A full chain ends at 1x1; more levels than that would shift the size
+  // past its width.
+  if (level_count > static_cast<std::uint32_t>(
+          std::bit_width(std::max(width, height)))) {
+    std::cout << "too many KTX2 levels for " << width << "x" << height << ": "
+              << name << std::endl;
+    return false;
+  }
+
+  if (HEADER_BYTES + level_count * LEVEL_INDEX_ENTRY_BYTES > size
+      || kvd_length > size || kvd_offset > size - kvd_length) {
+    std::cout << "truncated KTX2 file: " << name << std::endl;
+    return false;
+  }
+
+  image.vk_format = vk_format;
+  image.width = static_cast<int>(width);
+  image.height = static_cast<int>(height);
+  image.metadata.clear();
+  image.levels.clear();
+  parse_key_values(bytes + kvd_offset, kvd_length, image.metadata);
+  image.origin_bottom_left = false;
+  for (auto entry = image.metadata.begin(); entry != image.metadata.end();) {
+    if (entry->first == "KTXorientation") {
+      image.origin_bottom_left = entry->second.size() > 1 && entry->second[1] == 'u';
+      entry = image.metadata.erase(entry);
+    } else if (entry->first == "KTXwriter") {
+      entry = image.metadata.erase(entry);
+    } else {
+      entry++;
+    }
+  }
+
+  if (format.compressed && !image.origin_bottom_left) {
+    std::cout << "block-compressed KTX2 with a top-left origin is not "
+                 "supported: "
+              << name << std::endl;
+    return false;
+  }
+
+  levels.assign(level_count, {});
+  for (std::uint32_t level = 0; level < level_count; level++) {
+    const unsigned char* entry
+        = bytes + HEADER_BYTES + level * LEVEL_INDEX_ENTRY_BYTES;
+    std::uint64_t offset = read_le<std::uint64_t>(entry);
+    std::uint64_t length = read_le<std::uint64_t>(entry + 8);
+
+    int level_width = std::max(1, image.width >> level);
+    int level_height = std::max(1, image.height >> level);
+    if (length > size || offset > size - length
+        || length < ktx2_level_bytes(format, level_width, level_height)) {
+      std::cout << "truncated KTX2 level " << level << ": " << name
+                << std::endl;
+      return false;
+    }
+
+    levels[level] = { static_cast<std::size_t>(offset),
+      static_cast<std::size_t>(length) };
+  }
+
+  return true;
+}
+
+bool texture::read_ktx2(const std::string& path, Ktx2Image& image)
+{
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return false;
+  }
+
+  std::vector<unsigned char> bytes(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(bytes.data()),
+      static_cast<std::streamsize>(bytes.size()));
+
+  std::vector<Ktx2Level> levels;
+  if (!parse_ktx2(bytes.data(), bytes.size(), path, image, levels))
+    return false;
+
+  image.levels.assign(levels.size(), {});
+  for (std::size_t level = 0; level < levels.size(); level++) {
+    const auto begin = bytes.begin() + levels[level].offset;
+    image.levels[level].assign(begin, begin + levels[level].length);
+  }
+
+  return true;
+}
+
+bool texture::write_ktx2(const std::string& path, const Ktx2Image& image)
+{
+  GlTextureFormat format;
+  if (!gl_texture_format(image.vk_format, format) || image.levels.empty()) {
+    std::cout << "cannot write KTX2 format " << image.vk_format << std::endl;
+    return false;
+  }
+
+  const auto level_count = static_cast<std::uint32_t>(image.levels.size());
+
+  std::vector<unsigned char> out(KTX2_IDENTIFIER.begin(), KTX2_IDENTIFIER.end());
+  append_le<std::uint32_t>(out, image.vk_format);
+  append_le<std::uint32_t>(out, 1); // typeSize
+  append_le<std::uint32_t>(out, static_cast<std::uint32_t>(image.width));
+  append_le<std::uint32_t>(out, static_cast<std::uint32_t>(image.height));
+  append_le<std::uint32_t>(out, 0); // depth
+  append_le<std::uint32_t>(out, 0); // layers
+  append_le<std::uint32_t>(out, 1); // faces
+  append_le<std::uint32_t>(out, level_count);
+  append_le<std::uint32_t>(out, 0); // no supercompression
+
+  // Index section, patched once the offsets are known.
+  const std::size_t index_offset = out.size();
+  out.resize(HEADER_BYTES + level_count * LEVEL_INDEX_ENTRY_BYTES);
+
+  const auto dfd_offset = static_cast<std::uint32_t>(out.size());
+  if (!append_dfd(out, image.vk_format)) {
+    std::cout << "cannot write KTX2 format " << image.vk_format << std::endl;
+    return false;
+  }
+  const auto dfd_length = static_cast<std::uint32_t>(out.size() - dfd_offset);
+
+  const auto kvd_offset = static_cast<std::uint32_t>(out.size());
+  // The format requires entries sorted by key.
+  std::vector<std::pair<std::string, std::string>> entries = image.metadata;
+  entries.emplace_back("KTXorientation", image.origin_bottom_left ? "ru" : "rd");
+  entries.emplace_back("KTXwriter", "dvd-final-assessment");
+  std::sort(entries.begin(), entries.end());
+  for (const auto& [key, value] : entries)
+    append_key_value(out, key, value);
+  const auto kvd_length = static_cast<std::uint32_t>(out.size() - kvd_offset);
+
+  patch_le<std::uint32_t>(out, index_offset, dfd_offset);
+  patch_le<std::uint32_t>(out, index_offset + 4, dfd_length);
+  patch_le<std::uint32_t>(out, index_offset + 8, kvd_offset);
+  patch_le<std::uint32_t>(out, index_offset + 12, kvd_length);
+  patch_le<std::uint64_t>(out, index_offset + 16, 0);
+  patch_le<std::uint64_t>(out, index_offset + 24, 0);
+
+  // Levels are stored smallest first, each aligned to the block size.
+  for (std::uint32_t level = level_count; level-- > 0;) {
+    pad_to(out, 16);
+    std::size_t entry = HEADER_BYTES + level * LEVEL_INDEX_ENTRY_BYTES;
+    const auto& data = image.levels[level];
+    patch_le<std::uint64_t>(out, entry, out.size());
+    patch_le<std::uint64_t>(out, entry + 8, data.size());
+    patch_le<std::uint64_t>(out, entry + 16, data.size());
+    out.insert(out.end(), data.begin(), data.end());
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(out.data()),
+      static_cast<std::streamsize>(out.size()));
+  if (!file) {
+    std::cout << "failed to write file: " << path << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+const std::string* texture::find_metadata(
+    const Ktx2Image& image, const std::string& key)
+{
+  for (const auto& entry : image.metadata) {
+    if (entry.first == key)
+      return &entry.second;
+  }
+
+  return nullptr;
+}
+
+GLuint texture::upload_ktx2(const Ktx2Image& image)
+{
+  GlTextureFormat format;
+  if (!gl_texture_format(image.vk_format, format)
+      || !gl_texture_format_supported(format)) {
+    std::cout << "texture format " << image.vk_format
+              << " is not supported by this driver" << std::endl;
+    return 0;
+  }
+
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  const auto level_count = static_cast<GLint>(image.levels.size());
+  for (GLint level = 0; level < level_count; level++) {
+    int width = std::max(1, image.width >> level);
+    int height = std::max(1, image.height >> level);
+    const auto& data = image.levels[level];
+
+    if (format.compressed) {
+      glCompressedTexImage2D(GL_TEXTURE_2D, level, format.internal_format,
+          width, height, 0, static_cast<GLsizei>(data.size()), data.data());
+    } else if (!image.origin_bottom_left) {
+      glTexImage2D(GL_TEXTURE_2D, level, format.internal_format, width, height,
+          0, format.format, format.type,
+          flip_level_rows(format, data.data(), width, height).data());
+    } else {
+      glTexImage2D(GL_TEXTURE_2D, level, format.internal_format, width, height,
+          0, format.format, format.type, data.data());
+    }
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+      level_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  return texture;
+}
@@ -0,0 +1,395 @@
+#include "../../include/texture/mipmap.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "../../include/texture/pixel_ingest.h"
+
+namespace {
+
+constexpr char MIP_SOURCE_KEY[] { "dvdMipSource" };
+constexpr int LINEAR_TO_SRGB_STEPS { 4096 };
+constexpr std::size_t ROWS_PER_CHUNK { 8 };
+
+constexpr float PI { 3.14159265358979f };
+constexpr float KAISER_ALPHA { 4.0f };
+constexpr float KAISER_RADIUS { 3.0f };
+constexpr float LANCZOS_RADIUS { 3.0f };
+
+struct ColorTables {
+  std::array<float, 256> srgb_to_linear;
+  std::array<unsigned char, LINEAR_TO_SRGB_STEPS> linear_to_srgb;
+};
+
+const ColorTables& color_tables()
+{
+  static const ColorTables tables = [] {
+    ColorTables t;
+    for (int i = 0; i < 256; i++) {
+      float c = i / 255.0f;
+      t.srgb_to_linear[i] = c <= 0.04045f
+          ? c / 12.92f
+          : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for (int i = 0; i < LINEAR_TO_SRGB_STEPS; i++) {
+      float l = i / static_cast<float>(LINEAR_TO_SRGB_STEPS - 1);
+      float c = l <= 0.0031308f ? l * 12.92f
+                                : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+      t.linear_to_srgb[i] = static_cast<unsigned char>(c * 255.0f + 0.5f);
+    }
+    return t;
+  }();
+  return tables;
+}
+
+float sinc(float x)
+{
+  if (std::fabs(x) < 1e-5f)
+    return 1.0f;
+  return std::sin(PI * x) / (PI * x);
+}
+
+// Zeroth order modified Bessel function of the first kind.
+float bessel_i0(float x)
+{
+  float sum = 1.0f;
+  float term = 1.0f;
+  for (int k = 1; k < 16; k++) {
+    term *= (x / (2.0f * k)) * (x / (2.0f * k));
+    sum += term;
+  }
+  return sum;
+}
+
+float filter_radius(texture::MipFilter filter)
+{
+  switch (filter) {
+  case texture::MipFilter::KAISER:
+    return KAISER_RADIUS;
+  case texture::MipFilter::LANCZOS:
+    return LANCZOS_RADIUS;
+  default:
+    return 0.5f;
+  }
+}
+
+float filter_weight(texture::MipFilter filter, float x)
+{
+  switch (filter) {
+  case texture::MipFilter::KAISER: {
+    float t = x / KAISER_RADIUS;
+    if (t * t >= 1.0f)
+      return 0.0f;
+    return sinc(x) * bessel_i0(KAISER_ALPHA * std::sqrt(1.0f - t * t))
+        / bessel_i0(KAISER_ALPHA);
+  }
+  case texture::MipFilter::LANCZOS:
+    return std::fabs(x) < LANCZOS_RADIUS ? sinc(x) * sinc(x / LANCZOS_RADIUS)
+                                         : 0.0f;
+  default:
+    return std::fabs(x) <= 0.5f ? 1.0f : 0.0f;
+  }
+}
+
+// Source indices and weights for every output texel along one axis, with
+// the same number of taps each so the inner loops stay branch free. Edges
+// clamp.
+struct Taps {
+  int count;
+  std::vector<int> index;
+  std::vector<float> weight;
+};
+
+Taps make_taps(texture::MipFilter filter, int source_size, int target_size)
+{
+  const float scale = static_cast<float>(source_size) / target_size;
+  const float support = filter_radius(filter) * scale;
+
+  Taps taps;
+  taps.count = static_cast<int>(std::ceil(support * 2.0f)) + 1;
+  taps.index.resize(static_cast<std::size_t>(target_size) * taps.count);
+  taps.weight.resize(taps.index.size());
+
+  for (int i = 0; i < target_size; i++) {
+    float center = (i + 0.5f) * scale;
+    int first = static_cast<int>(std::floor(center - support));
+    float total = 0.0f;
+
+    for (int k = 0; k < taps.count; k++) {
+      int source = first + k;
+      float w = filter_weight(filter, (source + 0.5f - center) / scale);
+      taps.index[i * taps.count + k] = std::clamp(source, 0, source_size - 1);
+      taps.weight[i * taps.count + k] = w;
+      total += w;
+    }
+
+    for (int k = 0; k < taps.count; k++)
+      taps.weight[i * taps.count + k] /= total;
+  }
+
+  return taps;
+}
+
+// One premultiplied linear RGBA texel in a vector register.
+#if defined(__SSE2__)
+using Texel = __m128;
+inline Texel texel_zero() { return _mm_setzero_ps(); }
+inline Texel texel_load(const float* p) { return _mm_loadu_ps(p); }
+inline void texel_store(float* p, Texel t) { _mm_storeu_ps(p, t); }
+inline Texel texel_madd(Texel acc, const float* p, float w)
+{
+  return _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(w)));
+}
+#else
+struct Texel {
+  float v[4];
+};
+inline Texel texel_zero() { return {}; }
+inline Texel texel_load(const float* p) { return { p[0], p[1], p[2], p[3] }; }
+inline void texel_store(float* p, Texel t) { std::copy(t.v, t.v + 4, p); }
+inline Texel texel_madd(Texel acc, const float* p, float w)
+{
+  for (int c = 0; c < 4; c++)
+    acc.v[c] += p[c] * w;
+  return acc;
+}
+#endif
+
+void for_rows(threading::ThreadPool* pool, int rows,
+    const std::function<void(std::size_t, std::size_t)>& body)
+{
+  if (pool)
+    pool->parallel_for(rows, ROWS_PER_CHUNK, body);
+  else
+    body(0, rows);
+}
+
+void to_linear(const unsigned char* rgba, std::size_t texels, bool srgb,
+    float* out)
+{
+  const auto& tables = color_tables();
+  for (std::size_t i = 0; i < texels; i++) {
+    float alpha = rgba[i * 4 + 3] / 255.0f;
+    for (int c = 0; c < 3; c++) {
+      float value = srgb ? tables.srgb_to_linear[rgba[i * 4 + c]]
+                         : rgba[i * 4 + c] / 255.0f;
+      out[i * 4 + c] = value * alpha;
+    }
+    out[i * 4 + 3] = alpha;
+  }
+}
+
+void from_linear(const float* linear, std::size_t texels, bool srgb,
+    unsigned char* out)
+{
+  const auto& tables = color_tables();
+  for (std::size_t i = 0; i < texels; i++) {
+    float alpha = std::clamp(linear[i * 4 + 3], 0.0f, 1.0f);
+    float inverse = alpha > 0.0f ? 1.0f / linear[i * 4 + 3] : 0.0f;
+    for (int c = 0; c < 3; c++) {
+      float value = std::clamp(linear[i * 4 + c] * inverse, 0.0f, 1.0f);
+      out[i * 4 + c] = srgb
+          ? tables.linear_to_srgb[static_cast<int>(
+              value * (LINEAR_TO_SRGB_STEPS - 1) + 0.5f)]
+          : static_cast<unsigned char>(value * 255.0f + 0.5f);
+    }
+    out[i * 4 + 3] = static_cast<unsigned char>(alpha * 255.0f + 0.5f);
+  }
+}
+
+void downsample(const std::vector<float>& source, int width, int height,
+    std::vector<float>& target, int target_width, int target_height,
+    texture::MipFilter filter, threading::ThreadPool* pool)
+{
+  const Taps columns = make_taps(filter, width, target_width);
+  const Taps rows = make_taps(filter, height, target_height);
+
+  std::vector<float> horizontal(
+      static_cast<std::size_t>(target_width) * height * 4);
+
+  for_rows(pool, height, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t y = begin; y < end; y++) {
+      const float* in = source.data() + y * width * 4;
+      float* out = horizontal.data() + y * target_width * 4;
+      for (int x = 0; x < target_width; x++) {
+        const int* index = columns.index.data() + x * columns.count;
+        const float* weight = columns.weight.data() + x * columns.count;
+        Texel sum = texel_zero();
+        for (int k = 0; k < columns.count; k++)
+          sum = texel_madd(sum, in + index[k] * 4, weight[k]);
+        texel_store(out + x * 4, sum);
+      }
+    }
+  });
+
+  target.assign(static_cast<std::size_t>(target_width) * target_height * 4, 0.0f);
+
+  for_rows(pool, target_height, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t y = begin; y < end; y++) {
+      const int* index = rows.index.data() + y * rows.count;
+      const float* weight = rows.weight.data() + y * rows.count;
+      float* out = target.data() + y * target_width * 4;
+      for (int k = 0; k < rows.count; k++) {
+        const float* in = horizontal.data()
+            + static_cast<std::size_t>(index[k]) * target_width * 4;
+        for (int x = 0; x < target_width; x++) {
+          texel_store(out + x * 4,
+              texel_madd(texel_load(out + x * 4), in + x * 4, weight[k]));
+        }
+      }
+    }
+  });
+}
+
+std::string source_stamp(
+    const std::string& path, const texture::MipOptions& options)
+{
+  std::error_code error;
+  auto size = std::filesystem::file_size(path, error);
+  if (error)
+    return {};
+  auto modified = std::filesystem::last_write_time(path, error);
+  if (error)
+    return {};
+
+  return std::to_string(size) + ":"
+      + std::to_string(modified.time_since_epoch().count()) + ":"
+      + texture::mip_filter_name(options.filter) + ":"
+      + (options.srgb ? "srgb" : "linear");
+}
+
+std::filesystem::path mip_cache_directory()
+{
+#ifdef DVD_MIP_CACHE_DIR
+  return DVD_MIP_CACHE_DIR;
+#else
+  return std::filesystem::temp_directory_path() / "dvd-mip-cache";
+#endif
+}
+
+// Written under a name no other writer uses and then renamed over the
+// entry, so a reader never sees a torn file and two threads building the
+// same chain each leave a whole one.
+void write_mip_cache(const std::string& cache, const texture::Ktx2Image& image)
+{
+  std::error_code error;
+  std::filesystem::create_directories(
+      std::filesystem::path(cache).parent_path(), error);
+
+  std::ostringstream temporary;
+  temporary << cache << "." << std::this_thread::get_id() << "-"
+            << std::random_device {}() << ".tmp";
+  if (texture::write_ktx2(temporary.str(), image))
+    std::filesystem::rename(temporary.str(), cache, error);
+  std::filesystem::remove(temporary.str(), error);
+}
+
+} // namespace
+
+const char* texture::mip_filter_name(MipFilter filter)
+{
+  switch (filter) {
+  case MipFilter::KAISER:
+    return "kaiser";
+  case MipFilter::LANCZOS:
+    return "lanczos";
+  default:
+    return "box";
+  }
+}
+
+texture::Ktx2Image texture::generate_mipmaps(const unsigned char* rgba,
+    int width, int height, const MipOptions& options,
+    threading::ThreadPool* pool)
+{
+  Ktx2Image image;
+  image.vk_format
+      = options.srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+  image.width = width;
+  image.height = height;
+  image.origin_bottom_left = true;
+  image.levels.emplace_back(
+      rgba, rgba + static_cast<std::size_t>(width) * height * 4);
+
+  std::vector<float> current(static_cast<std::size_t>(width) * height * 4);
+  for_rows(pool, height, [&](std::size_t begin, std::size_t end) {
+    to_linear(rgba + begin * width * 4, (end - begin) * width, options.srgb,
+        current.data() + begin * width * 4);
+  });
+
+  std::vector<float> next;
+  while (width > 1 || height > 1) {
+    int next_width = std::max(1, width / 2);
+    int next_height = std::max(1, height / 2);
+    downsample(current, width, height, next, next_width, next_height,
+        options.filter, pool);
+
+    auto& level = image.levels.emplace_back(
+        static_cast<std::size_t>(next_width) * next_height * 4);
+    for_rows(pool, next_height, [&](std::size_t begin, std::size_t end) {
+      from_linear(next.data() + begin * next_width * 4,
+          (end - begin) * next_width, options.srgb,
+          level.data() + begin * next_width * 4);
+    });
+
+    std::swap(current, next);
+    width = next_width;
+    height = next_height;
+  }
+
+  return image;
+}
+
+std::string texture::mip_cache_path(const std::string& path)
+{
+  // The full path is hashed into the name so same-named sources from
+  // different directories get separate entries.
+  std::error_code error;
+  const auto absolute = std::filesystem::absolute(path, error);
+  std::ostringstream name;
+  name << std::hex
+       << std::hash<std::string> {}(error ? path : absolute.string()) << "-"
+       << std::filesystem::path(path).filename().string() << ".mips.ktx2";
+
+  return (mip_cache_directory() / name.str()).string();
+}
+
+bool texture::load_mipmapped_image(const std::string& path, Ktx2Image& image,
+    const MipOptions& options, threading::ThreadPool* pool)
+{
+  const std::string stamp = source_stamp(path, options);
+  const std::string cache = mip_cache_path(path);
+
+  if (!stamp.empty() && std::filesystem::exists(cache)
+      && read_ktx2(cache, image)) {
+    const std::string* cached_stamp = find_metadata(image, MIP_SOURCE_KEY);
+    if (cached_stamp && *cached_stamp == stamp)
+      return true;
+  }
+
+  IngestedImage source;
+  if (!load_image(path, source, { .srgb = options.srgb }, pool))
+    return false;
+
+  image = generate_mipmaps(
+      source.pixels.data(), source.width, source.height, options, pool);
+
+  // An unwritable cache directory only costs the cache, not the load.
+  if (!stamp.empty()) {
+    image.metadata = { { MIP_SOURCE_KEY, stamp } };
+    write_mip_cache(cache, image);
+  }
+
+  return true;
+}
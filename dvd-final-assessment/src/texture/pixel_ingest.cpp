@@ -0,0 +1,393 @@
+#include "../../include/texture/pixel_ingest.h"
+#include "../../include/threading/thread_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "../../lib/stb_image.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PIXEL_INGEST_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr std::size_t ROWS_PER_CHUNK { 16 };
+
+inline unsigned char premultiply_channel(unsigned char c, unsigned char a)
+{
+  unsigned int t = c * a + 128u;
+  return static_cast<unsigned char>((t + (t >> 8)) >> 8);
+}
+
+void expand_scalar(
+    const unsigned char* rgb, unsigned char* rgba, std::size_t texels)
+{
+  for (std::size_t i = 0; i < texels; i++) {
+    rgba[i * 4 + 0] = rgb[i * 3 + 0];
+    rgba[i * 4 + 1] = rgb[i * 3 + 1];
+    rgba[i * 4 + 2] = rgb[i * 3 + 2];
+    rgba[i * 4 + 3] = 255;
+  }
+}
+
+void premultiply_scalar(unsigned char* rgba, std::size_t texels)
+{
+  for (std::size_t i = 0; i < texels; i++) {
+    unsigned char a = rgba[i * 4 + 3];
+    rgba[i * 4 + 0] = premultiply_channel(rgba[i * 4 + 0], a);
+    rgba[i * 4 + 1] = premultiply_channel(rgba[i * 4 + 1], a);
+    rgba[i * 4 + 2] = premultiply_channel(rgba[i * 4 + 2], a);
+  }
+}
+
+#ifdef PIXEL_INGEST_X86
+
+// Spreads four packed RGB texels over four RGBA lanes; alpha is OR-ed in.
+#define RGB_TO_RGBA_SHUFFLE \
+  0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+// Each texel's alpha widened to 16 bits under its colour channels, for the
+// low (texels 0, 1) and high (texels 2, 3) halves of a 128-bit lane.
+#define ALPHA_LOW_SHUFFLE \
+  3, -1, 3, -1, 3, -1, 3, -1, 7, -1, 7, -1, 7, -1, 7, -1
+#define ALPHA_HIGH_SHUFFLE \
+  11, -1, 11, -1, 11, -1, 11, -1, 15, -1, 15, -1, 15, -1, 15, -1
+
+// The last 16-byte load starts 12 bytes into a group of four texels, so the
+// vector loops stop early enough never to read past the source row.
+__attribute__((target("ssse3"))) void expand_ssse3(
+    const unsigned char* rgb, unsigned char* rgba, std::size_t texels)
+{
+  const __m128i shuffle = _mm_setr_epi8(RGB_TO_RGBA_SHUFFLE);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+
+  std::size_t i = 0;
+  for (; i + 6 <= texels; i += 4) {
+    __m128i source
+        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+    __m128i expanded = _mm_or_si128(_mm_shuffle_epi8(source, shuffle), alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), expanded);
+  }
+
+  expand_scalar(rgb + i * 3, rgba + i * 4, texels - i);
+}
+
+__attribute__((target("avx2"))) void expand_avx2(
+    const unsigned char* rgb, unsigned char* rgba, std::size_t texels)
+{
+  const __m256i shuffle = _mm256_setr_epi8(
+      RGB_TO_RGBA_SHUFFLE, RGB_TO_RGBA_SHUFFLE);
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+
+  std::size_t i = 0;
+  for (; i + 10 <= texels; i += 8) {
+    __m128i low
+        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+    __m128i high
+        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3 + 12));
+    __m256i source = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+    __m256i expanded
+        = _mm256_or_si256(_mm256_shuffle_epi8(source, shuffle), alpha);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), expanded);
+  }
+
+  expand_ssse3(rgb + i * 3, rgba + i * 4, texels - i);
+}
+
+__attribute__((target("ssse3"))) inline __m128i premultiply_half_ssse3(
+    __m128i colour, __m128i alpha)
+{
+  const __m128i round = _mm_set1_epi16(128);
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(colour, alpha), round);
+  return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("ssse3"))) void premultiply_ssse3(
+    unsigned char* rgba, std::size_t texels)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_low = _mm_setr_epi8(ALPHA_LOW_SHUFFLE);
+  const __m128i alpha_high = _mm_setr_epi8(ALPHA_HIGH_SHUFFLE);
+  const __m128i alpha_bytes = _mm_set1_epi32(static_cast<int>(0xff000000u));
+
+  std::size_t i = 0;
+  for (; i + 4 <= texels; i += 4) {
+    auto* p = reinterpret_cast<__m128i*>(rgba + i * 4);
+    __m128i texel = _mm_loadu_si128(p);
+    __m128i low = premultiply_half_ssse3(
+        _mm_unpacklo_epi8(texel, zero), _mm_shuffle_epi8(texel, alpha_low));
+    __m128i high = premultiply_half_ssse3(
+        _mm_unpackhi_epi8(texel, zero), _mm_shuffle_epi8(texel, alpha_high));
+    __m128i packed = _mm_packus_epi16(low, high);
+    _mm_storeu_si128(p,
+        _mm_or_si128(_mm_andnot_si128(alpha_bytes, packed),
+            _mm_and_si128(alpha_bytes, texel)));
+  }
+
+  premultiply_scalar(rgba + i * 4, texels - i);
+}
+
+__attribute__((target("avx2"))) inline __m256i premultiply_half_avx2(
+    __m256i colour, __m256i alpha)
+{
+  const __m256i round = _mm256_set1_epi16(128);
+  __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(colour, alpha), round);
+  return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+// Unpack, shuffle and pack all work within 128-bit lanes, so the SSSE3
+// masks apply unchanged to each half.
+__attribute__((target("avx2"))) void premultiply_avx2(
+    unsigned char* rgba, std::size_t texels)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i alpha_low
+      = _mm256_setr_epi8(ALPHA_LOW_SHUFFLE, ALPHA_LOW_SHUFFLE);
+  const __m256i alpha_high
+      = _mm256_setr_epi8(ALPHA_HIGH_SHUFFLE, ALPHA_HIGH_SHUFFLE);
+  const __m256i alpha_bytes
+      = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+
+  std::size_t i = 0;
+  for (; i + 8 <= texels; i += 8) {
+    auto* p = reinterpret_cast<__m256i*>(rgba + i * 4);
+    __m256i texel = _mm256_loadu_si256(p);
+    __m256i low = premultiply_half_avx2(_mm256_unpacklo_epi8(texel, zero),
+        _mm256_shuffle_epi8(texel, alpha_low));
+    __m256i high = premultiply_half_avx2(_mm256_unpackhi_epi8(texel, zero),
+        _mm256_shuffle_epi8(texel, alpha_high));
+    __m256i packed = _mm256_packus_epi16(low, high);
+    _mm256_storeu_si256(p,
+        _mm256_or_si256(_mm256_andnot_si256(alpha_bytes, packed),
+            _mm256_and_si256(alpha_bytes, texel)));
+  }
+
+  premultiply_ssse3(rgba + i * 4, texels - i);
+}
+
+#undef RGB_TO_RGBA_SHUFFLE
+#undef ALPHA_LOW_SHUFFLE
+#undef ALPHA_HIGH_SHUFFLE
+
+#endif
+
+void expand_grey_to_rgba(const unsigned char* grey, unsigned char* rgba,
+    std::size_t texels, bool has_alpha)
+{
+  const int stride = has_alpha ? 2 : 1;
+  for (std::size_t i = 0; i < texels; i++) {
+    unsigned char g = grey[i * stride];
+    rgba[i * 4 + 0] = g;
+    rgba[i * 4 + 1] = g;
+    rgba[i * 4 + 2] = g;
+    rgba[i * 4 + 3] = has_alpha ? grey[i * stride + 1] : 255;
+  }
+}
+
+} // namespace
+
+texture::PixelFormat texture::pixel_format_for(int channels, bool srgb)
+{
+  switch (channels) {
+  case 1:
+    return { GL_R8, GL_RED, 1 };
+  case 2:
+    return { GL_RG8, GL_RG, 2 };
+  case 3:
+    return { static_cast<GLenum>(srgb ? GL_SRGB8 : GL_RGB8), GL_RGB, 3 };
+  default:
+    return { static_cast<GLenum>(srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8), GL_RGBA,
+      4 };
+  }
+}
+
+int texture::unpack_alignment(std::size_t row_bytes)
+{
+  for (int alignment : { 8, 4, 2 }) {
+    if (row_bytes % alignment == 0)
+      return alignment;
+  }
+
+  return 1;
+}
+
+bool texture::pixel_kernel_supported(PixelKernel kernel)
+{
+  switch (kernel) {
+  case PixelKernel::SCALAR:
+    return true;
+#ifdef PIXEL_INGEST_X86
+  case PixelKernel::SSSE3:
+    return __builtin_cpu_supports("ssse3");
+  case PixelKernel::AVX2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+texture::PixelKernel texture::best_pixel_kernel()
+{
+  static const PixelKernel best = [] {
+    if (pixel_kernel_supported(PixelKernel::AVX2))
+      return PixelKernel::AVX2;
+    if (pixel_kernel_supported(PixelKernel::SSSE3))
+      return PixelKernel::SSSE3;
+    return PixelKernel::SCALAR;
+  }();
+
+  return best;
+}
+
+const char* texture::pixel_kernel_name(PixelKernel kernel)
+{
+  switch (kernel) {
+  case PixelKernel::SCALAR:
+    return "scalar";
+  case PixelKernel::SSSE3:
+    return "ssse3";
+  case PixelKernel::AVX2:
+    return "avx2";
+  default:
+    return "unknown";
+  }
+}
+
+void texture::expand_rgb_to_rgba(const unsigned char* rgb,
+    unsigned char* rgba, std::size_t texels, PixelKernel kernel)
+{
+  switch (kernel) {
+#ifdef PIXEL_INGEST_X86
+  case PixelKernel::AVX2:
+    expand_avx2(rgb, rgba, texels);
+    return;
+  case PixelKernel::SSSE3:
+    expand_ssse3(rgb, rgba, texels);
+    return;
+#endif
+  default:
+    expand_scalar(rgb, rgba, texels);
+    return;
+  }
+}
+
+void texture::premultiply_alpha(
+    unsigned char* rgba, std::size_t texels, PixelKernel kernel)
+{
+  switch (kernel) {
+#ifdef PIXEL_INGEST_X86
+  case PixelKernel::AVX2:
+    premultiply_avx2(rgba, texels);
+    return;
+  case PixelKernel::SSSE3:
+    premultiply_ssse3(rgba, texels);
+    return;
+#endif
+  default:
+    premultiply_scalar(rgba, texels);
+    return;
+  }
+}
+
+texture::IngestedImage texture::ingest_pixels(const unsigned char* pixels,
+    int width, int height, int channels, const IngestOptions& options,
+    threading::ThreadPool* pool)
+{
+  const int output_channels = options.expand_to_rgba ? 4 : channels;
+  const std::size_t source_row = static_cast<std::size_t>(width) * channels;
+  const std::size_t target_row
+      = static_cast<std::size_t>(width) * output_channels;
+  const PixelKernel kernel = best_pixel_kernel();
+
+  IngestedImage image;
+  image.width = width;
+  image.height = height;
+  image.format = pixel_format_for(output_channels, options.srgb);
+  image.pixels.resize(target_row * height);
+
+  auto convert_rows = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t y = begin; y < end; y++) {
+      const unsigned char* source = pixels + y * source_row;
+      std::size_t target_y = options.flip_vertically ? height - 1 - y : y;
+      unsigned char* target = image.pixels.data() + target_y * target_row;
+
+      if (output_channels == channels)
+        std::memcpy(target, source, source_row);
+      else if (channels == 3)
+        expand_rgb_to_rgba(source, target, width, kernel);
+      else
+        expand_grey_to_rgba(source, target, width, channels == 2);
+
+      if (options.premultiply_alpha && output_channels == 4)
+        premultiply_alpha(target, width, kernel);
+    }
+  };
+
+  if (pool)
+    pool->parallel_for(height, ROWS_PER_CHUNK, convert_rows);
+  else
+    convert_rows(0, height);
+
+  return image;
+}
+
+bool texture::load_image(const std::string& path, IngestedImage& image,
+    const IngestOptions& options, threading::ThreadPool* pool)
+{
+  stbi_set_flip_vertically_on_load_thread(false);
+
+  int width, height, channels;
+  unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+  if (!pixels) {
+    std::cout << "failed to load file: " << path << std::endl;
+    return false;
+  }
+
+  image = ingest_pixels(pixels, width, height, channels, options, pool);
+  stbi_image_free(pixels);
+  return true;
+}
+
+bool texture::decode_image(const unsigned char* encoded, std::size_t size,
+    IngestedImage& image, const IngestOptions& options,
+    threading::ThreadPool* pool)
+{
+  stbi_set_flip_vertically_on_load_thread(false);
+
+  int width, height, channels;
+  unsigned char* pixels = stbi_load_from_memory(encoded,
+      static_cast<int>(size), &width, &height, &channels, 0);
+  if (!pixels)
+    return false;
+
+  image = ingest_pixels(pixels, width, height, channels, options, pool);
+  stbi_image_free(pixels);
+  return true;
+}
+
+void texture::upload_pixels(const unsigned char* pixels, int width,
+    int height, const PixelFormat& format, GLint level)
+{
+  const std::size_t row_bytes
+      = static_cast<std::size_t>(width) * format.channels;
+
+  if (format.channels <= 2) {
+    const GLint swizzle[] = { GL_RED, GL_RED, GL_RED,
+      format.channels == 2 ? GL_GREEN : GL_ONE };
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment(row_bytes));
+  glTexImage2D(GL_TEXTURE_2D, level, format.internal_format, width, height,
+      0, format.format, GL_UNSIGNED_BYTE, pixels);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void texture::upload_image(const IngestedImage& image, GLint level)
+{
+  upload_pixels(
+      image.pixels.data(), image.width, image.height, image.format, level);
+}
@@ -0,0 +1,2 @@
+// The one translation unit that compiles the stb_image implementation.
+#include "../../lib/stb_image.hpp"
@@ -0,0 +1,218 @@
+#include "../../include/threading/job_system.h"
+
+#include <cassert>
+#include <chrono>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+constexpr int SPINS_BEFORE_YIELD { 64 };
+constexpr int SPINS_BEFORE_SLEEP { 1024 };
+
+thread_local threading::JobSystem* current_system {};
+thread_local unsigned int current_index {};
+
+void pin_current_thread(unsigned int core)
+{
+#ifdef __linux__
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#else
+  (void)core;
+#endif
+}
+
+std::uint32_t next_random(std::uint32_t& state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+} // namespace
+
+threading::JobSystem::JobSystem(unsigned int thread_count, bool pin_to_cores)
+{
+  thread_count = std::max(1u, thread_count);
+
+  for (unsigned int i = 0; i < thread_count; i++) {
+    queues.push_back(std::make_unique<ThreadQueue>());
+    queues.back()->random_state = 0x9e3779b9u * (i + 1);
+  }
+
+  current_system = this;
+  current_index = 0;
+  if (pin_to_cores)
+    pin_current_thread(0);
+
+  for (unsigned int i = 1; i < thread_count; i++) {
+    workers.emplace_back([this, i, pin_to_cores] {
+      if (pin_to_cores)
+        pin_current_thread(i);
+      worker_loop(i);
+    });
+  }
+}
+
+threading::JobSystem::~JobSystem()
+{
+  stopping.store(true);
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+  }
+  sleep_signal.notify_all();
+
+  for (auto& worker : workers)
+    worker.join();
+
+  // Jobs that were run but never waited on still run: with the workers
+  // joined, this thread steals them from every queue, including whatever
+  // they spawn onto its own.
+  for (bool drained = false; !drained;) {
+    drained = true;
+    for (auto& queue : queues) {
+      while (Job* job = queue->deque.steal()) {
+        execute(job);
+        drained = false;
+      }
+    }
+  }
+
+  if (current_system == this)
+    current_system = nullptr;
+}
+
+threading::JobSystem::ThreadQueue& threading::JobSystem::local_queue()
+{
+  // Any other thread would share queue 0 with its owner, and the deque
+  // only tolerates one thread at the bottom.
+  assert(current_system == this
+      && "JobSystem used from a thread that neither constructed it nor "
+         "works for it");
+  return *queues[current_index];
+}
+
+threading::Job* threading::JobSystem::allocate_job(Job* parent)
+{
+  ThreadQueue& queue = local_queue();
+  Job* job = &queue.jobs[queue.next_job++ & (MAX_JOBS_PER_THREAD - 1)];
+
+  // The ring wrapped onto a job that is still alive; help until it is done.
+  while (job->unfinished.load(std::memory_order_acquire) > 0) {
+    if (Job* other = find_job())
+      execute(other);
+    else
+      std::this_thread::yield();
+  }
+
+  job->parent = parent;
+  job->unfinished.store(1, std::memory_order_relaxed);
+  if (parent)
+    parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+
+  return job;
+}
+
+void threading::JobSystem::run(Job* job)
+{
+  if (!local_queue().deque.push(job)) {
+    execute(job);
+    return;
+  }
+
+  if (sleeping.load(std::memory_order_relaxed) > 0)
+    sleep_signal.notify_one();
+}
+
+void threading::JobSystem::wait(Job* job)
+{
+  int idle = 0;
+  while (job->unfinished.load(std::memory_order_acquire) > 0) {
+    if (Job* other = find_job()) {
+      execute(other);
+      idle = 0;
+    } else if (++idle > SPINS_BEFORE_YIELD) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+threading::Job* threading::JobSystem::find_job()
+{
+  ThreadQueue& own = local_queue();
+  if (Job* job = own.deque.pop())
+    return job;
+
+  const std::size_t count = queues.size();
+  if (count == 1)
+    return nullptr;
+
+  std::size_t start = next_random(own.random_state) % count;
+  for (std::size_t i = 0; i < count; i++) {
+    std::size_t victim = (start + i) % count;
+    if (victim == current_index)
+      continue;
+    if (Job* job = queues[victim]->deque.steal())
+      return job;
+  }
+
+  return nullptr;
+}
+
+void threading::JobSystem::execute(Job* job)
+{
+  job->function(*job);
+  finish(job);
+}
+
+void threading::JobSystem::finish(Job* job)
+{
+  while (job) {
+    // Once the count reaches zero the owner may reuse the slot, so the
+    // parent has to be read first.
+    Job* parent = job->parent;
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      return;
+    job = parent;
+  }
+}
+
+void threading::JobSystem::worker_loop(unsigned int index)
+{
+  current_system = this;
+  current_index = index;
+
+  int idle = 0;
+  while (!stopping.load(std::memory_order_relaxed)) {
+    if (Job* job = find_job()) {
+      execute(job);
+      idle = 0;
+      continue;
+    }
+
+    idle++;
+    if (idle < SPINS_BEFORE_YIELD)
+      continue;
+    if (idle < SPINS_BEFORE_SLEEP) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Timed so a push that raced with going to sleep costs at most a
+    // millisecond rather than a lost wakeup.
+    sleeping.fetch_add(1);
+    {
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      sleep_signal.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    sleeping.fetch_sub(1);
+    idle = SPINS_BEFORE_YIELD;
+  }
+}
@@ -0,0 +1,28 @@
+#include "../../include/threading/task.h"
+
+void threading::ResumeQueue::push(std::coroutine_handle<> handle)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  waiting.push_back(handle);
+}
+
+std::size_t threading::ResumeQueue::drain()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running.swap(waiting);
+  }
+
+  for (auto handle : running)
+    handle.resume();
+
+  const std::size_t resumed = running.size();
+  running.clear();
+  return resumed;
+}
+
+std::size_t threading::ResumeQueue::pending() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return waiting.size();
+}
@@ -0,0 +1,86 @@
+#include "../../include/threading/thread_pool.h"
+
+#include <algorithm>
+
+threading::ThreadPool::ThreadPool(unsigned int thread_count)
+{
+  for (unsigned int i = 1; i < thread_count; i++)
+    workers.emplace_back([this] { worker_loop(); });
+}
+
+threading::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for (auto& worker : workers)
+    worker.join();
+}
+
+void threading::ThreadPool::parallel_for(std::size_t count,
+    std::size_t chunk_size,
+    const std::function<void(std::size_t, std::size_t)>& body)
+{
+  if (count == 0)
+    return;
+
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  if (workers.empty() || count <= chunk_size) {
+    body(0, count);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = &body;
+    job_count = count;
+    job_chunk = chunk_size;
+    next_chunk.store(0, std::memory_order_relaxed);
+    pending_workers = workers.size();
+    generation++;
+  }
+  wake.notify_all();
+
+  run_chunks();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [this] { return pending_workers == 0; });
+  job = nullptr;
+}
+
+void threading::ThreadPool::worker_loop()
+{
+  std::uint64_t seen_generation = 0;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock,
+          [&] { return stopping || generation != seen_generation; });
+      if (stopping)
+        return;
+      seen_generation = generation;
+    }
+
+    run_chunks();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--pending_workers == 0)
+      finished.notify_one();
+  }
+}
+
+void threading::ThreadPool::run_chunks()
+{
+  for (;;) {
+    std::size_t begin
+        = next_chunk.fetch_add(job_chunk, std::memory_order_relaxed);
+    if (begin >= job_count)
+      return;
+
+    (*job)(begin, std::min(begin + job_chunk, job_count));
+  }
+}
@@ -0,0 +1,125 @@
+// Offline asset packer: bakes shaders, textures and buffer data into one
+// archive that asset::AssetArchive memory maps at runtime.
+//
+//   asset-packer <output.pak> <root-dir> <file>...
+//
+// Entries are named by their path relative to root-dir. Images are decoded
+// and their Kaiser-filtered mip chain is baked to RGBA8, so the runtime
+// neither decodes nor generates mips. Shaders (.vs/.vert, .fs/.frag,
+// .gs/.geom) are stored as source text; anything else is stored raw.
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/asset/asset_archive.h"
+#include "../include/asset/file_io.h"
+#include "../include/resource/resource_cache.h"
+#include "../include/texture/mipmap.h"
+#include "../include/texture/pixel_ingest.h"
+
+namespace {
+
+bool is_shader(const std::string& extension)
+{
+  for (const char* candidate :
+      { ".vs", ".vert", ".fs", ".frag", ".gs", ".geom" }) {
+    if (extension == candidate)
+      return true;
+  }
+  return false;
+}
+
+bool is_image(const std::string& extension)
+{
+  for (const char* candidate : { ".png", ".jpg", ".jpeg", ".tga", ".bmp" }) {
+    if (extension == candidate)
+      return true;
+  }
+  return false;
+}
+
+bool bake_texture(const std::string& path, asset::ArchiveInput& input,
+    threading::ThreadPool& pool)
+{
+  texture::IngestedImage image;
+  if (!texture::load_image(path, image, { .srgb = true }, &pool))
+    return false;
+
+  auto mips = texture::generate_mipmaps(image.pixels.data(), image.width,
+      image.height, { texture::MipFilter::KAISER, true }, &pool);
+
+  input.kind = asset::AssetKind::TEXTURE;
+  input.width = static_cast<std::uint32_t>(image.width);
+  input.height = static_cast<std::uint32_t>(image.height);
+  input.level_count = static_cast<std::uint32_t>(mips.levels.size());
+  input.format = GL_RGBA8;
+  for (const auto& level : mips.levels)
+    input.data.insert(input.data.end(), level.begin(), level.end());
+
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 4) {
+    std::cout << "usage: " << argv[0]
+              << " <output.pak> <root-dir> <file>...\n";
+    return EXIT_FAILURE;
+  }
+
+  const std::string output = argv[1];
+  const std::filesystem::path root = argv[2];
+
+  threading::ThreadPool pool;
+  std::vector<asset::ArchiveInput> inputs;
+  std::size_t source_bytes = 0;
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 3; i < argc; i++) {
+    const std::filesystem::path path = argv[i];
+    const std::string extension = path.extension().string();
+
+    asset::ArchiveInput input;
+    input.name = std::filesystem::relative(path, root).generic_string();
+
+    if (!resource::hash_file(path.string(), input.content_hash))
+      return EXIT_FAILURE;
+    source_bytes += std::filesystem::file_size(path);
+
+    if (is_image(extension)) {
+      if (!bake_texture(path.string(), input, pool))
+        return EXIT_FAILURE;
+    } else {
+      input.kind
+          = is_shader(extension) ? asset::AssetKind::SHADER : asset::AssetKind::RAW;
+      if (!asset::read_file(path.string(), input.data)) {
+        std::cout << "failed to load file: " << path.string() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << input.name << ": " << asset::asset_kind_name(input.kind)
+              << ", " << input.data.size() << " bytes\n";
+    inputs.push_back(std::move(input));
+  }
+
+  if (!asset::write_archive(output, std::move(inputs)))
+    return EXIT_FAILURE;
+
+  std::chrono::duration<double, std::milli> elapsed
+      = std::chrono::steady_clock::now() - start;
+
+  std::cout << output << ": " << argc - 3 << " asset(s), "
+            << std::filesystem::file_size(output) << " bytes from "
+            << source_bytes << " source bytes in " << elapsed.count()
+            << " ms\n";
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,41 @@
+// Offline atlas builder: packs images into <prefix>.tga and writes the
+// name -> UV lookup to <prefix>.atlas.
+//
+//   atlas-packer <output-prefix> <image> [<image> ...]
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/texture/atlas.h"
+
+int main(int argc, char** argv)
+{
+  if (argc < 3) {
+    std::cout << "usage: " << argv[0] << " <output-prefix> <image>...\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string prefix = argv[1];
+  std::vector<std::string> paths(argv + 2, argv + argc);
+
+  auto images = texture::load_atlas_images(paths);
+  if (images.empty())
+    return EXIT_FAILURE;
+
+  texture::TextureAtlas atlas;
+  if (!atlas.build(images))
+    return EXIT_FAILURE;
+
+  if (!atlas.write(prefix + ".tga", prefix + ".atlas"))
+    return EXIT_FAILURE;
+
+  const auto& stats = atlas.stats();
+  std::cout << "images: " << stats.images << "\n"
+            << "atlas: " << stats.width << "x" << stats.height << "\n"
+            << "occupancy: " << stats.occupancy * 100.0 << " %\n"
+            << "packing time: " << stats.packing_ms << " ms\n";
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,553 @@
+// Offline asset bake: turns source assets into files the runtime can use
+// without parsing them.
+//
+//   bake [--force] [--srgb | --linear] [--db <file>] <source-dir>
+//        <output-dir> <input>...
+//
+// Inputs are paths relative to source-dir and keep that path under
+// output-dir:
+//
+//   .obj                      -> .mesh  vertex cache optimized, quantized
+//                                       to 16 bytes a vertex (baked_mesh.h)
+//   .png .jpg .jpeg .tga .bmp -> .ktx2  Kaiser mip chain, BC7 UNORM
+//                                       (see --srgb)
+//   .vs .fs .gs .vert .frag .geom       #include resolved, comments
+//                                       stripped, one file per variant
+//
+// A shader lists its variants on a line of its own,
+//
+//   // bake-variants: TEXTURED SKINNED
+//
+// and gets, besides the plain file, name.textured.vs and name.skinned.vs
+// with the #define inserted after #version.
+//
+// Colour images are mipmapped in linear light either way. By default
+// (--linear) the result is stored as UNORM, so the shader samples the same
+// encoded values the PNG holds and needs no sRGB framebuffer. --srgb tags
+// the data BC7_SRGB instead, for renderers that enable GL_FRAMEBUFFER_SRGB.
+// Images whose name contains "normal" are always linear.
+//
+// The database (output-dir/bake.db by default) records the content hash of
+// every file an output was built from, including shader includes. An input
+// is rebuilt only when one of those hashes, the recipe, or an output file
+// changed, so a re-run with nothing edited just hashes the sources.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/asset/file_io.h"
+#include "../include/mesh/baked_mesh.h"
+#include "../include/mesh/obj_loader.h"
+#include "../include/resource/resource_cache.h"
+#include "../include/texture/block_compression.h"
+#include "../include/texture/ktx2.h"
+#include "../include/texture/mipmap.h"
+#include "../include/texture/pixel_ingest.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Bump when any recipe's output changes, so old bakes rebuild.
+constexpr const char* BAKE_VERSION { "bake-1" };
+constexpr int MAX_INCLUDE_DEPTH { 16 };
+
+struct BakeRecord {
+  std::uint64_t recipe {};
+  // Source-relative path to content hash.
+  std::map<std::string, std::uint64_t> dependencies;
+  // Output-relative paths.
+  std::vector<std::string> outputs;
+};
+
+struct BakeJob {
+  fs::path source_dir;
+  fs::path output_dir;
+  std::string input;
+  threading::ThreadPool* pool;
+  bool srgb_output;
+  BakeRecord record;
+};
+
+std::string to_hex(std::uint64_t value)
+{
+  std::ostringstream out;
+  out << std::hex << std::setw(16) << std::setfill('0') << value;
+  return out.str();
+}
+
+std::vector<std::string> split(const std::string& text, char separator)
+{
+  std::vector<std::string> parts;
+  std::string part;
+  std::istringstream in(text);
+  while (std::getline(in, part, separator)) {
+    if (!part.empty())
+      parts.push_back(part);
+  }
+  return parts;
+}
+
+// One record per line: input, recipe, dependencies, outputs, tab separated.
+std::map<std::string, BakeRecord> read_database(const fs::path& path)
+{
+  std::map<std::string, BakeRecord> records;
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    auto fields = split(line, '\t');
+    if (fields.size() != 4)
+      continue;
+
+    BakeRecord record;
+    record.recipe = std::stoull(fields[1], nullptr, 16);
+    for (const auto& dependency : split(fields[2], ';')) {
+      const auto equals = dependency.rfind('=');
+      if (equals == std::string::npos)
+        continue;
+      record.dependencies[dependency.substr(0, equals)]
+          = std::stoull(dependency.substr(equals + 1), nullptr, 16);
+    }
+    record.outputs = split(fields[3], ';');
+    records[fields[0]] = std::move(record);
+  }
+
+  return records;
+}
+
+bool write_database(
+    const fs::path& path, const std::map<std::string, BakeRecord>& records)
+{
+  // Written aside and renamed, so an interrupted bake leaves the old one.
+  const fs::path staging = path.string() + ".tmp";
+  {
+    std::ofstream file(staging);
+    for (const auto& [input, record] : records) {
+      file << input << '\t' << to_hex(record.recipe) << '\t';
+      for (const auto& [dependency, hash] : record.dependencies)
+        file << dependency << '=' << to_hex(hash) << ';';
+      file << '\t';
+      for (const auto& output : record.outputs)
+        file << output << ';';
+      file << '\n';
+    }
+    if (!file) {
+      std::cout << "failed to write file: " << staging.string() << std::endl;
+      return false;
+    }
+  }
+
+  std::error_code error;
+  fs::rename(staging, path, error);
+  return !error;
+}
+
+std::string lower(std::string text)
+{
+  std::transform(text.begin(), text.end(), text.begin(),
+      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return text;
+}
+
+bool has_extension(const fs::path& path, std::initializer_list<const char*> list)
+{
+  const std::string extension = lower(path.extension().string());
+  return std::any_of(list.begin(), list.end(),
+      [&](const char* candidate) { return extension == candidate; });
+}
+
+std::string output_name(const std::string& input, const std::string& extension)
+{
+  return fs::path(input).replace_extension(extension).generic_string();
+}
+
+bool prepare_output(const BakeJob& job, const std::string& name)
+{
+  std::error_code error;
+  fs::create_directories((job.output_dir / name).parent_path(), error);
+  return !error;
+}
+
+bool bake_mesh(BakeJob& job)
+{
+  mesh::MeshData data;
+  if (!mesh::load_obj((job.source_dir / job.input).string(), data, job.pool))
+    return false;
+
+  const double before
+      = mesh::average_cache_miss_ratio(data.indices, data.vertices.size());
+  mesh::optimize_mesh(data);
+  const double after
+      = mesh::average_cache_miss_ratio(data.indices, data.vertices.size());
+
+  mesh::BakedMesh baked;
+  mesh::quantize_mesh(data, baked);
+
+  const std::string name = output_name(job.input, ".mesh");
+  if (!prepare_output(job, name)
+      || !mesh::write_baked_mesh((job.output_dir / name).string(), baked))
+    return false;
+
+  std::cout << "  " << data.indices.size() / 3 << " triangles, "
+            << data.vertices.size() << " vertices, ACMR " << std::fixed
+            << std::setprecision(2) << before << " -> " << after << ", "
+            << sizeof(mesh::MeshVertex) << " -> " << mesh::BAKED_VERTEX_BYTES
+            << " bytes per vertex\n";
+  job.record.outputs.push_back(name);
+  return true;
+}
+
+bool bake_texture(BakeJob& job)
+{
+  const bool colour = lower(job.input).find("normal") == std::string::npos;
+  const bool srgb = colour && job.srgb_output;
+
+  texture::IngestedImage loaded;
+  if (!texture::load_image(
+          (job.source_dir / job.input).string(), loaded, { .srgb = colour }))
+    return false;
+
+  const auto mips = texture::generate_mipmaps(loaded.pixels.data(),
+      loaded.width, loaded.height, { texture::MipFilter::KAISER, colour },
+      job.pool);
+
+  texture::Ktx2Image image;
+  image.vk_format = srgb ? texture::VK_FORMAT_BC7_SRGB_BLOCK
+                         : texture::VK_FORMAT_BC7_UNORM_BLOCK;
+  image.width = loaded.width;
+  image.height = loaded.height;
+  image.origin_bottom_left = true;
+  for (std::size_t level = 0; level < mips.levels.size(); level++) {
+    image.levels.push_back(texture::compress_image(mips.levels[level].data(),
+        std::max(1, loaded.width >> level), std::max(1, loaded.height >> level),
+        texture::BlockFormat::BC7));
+  }
+
+  const std::string name = output_name(job.input, ".ktx2");
+  if (!prepare_output(job, name)
+      || !texture::write_ktx2((job.output_dir / name).string(), image))
+    return false;
+
+  std::cout << "  " << loaded.width << "x" << loaded.height << ", "
+            << image.levels.size() << " levels, BC7 "
+            << (srgb ? "sRGB" : "linear") << "\n";
+  job.record.outputs.push_back(name);
+  return true;
+}
+
+// Inlines #include "file" (relative to the including file) and records
+// every file read as a dependency.
+bool expand_includes(BakeJob& job, const fs::path& relative, int depth,
+    std::string& out, std::vector<std::string>& variants)
+{
+  if (depth > MAX_INCLUDE_DEPTH) {
+    std::cout << "includes nested too deeply: " << relative.string()
+              << std::endl;
+    return false;
+  }
+
+  std::vector<unsigned char> bytes;
+  const fs::path path = job.source_dir / relative;
+  std::uint64_t hash;
+  if (!asset::read_file(path.string(), bytes)
+      || !resource::hash_file(path.string(), hash)) {
+    std::cout << "failed to load file: " << path.string() << std::endl;
+    return false;
+  }
+  job.record.dependencies[relative.generic_string()] = hash;
+
+  std::istringstream in(std::string(bytes.begin(), bytes.end()));
+  std::string line;
+  while (std::getline(in, line)) {
+    const auto start = line.find_first_not_of(" \t");
+    const std::string trimmed
+        = start == std::string::npos ? "" : line.substr(start);
+
+    if (trimmed.rfind("// bake-variants:", 0) == 0) {
+      std::istringstream names(trimmed.substr(17));
+      std::string name;
+      while (names >> name)
+        variants.push_back(name);
+      continue;
+    }
+
+    if (trimmed.rfind("#include", 0) == 0) {
+      const auto open = trimmed.find('"');
+      const auto close = trimmed.find('"', open + 1);
+      if (open == std::string::npos || close == std::string::npos) {
+        std::cout << "malformed #include in " << relative.string()
+                  << std::endl;
+        return false;
+      }
+      const fs::path included = (relative.parent_path()
+          / trimmed.substr(open + 1, close - open - 1))
+                                    .lexically_normal();
+      if (!expand_includes(job, included, depth + 1, out, variants))
+        return false;
+      continue;
+    }
+
+    out += line;
+    out += '\n';
+  }
+
+  return true;
+}
+
+// Drops comments, trailing whitespace and blank lines; the driver still
+// parses what is left, but less of it.
+std::string strip_glsl(const std::string& source)
+{
+  std::string code;
+  code.reserve(source.size());
+  for (std::size_t i = 0; i < source.size(); i++) {
+    if (source.compare(i, 2, "//") == 0) {
+      while (i < source.size() && source[i] != '\n')
+        i++;
+    } else if (source.compare(i, 2, "/*") == 0) {
+      const auto end = source.find("*/", i + 2);
+      i = end == std::string::npos ? source.size() : end + 1;
+      code += ' ';
+      continue;
+    }
+    if (i < source.size())
+      code += source[i];
+  }
+
+  std::string out;
+  std::istringstream in(code);
+  std::string line;
+  while (std::getline(in, line)) {
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+    if (!line.empty())
+      out += line + '\n';
+  }
+  return out;
+}
+
+std::string with_define(const std::string& source, const std::string& define)
+{
+  const std::string line = "#define " + define + "\n";
+  if (source.rfind("#version", 0) != 0)
+    return line + source;
+
+  const auto end = source.find('\n');
+  return end == std::string::npos ? source + "\n" + line
+                                  : source.substr(0, end + 1) + line
+          + source.substr(end + 1);
+}
+
+bool write_text(const BakeJob& job, const std::string& name,
+    const std::string& text)
+{
+  if (!prepare_output(job, name))
+    return false;
+
+  std::ofstream file(job.output_dir / name, std::ios::binary);
+  file << text;
+  if (!file) {
+    std::cout << "failed to write file: " << (job.output_dir / name).string()
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool bake_shader(BakeJob& job)
+{
+  std::string source;
+  std::vector<std::string> variants;
+  if (!expand_includes(job, job.input, 0, source, variants))
+    return false;
+
+  const std::string code = strip_glsl(source);
+  if (!write_text(job, job.input, code))
+    return false;
+  job.record.outputs.push_back(job.input);
+
+  const fs::path input(job.input);
+  for (const auto& variant : variants) {
+    const std::string name
+        = (input.parent_path()
+              / (input.stem().string() + "." + lower(variant)
+                  + input.extension().string()))
+              .generic_string();
+    if (!write_text(job, name, with_define(code, variant)))
+      return false;
+    job.record.outputs.push_back(name);
+  }
+
+  std::cout << "  " << source.size() << " -> " << code.size() << " bytes, "
+            << variants.size() + 1 << " variant(s)\n";
+  return true;
+}
+
+// Picks the recipe for an input; null when nothing bakes it.
+bool (*recipe_for(const std::string& input))(BakeJob&)
+{
+  const fs::path path(input);
+  if (has_extension(path, { ".obj" }))
+    return bake_mesh;
+  if (has_extension(path, { ".png", ".jpg", ".jpeg", ".tga", ".bmp" }))
+    return bake_texture;
+  if (has_extension(path, { ".vs", ".fs", ".gs", ".vert", ".frag", ".geom" }))
+    return bake_shader;
+  return nullptr;
+}
+
+class HashCache {
+public:
+  explicit HashCache(const fs::path& root)
+      : root(root)
+  {
+  }
+
+  bool get(const std::string& relative, std::uint64_t& hash)
+  {
+    auto found = hashes.find(relative);
+    if (found == hashes.end()) {
+      std::uint64_t computed;
+      if (!resource::hash_file((root / relative).string(), computed))
+        return false;
+      found = hashes.emplace(relative, computed).first;
+    }
+    hash = found->second;
+    return true;
+  }
+
+private:
+  fs::path root;
+  std::unordered_map<std::string, std::uint64_t> hashes;
+};
+
+bool up_to_date(const BakeRecord& record, std::uint64_t recipe,
+    const fs::path& output_dir, HashCache& hashes)
+{
+  if (record.recipe != recipe || record.outputs.empty())
+    return false;
+
+  for (const auto& [dependency, expected] : record.dependencies) {
+    std::uint64_t hash;
+    if (!hashes.get(dependency, hash) || hash != expected)
+      return false;
+  }
+
+  return std::all_of(record.outputs.begin(), record.outputs.end(),
+      [&](const std::string& output) { return fs::exists(output_dir / output); });
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  bool force = false;
+  bool srgb_output = false;
+  fs::path database;
+  std::vector<std::string> positional;
+
+  for (std::size_t i = 0; i < args.size(); i++) {
+    if (args[i] == "--force")
+      force = true;
+    else if (args[i] == "--srgb")
+      srgb_output = true;
+    else if (args[i] == "--linear")
+      srgb_output = false;
+    else if (args[i] == "--db" && i + 1 < args.size())
+      database = args[++i];
+    else
+      positional.push_back(args[i]);
+  }
+
+  if (positional.size() < 3) {
+    std::cout << "usage: " << argv[0]
+              << " [--force] [--srgb | --linear] [--db <file>] <source-dir>"
+                 " <output-dir> <input>...\n";
+    return EXIT_FAILURE;
+  }
+
+  const fs::path source_dir = positional[0];
+  const fs::path output_dir = positional[1];
+  if (database.empty())
+    database = output_dir / "bake.db";
+  fs::create_directories(output_dir);
+
+  auto records = read_database(database);
+  HashCache hashes(source_dir);
+  threading::ThreadPool pool;
+
+  std::size_t baked = 0;
+  std::size_t skipped = 0;
+  std::size_t failed = 0;
+  const auto start = std::chrono::steady_clock::now();
+
+  for (auto input_it = positional.begin() + 2; input_it != positional.end();
+      ++input_it) {
+    const std::string input = fs::path(*input_it).generic_string();
+    auto recipe = recipe_for(input);
+    if (!recipe) {
+      std::cout << input << ": no recipe for this file type\n";
+      failed++;
+      continue;
+    }
+
+    // The colour space only changes what images bake to.
+    std::string recipe_key = std::string(BAKE_VERSION) + "|"
+        + lower(fs::path(input).extension().string());
+    if (recipe == bake_texture)
+      recipe_key += srgb_output ? "|srgb" : "|linear";
+    const std::uint64_t recipe_hash
+        = resource::hash_bytes(recipe_key.data(), recipe_key.size());
+
+    auto existing = records.find(input);
+    if (!force && existing != records.end()
+        && up_to_date(existing->second, recipe_hash, output_dir, hashes)) {
+      skipped++;
+      continue;
+    }
+
+    std::cout << input << "\n";
+    BakeJob job { source_dir, output_dir, input, &pool, srgb_output, {} };
+    job.record.recipe = recipe_hash;
+
+    // Shaders record their own files as they read includes.
+    std::uint64_t hash;
+    if (!hashes.get(input, hash)) {
+      std::cout << "failed to load file: " << (source_dir / input).string()
+                << std::endl;
+      failed++;
+      continue;
+    }
+    job.record.dependencies[input] = hash;
+
+    if (!recipe(job)) {
+      records.erase(input);
+      failed++;
+      continue;
+    }
+
+    records[input] = std::move(job.record);
+    baked++;
+  }
+
+  if (!write_database(database, records))
+    return EXIT_FAILURE;
+
+  std::chrono::duration<double, std::milli> elapsed
+      = std::chrono::steady_clock::now() - start;
+  std::cout << "baked " << baked << ", up to date " << skipped << ", failed "
+            << failed << " in " << std::fixed << std::setprecision(1)
+            << elapsed.count() << " ms\n";
+
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,106 @@
+// Build step that compiles asset files into the executable:
+//
+//   embed <output.cpp> <root> <file>...
+//
+// writes a source file defining asset::embedded_assets, one byte array per
+// input named by its path relative to root ("texture/dvd-logo.png"). The
+// runtime mounts the table with Vfs::mount_embedded, so loading those files
+// needs no file I/O at all.
+//
+// #embed would do the same without the generated source, but neither
+// GCC 12 nor the clang versions we build with support it in C++.
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/asset/file_io.h"
+
+namespace {
+
+constexpr std::size_t BYTES_PER_LINE { 16 };
+
+// Names go into a string literal.
+std::string escape(const std::string& text)
+{
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 4) {
+    std::cout << "usage: " << argv[0] << " <output.cpp> <root> <file>...\n";
+    return EXIT_FAILURE;
+  }
+
+  const std::filesystem::path root = argv[2];
+  std::ostringstream source;
+  source << "// Generated by embed; do not edit.\n\n"
+         << "#include \"asset/embedded_assets.h\"\n\nnamespace {\n";
+
+  std::vector<std::string> names;
+  std::vector<std::size_t> sizes;
+  std::size_t total = 0;
+
+  for (int i = 3; i < argc; i++) {
+    std::filesystem::path path = argv[i];
+    if (path.is_relative())
+      path = root / path;
+
+    std::vector<unsigned char> bytes;
+    if (!asset::read_file(path.string(), bytes)) {
+      std::cout << "failed to load file: " << path.string() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // 16-aligned so packed vertex data can be read in place.
+    source << "\nalignas(16) const unsigned char asset_" << names.size()
+           << "[] = {";
+    for (std::size_t j = 0; j < bytes.size(); j++) {
+      source << (j % BYTES_PER_LINE ? " " : "\n  ")
+             << static_cast<unsigned>(bytes[j]) << ",";
+    }
+    // An empty file still needs one element to be a valid array.
+    if (bytes.empty())
+      source << " 0 ";
+    source << "\n};\n";
+
+    names.push_back(
+        path.lexically_relative(root).lexically_normal().generic_string());
+    sizes.push_back(bytes.size());
+    total += bytes.size();
+  }
+
+  source << "\n} // namespace\n\nnamespace asset {\n\n"
+         << "const EmbeddedAsset embedded_assets[] = {\n";
+  for (std::size_t i = 0; i < names.size(); i++) {
+    source << "  { \"" << escape(names[i]) << "\", asset_" << i << ", "
+           << sizes[i] << " },\n";
+  }
+  source << "};\n\nconst std::size_t embedded_asset_count { " << names.size()
+         << " };\n\n} // namespace asset\n";
+
+  const std::string output = argv[1];
+  std::ofstream file(output, std::ios::binary);
+  file << source.str();
+  if (!file) {
+    std::cout << "failed to write file: " << output << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "embedded " << names.size() << " files, " << total
+            << " bytes\n";
+  return EXIT_SUCCESS;
+}
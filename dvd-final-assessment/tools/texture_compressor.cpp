@@ -0,0 +1,150 @@
+// Offline block compressor: encodes an image to BC1, BC3 or BC7 on the CPU
+// and writes a KTX2 file that texture::upload_ktx2 hands straight to the GPU.
+//
+//   texture-compressor <bc1|bc3|bc7> [--srgb] [--mips <box|kaiser|lanczos>]
+//                      <input-image> <output.ktx2>
+//
+// With --mips the full chain is generated on the CPU and every level is
+// compressed, so the runtime never calls glGenerateMipmap.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/texture/block_compression.h"
+#include "../include/texture/ktx2.h"
+#include "../include/texture/mipmap.h"
+#include "../include/texture/pixel_ingest.h"
+
+namespace {
+
+bool parse_format(const std::string& name, bool srgb,
+    texture::BlockFormat& format, std::uint32_t& vk_format)
+{
+  if (name == "bc1") {
+    format = texture::BlockFormat::BC1;
+    vk_format = srgb ? texture::VK_FORMAT_BC1_RGB_SRGB_BLOCK
+                     : texture::VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+  } else if (name == "bc3") {
+    format = texture::BlockFormat::BC3;
+    vk_format = srgb ? texture::VK_FORMAT_BC3_SRGB_BLOCK
+                     : texture::VK_FORMAT_BC3_UNORM_BLOCK;
+  } else if (name == "bc7") {
+    format = texture::BlockFormat::BC7;
+    vk_format = srgb ? texture::VK_FORMAT_BC7_SRGB_BLOCK
+                     : texture::VK_FORMAT_BC7_UNORM_BLOCK;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+bool parse_filter(const std::string& name, texture::MipFilter& filter)
+{
+  for (auto candidate : { texture::MipFilter::BOX, texture::MipFilter::KAISER,
+           texture::MipFilter::LANCZOS }) {
+    if (name == texture::mip_filter_name(candidate)) {
+      filter = candidate;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  bool srgb = false;
+  bool mips = false;
+  texture::MipFilter filter = texture::MipFilter::KAISER;
+
+  std::vector<std::string> positional;
+  bool valid = true;
+  for (std::size_t i = 0; i < args.size(); i++) {
+    if (args[i] == "--srgb") {
+      srgb = true;
+    } else if (args[i] == "--mips" && i + 1 < args.size()) {
+      mips = true;
+      valid = valid && parse_filter(args[++i], filter);
+    } else {
+      positional.push_back(args[i]);
+    }
+  }
+
+  if (!valid || positional.size() != 3) {
+    std::cout << "usage: " << argv[0]
+              << " <bc1|bc3|bc7> [--srgb] [--mips <box|kaiser|lanczos>]"
+                 " <input-image> <output.ktx2>\n";
+    return EXIT_FAILURE;
+  }
+
+  texture::BlockFormat format;
+  std::uint32_t vk_format;
+  if (!parse_format(positional[0], srgb, format, vk_format)) {
+    std::cout << "unknown format: " << positional[0] << "\n";
+    return EXIT_FAILURE;
+  }
+
+  const std::string& input = positional[1];
+  const std::string& output = positional[2];
+
+  // Bottom row first, the same orientation the runtime loaders upload.
+  texture::IngestedImage loaded;
+  if (!texture::load_image(input, loaded, { .srgb = srgb }))
+    return EXIT_FAILURE;
+
+  const int width = loaded.width;
+  const int height = loaded.height;
+  const unsigned char* pixels = loaded.pixels.data();
+
+  auto start = std::chrono::steady_clock::now();
+
+  texture::Ktx2Image source;
+  if (mips) {
+    threading::ThreadPool pool;
+    source = texture::generate_mipmaps(
+        pixels, width, height, { filter, srgb }, &pool);
+  } else {
+    source.levels.emplace_back(
+        pixels, pixels + static_cast<std::size_t>(width) * height * 4);
+  }
+
+  texture::Ktx2Image image;
+  image.vk_format = vk_format;
+  image.width = width;
+  image.height = height;
+  image.origin_bottom_left = true;
+
+  std::size_t uncompressed = 0;
+  std::size_t compressed = 0;
+  for (std::size_t level = 0; level < source.levels.size(); level++) {
+    int level_width = std::max(1, width >> level);
+    int level_height = std::max(1, height >> level);
+    image.levels.push_back(texture::compress_image(
+        source.levels[level].data(), level_width, level_height, format));
+    uncompressed += source.levels[level].size();
+    compressed += image.levels.back().size();
+  }
+
+  std::chrono::duration<double, std::milli> encode_ms
+      = std::chrono::steady_clock::now() - start;
+
+  if (!texture::write_ktx2(output, image))
+    return EXIT_FAILURE;
+
+  std::cout << input << ": " << width << "x" << height << ", "
+            << image.levels.size() << " level(s)\n"
+            << "encode time: " << encode_ms.count() << " ms\n"
+            << "GPU memory: " << compressed << " bytes (RGBA8 "
+            << uncompressed << " bytes, "
+            << static_cast<double>(uncompressed) / compressed << "x smaller)\n";
+
+  return EXIT_SUCCESS;
+}
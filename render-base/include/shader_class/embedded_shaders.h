@@ -0,0 +1,21 @@
+#ifndef EMBEDDED_SHADERS_H
+#define EMBEDDED_SHADERS_H
+
+#include <cstddef>
+
+namespace engine {
+
+// A shader compiled into the executable by the embed_shaders build step
+// (tools/embed_shaders.cpp). `source` is null-terminated; `name` is the file
+// name it was embedded from.
+struct EmbeddedShader {
+  const char *name;
+  const char *source;
+  std::size_t size;
+};
+
+extern const EmbeddedShader embedded_shaders[];
+extern const std::size_t embedded_shader_count;
+
+} // namespace engine
+#endif
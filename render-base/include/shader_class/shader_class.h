@@ -9,6 +9,10 @@
 #include <string>
 
 std::string get_file_contents(const char *filename);
+// The copy embedded at build time, or the file itself under
+// $RENDER_BASE_SHADER_DIR when that is set, for editing shaders without a
+// rebuild.
+std::string get_shader_source(const char *filename);
 enum ShaderType { VERTEX, FRAGMENT, PROGRAM };
 std::string get_string_from_enum(ShaderType e);
 
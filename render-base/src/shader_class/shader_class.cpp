@@ -1,4 +1,8 @@
 #include "../../include/shader_class/shader_class.h"
+#include "../../include/shader_class/embedded_shaders.h"
+
+#include <cstdlib>
+#include <cstring>
 
 std::string get_file_contents(const char *filename) {
   std::ifstream in(filename, std::ios::binary);
@@ -15,6 +19,19 @@ std::string get_file_contents(const char *filename) {
   throw(errno);
 }
 
+std::string get_shader_source(const char *filename) {
+  if (const char *directory = std::getenv("RENDER_BASE_SHADER_DIR"))
+    return get_file_contents((std::string(directory) + "/" + filename).c_str());
+
+  for (std::size_t i = 0; i < engine::embedded_shader_count; i++) {
+    const engine::EmbeddedShader &shader = engine::embedded_shaders[i];
+    if (std::strcmp(shader.name, filename) == 0)
+      return std::string(shader.source, shader.size);
+  }
+
+  return get_file_contents(filename);
+}
+
 std::string get_string_from_enum(ShaderType e) {
   switch (e) {
   case VERTEX:
@@ -30,8 +47,8 @@ std::string get_string_from_enum(ShaderType e) {
 
 engine::Shader::Shader(const char *vertex_shader_file,
                        const char *fragment_shader_file) {
-  std::string vertex_code = get_file_contents(vertex_shader_file);
-  std::string fragement_code = get_file_contents(fragment_shader_file);
+  std::string vertex_code = get_shader_source(vertex_shader_file);
+  std::string fragement_code = get_shader_source(fragment_shader_file);
 
   const char *vertexSource = vertex_code.c_str();
   const char *fragmentSource = fragement_code.c_str();
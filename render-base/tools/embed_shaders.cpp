@@ -0,0 +1,69 @@
+// Build step that compiles shader files into the executable:
+//
+//   embed_shaders <output.cpp> <file>...
+//
+// writes a source file defining engine::embedded_shaders, one
+// null-terminated array per input, named by the input's file name.
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cout << "usage: " << argv[0] << " <output.cpp> <file>...\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ostringstream source;
+  source << "// Generated by embed_shaders; do not edit.\n\n"
+         << "#include \"embedded_shaders.h\"\n\nnamespace {\n";
+
+  std::vector<std::string> names;
+  std::vector<std::size_t> sizes;
+
+  for (int i = 2; i < argc; i++) {
+    std::ifstream in(argv[i], std::ios::binary);
+    if (!in) {
+      std::cout << "failed to load file: " << argv[i] << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+
+    // Bytes rather than a raw string literal, so no shader text can end it.
+    source << "\nconst char shader_" << names.size() << "[] = {";
+    for (std::size_t j = 0; j < contents.size(); j++) {
+      source << (j % 16 ? " " : "\n  ")
+             << static_cast<int>(static_cast<unsigned char>(contents[j]))
+             << ",";
+    }
+    source << "\n  0\n};\n";
+
+    names.push_back(std::filesystem::path(argv[i]).filename().string());
+    sizes.push_back(contents.size());
+  }
+
+  source << "\n} // namespace\n\nnamespace engine {\n\n"
+         << "const EmbeddedShader embedded_shaders[] = {\n";
+  for (std::size_t i = 0; i < names.size(); i++) {
+    source << "  { \"" << names[i] << "\", shader_" << i << ", " << sizes[i]
+           << " },\n";
+  }
+  source << "};\n\nconst std::size_t embedded_shader_count { " << names.size()
+         << " };\n\n} // namespace engine\n";
+
+  std::ofstream out(argv[1], std::ios::binary);
+  out << source.str();
+  if (!out) {
+    std::cout << "failed to write file: " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,8 +1,14 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 #include "../lib/include/glad/glad.h"
 #include "../subprojects/glfw-3.3.9/include/GLFW/glfw3.h"
+#include "triple_buffer.h"
 
 class VertexObject {
   private:
@@ -118,6 +124,65 @@ class ShaderProgramObject {
     };
 
     void render() { glUseProgram(shader_program); }
+
+    void set_float(const char *name, float value) {
+        glUniform1f(glGetUniformLocation(shader_program, name), value);
+    }
+};
+
+// Immutable view of the simulation state handed from the simulation thread to
+// the render thread. A new one is published every simulation tick.
+struct FrameSnapshot {
+    std::uint64_t tick{};
+    double simulation_time{};
+    float rotation{};
+    std::chrono::steady_clock::time_point published_at{};
+};
+
+using SimulationStep = std::function<void(FrameSnapshot &, double)>;
+
+class FrameMetrics {
+  private:
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point window_start{clock::now()};
+    std::uint64_t window_start_tick{};
+    std::uint64_t frames{};
+    double latency_sum_ms{};
+    double latency_max_ms{};
+
+  public:
+    void record_frame(double snapshot_latency_ms) {
+        frames++;
+        latency_sum_ms += snapshot_latency_ms;
+        if (snapshot_latency_ms > latency_max_ms)
+            latency_max_ms = snapshot_latency_ms;
+    }
+
+    // Prints the rates once per second: simulation ticks, rendered frames and
+    // the age of the snapshot each frame was drawn from.
+    void report(std::uint64_t simulation_ticks) {
+        auto now = clock::now();
+        double elapsed =
+            std::chrono::duration<double>(now - window_start).count();
+        if (elapsed < 1.0)
+            return;
+
+        double tick_rate = (simulation_ticks - window_start_tick) / elapsed;
+        double frame_rate = frames / elapsed;
+        double latency_avg_ms = frames ? latency_sum_ms / frames : 0.0;
+
+        std::cout << "simulation: " << tick_rate << " ticks/s"
+                  << " | render: " << frame_rate << " frames/s"
+                  << " | snapshot latency: avg " << latency_avg_ms
+                  << " ms, max " << latency_max_ms << " ms" << std::endl;
+
+        window_start = now;
+        window_start_tick = simulation_ticks;
+        frames = 0;
+        latency_sum_ms = 0.0;
+        latency_max_ms = 0.0;
+    }
 };
 
 class Renderer {
@@ -127,6 +192,39 @@ class Renderer {
     int screen_width;
     int screen_height;
     const char *window_name;
+    int simulation_rate{120};
+
+    TripleBuffer<FrameSnapshot> snapshots;
+    std::atomic<bool> simulating{false};
+    std::atomic<std::uint64_t> simulation_ticks{0};
+
+    void run_simulation(const SimulationStep &step) {
+        using clock = std::chrono::steady_clock;
+
+        const double dt = 1.0 / simulation_rate;
+        const auto tick_duration =
+            std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>(dt));
+
+        FrameSnapshot state{};
+        auto next_tick = clock::now();
+
+        while (simulating.load(std::memory_order_relaxed)) {
+            if (step)
+                step(state, dt);
+
+            state.tick++;
+            state.simulation_time += dt;
+            state.published_at = clock::now();
+
+            snapshots.write_slot() = state;
+            snapshots.publish();
+            simulation_ticks.fetch_add(1, std::memory_order_relaxed);
+
+            next_tick += tick_duration;
+            std::this_thread::sleep_until(next_tick);
+        }
+    }
 
   public:
     Renderer() {
@@ -146,6 +244,10 @@ class Renderer {
 
     void set_window_name(const char *name) { window_name = name; }
 
+    void set_simulation_rate(int ticks_per_second) {
+        simulation_rate = ticks_per_second;
+    }
+
     void close_renderer() {
         glfwTerminate();
         exit(EXIT_SUCCESS);
@@ -187,20 +289,45 @@ class Renderer {
             glfwSetWindowShouldClose(window, true);
     }
 
+    // Runs `step` on a simulation thread at simulation_rate ticks per second
+    // while this (GL) thread draws the latest published snapshot, so vsync no
+    // longer throttles the simulation and a slow tick never stalls a frame.
     void render(GLFWwindow *window, ShaderProgramObject &shader_program,
-                VertexObject &vertex_object) {
+                VertexObject &vertex_object,
+                const SimulationStep &step = nullptr) {
+        using clock = std::chrono::steady_clock;
+
+        FrameMetrics metrics{};
+
+        simulating.store(true);
+        std::thread simulation([this, &step] { run_simulation(step); });
 
         while (!glfwWindowShouldClose(window)) {
             close_window_on_esc_callback(window);
 
+            snapshots.consume();
+            const FrameSnapshot &snapshot = snapshots.read_slot();
+
             glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT);
 
             shader_program.render();
+            shader_program.set_float("rotation", snapshot.rotation);
             vertex_object.draw();
 
             glfwPollEvents();
             glfwSwapBuffers(window);
+
+            if (snapshot.tick != 0) {
+                std::chrono::duration<double, std::milli> latency =
+                    clock::now() - snapshot.published_at;
+                metrics.record_frame(latency.count());
+            }
+            metrics.report(
+                simulation_ticks.load(std::memory_order_relaxed));
         }
+
+        simulating.store(false);
+        simulation.join();
     }
 };
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Single-producer / single-consumer triple buffer.
+//
+// The producer always owns one slot (back), the consumer always owns one slot
+// (front) and the third slot (middle) is handed over through a single atomic
+// exchange, so neither side ever blocks or sees a half-written value.
+template <typename T> class TripleBuffer {
+  private:
+    static constexpr std::uint8_t INDEX_MASK{0x3};
+    static constexpr std::uint8_t FRESH_BIT{0x4};
+
+    std::array<T, 3> slots{};
+    std::atomic<std::uint8_t> middle{1};
+    std::uint8_t back{0};
+    std::uint8_t front{2};
+
+  public:
+    // Producer side: fill the slot returned here, then publish it.
+    T &write_slot() { return slots[back]; }
+
+    void publish() {
+        std::uint8_t published = back | FRESH_BIT;
+        back = middle.exchange(published, std::memory_order_acq_rel) &
+               INDEX_MASK;
+    }
+
+    // Consumer side: returns true when a newer value than the one in
+    // read_slot() was published and has been swapped in.
+    bool consume() {
+        if ((middle.load(std::memory_order_acquire) & FRESH_BIT) == 0)
+            return false;
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T &read_slot() const { return slots[front]; }
+};
+
+#endif
@@ -42,9 +42,13 @@ int main() {
     const char *vertex_shader_source =
         "#version 330 core\n"
         "layout (location = 0) in vec3 aPos;\n"
+        "uniform float rotation;\n"
         "void main()\n"
         "{\n"
-        " gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
+        " float c = cos(rotation);\n"
+        " float s = sin(rotation);\n"
+        " gl_Position = vec4(c * aPos.x - s * aPos.y, s * aPos.x + c * aPos.y,\n"
+        "                    aPos.z, 1.0);\n"
         "}\0";
 
     ShaderObject vertex_shader = ShaderObject(GL_VERTEX_SHADER);
@@ -72,7 +76,14 @@ int main() {
 
     shader_program.compile_shader_program();
 
-    renderer.render(window, shader_program, vertex_object);
+    constexpr float ROTATION_SPEED{1.0f}; // radians per second
+
+    renderer.set_simulation_rate(120);
+    renderer.render(window, shader_program, vertex_object,
+                    [](FrameSnapshot &state, double dt) {
+                        state.rotation +=
+                            ROTATION_SPEED * static_cast<float>(dt);
+                    });
 
     renderer.close_renderer();
 }